@@ -0,0 +1,75 @@
+// Data blob benchmarks on generated blobs of 10k, 100k and 1M cells, no database is needed
+//
+// split          - StringUtils::Split to a vector of strings (how blobs were split before tokens)
+// split_offsets  - StringUtils::SplitOffsets, the tokenizer of Assignment,
+//                  with the implementation chosen for the CPU and with each supported one (scalar, sse2, avx2)
+// set_raw_data   - Assignment::SetRawData, a copy of the blob and its tokens
+
+#include <string>
+#include <vector>
+
+#include "Benchmarks/benchmarks.h"
+#include "CCDB/Helpers/StringUtils.h"
+#include "CCDB/Model/Assignment.h"
+
+using namespace std;
+using namespace ccdb;
+
+
+//______________________________________________________________________________
+/** Blob of cellCount cells like "123.12345|" as they are in the vault */
+static string MakeBlob(int cellCount)
+{
+    string blob;
+    blob.reserve(static_cast<size_t>(cellCount) * 12);
+    for(int i = 0; i < cellCount; i++) {
+        blob += StringUtils::IntToString(i % 1000) + ".12345|";
+    }
+    return blob;
+}
+
+
+//______________________________________________________________________________
+void benchmark_BlobSplit(BenchmarkContext& context)
+{
+    const int cellCounts[] = {10000, 100000, 1000000};
+    for(int cellCount: cellCounts) {
+        string blob = MakeBlob(cellCount);
+        string cells = StringUtils::IntToString(cellCount);
+
+        BenchmarkResult result;
+        result.Group = "blob";
+
+        result.Name = "split_" + cells;
+        vector<string> strings;
+        RunBenchmark(context, result, [&](int, uint64_t) {
+            strings.clear();
+            StringUtils::Split(blob, strings, "|");
+        });
+
+        result.Name = "split_offsets_" + cells;
+        vector<StringToken> tokens;
+        RunBenchmark(context, result, [&](int, uint64_t) {
+            StringUtils::SplitOffsets(blob.data(), blob.size(), '|', tokens);
+        });
+
+        const StringUtils::SplitImplementations implementations[] = {
+            StringUtils::cSplitScalar, StringUtils::cSplitSSE2, StringUtils::cSplitAVX2 };
+        const char* implementationNames[] = {"scalar", "sse2", "avx2"};
+        for(size_t implementationIndex = 0; implementationIndex < 3; implementationIndex++) {
+            StringUtils::SplitImplementations implementation = implementations[implementationIndex];
+            if(!StringUtils::IsSplitImplementationSupported(implementation)) continue;
+
+            result.Name = "split_offsets_" + cells + "_" + implementationNames[implementationIndex];
+            RunBenchmark(context, result, [&](int, uint64_t) {
+                StringUtils::SplitOffsets(blob.data(), blob.size(), '|', tokens, implementation);
+            });
+        }
+
+        result.Name = "set_raw_data_" + cells;
+        Assignment assignment;
+        RunBenchmark(context, result, [&](int, uint64_t) {
+            assignment.SetRawData(blob);
+        });
+    }
+}
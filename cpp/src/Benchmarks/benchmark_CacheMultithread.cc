@@ -0,0 +1,60 @@
+// How GetCalib calls scale with the number of threads
+//
+// All threads share one Calibration (as JANA threads do) and read the same tables in turn.
+// warm - the cache is enabled and filled, with a concurrent read path calls per second grow linearly with threads
+// cold - the cache is disabled, each call goes to the provider
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Benchmarks/benchmarks.h"
+#include "CCDB/CalibrationGenerator.h"
+
+using namespace std;
+using namespace ccdb;
+
+
+//______________________________________________________________________________
+void benchmark_CacheMultithread(BenchmarkContext& context)
+{
+    for(const BenchmarkConnection& connection: context.Connections) {
+        vector<string> tables = connection.Tables;
+        tables.insert(tables.end(), connection.RowTables.begin(), connection.RowTables.end());
+
+        string tablesList;
+        for(const auto& table: tables) tablesList += (tablesList.empty() ? "" : ",") + table;
+
+        unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(connection.ConnectionString, 100, "default"));
+
+        for(int isWarm = 0; isWarm < 2; isWarm++) {
+            calib->EnableCache(isWarm != 0);
+            calib->ClearCache();
+
+            vector<vector<double> > values;
+            for(const auto& table: tables) {
+                if(!calib->GetCalib(values, table)) throw std::runtime_error("No constants for " + table);   // warm up
+            }
+
+            for(int threadsCount = 1; ; threadsCount *= 2) {
+                if(threadsCount > context.MaxThreads) threadsCount = context.MaxThreads;
+
+                BenchmarkResult result;
+                result.Group = "threads";
+                result.Name = "vector<vector<double>>";
+                result.Connection = connection.Label;
+                result.Table = tablesList;
+                result.Cache = isWarm ? "warm" : "cold";
+                result.Threads = threadsCount;
+
+                vector<vector<vector<double> > > threadValues(threadsCount);
+                RunBenchmark(context, result, [&](int threadIndex, uint64_t i) {
+                    calib->GetCalib(threadValues[threadIndex], tables[(i + threadIndex) % tables.size()]);
+                });
+
+                if(threadsCount == context.MaxThreads) break;
+            }
+        }
+    }
+}
@@ -0,0 +1,224 @@
+// Generated databases for ccdb_benchmarks
+//
+// The fixture is a copy of the source SQLite database (so the test tables are there too) with
+// /benchmark directory added:
+//   /benchmark/table_<rows>x<columns>   big double table, columns c0, c1, ...
+//   /benchmark/row_<columns>            one row double table
+//   /benchmark/meta/t0000, t0001, ...   small tables (3 int columns) which make metadata load heavy
+// Each table has one assignment in the default variation for all runs.
+// The fixture is also written as .ccdbsnap file for MappedSnapshotDataProvider.
+//
+// Synthetic databases (@see ccdb::SyntheticDatabase) have only generated tables, which are found by their sizes.
+
+#include <stdio.h>
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Benchmarks/benchmarks.h"
+#include "CCDB/CalibrationGenerator.h"
+#include "CCDB/Helpers/SQLite.h"
+#include "CCDB/Helpers/SyntheticDatabase.h"
+#include "CCDB/Model/Catalog.h"
+#include "CCDB/Providers/SnapshotDataProvider.h"
+
+using namespace std;
+using namespace ccdb;
+
+static const char* const cTestTable = "/test/test_vars/test_table";
+static const char* const cTestRow = "/test/test_vars/test_table2::test";
+static const int64_t cDefaultVariationId = 1;
+static const int64_t cAllRunsRangeId = 1;
+
+
+//______________________________________________________________________________
+/** Executes SQL without parameters, like BEGIN or COMMIT */
+static void ExecuteSql(sqlite3* database, const char* sql)
+{
+    char* errorMessage = nullptr;
+    if(sqlite3_exec(database, sql, nullptr, nullptr, &errorMessage) != SQLITE_OK) {
+        string error = string("Fixture SQL error: ") + (errorMessage ? errorMessage : "") + ". Query: " + sql;
+        sqlite3_free(errorMessage);
+        throw std::runtime_error(error);
+    }
+}
+
+
+//______________________________________________________________________________
+/** Adds a directory. Returns its id */
+static int64_t AddDirectory(sqlite3* database, const string& name, int64_t parentId)
+{
+    SQLiteStatement query(database, "INSERT INTO `directories` (`name`, `parentId`, `comment`) VALUES (?1, ?2, 'ccdb_benchmarks fixture')");
+    query.BindString(1, name);
+    query.BindInt64(2, parentId);
+    query.Execute([](uint64_t rowIndex) {});
+    return sqlite3_last_insert_rowid(database);
+}
+
+
+//______________________________________________________________________________
+/** Adds a type table with columns of columnType named prefix0, prefix1... and its assignment with the vault */
+static void AddTable(sqlite3* database, int64_t directoryId, const string& name, int rows, int columns,
+                     const char* columnType, const string& vault)
+{
+    SQLiteStatement tableQuery(database,
+        "INSERT INTO `typeTables` (`directoryId`, `name`, `nRows`, `nColumns`, `comment`) VALUES (?1, ?2, ?3, ?4, 'ccdb_benchmarks fixture')");
+    tableQuery.BindInt64(1, directoryId);
+    tableQuery.BindString(2, name);
+    tableQuery.BindInt32(3, rows);
+    tableQuery.BindInt32(4, columns);
+    tableQuery.Execute([](uint64_t rowIndex) {});
+    int64_t tableId = sqlite3_last_insert_rowid(database);
+
+    SQLiteStatement columnQuery(database, "INSERT INTO `columns` (`name`, `typeId`, `columnType`, `order`) VALUES (?1, ?2, ?3, ?4)");
+    for(int column = 0; column < columns; column++) {
+        columnQuery.BindString(1, "c" + to_string(column));
+        columnQuery.BindInt64(2, tableId);
+        columnQuery.BindString(3, columnType);
+        columnQuery.BindInt32(4, column);
+        columnQuery.Execute([](uint64_t rowIndex) {});
+    }
+
+    SQLiteStatement setQuery(database, "INSERT INTO `constantSets` (`vault`, `constantTypeId`) VALUES (?1, ?2)");
+    setQuery.BindString(1, vault);
+    setQuery.BindInt64(2, tableId);
+    setQuery.Execute([](uint64_t rowIndex) {});
+    int64_t constantSetId = sqlite3_last_insert_rowid(database);
+
+    SQLiteStatement assignmentQuery(database,
+        "INSERT INTO `assignments` (`variationId`, `runRangeId`, `constantSetId`, `comment`) VALUES (?1, ?2, ?3, 'ccdb_benchmarks fixture')");
+    assignmentQuery.BindInt64(1, cDefaultVariationId);
+    assignmentQuery.BindInt64(2, cAllRunsRangeId);
+    assignmentQuery.BindInt64(3, constantSetId);
+    assignmentQuery.Execute([](uint64_t rowIndex) {});
+}
+
+
+//______________________________________________________________________________
+/** Vault of rows x columns doubles */
+static string MakeDoubleVault(int rows, int columns)
+{
+    string vault;
+    char value[32];
+    for(int i = 0; i < rows * columns; i++) {
+        snprintf(value, sizeof(value), "%.6f", 1.0 + i * 0.001);
+        if(i) vault += '|';
+        vault += value;
+    }
+    return vault;
+}
+
+
+//______________________________________________________________________________
+BenchmarkFixture CreateBenchmarkFixture(const std::string& sourceSQLitePath, const std::string& directory,
+                                        int rows, int columns, int metadataTables)
+{
+    BenchmarkFixture fixture;
+    fixture.Directory = directory;
+    fixture.SQLitePath = directory + "/fixture.sqlite";
+    fixture.SnapshotPath = directory + "/fixture.ccdbsnap";
+    fixture.TablePath = "/benchmark/table_" + to_string(rows) + "x" + to_string(columns);
+    fixture.RowPath = "/benchmark/row_" + to_string(columns);
+    fixture.Rows = rows;
+    fixture.Columns = columns;
+    fixture.MetadataTables = metadataTables;
+
+    {
+        ifstream source(sourceSQLitePath, ios::binary);
+        if(!source) throw std::runtime_error("Can't read " + sourceSQLitePath);
+        ofstream copy(fixture.SQLitePath, ios::binary | ios::trunc);
+        copy<<source.rdbuf();
+        if(!copy) throw std::runtime_error("Can't write " + fixture.SQLitePath);
+    }
+
+    sqlite3* database = nullptr;
+    if(sqlite3_open_v2(fixture.SQLitePath.c_str(), &database, SQLITE_OPEN_READWRITE, nullptr) != SQLITE_OK) { // NOLINT(hicpp-signed-bitwise)
+        string error = "Can't open " + fixture.SQLitePath + ": " + sqlite3_errmsg(database);
+        sqlite3_close(database);
+        throw std::runtime_error(error);
+    }
+
+    try
+    {
+        ExecuteSql(database, "BEGIN");
+
+        int64_t benchmarkDirId = AddDirectory(database, "benchmark", 0);
+        AddTable(database, benchmarkDirId, fixture.TablePath.substr(fixture.TablePath.rfind('/') + 1), rows, columns, "double",
+                 MakeDoubleVault(rows, columns));
+        AddTable(database, benchmarkDirId, fixture.RowPath.substr(fixture.RowPath.rfind('/') + 1), 1, columns, "double",
+                 MakeDoubleVault(1, columns));
+
+        int64_t metaDirId = AddDirectory(database, "meta", benchmarkDirId);
+        char name[16];
+        for(int i = 0; i < metadataTables; i++) {
+            snprintf(name, sizeof(name), "t%04d", i);
+            AddTable(database, metaDirId, name, 1, 3, "int", to_string(i) + "|1|2");
+        }
+
+        ExecuteSql(database, "COMMIT");
+    }
+    catch (...)
+    {
+        sqlite3_close(database);
+        throw;
+    }
+    sqlite3_close(database);
+
+    SnapshotDataProvider snapshot;
+    snapshot.Connect(string(SnapshotDataProvider::ConnectionPrefix) + fixture.SQLitePath + "?blobs=eager");
+    snapshot.WriteBinarySnapshot(fixture.SnapshotPath);
+
+    return fixture;
+}
+
+
+//______________________________________________________________________________
+std::string CreateSyntheticDatabase(const std::string& directory, uint64_t seed)
+{
+    SyntheticDatabaseOptions options;
+    options.Seed = seed;
+
+    string filePath = directory + "/synthetic.sqlite";
+    remove(filePath.c_str());
+    SyntheticDatabase(options).Generate(filePath);
+    return filePath;
+}
+
+
+//______________________________________________________________________________
+void FindBenchmarkTables(BenchmarkConnection& connection)
+{
+    unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(connection.ConnectionString, 100, "default"));
+    shared_ptr<const Catalog> catalog = calib->GetProvider()->GetCatalog();
+
+    connection.Tables.clear();
+    connection.RowTables.clear();
+    if(catalog->FindTable(cTestTable)) {
+        connection.Tables.push_back(cTestTable);
+        connection.RowTables.push_back(cTestRow);
+        return;
+    }
+
+    vector<pair<int64_t, string> > tablesBySize;        //(cells, path) of tables with several rows
+    for(const CatalogTable& table: catalog->GetTables()) {
+        const ConstantsTypeTable& typeTable = *table.TypeTable;
+        if(typeTable.GetRowsCount() > 1) {
+            tablesBySize.emplace_back(static_cast<int64_t>(typeTable.GetRowsCount()) * typeTable.GetColumnsCount(), typeTable.GetFullPath());
+        }
+        else if(connection.RowTables.empty()) {
+            connection.RowTables.push_back(typeTable.GetFullPath());
+        }
+    }
+
+    sort(tablesBySize.begin(), tablesBySize.end());
+    if(tablesBySize.size() > 1) connection.Tables.push_back(tablesBySize[tablesBySize.size() / 2].second);
+    if(!tablesBySize.empty()) connection.Tables.push_back(tablesBySize.back().second);
+
+    if(connection.Tables.empty() && connection.RowTables.empty()) {
+        throw std::runtime_error("No tables to benchmark in " + connection.ConnectionString);
+    }
+}
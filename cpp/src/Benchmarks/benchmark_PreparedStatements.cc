@@ -1,299 +1,172 @@
-#ifndef benchmark_PreparedStatements_h__
-#define benchmark_PreparedStatements_h__
-
-#include <string.h>
-#include <my_global.h>
-#include <mysql.h>
-#include "CCDB/Console.h"
-#include "CCDB/Helpers/StopWatch.h"
-#include "CCDB/Providers/MySQLDataProvider.h"
-#include "CCDB/Model/Assignment.h"
-#include "Benchmarks/benchmarks.h"
-#include "CCDB/Model/ConstantsTypeTable.h"
-
-
-
-/////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////
-#define STRING_SIZE 50
-
-#define SELECT_SAMPLE "SELECT col1, col2, col3, col4 FROM test_table"
-
-MYSQL_STMT    *stmt;
-MYSQL_BIND    out_bind[2];
-MYSQL_BIND    in_binds[4];
-MYSQL_RES     *prepare_meta_result;
-MYSQL_TIME    ts;
-unsigned long length[4];
-int           param_count, column_count, row_count;
-short         small_data;
-int           int_data;
-char          str_data[STRING_SIZE];
-my_bool       is_null[4];
-my_bool       error[4];
-char select_query[]=
+// Measures what is saved by reusing prepared statements for the assignment query
+//
+// Usage: ccdb_bn_prepared [sqlite file or ""] [table path] [run] [iterations]
+// The default file is $CCDB_HOME/sql/ccdb.sqlite with /test/test_vars/test_table and run 100.
+// Three ways are compared:
+//   prepare  - the statement is compiled and finalized for each query (what the provider did before)
+//   reuse    - one persistent statement which is reset and rebound for each query
+//   provider - SQLiteDataProvider::GetAssignmentShort end to end (it uses cached statements)
+//   index    - the same with run-range index mode (a run scan: each iteration asks for the next run)
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <memory>
+#include <stdexcept>
+#include <stdlib.h>
+
+#include <CCDB/Helpers/SQLite.h>
+#include <CCDB/Providers/SQLiteDataProvider.h>
+#include <CCDB/Model/Assignment.h>
+#include <CCDB/Model/ConstantsTypeTable.h>
+
+using namespace std;
+using namespace std::chrono;
+
+static const char* cAssignmentQuery =
     "SELECT `assignments`.`id` AS `asId`, "
     "`constantSets`.`vault` AS `blob` "
     "FROM  `assignments` "
-    "USE INDEX (id_UNIQUE) "
-    "INNER JOIN `runranges` ON `assignments`.`runRangeId`= `runRanges`.`id` "
+    "INNER JOIN `runRanges` ON `assignments`.`runRangeId`= `runRanges`.`id` "
     "INNER JOIN `constantSets` ON `assignments`.`constantSetId` = `constantSets`.`id` "
-    "WHERE  `runRanges`.`runMin` <= ? "
-    "AND `runRanges`.`runMax` >= ? "
-    "AND  `assignments`.`variationId` =? "
-    "AND `constantSets`.`constantTypeId` = ? "
+    "INNER JOIN `typeTables` ON `constantSets`.`constantTypeId` = `typeTables`.`id` "
+    "WHERE  `runRanges`.`runMin` <= ?1 "
+    "AND `runRanges`.`runMax` >= ?1 "
+    "AND `assignments`.`variationId`= ?2 "
+    "AND  `constantSets`.`constantTypeId` =?3 "
     "ORDER BY `assignments`.`id` DESC "
     "LIMIT 1 ";
 
-MYSQL *mysql;
-unsigned long table_id = 1;
-unsigned int variationId=1;
-unsigned long variation_leng = 7;
-char * variation = "default";
 
-//_______________________________________________________________
-bool PreparedQueriesInit()
+//______________________________________________________________________________
+/** Binds the assignment query parameters and runs it. Returns the blob size to keep the work alive */
+static size_t RunAssignmentQuery(ccdb::SQLiteStatement& query, int run, int64_t variationId, int64_t tableId)
 {
-    //Initialize statements
-
-    //init mysql
-    mysql = mysql_init(NULL);
-    if(mysql == NULL)
-    {
-        fprintf(stderr, "mysql_init() returned NULL, probably memory allocation problem");
-        return false;
-    }
-
-    //Try to connect to server
-    if(!mysql_real_connect (
-        mysql,          //pointer to connection handler
-        "localhost",    //host to connect to
-        "ccdb_user",    //user name
-        "",             //password
-        "ccdb",         //database to use
-        0,              //port
-        NULL,           //socket (use default)
-        0))             //flags (none)
-    {
-        fprintf(stderr,"cant connect to database");
-        return false;
-    }
+    query.BindInt32(1, run);
+    query.BindInt64(2, variationId);
+    query.BindInt64(3, tableId);
+
+    size_t blobSize = 0;
+    query.Execute([&query, &blobSize](uint64_t rowIndex) {
+        blobSize += query.ReadString(1).size();
+    });
+    return blobSize;
+}
 
-    /* Prepare a SELECT query to fetch data from test_table */
-    stmt = mysql_stmt_init(mysql);
-    if (!stmt)
-    {
-        fprintf(stderr, " mysql_stmt_init(), out of memory\n");
-        return false;
-    }
-    if (mysql_stmt_prepare(stmt, select_query, strlen(select_query)))
-    {
-        fprintf(stderr, " mysql_stmt_prepare(), SELECT failed\n");
-        fprintf(stderr, " %s\n", mysql_stmt_error(stmt));
-        return false;
-    }
-    fprintf(stdout, " prepare, SELECT successful\n");
 
-    /* Get the parameter count from the statement */
-    param_count= mysql_stmt_param_count(stmt);
-    fprintf(stdout, " total parameters in SELECT: %d\n", param_count);
+//______________________________________________________________________________
+/** Selects a single integer by a single string parameter. Throws if nothing is found */
+static int64_t SelectId(sqlite3* database, const char* sql, const string& name)
+{
+    ccdb::SQLiteStatement query(database, sql);
+    query.BindString(1, name);
 
-    if (param_count != 4) /* validate parameter count */
-    {
-        fprintf(stderr, " invalid parameter count returned by MySQL\n");
-        return false;
-    }
+    int64_t id = -1;
+    query.Execute([&query, &id](uint64_t rowIndex) { id = query.ReadInt64(0); });
+    if(id < 0) throw std::runtime_error("Not found: " + name);
+    return id;
+}
 
-    /* Fetch result set meta information */
-    prepare_meta_result = mysql_stmt_result_metadata(stmt);
-    if (!prepare_meta_result)
-    {
-        fprintf(stderr, " mysql_stmt_result_metadata(), returned no meta information\n");
-        fprintf(stderr, " %s\n", mysql_stmt_error(stmt));
-        return false;
-    }
 
-    /* Get total columns in the query */
-    column_count= mysql_num_fields(prepare_meta_result);
-    fprintf(stdout, " total columns in SELECT statement: %d\n", column_count);
+//______________________________________________________________________________
+/** Prints one results row. Speedup is relative to baseSeconds, it is not printed if baseSeconds is 0 */
+static void PrintResult(const char* name, int iterations, double seconds, double baseSeconds)
+{
+    cout<<setw(10)<<name
+        <<setw(14)<<fixed<<setprecision(2)<<seconds * 1e6 / iterations
+        <<setw(14)<<setprecision(0)<<iterations / seconds;
+    if(baseSeconds > 0) cout<<setw(10)<<setprecision(2)<<baseSeconds / seconds;
+    cout<<endl;
+}
 
-    if (column_count != 2) /* validate column count */
-    {
-        fprintf(stderr, " invalid column count returned by MySQL\n");
-        return false;
-    }
 
-    memset(in_binds, 0, sizeof(in_binds));
+//______________________________________________________________________________
+int main(int argc, char *argv[])
+{
+    const char* ccdbHome = getenv("CCDB_HOME");
+    string filePath = string(ccdbHome ? ccdbHome : ".") + "/sql/ccdb.sqlite";
+    string tablePath = "/test/test_vars/test_table";
     int run = 100;
-
-    /* INTEGER PARAM */
-    /* This is a number type, so there is no need
-    to specify buffer_length */
-    in_binds[0].buffer_type= MYSQL_TYPE_LONG;
-    in_binds[0].buffer= (void *)&run;
-    in_binds[0].is_null= 0;
-    in_binds[0].length= 0;
-
-    in_binds[1].buffer_type= MYSQL_TYPE_LONG;
-    in_binds[1].buffer= (void *)&run;
-    in_binds[1].is_null= 0;
-    in_binds[1].length= 0;
-
-    /* STRING PARAM */
-    in_binds[2].buffer_type= MYSQL_TYPE_LONG;
-    in_binds[2].buffer= &variationId;
-    in_binds[1].is_null= 0;
-    in_binds[1].length= 0;
-
-    /* Type tables ID */
-    in_binds[3].buffer_type= MYSQL_TYPE_LONG;
-    in_binds[3].buffer= (void *)&table_id;
-    in_binds[3].is_null= 0;
-    in_binds[3].length= 0;
-
-    /* Bind the buffers */
-    if (mysql_stmt_bind_param(stmt, in_binds))
-    {
-        fprintf(stderr, " mysql_stmt_bind_param() failed\n");
-        fprintf(stderr, " %s\n", mysql_stmt_error(stmt));
-        return false;
+    int iterations = 100000;
+
+    if(argc > 1 && argv[1][0]) filePath = argv[1];    // "" keeps the default
+    if(argc > 2) tablePath = argv[2];
+    if(argc > 3) run = atoi(argv[3]);
+    if(argc > 4) iterations = atoi(argv[4]);
+    if(iterations < 1) iterations = 1;
+
+    sqlite3* database = nullptr;
+    if(sqlite3_open_v2(filePath.c_str(), &database, SQLITE_OPEN_READONLY|SQLITE_OPEN_NOMUTEX, nullptr) != SQLITE_OK) { // NOLINT(hicpp-signed-bitwise)
+        cerr<<"Can't open "<<filePath<<": "<<sqlite3_errmsg(database)<<endl;
+        sqlite3_close(database);
+        return 1;
     }
 
-    /* Bind the result buffers for all 4 columns before fetching them */
-    memset(out_bind, 0, sizeof(out_bind));
-
-    /* INTEGER COLUMN */
-    out_bind[0].buffer_type= MYSQL_TYPE_LONG;
-    out_bind[0].buffer= (char *)&int_data;
-    out_bind[0].is_null= &is_null[0];
-    out_bind[0].length= &length[0];
-    out_bind[0].error= &error[0];
-
-    /* STRING COLUMN */
-    out_bind[1].buffer_type= MYSQL_TYPE_STRING;
-    out_bind[1].buffer= (char *)str_data;
-    out_bind[1].buffer_length= STRING_SIZE;
-    out_bind[1].is_null= &is_null[1];
-    out_bind[1].length= &length[1];
-    out_bind[1].error= &error[1];
-
-    /* Bind the result buffers */
-    if (mysql_stmt_bind_result(stmt, out_bind))
+    size_t checkSum = 0;    //Trick the optimization
+    double prepareSeconds, reuseSeconds, providerSeconds, indexSeconds;
+    ccdb::SQLiteStatementCacheStats stats;
+    try
     {
-        fprintf(stderr, " mysql_stmt_bind_result() failed\n");
-        fprintf(stderr, " %s\n", mysql_stmt_error(stmt));
-        return false;
-    }
-
-    //all is done 
-    return true;
-}
-
-//_______________________________________________________________
-bool benchmark_PreparedStatements()
-{
-    //Do benchmark 
-
-    if(!PreparedQueriesInit()) return false;
-
-    MySQLDataProvider *prov = new MySQLDataProvider();
-    if(!prov->Connect("mysql://ccdb_user@localhost")) return false;
-
-    BENCHMARK_INIT("P R E P A R E D   Q U E R I E S    B E N C H M A R K S");
-
-    BENCHMARK_START("Get assignment prepared statements benchmark");
-    /* Execute the SELECT query */
-    for (int i=0; i<10000; i++)
-    {
-        prov->GetConstantsTypeTable("/test/test_vars/test_table",false);
-
-        if (mysql_stmt_execute(stmt))
-        {
-            fprintf(stderr, " mysql_stmt_execute(), failed\n");
-            fprintf(stderr, " %s\n", mysql_stmt_error(stmt));
-            exit(0);
+        ccdb::SQLiteDataProvider provider;
+        provider.Connect("sqlite://" + filePath);
+
+        unique_ptr<ccdb::ConstantsTypeTable> table(provider.DataProvider::GetConstantsTypeTable(tablePath, false));
+        if(!table) throw std::runtime_error("Not found: " + tablePath);
+        int64_t tableId = table->GetId();
+        int64_t variationId = SelectId(database, "SELECT `id` FROM `variations` WHERE `name` = ?1", "default");
+
+        // prepare: compile the query every time
+        auto start = steady_clock::now();
+        for(int i=0; i<iterations; i++) {
+            ccdb::SQLiteStatement query(database, cAssignmentQuery);
+            checkSum += RunAssignmentQuery(query, run, variationId, tableId);
         }
-
-        /* Now buffer all results to client (optional step) */
-        if (mysql_stmt_store_result(stmt))
-        {
-            fprintf(stderr, " mysql_stmt_store_result() failed\n");
-            fprintf(stderr, " %s\n", mysql_stmt_error(stmt));
-            exit(0);
+        prepareSeconds = duration<double>(steady_clock::now() - start).count();
+
+        // reuse: compile once, then reset and rebind
+        ccdb::SQLiteStatement cachedQuery(database);
+        cachedQuery.Prepare(cAssignmentQuery, /*isPersistent*/ true);
+        start = steady_clock::now();
+        for(int i=0; i<iterations; i++) {
+            cachedQuery.Reset();
+            checkSum += RunAssignmentQuery(cachedQuery, run, variationId, tableId);
         }
-    }
-
-    BENCHMARK_FINISH("1000 times prepared statements");
-
-    /* Fetch all rows */
-    row_count= 0;
-    fprintf(stdout, "Fetching results ...\n");
-    while (!mysql_stmt_fetch(stmt))
-    {
-        row_count++;
-        fprintf(stdout, "  row %d\n", row_count);
-
-        /* column 1 */
-        fprintf(stdout, "   column1 (integer)  : ");
-        if (is_null[0]) fprintf(stdout, " NULL\n");
-        else fprintf(stdout, " %d(%ld)\n", int_data, length[0]);
-
-        /* column 2 */
-        fprintf(stdout, "   column2 (string)   : ");
-        if (is_null[1]) fprintf(stdout, " NULL\n");
-        else fprintf(stdout, " %s(%ld)\n", str_data, length[1]);
-    }
-    int_data = 0;
-
-    /* Execute the SELECT query */
-    if (mysql_stmt_execute(stmt))
-    {
-        fprintf(stderr, " mysql_stmt_execute(), failed\n");
-        fprintf(stderr, " %s\n", mysql_stmt_error(stmt));
-        exit(0);
-    }
-
-    /* Now buffer all results to client (optional step) */
-    if (mysql_stmt_store_result(stmt))
-    {
-        fprintf(stderr, " mysql_stmt_store_result() failed\n");
-        fprintf(stderr, " %s\n", mysql_stmt_error(stmt));
-        exit(0);
-    }
-
-    /* Fetch all rows */
-    row_count= 0;
-    fprintf(stdout, "Fetching results ...\n");
-    while (!mysql_stmt_fetch(stmt))
-    {
-        row_count++;
-        fprintf(stdout, "  row %d\n", row_count);
-
-        /* column 1 */
-        fprintf(stdout, "   column1 (integer)  : ");
-        if (is_null[0]) fprintf(stdout, " NULL\n");
-        else fprintf(stdout, " %d(%ld)\n", int_data, length[0]);
-
-        /* column 2 */
-        fprintf(stdout, "   column2 (string)   : ");
-        if (is_null[1]) fprintf(stdout, " NULL\n");
-        else fprintf(stdout, " %s(%ld)\n", str_data, length[1]);
+        reuseSeconds = duration<double>(steady_clock::now() - start).count();
 
+        // provider: the whole GetAssignmentShort (type table, variation and assignment queries)
+        start = steady_clock::now();
+        for(int i=0; i<iterations; i++) {
+            unique_ptr<ccdb::Assignment> assignment(provider.GetAssignmentShort(run, tablePath, 0, "default", false));
+            if(assignment) checkSum += assignment->GetTokensCount();
+        }
+        providerSeconds = duration<double>(steady_clock::now() - start).count();
+        stats = provider.GetStatementCacheStats();
+
+        // index: resolve the run in memory, select the blob by the primary key
+        provider.SetRunRangeIndexEnabled(true);
+        start = steady_clock::now();
+        for(int i=0; i<iterations; i++) {
+            unique_ptr<ccdb::Assignment> assignment(provider.GetAssignmentShort(run + i, tablePath, 0, "default", false));
+            if(assignment) checkSum += assignment->GetTokensCount();
+        }
+        indexSeconds = duration<double>(steady_clock::now() - start).count();
     }
-
-    /* Free the prepared result metadata */
-    mysql_free_result(prepare_meta_result);
-
-
-    /* Close the statement */
-    if (mysql_stmt_close(stmt))
+    catch (std::exception& ex)
     {
-        fprintf(stderr, " failed while closing the statement\n");
-        fprintf(stderr, " %s\n", mysql_stmt_error(stmt));
-        exit(0);
+        cerr<<ex.what()<<endl;
+        sqlite3_close(database);
+        return 1;
     }
-
-    return true;
+    sqlite3_close(database);
+
+    cout<<"File: "<<filePath<<", table: "<<tablePath<<", run: "<<run<<", iterations: "<<iterations<<endl;
+    cout<<setw(10)<<"method"<<setw(14)<<"us/query"<<setw(14)<<"queries/s"<<setw(10)<<"speedup"<<endl;
+    PrintResult("prepare", iterations, prepareSeconds, prepareSeconds);
+    PrintResult("reuse", iterations, reuseSeconds, prepareSeconds);
+    PrintResult("provider", iterations, providerSeconds, 0);
+    PrintResult("index", iterations, indexSeconds, providerSeconds);
+    cout<<"Provider statements cache hits: "<<stats.Hits<<", misses: "<<stats.Misses<<endl;
+    if(checkSum == 0) cout<<"(zero check sum)"<<endl;
+    return 0;
 }
-
-#endif // benchmark_PreparedStatements_h__
\ No newline at end of file
@@ -1,44 +1,55 @@
-#ifndef benchmark_Providers_h__
-#define benchmark_Providers_h__
-
-#include "CCDB/Console.h"
-#include "CCDB/Helpers/StopWatch.h"
-#include "CCDB/Providers/MySQLDataProvider.h"
-#include "CCDB/Model/Assignment.h"
-#include "CCDB/Model/ConstantsTypeTable.h"
-
-#include "Tests/tests_macros.h"
-
-
-bool benchmark_Providers()
-{	
-	MySQLDataProvider *prov = new MySQLDataProvider();
-	if(!prov->Connect(gConnectionString)) return false;
-	
-	BENCHMARK_INIT("P R O V I D E R S   B E N C H M A R K S");
-	
-	BENCHMARK_START("Get assignment benchmark");
-	StopWatch queryTimer;
-	time_t queriesTime=0;
-	for(int i=0; i<1000; i++)
-	{
-		//if(i%100==0) console.WriteLine("%d",i);
-		Assignment * asgn = prov->GetAssignmentShort(100,"/test/test_vars/test_table");
-		delete asgn;
-	}
-	BENCHMARK_FINISH("1000 times GetAssignmentShort");
-	/*
-	vector<ConstantsTypeTable*> tables;
-	BENCHMARK_START("Get tables from directory");
-	for(int i=0; i<1000; i++)
-	{
-		//if(i%100==0) console.WriteLine("%d",i);
-		if(!prov->GetConstantsTypeTables(tables, "/test/test_vars", false)) break;
-	}
-	BENCHMARK_FINISH("1000 times GetConstantsTypeTables");
-	*/
-	delete prov;
-
-	return true;
+// Metadata benchmarks
+//
+// connect     - CalibrationGenerator::CreateCalibration and its deletion
+// directories - DataProvider::LoadDirectories of a connected provider
+// catalog     - DataProvider::RefreshCatalog (type tables, columns and variations at once)
+// first_call  - a new Calibration and its first GetCalib, what a job pays at start
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Benchmarks/benchmarks.h"
+#include "CCDB/CalibrationGenerator.h"
+#include "CCDB/Providers/DataProvider.h"
+
+using namespace std;
+using namespace ccdb;
+
+
+//______________________________________________________________________________
+void benchmark_Providers(BenchmarkContext& context)
+{
+    for(const BenchmarkConnection& connection: context.Connections) {
+        BenchmarkResult result;
+        result.Group = "metadata";
+        result.Connection = connection.Label;
+
+        result.Name = "connect";
+        RunBenchmark(context, result, [&](int, uint64_t) {
+            unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(connection.ConnectionString, 100, "default"));
+        });
+
+        unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(connection.ConnectionString, 100, "default"));
+        DataProvider* provider = calib->GetProvider();
+
+        result.Name = "directories";
+        RunBenchmark(context, result, [&](int, uint64_t) {
+            provider->LoadDirectories();
+        });
+
+        result.Name = "catalog";
+        RunBenchmark(context, result, [&](int, uint64_t) {
+            provider->RefreshCatalog();
+        });
+
+        result.Name = "first_call";
+        result.Table = connection.Tables.empty() ? connection.RowTables.back() : connection.Tables.back();
+        RunBenchmark(context, result, [&](int, uint64_t) {
+            unique_ptr<Calibration> newCalib(CalibrationGenerator::CreateCalibration(connection.ConnectionString, 100, "default"));
+            vector<vector<double> > values;
+            if(!newCalib->GetCalib(values, result.Table)) throw std::runtime_error("No constants for " + result.Table);
+        });
+    }
 }
-#endif // benchmark_Providers_h__
\ No newline at end of file
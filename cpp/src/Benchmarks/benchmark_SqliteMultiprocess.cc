@@ -1,89 +1,272 @@
-#include <iostream>
-#include <iomanip>
-#include <thread>
+// Many processes read the same SQLite file at job start
+//
+// N worker processes are forked. They start together, each opens the database with
+// CalibrationGenerator::CreateCalibration for a random run and replays the run request mix:
+// GetCalib of the connection tables and of a part of the other tables of the catalog. Then the next run.
+// The samples are the requests: opening of the Calibration of a run is one request, each GetCalib is another.
+// Throughput is the requests of all workers per wall second, latency percentiles are over all requests.
+//
+// Each sqlite:// connection is measured where its file is (disk or tmpfs) and as a copy in
+// context.TmpfsDir (/dev/shm by default). The workers write samples to shared memory.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/vfs.h>
+#endif
+#include <algorithm>
 #include <chrono>
-#include <vector>
-#include <string>
+#include <fstream>
+#include <memory>
 #include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Benchmarks/benchmarks.h"
+#include "CCDB/CalibrationGenerator.h"
+#include "CCDB/Model/Catalog.h"
+
+using namespace std;
+using namespace ccdb;
+
+static const char* const cSQLitePrefix = "sqlite://";
+static const int cMixTables = 30;           /// Maximum number of tables a run requests
+static const int cMaxRun = 100000;          /// Runs are random in 1..cMaxRun
+
+
+/** Worker results header in the shared memory. The latencies follow it */
+struct WorkerSamples
+{
+    uint64_t Count;                 /// Number of latencies
+    uint64_t AllocationsCount;
+    uint64_t AllocatedBytes;
+    int IsFailed;
+    char Error[256];
+};
+
+
+/** Copy of a database in its own temporary directory. Both are removed with the object */
+struct TemporaryCopy
+{
+    std::string Path;       /// Empty if the file isn't copied
+
+    ~TemporaryCopy()
+    {
+        if(Path.empty()) return;
+        remove(Path.c_str());
+        rmdir(Path.substr(0, Path.rfind('/')).c_str());
+    }
+};
+
+
+//______________________________________________________________________________
+/** @return "tmpfs" if the file is on tmpfs, otherwise "disk" */
+static string GetStorageName(const string& filePath)
+{
+#ifdef __linux__
+    const long cTmpfsMagic = 0x01021994;
+    struct statfs info;
+    if(statfs(filePath.c_str(), &info) == 0 && static_cast<long>(info.f_type) == cTmpfsMagic) return "tmpfs";
+#endif
+    return "disk";
+}
 
-#include <CCDB/Helpers/PathUtils.h>
-#include <CCDB/CalibrationGenerator.h>
-#include <CCDB/Helpers/PerfLog.h>
-#include "CCDB/Helpers/StopWatch.h"
 
-std::string con_str = "sqlite:///D:\\ccdb.sqlite";
-//std::string con_str = "mysql://ccdb_user@hallddb.jlab.org/ccdb";
-uint64_t run_min = 31495;
-uint64_t run_max = 31495;
-std::string tableName[] = {"FCAL/fcal_parms"}; //,"TOF/timing_offsets", "CDC/timing_offsets"};
+//______________________________________________________________________________
+/** Tables a run requests: the connection tables and others of the catalog evenly taken */
+static vector<string> GetRequestMix(const BenchmarkConnection& connection)
+{
+    vector<string> tables = connection.Tables;
+    tables.insert(tables.end(), connection.RowTables.begin(), connection.RowTables.end());
+
+    unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(connection.ConnectionString, 100, "default"));
+    const vector<CatalogTable>& catalogTables = calib->GetProvider()->GetCatalog()->GetTables();
+    size_t step = catalogTables.size() / cMixTables + 1;
+    for(size_t i = 0; i < catalogTables.size() && tables.size() < static_cast<size_t>(cMixTables); i += step) {
+        string fullPath = catalogTables[i].TypeTable->GetFullPath();
+        if(find(tables.begin(), tables.end(), fullPath) == tables.end()) tables.push_back(fullPath);
+    }
+    return tables;
+}
 
 
-int main()
+//______________________________________________________________________________
+/** Worker process body. Waits for the start, replays runs until the deadline and writes the samples */
+static void RunWorker(const BenchmarkContext& context, const string& connectionString, const vector<string>& tables,
+                      int workerIndex, int startPipe, WorkerSamples* samples, uint64_t* latencies)
 {
-    using namespace std;
     using namespace std::chrono;
 
-    std::random_device rd;
-    std::uniform_int_distribution<int> runRandomDistr(run_min, run_max);
-    int run = runRandomDistr(rd);
-    std::cout << "Randomly-chosen run: " << run << '\n';
+    char symbol;
+    while(read(startPipe, &symbol, 1) > 0) {}      // EOF when the parent closes the pipe
 
+    try
+    {
+        mt19937_64 random(static_cast<uint64_t>(workerIndex) + 1);
+        uniform_int_distribution<int> runs(1, cMaxRun);
+        vector<vector<string> > values;
 
-    auto now = system_clock::now();
-    auto now_c = system_clock::to_time_t(now);
+        AllocationCounters before = GetThreadAllocations();
+        auto start = steady_clock::now();
+        auto deadline = start + duration_cast<steady_clock::duration>(duration<double>(context.SecondsPerBenchmark));
+        uint64_t count = 0;
+        while(count < context.MaxOperations && start < deadline) {
+            unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(connectionString, runs(random), "default"));
+            auto end = steady_clock::now();
+            latencies[count++] = static_cast<uint64_t>(duration_cast<nanoseconds>(end - start).count());
+            start = end;
 
-    bool isParsedOk = false;
-    auto parsedTime_c = ccdb::PathUtils::ParseTime("2017-06-26 19:41:10", &isParsedOk);
-    auto parsedTime = system_clock::from_time_t(parsedTime_c);
-    cout << "Now is: " << std::put_time(std::localtime(&now_c), "%F %T") << '\n';
-    cout << "Req is: " << std::put_time(std::localtime(&parsedTime_c), "%F %T") << '\n';
-    cout << "Now > Req: " << (now > parsedTime) << '\n';
+            for(size_t i = 0; i < tables.size() && count < context.MaxOperations; i++) {
+                calib->GetCalib(values, tables[i]);
+                end = steady_clock::now();
+                latencies[count++] = static_cast<uint64_t>(duration_cast<nanoseconds>(end - start).count());
+                start = end;
+            }
+        }
+        AllocationCounters after = GetThreadAllocations();
 
-    while(now<parsedTime) {
-        std::this_thread::sleep_for(milliseconds(10));
-        now = system_clock::now();
+        samples->Count = count;
+        samples->AllocationsCount = after.Count - before.Count;
+        samples->AllocatedBytes = after.Bytes - before.Bytes;
     }
-    now_c = system_clock::to_time_t(now);
-    cout << "Now is: " << std::put_time(std::localtime(&now_c), "%F %T") << '\n';
-    cout << "Done"<<std::endl;
+    catch (std::exception& ex)
+    {
+        samples->IsFailed = 1;
+        strncpy(samples->Error, ex.what(), sizeof(samples->Error) - 1);
+    }
+}
 
 
-    // Get run
+//______________________________________________________________________________
+/** Forks result.Threads workers on the database and adds the result */
+static void RunProcesses(BenchmarkContext& context, BenchmarkResult& result, const string& connectionString, const vector<string>& tables)
+{
+    using namespace std::chrono;
 
-    auto con = ccdb::CalibrationGenerator::CreateCalibration(con_str, 30100, "default");
+    int processesCount = result.Threads;
+    size_t workerBytes = sizeof(WorkerSamples) + context.MaxOperations * sizeof(uint64_t);
+    workerBytes = (workerBytes + 4095) / 4096 * 4096;
+    size_t mappedBytes = workerBytes * processesCount;
+    void* memory = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0); // NOLINT(hicpp-signed-bitwise)
+    if(memory == MAP_FAILED) throw std::runtime_error("Can't map memory for worker samples");
 
-    std::uniform_int_distribution<int> tableRandom(0, 1);
-    vector<vector<double>> result;
+    auto getSamples = [&](int workerIndex) {
+        return reinterpret_cast<WorkerSamples*>(static_cast<char*>(memory) + workerBytes * workerIndex);
+    };
 
-    double sum = 0; // Trick the optimization;
+    int startPipe[2];
+    if(pipe(startPipe) != 0) {
+        munmap(memory, mappedBytes);
+        throw std::runtime_error("Can't create a pipe for workers");
+    }
 
+    fflush(nullptr);        // buffered output shouldn't be printed by the workers again
+    vector<pid_t> workers;
+    for(int workerIndex = 0; workerIndex < processesCount; workerIndex++) {
+        pid_t pid = fork();
+        if(pid == 0) {
+            close(startPipe[1]);
+            WorkerSamples* samples = getSamples(workerIndex);
+            RunWorker(context, connectionString, tables, workerIndex, startPipe[0],
+                      samples, reinterpret_cast<uint64_t*>(samples + 1));
+            _exit(0);
+        }
+        if(pid < 0) break;
+        workers.push_back(pid);
+    }
+
+    auto start = steady_clock::now();
+    close(startPipe[1]);
+    close(startPipe[0]);
 
+    bool isFailed = static_cast<int>(workers.size()) != processesCount;
+    for(pid_t pid: workers) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if(!WIFEXITED(status) || WEXITSTATUS(status) != 0) isFailed = true;
+    }
+    double seconds = duration<double>(steady_clock::now() - start).count();
 
-    for(int i=0; i<1000; i++) {
-        result.clear();
-        con->GetCalib(result, tableName[tableRandom(rd)]);
-        sum+=result[0][0];
+    string error;
+    vector<BenchmarkSamples> samples(workers.size());
+    for(size_t workerIndex = 0; workerIndex < workers.size(); workerIndex++) {
+        WorkerSamples* workerSamples = getSamples(static_cast<int>(workerIndex));
+        if(workerSamples->IsFailed) error = workerSamples->Error;
+        uint64_t* latencies = reinterpret_cast<uint64_t*>(workerSamples + 1);
+        samples[workerIndex].LatenciesNs.assign(latencies, latencies + workerSamples->Count);
+        samples[workerIndex].Allocations.Count = workerSamples->AllocationsCount;
+        samples[workerIndex].Allocations.Bytes = workerSamples->AllocatedBytes;
     }
+    munmap(memory, mappedBytes);
+
+    if(!error.empty()) throw std::runtime_error("Worker process failed on " + connectionString + ": " + error);
+    if(isFailed) throw std::runtime_error("Can't run " + to_string(processesCount) + " worker processes on " + connectionString);
 
+    context.AddResult(result, samples, seconds);
+}
 
 
+//______________________________________________________________________________
+/** Copies the file to a new temporary directory in directory. The copy path is empty if it fails */
+static void CopyToDirectory(const string& filePath, const string& directory, TemporaryCopy& copy)
+{
+    string dirTemplate = directory + "/ccdb_benchmarks_XXXXXX";
+    if(!mkdtemp(&dirTemplate[0])) return;
 
+    copy.Path = dirTemplate + "/" + filePath.substr(filePath.rfind('/') + 1);
+    ifstream source(filePath, ios::binary);
+    ofstream target(copy.Path, ios::binary | ios::trunc);
+    target<<source.rdbuf();
+    target.close();
+    if(!source || !target) {
+        remove(copy.Path.c_str());
+        rmdir(dirTemplate.c_str());
+        copy.Path.clear();
+    }
+}
 
 
+//______________________________________________________________________________
+void benchmark_SqliteMultiprocess(BenchmarkContext& context)
+{
+    for(const BenchmarkConnection& connection: context.Connections) {
+        if(connection.ConnectionString.compare(0, strlen(cSQLitePrefix), cSQLitePrefix) != 0) continue;
+        string filePath = connection.ConnectionString.substr(strlen(cSQLitePrefix));
 
-    // >oO DEBUG list of name-paths vector<string> namePaths;con->GetListOfNamepaths(namePaths);for(auto s:namePaths) { cout<<s<<endl; }
+        BenchmarkResult result;
+        result.Group = "processes";
+        result.Name = "run_mix";
 
+        // Where the file is and its copy on tmpfs (if the file isn't there already)
+        string storage = GetStorageName(filePath);
+        vector<pair<string, string> > files = {{storage, filePath}};      // (storage, path)
+        TemporaryCopy tmpfsCopy;
+        result.Connection = connection.Label + ":tmpfs";
+        if(storage != "tmpfs" && !context.TmpfsDir.empty() && context.IsSelected(result)) {
+            CopyToDirectory(filePath, context.TmpfsDir, tmpfsCopy);
+            if(tmpfsCopy.Path.empty()) printf("(can't copy %s to %s, tmpfs is skipped)\n", filePath.c_str(), context.TmpfsDir.c_str());
+            else files.emplace_back("tmpfs", tmpfsCopy.Path);
+        }
 
-/*
-    std::cout << "24 hours ago, the time was "
-              << std::put_time(std::localtime(&now_c), "%F %T") << '\n';
+        vector<string> tables = GetRequestMix(connection);
+        result.Table = tables.front() + " and " + to_string(tables.size() - 1) + " more";
 
-    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
-    std::cout << "Hello World\n";
-    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
-    std::cout << "Printing took "
-              << std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()
-              << "us.\n";
+        for(const auto& file: files) {
+            result.Connection = connection.Label + ":" + file.first;
+            if(!context.IsSelected(result)) continue;
 
-*/
-}
\ No newline at end of file
+            for(int processesCount = 1; ; processesCount *= 2) {
+                if(processesCount > context.MaxProcesses) processesCount = context.MaxProcesses;
+                result.Threads = processesCount;
+                RunProcesses(context, result, cSQLitePrefix + file.second, tables);
+                if(processesCount == context.MaxProcesses) break;
+            }
+        }
+    }
+}
@@ -1,217 +1,180 @@
-#pragma warning(disable:4800)
-#include "Benchmarks/benchmarks.h"
+// GetCalib benchmarks: each values type, GetView and GetCalibRows
+//
+// cold - the cache is disabled, each call loads the assignment from the provider and decodes it
+// warm - the cache is enabled and filled before the measurement, each call is a cache hit
+//
+// Tables (several rows) are read to vector<vector<T>>, vector<map<string, T>>, views and rows,
+// single row tables are read to T, vector<T> and map<string, T>.
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <map>
 
-#include "CCDB/Console.h"
-#include "CCDB/MySQLCalibration.h"
-#include "CCDB/Providers/MySQLDataProvider.h"
-#include "CCDB/Model/Directory.h"
-#include "CCDB/Model/Variation.h"
-#include "CCDB/Helpers/StringUtils.h"
-#include "CCDB/Helpers/WorkUtils.h"
-#include "CCDB/Helpers/StopWatch.h"
-#ifdef WIN32
-#include "winpthreads.h"
-#else //posix
-#include <pthread.h>
-#endif
+#include "Benchmarks/benchmarks.h"
+#include "CCDB/CalibrationGenerator.h"
+#include "CCDB/Helpers/RowSchema.h"
 
 using namespace std;
 using namespace ccdb;
 
-//Next functions is for data printing
-void test_UserAPI_PrintData(const vector<vector<string> > & data);
-void test_UserAPI_PrintData(const vector<vector<double> > & data);
-void test_UserAPI_PrintData(const vector<map<string,double> > & data);
-void test_UserAPI_PrintData(const vector<int> & data);
-void test_UserAPI_PrintData(const map<string,int> & data);
- 
-/** ********************************************************************* 
- * @brief Test of CCDB USER API work
- *
- * @return true if test passed
- */
-bool benchmark_UserAPI()
+static const char* const cTestTable = "/test/test_vars/test_table";
+
+/** Rows of /test/test_vars/test_table */
+struct BenchmarkTestRow
 {
-	bool result;
-	
-    BENCHMARK_INIT();
+    double x;
+    double y;
+    double z;
+};
 
-    vector<vector<string> > tabledValues;
-    MySQLCalibration *calib = new MySQLCalibration(100);
-    if(!calib->Connect(TESTS_CONENCTION_STRING)) return false;
+/** First columns of fixture and synthetic tables */
+struct BenchmarkFixtureRow
+{
+    double c0;
+    double c1;
+    double c2;
+};
 
-    BENCHMARK_START("20000 plain read of /test/test_vars/test_table");
-    for (int i=0; i<20000; i++)
+namespace ccdb
+{
+    template<> struct RowSchema<BenchmarkTestRow>
     {
-        calib->GetCalib(tabledValues, "/test/test_vars/test_table");
-    }
-    BENCHMARK_FINISH("20000 plain reads in ");
+        static constexpr auto Fields = std::make_tuple(
+            Field("x", &BenchmarkTestRow::x),
+            Field("y", &BenchmarkTestRow::y),
+            Field("z", &BenchmarkTestRow::z));
+    };
 
-    return true;
+    template<> struct RowSchema<BenchmarkFixtureRow>
+    {
+        static constexpr auto Fields = std::make_tuple(
+            Field("c0", &BenchmarkFixtureRow::c0),
+            Field("c1", &BenchmarkFixtureRow::c1),
+            Field("c2", &BenchmarkFixtureRow::c2));
+    };
 }
 
-typedef struct 
-{
-    int id;
-} parm;
 
-void *hello(void *arg)
+//______________________________________________________________________________
+/** Benchmarks calib->GetCalib(values, result.Table) with values of type T */
+template<typename T>
+static void RunGetCalib(BenchmarkContext& context, Calibration* calib, BenchmarkResult result, const char* typeName)
 {
-    parm *p=(parm *)arg;
-    BENCHMARK_INIT();
-
-    vector<vector<string> > tabledValues;
-    MySQLCalibration *calib = new MySQLCalibration(100);
-    if(!calib->Connect(TESTS_CONENCTION_STRING)) return NULL;
-
-    BENCHMARK_START("1200 plain read of /test/test_vars/test_table");
-    for (int i=0; i<1200; i++)
-    {
-        calib->GetCalib(tabledValues, "/test/test_vars/test_table");
-    }
-    BENCHMARK_FINISH("1200 plain reads in ");
-    return (NULL);
+    result.Name = typeName;
+    if(!context.IsSelected(result)) return;
+
+    T values;
+    if(!calib->GetCalib(values, result.Table)) throw std::runtime_error("No constants for " + result.Table);   // warm up
+    RunBenchmark(context, result, [&](int, uint64_t) {
+        calib->GetCalib(values, result.Table);
+    });
 }
 
 
-bool banchmark_UserAPIMultithread()
+//______________________________________________________________________________
+/** Benchmarks calib->GetCalibRows with Row */
+template<typename Row>
+static void RunGetCalibRows(BenchmarkContext& context, Calibration* calib, BenchmarkResult result)
 {
-    bool result;
-    pthread_t *threads;
-    pthread_attr_t pthread_custom_attr;
-    parm *p;
-
-    int n = 8;
-    int i =0; 
-    BENCHMARK_INIT();
-    BENCHMARK_START("Total is 10000 plain read of /test/test_vars/test_table");
-    threads = (pthread_t *) malloc (n*sizeof(*threads));
-    pthread_attr_init(&pthread_custom_attr);
-
-    p=(parm *)malloc(sizeof(parm)*n);
-    /* Start up thread */
-
-    for (i=0; i<n; i++)
+    result.Name = "GetCalibRows";
+    if(!context.IsSelected(result)) return;
+
+    vector<Row> rows;
+    try
     {
-        p[i].id=i;
-        pthread_create(&threads[i], &pthread_custom_attr, hello, (void *)(p+i));
+        if(!calib->GetCalibRows(rows, result.Table)) throw std::runtime_error("No constants for " + result.Table);
     }
-
-    /* Synchronize the completion of each thread. */
-
-    for (i=0; i<n; i++)
+    catch (std::logic_error&)
     {
-        pthread_join(threads[i],NULL);
+        return;     //Row doesn't fit the table columns (a synthetic table may have fewer or string columns)
     }
-    free(p);
-    BENCHMARK_FINISH("Total. 10000 plain reads in ");
-    return true;
+    RunBenchmark(context, result, [&](int, uint64_t) {
+        calib->GetCalibRows(rows, result.Table);
+    });
 }
 
-bool benchmark_AllHallDConstants()
-{
-    bool result;
-
-    BENCHMARK_INIT();
 
-  
-    MySQLCalibration *calib = new MySQLCalibration(100);
-    if(!calib->Connect(TESTS_CONENCTION_STRING)) return false;
-    vector<string> namepathes;
-    calib->GetListOfNamepaths(namepathes);
-
-    vector<vector<string> > tabledValues;
-    long valuesCount = 0;
-    BENCHMARK_START("20000 plain read of /test/test_vars/test_table");
-    for (int i=0; i<namepathes.size(); i++)
-    {
-        calib->GetCalib(tabledValues, namepathes[i]);
-        if(tabledValues.size()>0)
-        {
-            valuesCount+=tabledValues.size() * tabledValues[0].size();
-        }
-    }
-    cout<<"totas constants  "<<valuesCount<<endl;
-    BENCHMARK_FINISH("20000 plain reads in ");
-
-    return true;
-}
-/*
 //______________________________________________________________________________
-void test_UserAPI_PrintData(const vector<vector<string> > & data)
+/** Benchmarks reading a table of several rows by all means */
+template<typename Row>
+static void RunTable(BenchmarkContext& context, Calibration* calib, const BenchmarkResult& result)
 {
-    int rowsNum = data.size();
-    int columnsNum = data[0].size(); //rawTableValues[0] - size was checked in GetCalib
-
-    //print values
-    for (int rowIter = 0; rowIter < rowsNum; rowIter++)
-    {   
-        for (int columnsIter = 0; columnsIter < columnsNum; columnsIter++)
-        {
-            gConsole.Write("|  %-9s ", data[rowIter][columnsIter].c_str());
-        }
-        gConsole.WriteLine("|");
+    RunGetCalib<vector<vector<string> > >(context, calib, result, "vector<vector<string>>");
+    RunGetCalib<vector<vector<double> > >(context, calib, result, "vector<vector<double>>");
+    RunGetCalib<vector<vector<int> > >(context, calib, result, "vector<vector<int>>");
+    RunGetCalib<vector<map<string, string> > >(context, calib, result, "vector<map<string,string>>");
+    RunGetCalib<vector<map<string, double> > >(context, calib, result, "vector<map<string,double>>");
+    RunGetCalib<vector<map<string, int> > >(context, calib, result, "vector<map<string,int>>");
+    RunGetCalibRows<Row>(context, calib, result);
+
+    BenchmarkResult viewResult = result;
+    viewResult.Name = "GetView";
+    if(context.IsSelected(viewResult)) {
+        double sum = 0;    //Trick the optimization
+        calib->GetView(result.Table);
+        RunBenchmark(context, viewResult, [&](int, uint64_t) {
+            ConstantsView view = calib->GetView(result.Table);
+            sum += view.GetRowsCount();
+        });
+        if(sum == 0) printf("(zero check sum)\n");
     }
-}
 
-//______________________________________________________________________________
-void test_UserAPI_PrintData(const vector<vector<double> > & data)
-{
-    int rowsNum = data.size();
-    int columnsNum = data[0].size(); //rawTableValues[0] - size was checked in GetCalib
-
-    //print values
-    for (int rowIter = 0; rowIter < rowsNum; rowIter++)
-    {   
-        for (int columnsIter = 0; columnsIter < columnsNum; columnsIter++)
-        {
-            gConsole.Write("| %-9s ", StringUtils::Format("%.6d", data[rowIter][columnsIter]).c_str());
-        }
-        gConsole.WriteLine("|");
+    BenchmarkResult handleResult = result;
+    handleResult.Name = "vector<vector<double>>(handle)";
+    if(context.IsSelected(handleResult)) {
+        RequestHandle handle = calib->Resolve(result.Table);
+        vector<vector<double> > values;
+        calib->GetCalib(values, handle);
+        RunBenchmark(context, handleResult, [&](int, uint64_t) {
+            calib->GetCalib(values, handle);
+        });
     }
 }
 
-//______________________________________________________________________________
-void test_UserAPI_PrintData(const vector<map<string,double> > & data)
-{
-    int rowsNum = data.size();
-    int columnsNum = data[0].size(); //rawTableValues[0] - size was checked in GetCalib
-
-    //print values
-    for (int rowIter = 0; rowIter < rowsNum; rowIter++)
-    {   
-        map<string,double>::const_iterator cell;
-        const map<string,double> &row = data[rowIter];
-
-        for (cell = row.begin(); cell!= row.end(); cell++)
-        {
-            gConsole.Write("| %-20s ", StringUtils::Format("%s : %.6d", cell->first.c_str(), cell->second).c_str());
-        }
-        gConsole.WriteLine("|");
-    }
-}
 
 //______________________________________________________________________________
-void test_UserAPI_PrintData(const vector<int> & data)
+/** Benchmarks reading a single row table by all means */
+static void RunRow(BenchmarkContext& context, Calibration* calib, const BenchmarkResult& result)
 {
-    //print values
-    for (int columnsIter = 0; columnsIter < data.size(); columnsIter++)
-    {
-        gConsole.Write("| %-9s ", StringUtils::Format("%i", data[columnsIter]).c_str());
-    }
-    gConsole.WriteLine("|");
+    RunGetCalib<string>(context, calib, result, "string");
+    RunGetCalib<double>(context, calib, result, "double");
+    RunGetCalib<int>(context, calib, result, "int");
+    RunGetCalib<vector<string> >(context, calib, result, "vector<string>");
+    RunGetCalib<vector<double> >(context, calib, result, "vector<double>");
+    RunGetCalib<vector<int> >(context, calib, result, "vector<int>");
+    RunGetCalib<map<string, string> >(context, calib, result, "map<string,string>");
+    RunGetCalib<map<string, double> >(context, calib, result, "map<string,double>");
+    RunGetCalib<map<string, int> >(context, calib, result, "map<string,int>");
 }
 
+
 //______________________________________________________________________________
-void test_UserAPI_PrintData(const map<string,int> & data)
+void benchmark_UserAPI(BenchmarkContext& context)
 {
-    map<string,int>::const_iterator cell;
-    const map<string,int> &row = data;
-
-    for (cell = row.begin(); cell!= row.end(); cell++)
-    {
-        gConsole.Write("| %-20s ", StringUtils::Format("%s : %i", cell->first.c_str(), cell->second).c_str());
+    for(const BenchmarkConnection& connection: context.Connections) {
+        unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(connection.ConnectionString, 100, "default"));
+
+        for(int isWarm = 0; isWarm < 2; isWarm++) {
+            calib->EnableCache(isWarm != 0);
+            calib->ClearCache();
+
+            BenchmarkResult result;
+            result.Group = "getcalib";
+            result.Connection = connection.Label;
+            result.Cache = isWarm ? "warm" : "cold";
+
+            for(const string& table: connection.Tables) {
+                result.Table = table;
+                if(table == cTestTable) RunTable<BenchmarkTestRow>(context, calib.get(), result);
+                else RunTable<BenchmarkFixtureRow>(context, calib.get(), result);
+            }
+
+            for(const string& table: connection.RowTables) {
+                result.Table = table;
+                RunRow(context, calib.get(), result);
+            }
+        }
     }
-    gConsole.WriteLine("|");
 }
-*/
\ No newline at end of file
@@ -1,32 +1,192 @@
-// This is not a formal unit tests config
+// Harness of ccdb_benchmarks. This is not a formal unit tests config
+//
+// A benchmark calls one operation in a loop on 1 or more threads for a given time
+// (or until the maximum number of operations is done) and measures each call.
+// The results are latency percentiles, throughput and operator new allocations per call.
+// Allocations are counted by global operator new of ccdb_benchmarks (@see benchmarks.cc),
+// memory that SQLite allocates with malloc is not counted.
 
+#ifndef benchmarks_h__
+#define benchmarks_h__
 
-#ifndef bencjmarks_h__
-#define bencjmarks_h__
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
 
-#ifndef WIN32
-#define TESTS_CONENCTION_STRING "mysql://ccdb_user@127.0.0.1:3306 ccdb"
-#else
-#define TESTS_CONENCTION_STRING "mysql://ccdb_user@127.0.0.1:3306 ccdb"
-#endif
+/** @brief Number and bytes of operator new allocations made by the calling thread so far */
+struct AllocationCounters
+{
+    uint64_t Count;
+    uint64_t Bytes;
+};
 
-#include "CCDB/Console.h"
-#include "CCDB/Helpers/StopWatch.h"
+AllocationCounters GetThreadAllocations();
 
-using namespace std;
-using namespace ccdb;
 
-extern Console gConsole;
-extern std::string gConnectionString;
+/** @brief Connection a benchmark runs against */
+struct BenchmarkConnection
+{
+    std::string Label;                      /// Short name for reports: sqlite, fixture-sqlite, ...
+    std::string ConnectionString;
+    std::vector<std::string> Tables;        /// Tables of several rows. The last one is the biggest
+    std::vector<std::string> RowTables;     /// Tables of one row
+};
 
 
-//must be called once per function that performs tests
-#define BENCHMARK_INIT() StopWatch stopwatch; 
+/** @brief Generated database with big tables and many type tables (@see CreateBenchmarkFixture) */
+struct BenchmarkFixture
+{
+    std::string Directory;          /// Where the fixture files are
+    std::string SQLitePath;         /// Copy of the source database with the fixture tables
+    std::string SnapshotPath;       /// .ccdbsnap of SQLitePath
+    std::string TablePath;          /// rows x columns double table
+    std::string RowPath;            /// 1 x columns double table
+    int Rows;
+    int Columns;
+    int MetadataTables;             /// Number of small type tables in /benchmark/meta
+};
 
-//must be called once per function that performs tests
-#define BENCHMARK_START(title) gConsole.WriteLine(Console::cBrightBlue,"\n[ %s ]", (title)); stopwatch.Start();
+/** @brief Copies sourceSQLitePath to directory and adds the fixture tables to the copy. Writes the .ccdbsnap of it */
+BenchmarkFixture CreateBenchmarkFixture(const std::string& sourceSQLitePath, const std::string& directory, int rows, int columns, int metadataTables);
 
-//must be called once per function that performs tests
-#define BENCHMARK_FINISH(title) stopwatch.Stop(); gConsole.WriteLine(Console::cGreen, " %s %f", (title), stopwatch.GetDuration());
+/** @brief Generates synthetic.sqlite with the seed in directory (@see ccdb::SyntheticDatabase). Returns its path */
+std::string CreateSyntheticDatabase(const std::string& directory, uint64_t seed);
 
-#endif // bencjmarks_h__
\ No newline at end of file
+/** @brief Fills connection tables: test tables if the database has them, otherwise a middle size and the biggest tables */
+void FindBenchmarkTables(BenchmarkConnection& connection);
+
+
+/** @brief One measured benchmark, a line of the report */
+struct BenchmarkResult
+{
+    BenchmarkResult(): Threads(1), Operations(0), Seconds(0), P50Us(0), P99Us(0), P999Us(0), MeanUs(0),
+                       OpsPerSecond(0), AllocationsPerOp(0), AllocatedBytesPerOp(0) {}
+
+    std::string Group;              /// getcalib, metadata, threads, processes or blob
+    std::string Name;               /// What is measured. For getcalib it is the values type
+    std::string Connection;         /// @see BenchmarkConnection::Label
+    std::string Table;              /// Namepath (if any)
+    std::string Cache;              /// cold (no cache), warm (cache hits) or empty
+    int Threads;                    /// Or worker processes for processes group
+
+    uint64_t Operations;            /// Done by all threads
+    double Seconds;                 /// Wall time
+    double P50Us;
+    double P99Us;
+    double P999Us;
+    double MeanUs;
+    double OpsPerSecond;
+    double AllocationsPerOp;
+    double AllocatedBytesPerOp;
+
+    /** @brief group/name/connection/cache. Used by --filter */
+    std::string GetId() const;
+};
+
+
+/** @brief Latencies and allocations of one benchmark thread */
+struct BenchmarkSamples
+{
+    std::vector<uint64_t> LatenciesNs;
+    AllocationCounters Allocations;
+};
+
+
+/** @brief Settings and results of a run of ccdb_benchmarks */
+struct BenchmarkContext
+{
+    std::vector<BenchmarkConnection> Connections;
+    BenchmarkFixture Fixture;       /// Generated fixture (if it is created)
+    double SecondsPerBenchmark;
+    uint64_t MaxOperations;         /// Per thread
+    int MaxThreads;
+    int MaxProcesses;               /// For benchmark_SqliteMultiprocess
+    std::string TmpfsDir;           /// Where benchmark_SqliteMultiprocess copies databases to read them from tmpfs. Empty - don't copy
+    std::string Filter;             /// Only benchmarks with ids that contain it are run
+
+    std::vector<BenchmarkResult> Results;
+
+    bool IsSelected(const BenchmarkResult& result) const;
+
+    /** @brief Computes the statistics of the result from the samples, prints it and adds it to Results */
+    void AddResult(BenchmarkResult& result, std::vector<BenchmarkSamples>& samples, double seconds);
+};
+
+
+//______________________________________________________________________________
+/** @brief Runs operation(threadIndex, operationIndex) on result.Threads threads and adds the result to the context
+ *
+ * Threads start together and stop after context.SecondsPerBenchmark or after context.MaxOperations calls each.
+ * The operation is measured as it is, warm up (if needed) is done by the caller.
+ */
+template<typename Operation>
+void RunBenchmark(BenchmarkContext& context, BenchmarkResult result, Operation operation)
+{
+    using namespace std::chrono;
+
+    if(!context.IsSelected(result)) return;
+    if(result.Threads < 1) result.Threads = 1;
+
+    std::vector<BenchmarkSamples> samples(result.Threads);
+    std::atomic<int> readyCount(0);
+    std::atomic<int> doneCount(0);
+    std::atomic<bool> isStarted(false);
+    std::atomic<bool> isStopped(false);
+
+    std::vector<std::thread> threads;
+    for(int threadIndex = 0; threadIndex < result.Threads; threadIndex++) {
+        threads.emplace_back([&, threadIndex]() {
+            BenchmarkSamples& threadSamples = samples[threadIndex];
+            threadSamples.LatenciesNs.reserve(context.MaxOperations);   //no allocations by the harness while measuring
+
+            readyCount++;
+            while(!isStarted) std::this_thread::yield();
+
+            AllocationCounters before = GetThreadAllocations();
+            auto start = steady_clock::now();
+            for(uint64_t i = 0; i < context.MaxOperations && !isStopped.load(std::memory_order_relaxed); i++) {
+                operation(threadIndex, i);
+                auto end = steady_clock::now();
+                threadSamples.LatenciesNs.push_back(static_cast<uint64_t>(duration_cast<nanoseconds>(end - start).count()));
+                start = end;
+            }
+            AllocationCounters after = GetThreadAllocations();
+            threadSamples.Allocations.Count = after.Count - before.Count;
+            threadSamples.Allocations.Bytes = after.Bytes - before.Bytes;
+            doneCount++;
+        });
+    }
+
+    while(readyCount < result.Threads) std::this_thread::yield();
+
+    auto start = steady_clock::now();
+    isStarted = true;
+    auto deadline = start + duration_cast<steady_clock::duration>(duration<double>(context.SecondsPerBenchmark));
+    while(doneCount < result.Threads && steady_clock::now() < deadline) std::this_thread::sleep_for(milliseconds(1));
+    isStopped = true;
+    for(auto& thread: threads) thread.join();
+    double seconds = duration<double>(steady_clock::now() - start).count();
+
+    context.AddResult(result, samples, seconds);
+}
+
+
+/** @brief GetCalib of each values type, GetView and GetCalibRows with cold and warm cache */
+void benchmark_UserAPI(BenchmarkContext& context);
+
+/** @brief Connect, directories and catalog load, the first GetCalib of a new Calibration */
+void benchmark_Providers(BenchmarkContext& context);
+
+/** @brief GetCalib from 1 to MaxThreads threads sharing one Calibration */
+void benchmark_CacheMultithread(BenchmarkContext& context);
+
+/** @brief StringUtils::Split, SplitOffsets (each implementation) and Assignment::SetRawData on blobs of 10k, 100k and 1M cells */
+void benchmark_BlobSplit(BenchmarkContext& context);
+
+/** @brief Worker processes from 1 to MaxProcesses replay job start requests on the same SQLite file (disk and tmpfs) */
+void benchmark_SqliteMultiprocess(BenchmarkContext& context);
+
+#endif // benchmarks_h__
@@ -2,30 +2,195 @@
 #include <assert.h>
 #include <iostream>
 #include <memory>
+#include <unordered_set>
 
 #include "CCDB/Calibration.h"
 #include "CCDB/Providers/DataProvider.h"
 #include "CCDB/Helpers/PathUtils.h"
 #include "CCDB/Helpers/TimeProvider.h"
-#include "CCDB/Helpers/PerfLog.h"
+#include "CCDB/Helpers/Trace.h"
 
 using namespace std;
 
 namespace ccdb
 {
 
+//______________________________________________________________________________
+static void ReadCell(const ConstantsView& view, size_t row, size_t column, string& value)  { value.assign(view.GetString(row, column)); }
+static void ReadCell(const ConstantsView& view, size_t row, size_t column, double& value)  { value = view.GetDouble(row, column); }
+static void ReadCell(const ConstantsView& view, size_t row, size_t column, int& value)     { value = view.GetInt(row, column); }
+
+
+//______________________________________________________________________________
+static void ReadRow(const ConstantsView& view, size_t row, vector<string>& values)
+{
+    values.clear();
+    values.reserve(view.GetColumnsCount());
+    for (size_t colIter = 0; colIter < view.GetColumnsCount(); colIter++) values.emplace_back(view.GetString(row, colIter));
+}
+
+static void ReadRow(const ConstantsView& view, size_t row, vector<double>& values)
+{
+    Span<const double> cells = view.GetDoubleRow(row);
+    values.assign(cells.begin(), cells.end());
+}
+
+static void ReadRow(const ConstantsView& view, size_t row, vector<int>& values)
+{
+    Span<const int> cells = view.GetIntRow(row);
+    values.assign(cells.begin(), cells.end());
+}
+
+
+//______________________________________________________________________________
+static void CheckHasRows(const ConstantsView& view, const char* funcName)
+{
+    if(view.GetRowsCount() == 0 || view.GetColumnsCount() == 0) {
+        throw std::logic_error(string(funcName) + ". Data has no rows. Zero rows are not supposed to be.");
+    }
+}
+
+
+//______________________________________________________________________________
+static void CheckSingleRow(const ConstantsView& view, const char* funcName)
+{
+    // Checks that data for vector<dataType> version of GetCalib is one row
+
+    CheckHasRows(view, funcName);
+
+    if(view.GetRowsCount() != 1) {
+        throw std::logic_error(string(funcName) + ". logic_error: Calling of single row vector<dataType> version of GetCalib method on dataset that has more than one rows. Use GetCalib vector<vector<dataType> > instead.");
+    }
+}
+
+
+//______________________________________________________________________________
+// GetCalib fills its container from the columnar view of the assignment (@see ConstantsView).
+// Numbers are converted from strings once per assignment and kept with it (@see Assignment::GetDoubleData),
+// strings are taken from the cells of the blob. Containers are built with exact sizes and moved to values.
+// T is string, double or int, the container type selects the function
+
+//______________________________________________________________________________
+template<typename T>
+static void FillValues(T &value, const ConstantsView& view, const char* funcName)
+{
+    // One value: the first cell of the only row
+
+    CheckSingleRow(view, funcName);
+    ReadCell(view, 0, 0, value);
+}
+
+
+//______________________________________________________________________________
+template<typename T>
+static void FillValues(vector<T> &values, const ConstantsView& view, const char* funcName)
+{
+    // The only row to vector
+
+    CheckSingleRow(view, funcName);
+    ReadRow(view, 0, values);
+}
+
+
+//______________________________________________________________________________
+template<typename T>
+static void FillValues(vector< vector<T> > &values, const ConstantsView& view, const char* funcName)
+{
+    // Vector of rows
+
+    CheckHasRows(view, funcName);
+
+    vector< vector<T> > rows;
+    rows.reserve(view.GetRowsCount());
+    for (size_t rowIter = 0; rowIter < view.GetRowsCount(); rowIter++)
+    {
+        vector<T> row;
+        ReadRow(view, rowIter, row);
+        rows.push_back(std::move(row));
+    }
+    values = std::move(rows);
+}
+
+
+//______________________________________________________________________________
+template<typename T>
+static void FillValues(vector< map<string, T> > &values, const ConstantsView& view, const char* funcName)
+{
+    // Vector of rows, where each row is map<column_name, value>
+
+    CheckHasRows(view, funcName);
+
+    vector<string> columnNames = view.GetColumnNames();
+    vector< map<string, T> > rows(view.GetRowsCount());
+    vector<T> row;
+    for (size_t rowIter = 0; rowIter < view.GetRowsCount(); rowIter++)
+    {
+        ReadRow(view, rowIter, row);
+        for (size_t colIter = 0; colIter < columnNames.size(); colIter++)
+        {
+            rows[rowIter].emplace(columnNames[colIter], std::move(row[colIter]));
+        }
+    }
+    values = std::move(rows);
+}
+
+
+//______________________________________________________________________________
+template<typename T>
+static void FillValues(map<string, T> &values, const ConstantsView& view, const char* funcName)
+{
+    // One row or one column of data to map. @see GetCalib( map<string, string>&, const string&)
+
+    CheckHasRows(view, funcName);
+
+	// This method is used to return a 1-D array of values (in the form of a
+	// map<string, string>). The data may be stored in either column-wise (1
+	// row with many columns) or row-wise (1 column with many rows). We wish
+	// to support either so we must check which format it is in. If it is
+	// stored row-wise, then we'll need to make up the column names so that
+	// the map being returned is properly ordered.
+	// 5/25/2014  D. Lawrence
+
+    size_t rowsNum = view.GetRowsCount();
+    size_t columnsNum = view.GetColumnsCount();
+    if(rowsNum>1 && columnsNum>1){
+        throw std::logic_error(string(funcName) + ". Appears to be a table (both dimensions are > 1).");
+    }
+
+    map<string, T> result;
+    vector<T> row;
+    if(rowsNum>1){
+        // ---- ROW-WISE ----
+        for(size_t i=0; i<rowsNum; i++){
+            char colName[16];
+            sprintf(colName, "v%04d", static_cast<int>(i)); // TODO this will be a problem for more than 10k values!
+            ReadRow(view, i, row);
+            result.emplace_hint(result.end(), colName, std::move(row[0]));
+        }
+    }else{
+        // ---- COLUMN-WISE ----
+        ReadRow(view, 0, row);
+        for (size_t i=0; i<columnsNum; i++) result.emplace(view.GetColumnName(i), std::move(row[i]));
+    }
+    values = std::move(result);
+}
+
+
 //______________________________________________________________________________
 Calibration::Calibration()
 {
     //Constructor 
 
     mProvider = nullptr;
+    mProviderGeneration = 0;
     mProviderIsLocked = false; //by default we assume that we own the provider
     mDefaultRun = 0;
 	mDefaultTime = 0;
     mDefaultVariation = "default";
     mIsAutoReconnect = true;
     mLastActivityTime=0;
+    mAsyncThreadsCount = 4;
+    mIsAsyncStopped = false;
 
 #ifdef CCDB_CACHE_ON
     mIsCacheEnabled = true;
@@ -45,9 +210,12 @@ Calibration::Calibration(int defaultRun, string defaultVariation/*="default"*/,
 	mDefaultTime = defaultTime;
 
     mProvider = nullptr;
+    mProviderGeneration = 0;
     mProviderIsLocked = false;      // by default we assume that we own the provider
     mIsAutoReconnect = true;
     mLastActivityTime=0;
+    mAsyncThreadsCount = 4;
+    mIsAsyncStopped = false;
 
 #ifdef CCDB_CACHE_ON
     mIsCacheEnabled = true;
@@ -61,6 +229,8 @@ Calibration::Calibration(int defaultRun, string defaultVariation/*="default"*/,
 Calibration::~Calibration()
 {
     //Destructor
+    WaitPrefetch();     //the background prefetch uses the provider
+    StopAsyncRequests();    //derived classes stop them earlier, while their state is alive
     if(!mProviderIsLocked && mProvider!=nullptr) delete mProvider;
 }
 
@@ -71,9 +241,29 @@ void Calibration::UseProvider( DataProvider * provider, bool lockProvider/*=true
     // set provider to use. 
     //if lockProvider==true, than @see Connect, @see Disconnect and @see SetConnectionString 
     //will not affect connection of provider. The provider will not be deleted in destruction. 
-    std::lock_guard<std::mutex> lock(mReadMutex);
+    std::lock_guard<ReadMostlyMutex> lock(mReadMutex);     //waits for the readers of the previous provider
 	mProvider = provider;	
 	mProviderIsLocked = lockProvider;
+	NextProviderGeneration();
+	mCache.Clear();     //cached assignments belong to the previous provider
+
+    std::lock_guard<std::mutex> bindingsLock(mRowBindingsMutex);
+    mRowBindings.clear();   //table ids of another provider may mean other tables
+}
+
+
+//______________________________________________________________________________
+template<typename T>
+bool Calibration::GetCalibByNamepath(T &values, const string& namepath, const char* funcName)
+{
+    // All GetCalib overloads are instantiations of this function
+
+    auto assignment = AcquireAssignment(namepath, true);
+    if(!assignment) return false;
+
+    TraceSpan span(TracePhase::Decode);
+    FillValues(values, ConstantsView(*assignment), funcName);
+    return true;
 }
 
 
@@ -100,102 +290,21 @@ bool Calibration::GetCalib( vector< map<string, string> > &values, const string
 	 * @return true if constants were found and filled. false if namepath was not found. raises std::logic_error if any other error acured.
 	 */  
 
-    auto assignment = GetAssignment(namepath, true);
-        
-    if(!assignment)
-    {       
-        return false; //TODO possibly exception throwing?
-    }
-
-    //Get data
-    
-    assert(values.empty());
-    
-    assignment->GetMappedData(values);
-    
-    //check data, get columns 
-    if(values.size() == 0){
-        throw std::logic_error("Calibration::GetCalib( vector< map<string, string> >&, const string&). Data has no rows. Zero rows are not supposed to be.");
-    }
-    return true;
+    return GetCalibByNamepath(values, namepath, "Calibration::GetCalib( vector< map<string, string> >&, const string&)");
 }
 
 
 //______________________________________________________________________________
 bool Calibration::GetCalib( vector< map<string, double> > &values, const string & namepath )
 {
-    //read values
-
-    //TODO right now the function works through copy. 
-    //one needs to find out, maybe it needs to be reimplemented
-    
-    vector<map<string, string> > rawValues;
-    try
-    {
-        if(!GetCalib(rawValues, namepath)) return false;
-    }
-    catch (std::exception &)
-    {
-    	throw;
-    }
-
-    assert(values.empty());
-    
-    int rowsNum = rawValues.size();
-    int columnsNum = rawValues[0].size(); //rawTableValues[0] - size was checked in GetCalib
-
-    values.resize(rawValues.size());
-
-    //compose values
-    for (int rowIter = 0; rowIter < rowsNum; rowIter++)
-    {
-        map<string, string>::iterator iter;
-        for ( iter=rawValues[rowIter].begin() ; iter != rawValues[rowIter].end(); iter++ )
-        {
-            double tmpVal = StringUtils::ParseDouble(iter->second);
-            values[rowIter][iter->first] = tmpVal;
-        }
-    }
-
-    return true;
+    return GetCalibByNamepath(values, namepath, "Calibration::GetCalib( vector< map<string, double> >&, const string&)");
 }
 
 
 //______________________________________________________________________________
 bool Calibration::GetCalib( vector< map<string, int> > &values, const string & namepath )
 {
-    //TODO right now the function works through copy. 
-    //one needs to find out, maybe it needs to be reimplemented
-
-    vector<map<string, string> > rawValues;
-    try
-    {
-        if(!GetCalib(rawValues, namepath)) return false;
-    }
-    catch (std::exception &)
-    {
-        throw;
-    }
-
-    assert(values.empty());
-
-    int rowsNum = rawValues.size();
-    int columnsNum = rawValues[0].size(); //rawTableValues[0] - size was checked in GetCalib
-
-    values.resize(rawValues.size());
-
-    //compose values
-    for (int rowIter = 0; rowIter < rowsNum; rowIter++)
-    {
-        map<string, string>::iterator iter;
-        for ( iter=rawValues[rowIter].begin() ; iter != rawValues[rowIter].end(); iter++ )
-        {
-            int intlVal = StringUtils::ParseInt(iter->second);
-            values[rowIter][iter->first] = intlVal;
-        }
-    }
-
-    return true;
+    return GetCalibByNamepath(values, namepath, "Calibration::GetCalib( vector< map<string, int> >&, const string&)");
 }
 
 
@@ -212,86 +321,21 @@ bool Calibration::GetCalib( vector< vector<string> > &values, const string & nam
      * @return true if constants were found and filled. false if namepath was not found. raises std::logic_error if any other error acured.
      */
     
-    auto assignment = GetAssignment(namepath, false);
-    
-    if(!assignment)
-    {
-        return false;
-    }
-   
-    assignment->GetData(values);
-    
-    return true;
+    return GetCalibByNamepath(values, namepath, "Calibration::GetCalib( vector< vector<string> >&, const string&)");
 }
 
 
 //______________________________________________________________________________
 bool Calibration::GetCalib( vector< vector<double> > &values, const string & namepath )
 {
-    //TODO right now the function works through copy. One has to check, maybe it needs to be reimplemented
-
-    vector< vector<string> > rawValues;
-    try
-    {
-        if(!GetCalib(rawValues, namepath)) return false;
-    }
-    catch (std::exception &)
-    {
-        throw;
-    }
-
-    assert(values.empty());
-
-    int rowsNum = rawValues.size();
-    int columnsNum = rawValues[0].size(); //rawTableValues[0] - size was checked in GetCalib
-
-    values.resize(rawValues.size());
-
-    //compose values
-    for (int rowIter = 0; rowIter < rowsNum; rowIter++)
-    {   
-        for (int columnsIter = 0; columnsIter < columnsNum; columnsIter++)
-        {
-            double tmpVal = StringUtils::ParseDouble(rawValues[rowIter][columnsIter]);
-            values[rowIter].push_back(tmpVal);
-        }
-    }
-
-    return true;
+    return GetCalibByNamepath(values, namepath, "Calibration::GetCalib( vector< vector<double> >&, const string&)");
 }
 
 
 //______________________________________________________________________________
 bool Calibration::GetCalib( vector< vector<int> > &values, const string & namepath )
 {
-    vector< vector<string> > rawValues;
-    try
-    {
-        if(!GetCalib(rawValues, namepath)) return false;
-    }
-    catch (std::exception &)
-    {
-        throw;
-    }
-
-    assert(values.empty());
-
-    int rowsNum = rawValues.size();
-    int columnsNum = rawValues[0].size(); //rawTableValues[0] - size was checked in GetCalib
-
-    values.resize(rawValues.size());
-
-    //compose values
-    for (int rowIter = 0; rowIter < rowsNum; rowIter++)
-    {   
-        for (int columnsIter = 0; columnsIter < columnsNum; columnsIter++)
-        {
-            int tmpVal = StringUtils::ParseInt(rawValues[rowIter][columnsIter]);
-            values[rowIter].push_back(tmpVal);
-        }
-    }
-
-    return true;
+    return GetCalibByNamepath(values, namepath, "Calibration::GetCalib( vector< vector<int> >&, const string&)");
 }
 
 
@@ -308,128 +352,21 @@ bool Calibration::GetCalib( map<string, string> &values, const string & namepath
      * @return true if constants were found and filled. false if namepath was not found. raises std::logic_error if any other error acured.
      */
 
-
-    auto assignment = GetAssignment(namepath, true);
-    
-    if(assignment == NULL)
-    {
-        //TODO possibly exception throwing?
-        return false;
-    }
-
-    //Get data
-    vector< vector<string> > rawTableValues;
-    assignment->GetData(rawTableValues);
-
-    //check data a little...
-    if(rawTableValues.size() == 0)
-    {
-        throw std::logic_error("Calibration::GetCalib( map<string, string>&, const string&). Data has no rows. Zero rows are not supposed to be.");
-    }
-	
-	//VALUES VALIDATION
-	assert(values.empty());
-
-	// This method is used to return a 1-D array of values (in the form of a
-	// map<string, string>). The data may be stored in either column-wise (1 
-	// row with many columns) or row-wise (1 column with many rows). We wish
-	// to support either so we must check which format it is in. If it is
-	// stored row-wise, then we'll need to make up the column names so that
-	// the map being returned is properly ordered.
-	// 5/25/2014  D. Lawrence
-	
-	// Make sure at least one dimension is exactly 1. (Assume all inner vectors
-	// are the same size as the zeroth one.)
-	int rowsNum = rawTableValues.size();
-	int columnsNum = rawTableValues[0].size();
-	if(rowsNum>1 && columnsNum>1){
-		throw std::logic_error("Calibration::GetCalib( map<string, string>&, const string&). Appears to be a table (both dimensions are > 1).");
-	}
-	
-	if(rowsNum>1){
-		// ---- ROW-WISE ----
-		
-		// Loop over rows, generating a column name for each and filling "values"
-		for(unsigned int i=0; i<rowsNum; i++){
-			char colName[16];
-			sprintf(colName, "v%04d", i); // TODO this will be a problem for more than 10k values!
-			values[colName] = rawTableValues[i][0];
-		}
-		
-	}else{
-		// ---- COLUMN-WISE ----
-
-		//now we take only first row of table
-		vector<string> rawValues = rawTableValues[0];
-
-		//get columns names
-		vector<string> columnNames = assignment->GetTypeTable()->GetColumnNames();
-		assert(columnsNum == columnNames.size());
-
-		//compose values
-		for (int i=0; i<columnsNum; i++) values[columnNames[i]] = rawValues[i];
-	}
-
-    //finishing
-    return true;
+    return GetCalibByNamepath(values, namepath, "Calibration::GetCalib( map<string, string>&, const string&)");
 }
 
 
 //______________________________________________________________________________
 bool Calibration::GetCalib( map<string, double> &values, const string & namepath )
 {
-    map<string, string> rawValues;
-    try
-    {
-        if(!GetCalib(rawValues, namepath)) return false;
-    }
-    catch (std::exception &)
-    {
-        throw;
-    }
-
-    assert(values.empty());
-    
-    //compose values
-    map<string, string>::iterator iter;
-    for ( iter=rawValues.begin() ; iter != rawValues.end(); iter++ )
-    {
-        double tmpVal = StringUtils::ParseDouble(iter->second);
-        values[iter->first] = tmpVal;
-    }
-
-    return true;
+    return GetCalibByNamepath(values, namepath, "Calibration::GetCalib( map<string, double>&, const string&)");
 }
 
 
 //______________________________________________________________________________
 bool Calibration::GetCalib( map<string, int> &values, const string & namepath )
 {
-    //TODO right now the function works through copy. 
-    //one needs to find out, maybe it needs to be reimplemented
-
-
-    map<string, string> rawValues;
-    try
-    {
-        if(!GetCalib(rawValues, namepath)) return false;
-    }
-    catch (std::exception &)
-    {
-        throw;
-    }
-
-    assert(values.empty());
-
-    //compose values
-    map<string, string>::iterator iter;
-    for ( iter=rawValues.begin() ; iter != rawValues.end(); iter++ )
-    {
-        int tmpVal = StringUtils::ParseInt(iter->second);
-        values[iter->first] = tmpVal;
-    }
-
-    return true;
+    return GetCalibByNamepath(values, namepath, "Calibration::GetCalib( map<string, int>&, const string&)");
 }
 
 
@@ -445,78 +382,21 @@ bool Calibration::GetCalib( vector<string> &values, const string & namepath )
      * @return true if constants were found and filled. false if namepath was not found. raises std::logic_error if any other error acured.
      */
 
-	
-    
-	auto assignment = GetAssignment(namepath, true);
-    
-    if(assignment == nullptr) return false; //TODO possibly exception throwing?
-
-    //Get data
-    values.clear();
-    assignment->GetVectorData(values);
-   
-    //check data and check that the user will get what he ment...
-    if(values.size() == 0)
-        throw std::logic_error("Calibration::GetCalib(vector<string> &, const string &). Data has no rows. Zero rows are not supposed to be.");
-
-    if(values.size() != assignment->GetTypeTable()->GetColumnsCount())
-        throw std::logic_error("Calibration::GetCalib(vector<string> &, const string &). logic_error: Calling of single row vector<dataType> version of GetCalib method on dataset that has more than one rows. Use GetCalib vector<vector<dataType> > instead.");
-
-    return true;
+    return GetCalibByNamepath(values, namepath, "Calibration::GetCalib(vector<string> &, const string &)");
 }
 
 
 //______________________________________________________________________________
 bool Calibration::GetCalib( vector<double> &values, const string & namepath )
 {
-    vector<string> rawValues;
-    try
-    {
-        if(!GetCalib(rawValues, namepath)) return false;
-    }
-    catch (std::exception &)
-    {
-        throw;
-    }
-    
-    int columnsNum = rawValues.size(); //rawTableValues[0] - size was checked in GetCalib    
-
-    values.resize(rawValues.size());
-
-    //compose values
-    for (int columnsIter = 0; columnsIter < columnsNum; columnsIter++)
-    {
-        double tmpVal = StringUtils::ParseDouble(rawValues[columnsIter]);
-        values[columnsIter] = tmpVal;
-    }
-    return true;
+    return GetCalibByNamepath(values, namepath, "Calibration::GetCalib(vector<double> &, const string &)");
 }
 
 
 //______________________________________________________________________________
 bool Calibration::GetCalib( vector<int> &values, const string & namepath )
 {
-    vector<string> rawValues;
-    try
-    {
-        if(!GetCalib(rawValues, namepath)) return false;
-    }
-    catch (std::exception &)
-    {
-        throw;
-    }
-
-    int columnsNum = rawValues.size(); //rawTableValues[0] - size was checked in GetCalib
-
-    values.resize(rawValues.size());
-
-    //compose values
-    for (int columnsIter = 0; columnsIter < columnsNum; columnsIter++)
-    {
-        int tmpVal = StringUtils::ParseInt(rawValues[columnsIter]);
-        values[columnsIter] = tmpVal;
-    }
-    return true;
+    return GetCalibByNamepath(values, namepath, "Calibration::GetCalib(vector<int> &, const string &)");
 }
 
 //______________________________________________________________________________
@@ -526,47 +406,147 @@ bool Calibration::GetCalib(string &value, const string & namepath)
 	 *
 	 * This version of function fills just one value
 	 *
-	 * @remark 	Actually the function calls  GetCalib(vector<string> &values, ...)
-	 * 			and converts its first element to the required type
+	 * @remark 	The value is the first cell. The data must have one row as for GetCalib(vector<string> &values, ...)
 	 *
 	 * @parameter [out] value
 	 * @parameter [in]  namepath - data path
 	 * @return true if constants were found and filled. false if namepath was not found. raises std::exception if any other error acured.
 	 */
 
-	vector<string> rawValues;
-	try
-	{
-		if(!GetCalib(rawValues, namepath)) return false;
-	}
-	catch (std::exception &)
-	{
-		throw;
-	}
-
-	assert(rawValues.size());
-	value = rawValues[0];
-	return true;
+	return GetCalibByNamepath(value, namepath, "Calibration::GetCalib(string &, const string &)");
 }
 
 //______________________________________________________________________________
 bool Calibration::GetCalib(double &value, const string & namepath)
 {
-	string rawValue;
-	if(!GetCalib(rawValue, namepath)) return false;
-	value = StringUtils::ParseDouble(rawValue);
-	return false;
+	return GetCalibByNamepath(value, namepath, "Calibration::GetCalib(double &, const string &)");
 }
 
 //______________________________________________________________________________
 bool Calibration::GetCalib(int &value, const string & namepath)
 {
-	string rawValue;
-	if(!GetCalib(rawValue, namepath)) return false;
-	value = StringUtils::ParseInt(rawValue);
-	return false;
+	return GetCalibByNamepath(value, namepath, "Calibration::GetCalib(int &, const string &)");
+}
+
+
+//______________________________________________________________________________
+template<typename T>
+bool Calibration::GetCalibResolved(T &values, const RequestHandle& handle, const char* funcName)
+{
+    auto assignment = AcquireAssignment(handle);
+    if(!assignment) return false;
+
+    TraceSpan span(TracePhase::Decode);
+    FillValues(values, ConstantsView(*assignment), funcName);
+    return true;
 }
 
+
+//______________________________________________________________________________
+bool Calibration::GetCalib(vector< map<string, string> > &values, const RequestHandle& handle)
+{
+    return GetCalibResolved(values, handle, "Calibration::GetCalib( vector< map<string, string> >&, const RequestHandle&)");
+}
+
+bool Calibration::GetCalib(vector< map<string, double> > &values, const RequestHandle& handle)
+{
+    return GetCalibResolved(values, handle, "Calibration::GetCalib( vector< map<string, double> >&, const RequestHandle&)");
+}
+
+bool Calibration::GetCalib(vector< map<string, int> > &values, const RequestHandle& handle)
+{
+    return GetCalibResolved(values, handle, "Calibration::GetCalib( vector< map<string, int> >&, const RequestHandle&)");
+}
+
+bool Calibration::GetCalib(vector< vector<string> > &values, const RequestHandle& handle)
+{
+    return GetCalibResolved(values, handle, "Calibration::GetCalib( vector< vector<string> >&, const RequestHandle&)");
+}
+
+bool Calibration::GetCalib(vector< vector<double> > &values, const RequestHandle& handle)
+{
+    return GetCalibResolved(values, handle, "Calibration::GetCalib( vector< vector<double> >&, const RequestHandle&)");
+}
+
+bool Calibration::GetCalib(vector< vector<int> > &values, const RequestHandle& handle)
+{
+    return GetCalibResolved(values, handle, "Calibration::GetCalib( vector< vector<int> >&, const RequestHandle&)");
+}
+
+bool Calibration::GetCalib(map<string, string> &values, const RequestHandle& handle)
+{
+    return GetCalibResolved(values, handle, "Calibration::GetCalib( map<string, string>&, const RequestHandle&)");
+}
+
+bool Calibration::GetCalib(map<string, double> &values, const RequestHandle& handle)
+{
+    return GetCalibResolved(values, handle, "Calibration::GetCalib( map<string, double>&, const RequestHandle&)");
+}
+
+bool Calibration::GetCalib(map<string, int> &values, const RequestHandle& handle)
+{
+    return GetCalibResolved(values, handle, "Calibration::GetCalib( map<string, int>&, const RequestHandle&)");
+}
+
+bool Calibration::GetCalib(vector<string> &values, const RequestHandle& handle)
+{
+    return GetCalibResolved(values, handle, "Calibration::GetCalib(vector<string> &, const RequestHandle&)");
+}
+
+bool Calibration::GetCalib(vector<double> &values, const RequestHandle& handle)
+{
+    return GetCalibResolved(values, handle, "Calibration::GetCalib(vector<double> &, const RequestHandle&)");
+}
+
+bool Calibration::GetCalib(vector<int> &values, const RequestHandle& handle)
+{
+    return GetCalibResolved(values, handle, "Calibration::GetCalib(vector<int> &, const RequestHandle&)");
+}
+
+bool Calibration::GetCalib(string &value, const RequestHandle& handle)
+{
+    return GetCalibResolved(value, handle, "Calibration::GetCalib(string &, const RequestHandle&)");
+}
+
+bool Calibration::GetCalib(double &value, const RequestHandle& handle)
+{
+    return GetCalibResolved(value, handle, "Calibration::GetCalib(double &, const RequestHandle&)");
+}
+
+bool Calibration::GetCalib(int &value, const RequestHandle& handle)
+{
+    return GetCalibResolved(value, handle, "Calibration::GetCalib(int &, const RequestHandle&)");
+}
+
+
+//______________________________________________________________________________
+ConstantsView Calibration::GetView(const string& namepath)
+{
+    return ConstantsView(std::shared_ptr<const Assignment>(GetAssignmentShared(namepath, true)));
+}
+
+
+//______________________________________________________________________________
+ConstantsView Calibration::GetView(const RequestHandle& handle)
+{
+    return ConstantsView(std::shared_ptr<const Assignment>(GetAssignmentShared(handle)));
+}
+
+
+//______________________________________________________________________________
+const std::vector<RowColumnBinding>& Calibration::GetRowBinding(std::type_index rowType, const ConstantsTypeTable& table, const RowColumnSpec* columns, size_t columnsCount)
+{
+    // Bindings are never removed while the provider is used, so the reference stays valid (map nodes don't move)
+
+    std::lock_guard<std::mutex> lock(mRowBindingsMutex);
+    auto key = std::make_pair(rowType, table.GetId());
+    auto bindingIter = mRowBindings.find(key);
+    if(bindingIter != mRowBindings.end()) return bindingIter->second;
+
+    return mRowBindings.emplace(key, BindRowColumns(table, columns, columnsCount)).first->second;
+}
+
+
 //______________________________________________________________________________
 string Calibration::GetConnectionString() const
 {
@@ -584,49 +564,368 @@ Assignment* Calibration::GetAssignment(const string& namepath, bool loadColumns
      * namepath is the common ccdb request; @see GetCalib
      *
      * @remark the function is thread safe
+     * @warning the caller owns the returned object. It is always loaded from the provider:
+     *          a cached assignment may be evicted (or not stored at all) at any moment,
+     *          so it can't be given by a raw pointer. @see GetAssignmentShared uses the cache
      * 
      * @parameter [in] namepath - full namepath is /path/to/data:run:variation:time but usually it is only /path/to/data
      * @return   DAssignment *
      */
 
-    auto pl = PerfLog("Calibration::GetAssignment=>" + namepath );
-    static std::map<std::string, Assignment*> cache;
+    TraceSpan span(TracePhase::Request, namepath);
+    UpdateActivityTime();
+    CheckConnection();  // Check if is connected and reconnect if needed (and allowed)
 
-	UpdateActivityTime();
+    auto lock = LockProviderForRead();
+    return LoadAssignment(namepath, loadColumns, nullptr);
+}
 
-    RequestParseResult result = PathUtils::ParseRequest(namepath);
-    string variation = (result.WasParsedVariation ? result.Variation : mDefaultVariation);
-    int run  = (result.WasParsedRunNumber ? result.RunNumber : mDefaultRun);
+
+//______________________________________________________________________________
+std::shared_ptr<Assignment> Calibration::GetAssignmentShared(const string& namepath, bool loadColumns /*=true*/)
+{
+    /** @brief Gets the assignment from provider using namepath
+     * namepath is the common ccdb request; @see GetCalib
+     *
+     * @remark the function is thread safe
+     *
+     * @parameter [in] namepath - full namepath is /path/to/data:run:variation:time but usually it is only /path/to/data
+     * @return   shared pointer to assignment or empty pointer if no assignment found
+     */
+
+    // Default run, variation and time of the Calibration never change, so the request alone is the key
+    uint64_t cacheKey = AssignmentCache::MakeKey(namepath);
+
+    if(mIsCacheEnabled)
+    {
+        TraceSpan span(TracePhase::Cache, namepath);
+        std::shared_ptr<Assignment> assignment = mCache.Find(cacheKey, namepath);
+        if(assignment) return assignment;
+    }
+
+    return LoadAndCacheAssignment(cacheKey, namepath, loadColumns);
+}
 
 
+//______________________________________________________________________________
+AssignmentCache::ReadPtr Calibration::AcquireAssignment(const string& namepath, bool loadColumns)
+{
+    // Cache hits lock the cache only for the lookup and don't touch the provider or mReadMutex,
+    // so any number of threads read cached constants concurrently
+
+    uint64_t cacheKey = AssignmentCache::MakeKey(namepath);
+
+    if(mIsCacheEnabled)
+    {
+        TraceSpan span(TracePhase::Cache, namepath);
+        AssignmentCache::ReadPtr assignment = mCache.Acquire(cacheKey, namepath);
+        if(assignment) return assignment;
+    }
+
+    return AssignmentCache::ReadPtr(LoadAndCacheAssignment(cacheKey, namepath, loadColumns));
+}
 
-    auto time = result.WasParsedTime ? result.Time: mDefaultTime;
 
+//______________________________________________________________________________
+RequestHandle Calibration::Resolve(const string& namepath)
+{
+    UpdateActivityTime();
     CheckConnection();  // Check if is connected and reconnect if needed (and allowed)
-	
-    //Lock();Unlock();
-    std::lock_guard<std::mutex> lock(mReadMutex);
 
-    // Check if we have this value in the cache
-    string cache_key = namepath + ":" + to_string(run) + ":" + variation + ":" + to_string(time);
+    RequestHandle handle;
+    handle.mNamepath = namepath;
+    handle.mCacheKey = AssignmentCache::MakeKey(namepath);
+    handle.mRequest = MakeRequest(namepath);
+
+    auto lock = LockProviderForRead();
+    std::shared_ptr<const Catalog> catalog = mProvider->IsCatalogEnabled() ? mProvider->GetCatalog() : nullptr;   //holds the record
+    const CatalogTable* record = catalog ? catalog->FindTable(handle.mRequest.Path) : nullptr;
+    if(record) handle.mTypeTable = record->TypeTable;
+    else handle.mTypeTable.reset(mProvider->GetConstantsTypeTable(handle.mRequest.Path, /*loadColumns*/ true));
+    if(!handle.mTypeTable) {
+        throw std::runtime_error("Calibration::Resolve => Type table was not found: '" + handle.mRequest.Path + "'");
+    }
+
+    handle.mVariation = mProvider->GetVariation(handle.mRequest.Variation);
+    if(!handle.mVariation) {
+        throw std::runtime_error("Calibration::Resolve => No variation '" + handle.mRequest.Variation + "' was found");
+    }
+
+    handle.mProviderGeneration = mProviderGeneration;
+    return handle;
+}
+
+
+//______________________________________________________________________________
+std::shared_ptr<Assignment> Calibration::GetAssignmentShared(const RequestHandle& handle)
+{
     if(mIsCacheEnabled)
     {
-        if (  cache.find(cache_key) != cache.end() ) {
-            return cache[cache_key];
+        TraceSpan span(TracePhase::Cache, handle.mNamepath);
+        std::shared_ptr<Assignment> assignment = mCache.Find(handle.mCacheKey, handle.mNamepath);
+        if(assignment) return assignment;
+    }
+
+    return LoadAndCacheAssignment(handle.mCacheKey, handle.mNamepath, true, &handle);
+}
+
+
+//______________________________________________________________________________
+AssignmentCache::ReadPtr Calibration::AcquireAssignment(const RequestHandle& handle)
+{
+    // Same as AcquireAssignment(namepath) but the key is already computed
+
+    if(mIsCacheEnabled)
+    {
+        TraceSpan span(TracePhase::Cache, handle.mNamepath);
+        AssignmentCache::ReadPtr assignment = mCache.Acquire(handle.mCacheKey, handle.mNamepath);
+        if(assignment) return assignment;
+    }
+
+    return AssignmentCache::ReadPtr(LoadAndCacheAssignment(handle.mCacheKey, handle.mNamepath, true, &handle));
+}
+
+
+//______________________________________________________________________________
+std::shared_ptr<Assignment> Calibration::LoadAndCacheAssignment(uint64_t cacheKey, const string& namepath, bool loadColumns, const RequestHandle* handle /*=nullptr*/)
+{
+    // Loads assignment from the provider (a cache miss)
+
+    TraceSpan span(TracePhase::Request, namepath);
+
+	UpdateActivityTime();
+    CheckConnection();  // Check if is connected and reconnect if needed (and allowed)
+
+    auto lock = LockProviderForRead();
+
+    if(!mIsCacheEnabled) return std::shared_ptr<Assignment>(LoadAssignment(namepath, loadColumns, handle));
+
+    // Other thread could load the same assignment while we waited for the lock
+    std::shared_ptr<Assignment> assignment = mCache.Find(cacheKey, namepath, /*countStats*/ false);
+    if(assignment) return assignment;
+
+    // Cached assignment may serve any GetCalib overload later, so it should have column names
+    assignment.reset(LoadAssignment(namepath, /*loadColumns*/ true, handle));
+    mCache.Insert(cacheKey, namepath, assignment);
+    return assignment;
+}
+
+
+//______________________________________________________________________________
+void Calibration::NextProviderGeneration()
+{
+    static std::atomic<uint64_t> lastGeneration(0);
+    mProviderGeneration = ++lastGeneration;
+}
+
+
+//______________________________________________________________________________
+Calibration::ProviderReadLock Calibration::LockProviderForRead()
+{
+    // Providers that support concurrent reads (each query gets its own connection)
+    // serve many threads in parallel under the shared lock. Others get one thread at a time.
+    // Either way UseProvider can't swap (and the user can't delete) the provider while it is read
+
+    ProviderReadLock lock;
+    lock.SharedLock = std::shared_lock<ReadMostlyMutex>(mReadMutex);
+    if(!mProvider || mProvider->IsConcurrentReadSupported()) return lock;
+
+    lock.SharedLock.unlock();
+    lock.ExclusiveLock = std::unique_lock<ReadMostlyMutex>(mReadMutex);
+    return lock;
+}
+
+
+//______________________________________________________________________________
+size_t Calibration::Prefetch(const vector<string>& namepaths)
+{
+    if(!mIsCacheEnabled) return 0;
+
+    UpdateActivityTime();
+    CheckConnection();  // Check if is connected and reconnect if needed (and allowed)
+    return PrefetchConnected(namepaths);
+}
+
+
+//______________________________________________________________________________
+void Calibration::StartPrefetch(const vector<string>& namepaths)
+{
+    std::lock_guard<std::mutex> lock(mPrefetchThreadMutex);
+    if(mPrefetchThread.joinable()) mPrefetchThread.join();
+
+    mPrefetchThread = std::thread([this, namepaths]() {
+        // The thread runs until ~Calibration at most, when the derived class is already destroyed.
+        // So it doesn't call virtual methods of Calibration (no reconnection).
+        // PrefetchConnected checks the provider under the read lock
+        try
+        {
+            PrefetchConnected(namepaths);
+        }
+        catch (std::exception&)
+        {
+            // The same requests report the error when they are loaded by GetCalib
+        }
+    });
+}
+
+
+//______________________________________________________________________________
+void Calibration::WaitPrefetch()
+{
+    std::lock_guard<std::mutex> lock(mPrefetchThreadMutex);
+    if(mPrefetchThread.joinable()) mPrefetchThread.join();
+}
+
+
+//______________________________________________________________________________
+void Calibration::StopAsyncRequests()
+{
+    // Queued requests are not served after this: they end with an error without touching the provider.
+    // Requests that are already running are waited for
+
+    mIsAsyncStopped = true;
+    std::unique_ptr<WorkerPool> workerPool;
+    {
+        std::lock_guard<std::mutex> lock(mWorkerPoolMutex);
+        workerPool = std::move(mWorkerPool);
+    }
+    workerPool.reset();     //runs what is left in the queue and joins the threads
+}
+
+
+//______________________________________________________________________________
+void Calibration::CheckAsyncNotStopped() const
+{
+    if(mIsAsyncStopped) throw std::logic_error("Calibration is being destroyed, the asynchronous request is canceled");
+}
+
+
+//______________________________________________________________________________
+WorkerPool& Calibration::GetWorkerPool()
+{
+    std::lock_guard<std::mutex> lock(mWorkerPoolMutex);
+    CheckAsyncNotStopped();
+    if(!mWorkerPool) mWorkerPool.reset(new WorkerPool(mAsyncThreadsCount > 0 ? mAsyncThreadsCount.load() : 1));
+    return *mWorkerPool;
+}
+
+
+//______________________________________________________________________________
+std::future<std::shared_ptr<Assignment> > Calibration::GetAssignmentAsync(const string& namepath, bool loadColumns /*=true*/)
+{
+    return RunAsync<std::shared_ptr<Assignment> >([this, namepath, loadColumns]() {
+        return GetAssignmentShared(namepath, loadColumns);
+    });
+}
+
+
+//______________________________________________________________________________
+void Calibration::GetAssignmentAsync(const string& namepath, std::function<void(std::shared_ptr<Assignment>, std::exception_ptr)> callback, bool loadColumns /*=true*/)
+{
+    GetWorkerPool().Submit([this, namepath, callback, loadColumns]() {
+        std::shared_ptr<Assignment> assignment;
+        std::exception_ptr error;
+        try
+        {
+            CheckAsyncNotStopped();
+            assignment = GetAssignmentShared(namepath, loadColumns);
         }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        callback(assignment, error);
+    });
+}
+
+
+//______________________________________________________________________________
+vector<string> Calibration::GetRequestedNamepaths()
+{
+    return mCache.GetUsedRequests();
+}
+
+
+//______________________________________________________________________________
+size_t Calibration::PrefetchConnected(const vector<string>& namepaths)
+{
+    if(!mIsCacheEnabled) return 0;
+
+    // Only namepaths that are not cached yet, each once
+    vector<string> missingNamepaths;
+    vector<uint64_t> cacheKeys;
+    vector<AssignmentRequest> requests;
+    unordered_set<uint64_t> seenKeys;
+    for(const string& namepath: namepaths)
+    {
+        uint64_t cacheKey = AssignmentCache::MakeKey(namepath);
+        if(!seenKeys.insert(cacheKey).second) continue;
+        if(mCache.Find(cacheKey, namepath, /*countStats*/ false)) continue;
+
+        missingNamepaths.push_back(namepath);
+        cacheKeys.push_back(cacheKey);
+        requests.push_back(MakeRequest(namepath));
     }
+    if(requests.empty()) return 0;
 
-    Assignment* assigment;
+    TraceSpan span(TracePhase::Prefetch);
 
-    if(time < 0) time = 0;
+    vector<Assignment*> assignments;
+    {
+        auto lock = LockProviderForRead();
+        if(!mProvider || !mProvider->IsConnected()) return 0;      // the background prefetch doesn't reconnect
 
-    assigment = (mProvider->GetAssignmentShort(run, PathUtils::MakeAbsolute(result.Path), time, variation, loadColumns));
+        // Cached assignment may serve any GetCalib overload later, so it should have column names
+        assignments = mProvider->GetAssignmentsShort(requests, /*loadColumns*/ true);
+    }
 
-    if(mIsCacheEnabled) {
-        cache[cache_key] = assigment;
+    size_t addedCount = 0;
+    for(size_t i = 0; i < assignments.size(); i++)
+    {
+        std::shared_ptr<Assignment> assignment(assignments[i]);
+        if(!assignment) continue;
+
+        // Other thread could load the same assignment meanwhile, the first one is kept
+        if(mCache.Find(cacheKeys[i], missingNamepaths[i], /*countStats*/ false)) continue;
+        mCache.Insert(cacheKeys[i], missingNamepaths[i], assignment, /*isPrefetched*/ true);
+        addedCount++;
     }
+    return addedCount;
+}
 
-    return assigment;
+
+//______________________________________________________________________________
+AssignmentRequest Calibration::MakeRequest(const string& namepath) const
+{
+    TraceSpan span(TracePhase::Parse, namepath);
+    RequestParseResult result = PathUtils::ParseRequest(namepath);
+
+    AssignmentRequest request;
+    request.Variation = (result.WasParsedVariation ? result.Variation : mDefaultVariation);
+    request.RunNumber  = (result.WasParsedRunNumber ? result.RunNumber : mDefaultRun);
+    request.Time = result.WasParsedTime ? result.Time: mDefaultTime;
+    if(request.Time < 0) request.Time = 0;
+    request.Path = PathUtils::MakeAbsolute(result.Path);
+    return request;
+}
+
+
+//______________________________________________________________________________
+Assignment* Calibration::LoadAssignment(const string& namepath, bool loadColumns, const RequestHandle* handle)
+{
+    // Handles made for another calibration, provider or connection are not trusted, they go by namepath.
+    // Generations are unique over all Calibrations, so a handle of a destroyed one doesn't match
+
+    if(handle && handle->mProviderGeneration != 0 && handle->mProviderGeneration == mProviderGeneration)
+    {
+        const AssignmentRequest& request = handle->mRequest;
+        return mProvider->GetResolvedAssignmentShort(request.RunNumber, handle->mTypeTable, handle->mVariation, request.Time);
+    }
+
+    // Parses namepath, applies defaults and queries the provider. @see LockProviderForRead
+
+    AssignmentRequest request = MakeRequest(namepath);
+    return mProvider->GetAssignmentShort(request.RunNumber, request.Path, request.Time, request.Variation, loadColumns);
 }
 
 
@@ -642,7 +941,7 @@ void Calibration::GetListOfNamepaths( vector<string> &namepaths )
     UpdateActivityTime();
 
     vector<ConstantsTypeTable*> tables;
-    std::lock_guard<std::mutex> lock(mReadMutex);
+    auto lock = LockProviderForRead();
     tables = mProvider->GetAllConstantsTypeTables(/*loadColumns*/ false);
 
     for (auto &table : tables) {
@@ -712,10 +1011,39 @@ void Calibration::UpdateActivityTime()
      * @remarks - cache greatly (2 magnitudes) reduses the time to get the same constants from DB
      *            but it costs some memory. Shouldn't be a bug source but caches are alwais caches
      */
-    void Calibration::EnableCache(bool value) { mIsCacheEnabled = value;}
+    void Calibration::EnableCache(bool value)
+    {
+        std::lock_guard<ReadMostlyMutex> lock(mReadMutex);
+        mIsCacheEnabled = value;
+        if(!value) mCache.Clear();
+    }
 
     /** @brief if true the caching is using */
     bool Calibration::IsCacheEnabled() { return mIsCacheEnabled;}
 
+    /** @brief Sets memory budget of the cache in bytes */
+    void Calibration::SetCacheMaxBytes(size_t maxBytes)
+    {
+        mCache.SetMaxBytes(maxBytes);
+    }
+
+    /** @brief Gets memory budget of the cache in bytes */
+    size_t Calibration::GetCacheMaxBytes()
+    {
+        return mCache.GetMaxBytes();
+    }
+
+    /** @brief Gets cache hits, misses, evictions and memory counters */
+    AssignmentCacheStats Calibration::GetCacheStats()
+    {
+        return mCache.GetStats();
+    }
+
+    /** @brief Removes all cached assignments */
+    void Calibration::ClearCache()
+    {
+        mCache.Clear();
+    }
+
 }
 
@@ -7,9 +7,21 @@
 #include <time.h>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <thread>
+#include <future>
+#include <functional>
+#include <typeindex>
 
 #include "Globals.h"
 #include "Providers/DataProvider.h"
+#include "Helpers/AssignmentCache.h"
+#include "Helpers/ReadMostlyMutex.h"
+#include "Helpers/WorkerPool.h"
+#include "Helpers/RowSchema.h"
+#include "Helpers/Trace.h"
+#include "Model/ConstantsView.h"
 
 #define ERRMSG_INVALID_CONNECT_USAGE "Invalid DMySQLCalibration usage. Using DMySQLCalibration::Connect method with provider == NULL and ProviderIsLocked==true." 
 #define ERRMSG_CONNECTED_TO_ANOTHER "The connection is open to another source. DCalibration is already connected using another connection string" 
@@ -18,6 +30,38 @@
 
 namespace ccdb
 {
+    class Calibration;
+
+    /** @brief Pre-resolved GetCalib request. @see Calibration::Resolve
+     *
+     * Holds the parsed request with defaults applied, the type table (column layout), the variation
+     * and the cache key. GetCalib with a handle skips parsing and all metadata lookups.
+     * The handle is valid for the Calibration that made it until its provider is changed or reconnected
+     * (otherwise the request is resolved by namepath as usual). It is cheap to copy
+     */
+    class RequestHandle
+    {
+    public:
+        RequestHandle(): mCacheKey(0), mVariation(nullptr), mProviderGeneration(0) {}
+
+        const std::string& GetNamepath() const { return mNamepath; }        /// Namepath as it was given to Resolve
+        const AssignmentRequest& GetRequest() const { return mRequest; }    /// Absolute path, run, variation and time
+        const std::shared_ptr<ConstantsTypeTable>& GetTypeTable() const { return mTypeTable; }   /// Table with columns
+        Variation* GetVariation() const { return mVariation; }              /// Requested variation
+        uint64_t GetCacheKey() const { return mCacheKey; }                  /// @see AssignmentCache::MakeKey
+        bool IsValid() const { return mProviderGeneration != 0; }           /// Made by Calibration::Resolve
+
+    private:
+        friend class Calibration;
+
+        std::string mNamepath;
+        uint64_t mCacheKey;
+        AssignmentRequest mRequest;
+        std::shared_ptr<ConstantsTypeTable> mTypeTable;
+        Variation* mVariation;              /// Owned by the provider
+        uint64_t mProviderGeneration;       /// Provider generation of the Calibration that resolved the request
+    };
+
 
     class Calibration {
 
@@ -95,6 +139,7 @@ namespace ccdb
         /** @brief set provider to use.
          * if lockProvider==true, than @see Connect, @see Disconnect and @see SetConnectionString
          * will not affect connection of provider. The provider will not be deleted in destruction.
+         * The function waits for the requests that read the previous provider, so it may be deleted after the call.
          * @parameter [in] DDataProvider * provider
          * @parameter [in] bool lockProvider
          * @return   void
@@ -178,6 +223,89 @@ namespace ccdb
         virtual bool GetCalib(double &value, const string & namepath);
         virtual bool GetCalib(int &value, const string & namepath);
 
+        /** @brief Resolves namepath once for repeated GetCalib calls
+         *
+         * Parses the namepath, applies defaults, finds the type table (with columns) and the variation.
+         * GetCalib(values, handle) overloads then skip all the string work and metadata lookups:
+         * a cache hit is a probe by the precomputed key, a miss goes to the provider by the resolved
+         * table and variation (@see DataProvider::GetResolvedAssignmentShort)
+         *
+         * @remark the function is thread safe
+         * @parameter [in]  namepath - data path, like in @see GetCalib
+         * @return  handle. Raises std::runtime_error if the table or the variation doesn't exist
+         */
+        RequestHandle Resolve(const string & namepath);
+
+        /** @brief Get constants by pre-resolved request. @see Resolve and GetCalib with namepath of the same values type
+         * @return true if constants were found and filled, false if there is no assignment
+         */
+        bool GetCalib(vector< map<string, string> > &values, const RequestHandle& handle);
+        bool GetCalib(vector< map<string, double> > &values, const RequestHandle& handle);
+        bool GetCalib(vector< map<string, int> > &values, const RequestHandle& handle);
+        bool GetCalib(vector< vector<string> > &values, const RequestHandle& handle);
+        bool GetCalib(vector< vector<double> > &values, const RequestHandle& handle);
+        bool GetCalib(vector< vector<int> >   &values, const RequestHandle& handle);
+        bool GetCalib(map<string, string> &values, const RequestHandle& handle);
+        bool GetCalib(map<string, double> &values, const RequestHandle& handle);
+        bool GetCalib(map<string, int> &values, const RequestHandle& handle);
+        bool GetCalib(vector<string> &values, const RequestHandle& handle);
+        bool GetCalib(vector<double> &values, const RequestHandle& handle);
+        bool GetCalib(vector<int> &values, const RequestHandle& handle);
+        bool GetCalib(string &value, const RequestHandle& handle);
+        bool GetCalib(double &value, const RequestHandle& handle);
+        bool GetCalib(int &value, const RequestHandle& handle);
+
+        /** @brief Gets constants as a columnar view (@see ConstantsView)
+         *
+         * The view shares the assignment, so with the cache on it is the cached data itself: columns
+         * and rows are given as spans of decoded values without copying, column names are resolved
+         * to indexes once. GetCalib overloads fill their containers from the same view.
+         *
+         * @parameter [in] namepath - data path, like in @see GetCalib
+         * @return view of the constants or empty view (IsEmpty() is true) if no assignment was found
+         */
+        ConstantsView GetView(const string & namepath);
+
+        /** @brief @see GetView by pre-resolved request (@see Resolve) */
+        ConstantsView GetView(const RequestHandle& handle);
+
+        /** @brief Gets constants as a vector of user structs described by @see RowSchema
+         *
+         * Columns are bound to the struct members once per type table (the binding is checked against
+         * the table columns and kept), then every row is decoded straight into contiguous structs
+         * from the data decoded once per assignment. No maps or per cell strings are made.
+         *
+         * @code
+         *     vector<TofGain> gains;
+         *     calib->GetCalibRows(gains, "/TOF/gains");
+         * @endcode
+         *
+         * @throw std::logic_error if a schema column is missing in the table or has an incompatible type
+         * @parameter [out] rows - one struct per row
+         * @parameter [in] namepath - data path, like in @see GetCalib
+         * @return true if constants were found and filled. false if namepath was not found.
+         */
+        template<typename Row>
+        bool GetCalibRows(std::vector<Row> &rows, const string & namepath)
+        {
+            auto assignment = AcquireAssignment(namepath, true);
+            if(!assignment) return false;
+            TraceSpan span(TracePhase::Decode);
+            FillRows(rows, *assignment, GetRowBinding(typeid(Row), *assignment->GetTypeTable(), GetRowColumnSpecs<Row>().data(), GetRowColumnSpecs<Row>().size()));
+            return true;
+        }
+
+        /** @brief @see GetCalibRows by pre-resolved request (@see Resolve) */
+        template<typename Row>
+        bool GetCalibRows(std::vector<Row> &rows, const RequestHandle& handle)
+        {
+            auto assignment = AcquireAssignment(handle);
+            if(!assignment) return false;
+            TraceSpan span(TracePhase::Decode);
+            FillRows(rows, *assignment, GetRowBinding(typeid(Row), *assignment->GetTypeTable(), GetRowColumnSpecs<Row>().data(), GetRowColumnSpecs<Row>().size()));
+            return true;
+        }
+
         /** @brief gets connection string which is used for current provider
         *@return mConnectionString
         */
@@ -249,24 +377,132 @@ namespace ccdb
         * namepath is the common ccdb request; @see GetCalib
         *
         * @remark the function is thread safe
+        * @warning the caller owns the returned object. The cache is not used: a cached assignment may be
+        *          evicted at any moment (@see SetCacheMaxBytes), so it is given only by @see GetAssignmentShared
         *
         * @parameter [in] namepath -  full namepath is /path/to/data:run:variation:time but usually it is only /path/to/data
         * @return   DAssignment *
         */
         virtual Assignment* GetAssignment(const string& namepath, bool loadColumns = true);
 
+        /** @brief Gets the assignment from provider using namepath. Same as @see GetAssignment
+        * but the assignment is alive while the returned pointer is held
+        *
+        * @remark the function is thread safe
+        *
+        * @parameter [in] namepath -  full namepath is /path/to/data:run:variation:time but usually it is only /path/to/data
+        * @return   shared pointer to assignment or empty pointer if no assignment found
+        */
+        virtual std::shared_ptr<Assignment> GetAssignmentShared(const string& namepath, bool loadColumns = true);
+
+        /** @brief Gets the assignment by pre-resolved request. @see Resolve and GetAssignmentShared */
+        std::shared_ptr<Assignment> GetAssignmentShared(const RequestHandle& handle);
+
+        /** @brief Loads assignments of many namepaths into the cache at once
+        *
+        * The provider resolves all the requests with a few set-based queries (@see DataProvider::GetAssignmentsShort),
+        * so GetCalib calls with these namepaths that follow are cache hits. Already cached namepaths are skipped.
+        * Namepaths without data (or with not existing tables) are not cached, they go to the provider as usual.
+        *
+        * @remark the function is thread safe. Does nothing if the cache is disabled
+        *
+        * @parameter [in] namepaths - requests as they are given to GetCalib
+        * @return   number of assignments added to the cache
+        */
+        virtual size_t Prefetch(const vector<string>& namepaths);
+
+        /** @brief Starts @see Prefetch of the namepaths on a background thread
+        *
+        * CalibrationGenerator calls it for a new run with the namepaths requested for the previous run
+        * (@see CalibrationGenerator::SetRunPrefetchEnabled). The calibration may be used at once:
+        * requests that come before the prefetch is done are loaded as usual.
+        * Errors of the background prefetch are ignored, the same requests report them in GetCalib
+        *
+        * @remark Prefetched entries and those of them that were requested are counted in @see GetCacheStats
+        * @parameter [in] namepaths - requests as they are given to GetCalib
+        */
+        void StartPrefetch(const vector<string>& namepaths);
+
+        /** @brief Waits until the background prefetch started by @see StartPrefetch is done */
+        void WaitPrefetch();
+
+        /** @brief Starts @see GetCalib on the worker pool of this calibration and returns at once
+        *
+        * Independent requests run in parallel (as far as the provider allows concurrent reads, @see
+        * DataProvider::IsConcurrentReadSupported), so a factory can start all its requests and wait once.
+        * The future gives the result of GetCalib or rethrows its exception.
+        *
+        * @warning values must stay alive and must not be used until the future is ready.
+        *          All futures must be waited for before the calibration is deleted
+        *
+        * @parameter [out] values - any container accepted by GetCalib
+        * @parameter [in] namepath - data path, like in @see GetCalib
+        * @return   future of the GetCalib result
+        */
+        template<typename T>
+        std::future<bool> GetCalibAsync(T &values, const string & namepath)
+        {
+            return RunAsync<bool>([this, &values, namepath]() { return GetCalib(values, namepath); });
+        }
+
+        /** @brief Starts @see GetAssignmentShared on the worker pool of this calibration and returns at once
+        *
+        * @warning All futures must be waited for before the calibration is deleted
+        * @parameter [in] namepath - data path, like in @see GetCalib
+        * @return   future of the assignment (empty pointer if no assignment found)
+        */
+        std::future<std::shared_ptr<Assignment> > GetAssignmentAsync(const string& namepath, bool loadColumns = true);
+
+        /** @brief Starts @see GetAssignmentShared on the worker pool and calls the callback with the result
+        *
+        * The callback is called on a pool thread. On error the assignment is empty and the exception is given
+        *
+        * @parameter [in] namepath - data path, like in @see GetCalib
+        * @parameter [in] callback - called with the assignment and nullptr, or empty pointer and the error
+        */
+        void GetAssignmentAsync(const string& namepath, std::function<void(std::shared_ptr<Assignment>, std::exception_ptr)> callback, bool loadColumns = true);
+
+        /** @brief Number of threads of the worker pool for asynchronous requests. Default is 4
+        *
+        * The pool is started by the first asynchronous request, later changes have no effect
+        */
+        void SetAsyncThreadsCount(size_t count) { mAsyncThreadsCount = count; }
+
+        /** @brief @see SetAsyncThreadsCount */
+        size_t GetAsyncThreadsCount() const { return mAsyncThreadsCount; }
+
+        /** @brief Namepaths requested from this calibration (its working set)
+        *
+        * Only cached namepaths are known. Prefetched namepaths which were never requested are not included
+        */
+        vector<string> GetRequestedNamepaths();
+
         /** @brief if true the data will be cached
          *
-         * @param value true - enable cache, false - disable
+         * @param value true - enable cache, false - disable (cached data is released)
          *
          * @remarks - cache greatly (2 magnitudes) reduses the time to get the same constants from DB
-         *            but it costs some memory. Shouldn't be a bug source but caches are alwais caches
+         *            but it costs some memory. The memory is limited by @see SetCacheMaxBytes
          */
         void EnableCache(bool value);
 
         /** @brief if true the caching is using */
         bool IsCacheEnabled();
 
+        /** @brief Sets memory budget of the cache in bytes.
+         *  The least recently used assignments are evicted when the budget is exceeded
+         */
+        void SetCacheMaxBytes(size_t maxBytes);
+
+        /** @brief Gets memory budget of the cache in bytes */
+        size_t GetCacheMaxBytes();
+
+        /** @brief Gets cache hits, misses, evictions and memory counters */
+        AssignmentCacheStats GetCacheStats();
+
+        /** @brief Removes all cached assignments */
+        void ClearCache();
+
     protected:
 
         /**@brief Try to auto-reconnect if possible
@@ -289,20 +525,105 @@ namespace ccdb
          */
         void UpdateActivityTime();
 
+        /** @brief Cancels queued asynchronous requests and waits for the running ones
+         *
+         * Requests call virtual methods (@see IsConnected), so derived classes call it first in their destructors.
+         * Queued requests end with std::logic_error (given to the future or to the callback).
+         * New asynchronous requests throw std::logic_error
+         */
+        void StopAsyncRequests();
+
+        /** @brief Gives mProvider a new generation, so handles resolved before are not trusted
+         *
+         * Called when the provider is changed or connected. mReadMutex must be locked for writing
+         */
+        void NextProviderGeneration();
+
         DataProvider *mProvider;         /// Underlaid DataProvider object
+        uint64_t mProviderGeneration;    /// Unique over all Calibrations, 0 if there is none (@see NextProviderGeneration). Guarded by mReadMutex
         bool mProviderIsLocked;          /// If provider
         int mDefaultRun;                 /// Default run number
         string mDefaultVariation;        /// Default variation
         time_t mDefaultTime;             /// Set default time
-        time_t mLastActivityTime;        /// Time of the last request
+        std::atomic<time_t> mLastActivityTime;  /// Time of the last request (written by many threads)
         bool mIsAutoReconnect;           /// Try to auto-reconnect if possible
-        bool mIsCacheEnabled;            /// If true the data is cached
-
-        std::mutex mReadMutex;
+        std::atomic<bool> mIsCacheEnabled;  /// If true the data is cached
+        AssignmentCache mCache;          /// Cache of assignments by request
+
+        ReadMostlyMutex mReadMutex;      /// Guards mProvider, readers lock it by LockProviderForRead. Cache hits don't lock it
+        std::thread mPrefetchThread;     /// Background prefetch (@see StartPrefetch)
+        std::mutex mPrefetchThreadMutex; /// Guards mPrefetchThread
+        std::unique_ptr<WorkerPool> mWorkerPool;    /// Runs asynchronous requests. Started by the first one
+        std::mutex mWorkerPoolMutex;     /// Guards mWorkerPool creation
+        std::atomic<size_t> mAsyncThreadsCount;     /// @see SetAsyncThreadsCount
+        std::atomic<bool> mIsAsyncStopped;          /// Set by StopAsyncRequests. Queued requests fail after it
+        std::map<std::pair<std::type_index, int>, std::vector<RowColumnBinding> > mRowBindings;   /// (row type, type table id) => binding. @see GetCalibRows
+        std::mutex mRowBindingsMutex;    /// Guards mRowBindings
     private:
         Calibration(const Calibration& rhs);
         Calibration& operator=(const Calibration& rhs);
         void CheckConnection(); /// Check if is connected and reconnect if needed (and allowed)
+
+        /// Parses namepath and applies defaults
+        AssignmentRequest MakeRequest(const string& namepath) const;
+
+        /// Prefetch body. Returns 0 if there is no connected provider (it doesn't reconnect)
+        size_t PrefetchConnected(const vector<string>& namepaths);
+
+
+        /// Lock of LockProviderForRead. One of the locks is owned
+        struct ProviderReadLock
+        {
+            std::shared_lock<ReadMostlyMutex> SharedLock;       /// The provider supports concurrent reads
+            std::unique_lock<ReadMostlyMutex> ExclusiveLock;    /// Other providers
+        };
+
+        /// Locks mReadMutex, shared if the provider supports concurrent reads (or there is no provider)
+        ProviderReadLock LockProviderForRead();
+
+        /// Gets assignment from the cache or loads it
+        AssignmentCache::ReadPtr AcquireAssignment(const string& namepath, bool loadColumns);
+
+        /// Starts the worker pool if it is not started yet
+        WorkerPool& GetWorkerPool();
+
+        /// Throws std::logic_error if asynchronous requests are stopped (@see StopAsyncRequests)
+        void CheckAsyncNotStopped() const;
+
+        /// Runs the function on the worker pool
+        template<typename R>
+        std::future<R> RunAsync(std::function<R()> func)
+        {
+            auto task = std::make_shared<std::packaged_task<R()> >([this, func]() {
+                CheckAsyncNotStopped();
+                return func();
+            });
+            std::future<R> result = task->get_future();
+            GetWorkerPool().Submit([task]() { (*task)(); });
+            return result;
+        }
+
+        /// Same as AcquireAssignment(namepath) by pre-resolved request
+        AssignmentCache::ReadPtr AcquireAssignment(const RequestHandle& handle);
+
+        /// GetCalib body. T is any container accepted by GetCalib
+        template<typename T>
+        bool GetCalibByNamepath(T &values, const string& namepath, const char* funcName);
+
+        /// GetCalib body for pre-resolved requests
+        template<typename T>
+        bool GetCalibResolved(T &values, const RequestHandle& handle, const char* funcName);
+
+        /// Loads assignment from the provider and adds it to the cache if the cache is enabled.
+        /// If handle is given and is made for the current provider, it is used instead of parsing the namepath
+        std::shared_ptr<Assignment> LoadAndCacheAssignment(uint64_t cacheKey, const string& namepath, bool loadColumns, const RequestHandle* handle = nullptr);
+
+        /// Queries the provider by handle if it is resolved for the current provider, by namepath otherwise.
+        /// The provider must be locked (@see LockProviderForRead)
+        Assignment* LoadAssignment(const string& namepath, bool loadColumns, const RequestHandle* handle);
+
+        /// Binding of the row type schema to the table columns. Made by BindRowColumns once per row type and table
+        const std::vector<RowColumnBinding>& GetRowBinding(std::type_index rowType, const ConstantsTypeTable& table, const RowColumnSpec* columns, size_t columnsCount);
     };
 }
 
@@ -4,6 +4,8 @@
 #include "CCDB/CalibrationGenerator.h"
 #include "CCDB/SQLiteCalibration.h"
 #include "CCDB/Providers/SQLiteDataProvider.h"
+#include "CCDB/Providers/SnapshotDataProvider.h"
+#include "CCDB/Providers/MappedSnapshotDataProvider.h"
 #include "CCDB/Helpers/TimeProvider.h"
 #ifdef CCDB_MYSQL
 #include "CCDB/MySQLCalibration.h"
@@ -40,10 +42,11 @@ namespace ccdb
         else
         {
             //It should be sqlite, but lets check then...
-            if(connectionString.find("sqlite://")!=0)
+            if(connectionString.find("sqlite://")!=0 && !SnapshotDataProvider::IsSnapshotConnectionString(connectionString) &&
+               !MappedSnapshotDataProvider::IsMappedSnapshotConnectionString(connectionString))
             {
                 //something wrong here!!!
-                throw std::logic_error("Unknown connection string type. mysql:// and sqlite:// are only known types now. The connection string: " + connectionString);
+                throw std::logic_error("Unknown connection string type. mysql://, sqlite://, sqlite+snapshot:// and ccdbsnap:// are only known types now. The connection string: " + connectionString);
             }
         }
 
@@ -69,6 +72,8 @@ namespace ccdb
         #endif
 
         if(str.find("sqlite://")== 0) return true;
+        if(SnapshotDataProvider::IsSnapshotConnectionString(str)) return true;
+        if(MappedSnapshotDataProvider::IsMappedSnapshotConnectionString(str)) return true;
         return false;
     }
 
@@ -80,6 +85,9 @@ namespace ccdb
         mInactivityCheckInterval = 100;
         time_t now = ccdb::TimeProvider::GetUnixTimeStamp(ccdb::ClockSources::Monotonic);
         mLastInactivityCheckTime = now;
+        mIsRunPrefetchEnabled = true;
+        mRunPrefetchesCount = 0;
+        mIsCatalogEnabled = false;
     }
 
 
@@ -123,10 +131,11 @@ namespace ccdb
         else
         {
             //It should be sqlite, but lets check then...
-            if(connectionString.find("sqlite://")!=0)
+            if(connectionString.find("sqlite://")!=0 && !SnapshotDataProvider::IsSnapshotConnectionString(connectionString) &&
+               !MappedSnapshotDataProvider::IsMappedSnapshotConnectionString(connectionString))
             {
                 //something wrong here!!!
-                throw std::logic_error("Unknown connection string type. mysql:// and sqlite:// are only known types now. The connection string: " + connectionString);
+                throw std::logic_error("Unknown connection string type. mysql://, sqlite://, sqlite+snapshot:// and ccdbsnap:// are only known types now. The connection string: " + connectionString);
             }
         }
 
@@ -140,10 +149,41 @@ namespace ccdb
             throw std::logic_error(message);
         }
 
+        //the metadata of the same database is loaded once and shared
+        if(mIsCatalogEnabled)
+        {
+            calib->GetProvider()->SetCatalogEnabled(true);
+            for(Calibration* otherCalib: mCalibrations)
+            {
+                if(otherCalib->GetConnectionString() != calib->GetConnectionString()) continue;
+                std::shared_ptr<const Catalog> catalog = otherCalib->GetProvider()->GetLoadedCatalog();
+                if(!catalog) continue;
+                calib->GetProvider()->SetCatalog(catalog);
+                break;
+            }
+        }
+
         //add it to arrays
         mCalibrationsByHash[calibHash] = calib;
         mCalibrations.push_back(calib);
 
+        //a new run of the same context is likely to need what the previous run requested
+        string contextHash = connectionString + "\n" + variation + "\n" + std::to_string(time);
+        Calibration* previousCalib = mLastCalibrationByContext[contextHash];
+        mLastCalibrationByContext[contextHash] = calib;
+        if(mIsRunPrefetchEnabled && previousCalib && previousCalib->IsCacheEnabled())
+        {
+            vector<string> namepaths = previousCalib->GetRequestedNamepaths();
+            if(!namepaths.empty())
+            {
+                //the cache is set up as the user did it for the previous run
+                calib->EnableCache(true);
+                calib->SetCacheMaxBytes(previousCalib->GetCacheMaxBytes());
+                calib->StartPrefetch(namepaths);
+                mRunPrefetchesCount++;
+            }
+        }
+
         return calib;
     }
 
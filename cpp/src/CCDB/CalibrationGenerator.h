@@ -97,6 +97,35 @@ public:
      */
     void SetInactivityCheckInterval(time_t val) { mInactivityCheckInterval = val; }
 
+
+    /** @brief Enables prefetch of the previous run working set when a Calibration for a new run is made
+     *
+     *  A job usually requests the same namepaths for every run. When MakeCalibration makes a Calibration
+     *  for a new run, the namepaths requested from the previous Calibration with the same connection string,
+     *  variation and time are prefetched on a background thread (@see Calibration::StartPrefetch).
+     *  The first events of the run then don't wait for hundreds of requests one by one.
+     *  How many prefetched entries were requested is counted in Calibration::GetCacheStats.
+     *  Works if the cache of the previous Calibration is enabled, the new one gets the same cache settings.
+     *  Enabled by default
+     */
+    void SetRunPrefetchEnabled(bool val) { mIsRunPrefetchEnabled = val; }
+
+    /** @brief @see SetRunPrefetchEnabled */
+    bool IsRunPrefetchEnabled() const { return mIsRunPrefetchEnabled; }
+
+    /** @brief Number of run-transition prefetches started. @see SetRunPrefetchEnabled */
+    uint64_t GetRunPrefetchesCount() const { return mRunPrefetchesCount; }
+
+    /** @brief Enables the metadata catalog for providers of new Calibrations (@see DataProvider::SetCatalogEnabled)
+     *
+     *  Calibrations made with the same connection string share one catalog: the catalog loaded
+     *  by one provider is given to the providers of next Calibrations. Disabled by default
+     */
+    void SetCatalogEnabled(bool val) { mIsCatalogEnabled = val; }
+
+    /** @brief @see SetCatalogEnabled */
+    bool IsCatalogEnabled() const { return mIsCatalogEnabled; }
+
 private:	
 
     //@parameter [in] connectionString - Connection string to the data source
@@ -111,6 +140,11 @@ private:
 	time_t mMaxInactiveTime;                                    ///Max inactive time for calibration secs
     time_t mLastInactivityCheckTime;                            ///Last time of inactivity check from Unix epoch
     time_t mInactivityCheckInterval;                            ///Interval to check inactivity secs
+
+    bool mIsRunPrefetchEnabled;                                 ///Prefetch previous run working set. @see SetRunPrefetchEnabled
+    uint64_t mRunPrefetchesCount;                               ///Number of started run-transition prefetches
+    bool mIsCatalogEnabled;                                     ///Providers use shared catalog. @see SetCatalogEnabled
+    std::map<std::string, Calibration*> mLastCalibrationByContext;  ///connection string, variation and time => the last made Calibration
 };
 }
 
@@ -2,6 +2,7 @@
 #define __CCDB_CONSTANTS_TABLE_H__
 
 #include <algorithm>
+#include <memory>
 #include <string>
 #include <sstream>
 #include <stdexcept>
@@ -122,8 +123,9 @@ class ConstantsTable
         calib.Connect(conn);
 
         calib.GetCalib(values, constsetid_str);
-        columns = calib.GetAssignment(constsetid_str)->GetTypeTable()->GetColumnNames();
-        column_types = calib.GetAssignment(constsetid_str)->GetTypeTable()->GetColumnTypeStrings();
+        std::shared_ptr<Assignment> assignment = calib.GetAssignmentShared(constsetid_str);
+        columns = assignment->GetTypeTable()->GetColumnNames();
+        column_types = assignment->GetTypeTable()->GetColumnTypeStrings();
     }
 
     /** \return number of rows in this data set.
@@ -0,0 +1,286 @@
+#include <vector>
+
+#include "CCDB/Helpers/AssignmentCache.h"
+
+using namespace std;
+
+namespace ccdb
+{
+
+//______________________________________________________________________________
+AssignmentCache::AssignmentCache(size_t maxBytes):
+    mClockHand(mClock.end()),
+    mMaxBytes(maxBytes),
+    mUsedBytes(0),
+    mEvictions(0),
+    mPrefetched(0),
+    mPrefetchedUsed(0)
+{
+}
+
+
+//______________________________________________________________________________
+uint64_t AssignmentCache::MakeKey(const std::string& request)
+{
+    // FNV-1a 64 bit
+    uint64_t hash = 14695981039346656037ULL;
+    for(unsigned char c: request) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+
+//______________________________________________________________________________
+std::shared_ptr<Assignment> AssignmentCache::Find(uint64_t key, const std::string& request, bool countStats /*=true*/)
+{
+    std::shared_ptr<Assignment> assignment;
+    bool isOverBudget;
+    {
+        std::shared_lock<ReadMostlyMutex> lock(mMutex);
+        Entry* entry = Touch(key, request, countStats);
+        if(!entry) return assignment;
+
+        assignment = entry->Value;
+        isOverBudget = RefreshBytes(*entry);
+    }
+
+    if(isOverBudget) EvictOverBudget();
+    return assignment;
+}
+
+
+//______________________________________________________________________________
+AssignmentCache::ReadPtr AssignmentCache::Acquire(uint64_t key, const std::string& request)
+{
+    std::shared_ptr<Assignment> assignment;
+    {
+        std::shared_lock<ReadMostlyMutex> lock(mMutex);
+        Entry* entry = Touch(key, request, true);
+        if(!entry) return ReadPtr();
+        assignment = entry->Value;
+    }
+    return ReadPtr(this, key, std::move(assignment));
+}
+
+
+//______________________________________________________________________________
+void AssignmentCache::ReadPtr::Release()
+{
+    //typed data may be decoded while the assignment was held
+    if(mCache && mHeld->GetMemoryUsage() != mMemoryUsage) mCache->RefreshBytes(mKey, *mHeld);
+    mCache = nullptr;
+    mHeld.reset();
+}
+
+
+//______________________________________________________________________________
+AssignmentCache::Entry* AssignmentCache::Touch(uint64_t key, const std::string& request, bool countStats)
+{
+    auto entryIter = mEntries.find(key);
+    if(entryIter == mEntries.end() || entryIter->second.Request != request) {
+        if(countStats) mMisses.Increment();
+        return nullptr;
+    }
+
+    // Mark the entry as used for the clock hand.
+    // A hot entry is written once per pass of the hand, not once per hit
+    Entry& entry = entryIter->second;
+    if(!entry.IsReferenced.load(std::memory_order_relaxed)) {
+        entry.IsReferenced.store(true, std::memory_order_relaxed);
+    }
+
+    if(countStats) {
+        mHits.Increment();
+
+        //the flag is written once, on the first request of a prefetched entry
+        if(entry.IsPrefetched.load(std::memory_order_relaxed) && entry.IsPrefetched.exchange(false)) mPrefetchedUsed++;
+    }
+    return &entry;
+}
+
+
+//______________________________________________________________________________
+bool AssignmentCache::RefreshBytes(Entry& entry)
+{
+    //typed data may be decoded after the assignment was cached, so the size is refreshed
+    size_t bytes = GetEntryBytes(entry.Request, *entry.Value);
+    if(bytes == entry.Bytes.load(std::memory_order_relaxed)) return false;
+
+    size_t oldBytes = entry.Bytes.exchange(bytes);
+    size_t usedBytes = (mUsedBytes += bytes - oldBytes);
+    return usedBytes > mMaxBytes;
+}
+
+
+//______________________________________________________________________________
+void AssignmentCache::RefreshBytes(uint64_t key, const Assignment& assignment)
+{
+    bool isOverBudget = false;
+    {
+        std::shared_lock<ReadMostlyMutex> lock(mMutex);
+        auto entryIter = mEntries.find(key);
+        if(entryIter != mEntries.end() && entryIter->second.Value.get() == &assignment) {
+            isOverBudget = RefreshBytes(entryIter->second);
+        }
+    }
+
+    if(isOverBudget) EvictOverBudget();
+}
+
+
+//______________________________________________________________________________
+void AssignmentCache::Insert(uint64_t key, const std::string& request, const std::shared_ptr<Assignment>& assignment, bool isPrefetched /*=false*/)
+{
+    if(!assignment) return;
+
+    size_t bytes = GetEntryBytes(request, *assignment);
+
+    std::lock_guard<ReadMostlyMutex> lock(mMutex);
+
+    //replace the old value if any
+    auto entryIter = mEntries.find(key);
+    if(entryIter != mEntries.end()) EraseEntry(entryIter);
+
+    if(bytes > mMaxBytes) return;     // it will never fit
+
+    EvictToFit(mMaxBytes - bytes);
+
+    // The new entry is put just behind the hand, so the hand comes to it last
+    auto clockPosition = mClock.insert(mClockHand, key);
+    mEntries.emplace(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(request, assignment, bytes, clockPosition, isPrefetched));
+    mUsedBytes += bytes;
+    if(isPrefetched) mPrefetched++;
+}
+
+
+//______________________________________________________________________________
+std::vector<std::string> AssignmentCache::GetUsedRequests() const
+{
+    std::shared_lock<ReadMostlyMutex> lock(mMutex);
+    vector<string> requests;
+    requests.reserve(mEntries.size());
+    for(auto& keyEntry: mEntries) {
+        if(!keyEntry.second.IsPrefetched) requests.push_back(keyEntry.second.Request);
+    }
+    return requests;
+}
+
+
+//______________________________________________________________________________
+void AssignmentCache::Clear()
+{
+    std::lock_guard<ReadMostlyMutex> lock(mMutex);
+    mEntries.clear();
+    mClock.clear();
+    mClockHand = mClock.end();
+    mUsedBytes = 0;
+}
+
+
+//______________________________________________________________________________
+void AssignmentCache::SetMaxBytes(size_t maxBytes)
+{
+    std::lock_guard<ReadMostlyMutex> lock(mMutex);
+    mMaxBytes = maxBytes;
+    EvictToFit(mMaxBytes);
+}
+
+
+//______________________________________________________________________________
+void AssignmentCache::EvictOverBudget()
+{
+    std::lock_guard<ReadMostlyMutex> lock(mMutex);
+    EvictToFit(mMaxBytes);
+}
+
+
+//______________________________________________________________________________
+size_t AssignmentCache::GetEntriesCount() const
+{
+    std::shared_lock<ReadMostlyMutex> lock(mMutex);
+    return mEntries.size();
+}
+
+
+//______________________________________________________________________________
+AssignmentCacheStats AssignmentCache::GetStats() const
+{
+    AssignmentCacheStats stats;
+    stats.Hits = mHits.Get();
+    stats.Misses = mMisses.Get();
+    stats.Evictions = mEvictions;
+    stats.Entries = GetEntriesCount();
+    stats.UsedBytes = mUsedBytes;
+    stats.MaxBytes = mMaxBytes;
+    stats.Prefetched = mPrefetched;
+    stats.PrefetchedUsed = mPrefetchedUsed;
+    return stats;
+}
+
+
+//______________________________________________________________________________
+void AssignmentCache::ResetStats()
+{
+    mHits.Reset();
+    mMisses.Reset();
+    mEvictions = 0;
+    mPrefetched = 0;
+    mPrefetchedUsed = 0;
+}
+
+
+//______________________________________________________________________________
+size_t AssignmentCache::GetEntryBytes(const std::string& request, const Assignment& assignment)
+{
+    return assignment.GetMemoryUsage() + request.capacity() + sizeof(Entry);
+}
+
+
+//______________________________________________________________________________
+void AssignmentCache::EvictToFit(size_t maxBytes)
+{
+    //the hand gives referenced entries one more round and evicts the first one that is not referenced
+    while(mUsedBytes > maxBytes && !mEntries.empty()) {
+        if(mClockHand == mClock.end()) mClockHand = mClock.begin();
+
+        auto entryIter = mEntries.find(*mClockHand);
+        if(entryIter->second.IsReferenced.exchange(false)) {
+            ++mClockHand;
+            continue;
+        }
+
+        EraseEntry(entryIter);
+        mEvictions++;
+    }
+}
+
+
+//______________________________________________________________________________
+void AssignmentCache::EraseEntry(std::unordered_map<uint64_t, Entry>::iterator entryIter)
+{
+    Entry& entry = entryIter->second;
+    if(mClockHand == entry.ClockPosition) ++mClockHand;
+    mClock.erase(entry.ClockPosition);
+    mUsedBytes -= entry.Bytes;
+    mEntries.erase(entryIter);
+}
+
+
+//______________________________________________________________________________
+uint64_t AssignmentCache::StripedCounter::Get() const
+{
+    uint64_t sum = 0;
+    for(size_t i = 0; i < StripesCount; i++) sum += mStripes[i].Value.load(std::memory_order_relaxed);
+    return sum;
+}
+
+
+//______________________________________________________________________________
+void AssignmentCache::StripedCounter::Reset()
+{
+    for(size_t i = 0; i < StripesCount; i++) mStripes[i].Value.store(0, std::memory_order_relaxed);
+}
+
+}
@@ -0,0 +1,208 @@
+#ifndef _AssignmentCache_
+#define _AssignmentCache_
+
+#include <stdint.h>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+
+#include "CCDB/Model/Assignment.h"
+#include "CCDB/Helpers/ReadMostlyMutex.h"
+
+namespace ccdb
+{
+    /** @brief Snapshot of AssignmentCache counters. @see AssignmentCache::GetStats */
+    struct AssignmentCacheStats
+    {
+        uint64_t Hits;          /// Number of requests served from the cache
+        uint64_t Misses;        /// Number of requests that had to go to the provider
+        uint64_t Evictions;     /// Number of entries removed to fit the byte budget
+        size_t   Entries;       /// Number of entries currently in the cache
+        size_t   UsedBytes;     /// Estimated memory used by cached assignments
+        size_t   MaxBytes;      /// Byte budget of the cache
+        uint64_t Prefetched;    /// Number of entries inserted by prefetch (@see Insert)
+        uint64_t PrefetchedUsed;    /// Number of prefetched entries that were requested afterwards
+    };
+
+
+    /** @brief Size aware LRU cache of assignments
+     *
+     * The cache is owned by a Calibration object. The key is a 64 bit hash of the user request
+     * (namepath as it is given to GetCalib), computed once per request. Since run, variation and time
+     * defaults of a Calibration never change, the request string alone identifies the assignment.
+     * The request string is stored alongside so a hash collision can never return wrong data.
+     *
+     * When estimated memory of cached assignments exceeds MaxBytes, the least recently used entries are
+     * evicted. Assignments are held by shared_ptr, so an evicted assignment lives until the last user releases it.
+     *
+     * The class is thread safe and is made for many concurrent Find calls: Find takes a ReadMostlyMutex
+     * for reading only for the lookup. Recency is tracked by CLOCK, an approximation of LRU: a hit sets
+     * the referenced flag of the entry (it is written once, not on each hit of a hot entry). The eviction
+     * moves the clock hand over the entries in insertion order, clears the flags that are set and evicts
+     * the first entry without the flag. So an entry found since the hand passed it survives one more round,
+     * and evicting an entry is amortized O(1).
+     */
+    class AssignmentCache
+    {
+    public:
+        static const size_t DefaultMaxBytes = 256*1024*1024;   /// Default byte budget 256 MB
+
+        explicit AssignmentCache(size_t maxBytes = DefaultMaxBytes);
+
+        /** @brief Makes 64 bit key (FNV-1a hash) of the request string */
+        static uint64_t MakeKey(const std::string& request);
+
+        /** @brief Finds assignment by key and request. Counts hit or miss
+         *
+         * @param [in] key        - key made by MakeKey(request)
+         * @param [in] request    - the request string (used to validate the key)
+         * @param [in] countStats - if false, hits and misses counters are not changed
+         * @return assignment or empty pointer if not found
+         */
+        std::shared_ptr<Assignment> Find(uint64_t key, const std::string& request, bool countStats = true);
+
+        class ReadPtr;
+
+        /** @brief Finds assignment and returns pointer that holds it while alive
+         *
+         * The cache is locked only for the lookup, the assignment is held by its shared_ptr.
+         * If the assignment grows while it is held (typed data is decoded on the first use),
+         * its size in the cache is refreshed when the pointer is released.
+         *
+         * @return empty ReadPtr if the assignment is not found. Counts hit or miss
+         */
+        ReadPtr Acquire(uint64_t key, const std::string& request);
+
+        /** @brief Adds assignment to the cache (replaces existing one with the same key)
+         *
+         * Evicts least recently used entries if the budget is exceeded.
+         * Assignments bigger than the whole budget are not cached
+         *
+         * @param [in] isPrefetched - the assignment is loaded before it is requested.
+         *                            The first Find or Acquire of it is counted as PrefetchedUsed
+         */
+        void Insert(uint64_t key, const std::string& request, const std::shared_ptr<Assignment>& assignment, bool isPrefetched = false);
+
+        /** @brief Requests of the cached entries, except prefetched ones that were never requested
+         *
+         * It is the working set of the cache owner: what was actually requested and is still cached
+         */
+        std::vector<std::string> GetUsedRequests() const;
+
+        /** @brief Removes all entries. Counters are not reset */
+        void Clear();
+
+        /** @brief Sets byte budget. Evicts entries immediately if they don't fit in the new budget */
+        void SetMaxBytes(size_t maxBytes);
+        size_t GetMaxBytes() const { return mMaxBytes; }
+
+        size_t GetUsedBytes() const { return mUsedBytes; }     /// Estimated memory used by cached assignments
+        size_t GetEntriesCount() const;                         /// Number of cached assignments
+
+        /** @brief Gets hits, misses, evictions and size counters */
+        AssignmentCacheStats GetStats() const;
+
+        /** @brief Sets hits, misses and evictions counters to 0 */
+        void ResetStats();
+
+    private:
+
+        struct Entry
+        {
+            Entry(const std::string& request, const std::shared_ptr<Assignment>& value, size_t bytes, std::list<uint64_t>::iterator clockPosition, bool isPrefetched):
+                Request(request), Value(value), Bytes(bytes), IsReferenced(false), ClockPosition(clockPosition), IsPrefetched(isPrefetched) {}
+
+            std::string Request;
+            std::shared_ptr<Assignment> Value;
+            std::atomic<size_t> Bytes;
+            std::atomic<bool> IsReferenced;     /// Found since the clock hand passed the entry
+            std::list<uint64_t>::iterator ClockPosition;    /// The key in mClock
+            std::atomic<bool> IsPrefetched;     /// Prefetched and not requested yet
+        };
+
+        /** Counter split to cache line aligned stripes, so threads don't write the same memory */
+        class StripedCounter
+        {
+        public:
+            void Increment() { mStripes[ReadMostlyMutex::GetThreadIndex() % StripesCount].Value.fetch_add(1, std::memory_order_relaxed); }
+            uint64_t Get() const;
+            void Reset();
+        private:
+            static const size_t StripesCount = 16;
+            struct alignas(64) Stripe
+            {
+                Stripe(): Value(0) {}
+                std::atomic<uint64_t> Value;
+            };
+            Stripe mStripes[StripesCount];
+        };
+
+        friend class ReadPtr;
+
+        static size_t GetEntryBytes(const std::string& request, const Assignment& assignment);
+        Entry* Touch(uint64_t key, const std::string& request, bool countStats);   /// Finds entry and marks it used. mMutex must be locked
+        bool RefreshBytes(Entry& entry);    /// Updates entry size. Returns true if the budget is exceeded. mMutex must be locked
+        void RefreshBytes(uint64_t key, const Assignment& assignment);     /// Updates size of the entry if it still holds the assignment
+        void EvictOverBudget();             /// Locks mMutex and evicts entries to fit mMaxBytes
+        void EvictToFit(size_t maxBytes);   /// mMutex must be locked for writing
+        void EraseEntry(std::unordered_map<uint64_t, Entry>::iterator entryIter);  /// mMutex must be locked for writing
+
+        std::unordered_map<uint64_t, Entry> mEntries;   /// key => entry
+        std::list<uint64_t> mClock;                     /// Keys of entries in insertion order, a ring for the clock hand
+        std::list<uint64_t>::iterator mClockHand;       /// The next entry to check for eviction (end() is the ring start)
+        mutable ReadMostlyMutex mMutex;
+        std::atomic<size_t> mMaxBytes;
+        std::atomic<size_t> mUsedBytes;
+        StripedCounter mHits;
+        StripedCounter mMisses;
+        std::atomic<uint64_t> mEvictions;
+        std::atomic<uint64_t> mPrefetched;
+        std::atomic<uint64_t> mPrefetchedUsed;
+
+        AssignmentCache(const AssignmentCache& rhs);
+        AssignmentCache& operator=(const AssignmentCache& rhs);
+    };
+
+
+    /** @brief Assignment pointer returned by AssignmentCache::Acquire
+     *
+     * Holds the assignment by shared_ptr. For a cached assignment it also keeps the key
+     * to refresh the entry size on release (@see AssignmentCache::Acquire)
+     */
+    class AssignmentCache::ReadPtr
+    {
+    public:
+        ReadPtr(): mCache(nullptr), mKey(0), mMemoryUsage(0) {}
+        explicit ReadPtr(std::shared_ptr<Assignment> assignment): mCache(nullptr), mKey(0), mMemoryUsage(0), mHeld(std::move(assignment)) {}
+        ReadPtr(ReadPtr&& rhs) noexcept: mCache(rhs.mCache), mKey(rhs.mKey), mMemoryUsage(rhs.mMemoryUsage), mHeld(std::move(rhs.mHeld)) { rhs.mCache = nullptr; }
+        ~ReadPtr() { Release(); }
+
+        Assignment* get() const { return mHeld.get(); }
+        Assignment* operator->() const { return get(); }
+        Assignment& operator*() const { return *get(); }
+        explicit operator bool() const { return get() != nullptr; }
+
+        /** @brief Refreshes the entry size if the assignment has grown and clears the pointer */
+        void Release();
+
+    private:
+        friend class AssignmentCache;
+        ReadPtr(AssignmentCache* cache, uint64_t key, std::shared_ptr<Assignment> assignment):
+            mCache(cache), mKey(key), mMemoryUsage(assignment->GetMemoryUsage()), mHeld(std::move(assignment)) {}
+
+        AssignmentCache* mCache;                /// Not null if the assignment is cached
+        uint64_t mKey;
+        size_t mMemoryUsage;                    /// Assignment::GetMemoryUsage when it was acquired
+        std::shared_ptr<Assignment> mHeld;
+
+        ReadPtr(const ReadPtr& rhs);
+        ReadPtr& operator=(const ReadPtr& rhs);
+    };
+}
+
+#endif // _AssignmentCache_
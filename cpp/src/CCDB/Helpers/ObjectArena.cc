@@ -0,0 +1,69 @@
+#include <stdint.h>
+#include <stdexcept>
+
+#include "CCDB/Helpers/ObjectArena.h"
+
+using namespace std;
+
+namespace ccdb
+{
+
+//______________________________________________________________________________
+ObjectArena::ObjectArena(size_t chunkBytes):
+    mChunkBytes(chunkBytes),
+    mPosition(nullptr),
+    mEnd(nullptr),
+    mObjectsCount(0),
+    mUsedBytes(0)
+{
+    if(chunkBytes == 0) throw std::logic_error("ObjectArena::ObjectArena. Chunk size must be greater than 0");
+}
+
+
+//______________________________________________________________________________
+ObjectArena::~ObjectArena()
+{
+    Clear();
+}
+
+
+//______________________________________________________________________________
+void ObjectArena::Clear()
+{
+    // Objects may point to each other, so they are destroyed in the reverse order of creation
+
+    for(auto destructorIter = mDestructors.rbegin(); destructorIter != mDestructors.rend(); ++destructorIter)
+    {
+        destructorIter->Destroy(destructorIter->Object);
+    }
+
+    mDestructors.clear();
+    mChunks.clear();
+    mPosition = nullptr;
+    mEnd = nullptr;
+    mObjectsCount = 0;
+    mUsedBytes = 0;
+}
+
+
+//______________________________________________________________________________
+void* ObjectArena::Allocate(size_t size, size_t alignment)
+{
+    uintptr_t mask = ~static_cast<uintptr_t>(alignment - 1);
+    uintptr_t position = (reinterpret_cast<uintptr_t>(mPosition) + alignment - 1) & mask;
+    if(!mPosition || position + size > reinterpret_cast<uintptr_t>(mEnd))
+    {
+        // new[] aligns chunks for fundamental types only, so there is room to align over-aligned objects
+        size_t chunkBytes = size + alignment > mChunkBytes ? size + alignment : mChunkBytes;
+        mChunks.emplace_back(new char[chunkBytes]);
+        mPosition = mChunks.back().get();
+        mEnd = mPosition + chunkBytes;
+        position = (reinterpret_cast<uintptr_t>(mPosition) + alignment - 1) & mask;
+    }
+
+    mPosition = reinterpret_cast<char*>(position + size);
+    mUsedBytes += size;
+    return reinterpret_cast<void*>(position);
+}
+
+}
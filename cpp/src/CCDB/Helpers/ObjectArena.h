@@ -0,0 +1,75 @@
+#ifndef _ObjectArena_
+#define _ObjectArena_
+
+#include <stddef.h>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ccdb
+{
+    /** @brief Arena of objects that are released all at once
+     *
+     * Providers create model objects (directories, variations, type tables and columns of a catalog)
+     * in arenas instead of allocating them one by one. Objects are placed one after another in big chunks,
+     * so loading thousands of them takes a few allocations and walking them touches adjacent memory.
+     * Objects are destroyed (in the reverse order) by Clear or by the arena destructor.
+     *
+     * @warning objects made by the arena must not be deleted.
+     * @remark the arena is not thread safe, it is used under the lock that guards the objects it holds
+     */
+    class ObjectArena
+    {
+    public:
+        /** @brief The arena allocates memory by chunks of chunkBytes (bigger objects get a chunk of their own) */
+        explicit ObjectArena(size_t chunkBytes = 64 * 1024);
+        ~ObjectArena();
+
+        /** @brief Creates object of type T in the arena */
+        template<typename T, typename... Args>
+        T* Create(Args&&... args)
+        {
+            void* memory = Allocate(sizeof(T), alignof(T));
+            T* object = new(memory) T(std::forward<Args>(args)...);
+            if(!std::is_trivially_destructible<T>::value) mDestructors.push_back(Destructor{&DestroyObject<T>, object});
+            mObjectsCount++;
+            return object;
+        }
+
+        /** @brief Destroys all objects and releases the memory */
+        void Clear();
+
+        size_t GetObjectsCount() const { return mObjectsCount; }    /// Number of objects in the arena
+        size_t GetChunksCount() const { return mChunks.size(); }    /// Number of memory chunks (allocations)
+        size_t GetUsedBytes() const { return mUsedBytes; }          /// Memory taken by objects
+
+    private:
+        ObjectArena(const ObjectArena& rhs);
+        ObjectArena& operator=(const ObjectArena& rhs);
+
+        /// Destroy function of an object of not trivially destructible type
+        struct Destructor
+        {
+            void (*Destroy)(void*);
+            void* Object;
+        };
+
+        template<typename T>
+        static void DestroyObject(void* object) { static_cast<T*>(object)->~T(); }
+
+        /// Memory for the next object. Starts a new chunk if the current one has no room
+        void* Allocate(size_t size, size_t alignment);
+
+        size_t mChunkBytes;
+        std::vector<std::unique_ptr<char[]> > mChunks;
+        char* mPosition;            /// Free memory of the current chunk
+        char* mEnd;                 /// End of the current chunk
+        std::vector<Destructor> mDestructors;
+        size_t mObjectsCount;
+        size_t mUsedBytes;
+    };
+}
+
+#endif // _ObjectArena_
@@ -0,0 +1,88 @@
+#ifndef _ReadMostlyMutex_
+#define _ReadMostlyMutex_
+
+#include <stddef.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+namespace ccdb
+{
+    /** @brief Reader-writer mutex that is cheap to lock for reading from many threads
+     *
+     * std::shared_mutex keeps all readers in one counter, so each lock_shared is a write to
+     * the same cache line, and readers on many cores slow each other down.
+     * Here each thread has its own (cache line aligned) readers counter slot, so readers do not share
+     * written memory at all. The cost is moved to writers: lock() waits for all slots to become zero.
+     * Use it for read mostly data, like caches where writes happen only on misses.
+     *
+     * The class satisfies SharedMutex requirements (works with std::shared_lock and std::lock_guard)
+     * @remark the mutex is not recursive. Writers don't starve: new readers wait while a writer is pending
+     */
+    class ReadMostlyMutex
+    {
+    public:
+        static const size_t SlotsCount = 64;     /// Threads are spread over slots (more threads share slots)
+
+        ReadMostlyMutex(): mIsWriterPending(false) {}
+
+        void lock_shared()
+        {
+            Slot& slot = mSlots[GetThreadIndex() % SlotsCount];
+            for(;;)
+            {
+                slot.Readers.fetch_add(1);
+                if(!mIsWriterPending.load()) return;
+
+                //a writer is pending. Step back and let it go first
+                slot.Readers.fetch_sub(1);
+                while(mIsWriterPending.load(std::memory_order_relaxed)) std::this_thread::yield();
+            }
+        }
+
+        void unlock_shared()
+        {
+            mSlots[GetThreadIndex() % SlotsCount].Readers.fetch_sub(1, std::memory_order_release);
+        }
+
+        void lock()
+        {
+            mWriterMutex.lock();
+            mIsWriterPending.store(true);
+            for(size_t i = 0; i < SlotsCount; i++)
+            {
+                while(mSlots[i].Readers.load() != 0) std::this_thread::yield();
+            }
+        }
+
+        void unlock()
+        {
+            mIsWriterPending.store(false, std::memory_order_release);
+            mWriterMutex.unlock();
+        }
+
+        /** @brief Small sequential index of the calling thread. Handy to spread per thread data over stripes */
+        static size_t GetThreadIndex()
+        {
+            static std::atomic<size_t> threadsCount(0);
+            thread_local size_t index = threadsCount.fetch_add(1, std::memory_order_relaxed);
+            return index;
+        }
+
+    private:
+        struct alignas(64) Slot
+        {
+            Slot(): Readers(0) {}
+            std::atomic<long> Readers;
+        };
+
+        Slot mSlots[SlotsCount];
+        alignas(64) std::atomic<bool> mIsWriterPending;
+        std::mutex mWriterMutex;
+
+        ReadMostlyMutex(const ReadMostlyMutex& rhs);
+        ReadMostlyMutex& operator=(const ReadMostlyMutex& rhs);
+    };
+}
+
+#endif // _ReadMostlyMutex_
@@ -0,0 +1,35 @@
+#include "CCDB/Helpers/RowSchema.h"
+
+using namespace std;
+
+namespace ccdb
+{
+
+//______________________________________________________________________________
+std::vector<RowColumnBinding> BindRowColumns(const ConstantsTypeTable& table, const RowColumnSpec* columns, size_t columnsCount)
+{
+    const vector<ConstantsTypeColumn*>& tableColumns = table.GetColumns();
+
+    vector<RowColumnBinding> binding;
+    binding.reserve(columnsCount);
+    for(size_t i = 0; i < columnsCount; i++)
+    {
+        size_t index = 0;
+        while(index < tableColumns.size() && tableColumns[index]->GetName() != columns[i].Name) index++;
+
+        if(index == tableColumns.size()) {
+            throw std::logic_error(string("ccdb::BindRowColumns. Table '") + table.GetFullPath() + "' has no column '" + columns[i].Name + "'");
+        }
+
+        ConstantsTypeColumn::ColumnTypes type = tableColumns[index]->GetType();
+        if(!columns[i].IsString && type == ConstantsTypeColumn::cStringColumn) {
+            throw std::logic_error(string("ccdb::BindRowColumns. Column '") + columns[i].Name + "' of table '" + table.GetFullPath() +
+                                   "' is a string column and can't be read to a numeric member");
+        }
+
+        binding.push_back(RowColumnBinding{index, type});
+    }
+    return binding;
+}
+
+}
@@ -0,0 +1,193 @@
+#ifndef _RowSchema_
+#define _RowSchema_
+
+#include <stddef.h>
+#include <array>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "CCDB/Model/Assignment.h"
+#include "CCDB/Model/ConstantsTypeTable.h"
+#include "CCDB/Helpers/StringUtils.h"
+
+namespace ccdb
+{
+    /** @brief Binds a column of a type table to a member of a user row struct. @see RowSchema */
+    template<typename Row, typename T>
+    struct RowField
+    {
+        const char* Column;     /// Column name in the type table
+        T Row::* Member;        /// Member of the row struct
+    };
+
+
+    /** @brief Makes RowField, like Field("gain", &MyRow::gain). Used in RowSchema descriptors */
+    template<typename Row, typename T>
+    constexpr RowField<Row, T> Field(const char* column, T Row::* member)
+    {
+        return RowField<Row, T>{column, member};
+    }
+
+
+    /** @brief Compile time descriptor of a user row struct for Calibration::GetCalibRows
+     *
+     * A descriptor is a specialization with a constexpr tuple of fields:
+     * @code
+     *     struct TofGain { double gain; double offset; int status; };
+     *
+     *     namespace ccdb {
+     *         template<> struct RowSchema<TofGain> {
+     *             static constexpr auto Fields = std::make_tuple(
+     *                 Field("gain", &TofGain::gain),
+     *                 Field("offset", &TofGain::offset),
+     *                 Field("status", &TofGain::status));
+     *         };
+     *     }
+     * @endcode
+     *
+     * Not every column has to be mapped, the order of fields doesn't matter. Members may be floating point,
+     * integer, bool or std::string. The ccdb_rowschema tool writes descriptors of existing tables.
+     */
+    template<typename Row>
+    struct RowSchema;
+
+
+    /** @brief Schema field as it is checked against a type table. @see BindRowColumns */
+    struct RowColumnSpec
+    {
+        const char* Name;       /// Column name
+        bool IsString;          /// The member is std::string and takes any column. Numeric members need numeric columns
+    };
+
+
+    /** @brief Schema field bound to a column of a type table */
+    struct RowColumnBinding
+    {
+        size_t Index;                               /// Index of the column in the table
+        ConstantsTypeColumn::ColumnTypes Type;      /// Type of the column
+    };
+
+
+    /** @brief Finds table columns of schema fields
+     *
+     * @throw std::logic_error if the table has no such column or a numeric member is mapped to a string column
+     * @return bindings in the order of columns
+     */
+    std::vector<RowColumnBinding> BindRowColumns(const ConstantsTypeTable& table, const RowColumnSpec* columns, size_t columnsCount);
+
+
+    namespace RowSchemaDetail
+    {
+        template<typename Row, typename... T, size_t... I>
+        std::array<RowColumnSpec, sizeof...(T)> MakeSpecs(const std::tuple<RowField<Row, T>...>& fields, std::index_sequence<I...>)
+        {
+            return {{ RowColumnSpec{std::get<I>(fields).Column, std::is_same<T, std::string>::value}... }};
+        }
+
+        template<typename Row, typename... T>
+        std::array<RowColumnSpec, sizeof...(T)> MakeSpecs(const std::tuple<RowField<Row, T>...>& fields)
+        {
+            return MakeSpecs(fields, std::index_sequence_for<T...>());
+        }
+
+        /// Fills one member of all rows from the column
+        template<typename Row, typename T>
+        void FillColumn(std::vector<Row>& rows, const Assignment& assignment, const RowField<Row, T>& field,
+                        const RowColumnBinding& column, size_t columnsCount)
+        {
+            // Numbers come from the data decoded once per assignment (and kept in the cache with it)
+
+            size_t cell = column.Index;
+            if constexpr (std::is_same<T, std::string>::value)
+            {
+                for(Row& row: rows) { row.*field.Member = std::string(assignment.GetToken(cell)); cell += columnsCount; }
+            }
+            else if constexpr (std::is_floating_point<T>::value)
+            {
+                const std::vector<double>& data = assignment.GetDoubleData();
+                for(Row& row: rows) { row.*field.Member = static_cast<T>(data[cell]); cell += columnsCount; }
+            }
+            else if constexpr (std::is_same<T, bool>::value)
+            {
+                const std::vector<int>& data = assignment.GetIntData();
+                for(Row& row: rows) { row.*field.Member = data[cell] != 0; cell += columnsCount; }
+            }
+            else if constexpr (std::is_integral<T>::value && std::is_signed<T>::value && sizeof(T) <= sizeof(int))
+            {
+                const std::vector<int>& data = assignment.GetIntData();
+                for(Row& row: rows) { row.*field.Member = static_cast<T>(data[cell]); cell += columnsCount; }
+            }
+            else if constexpr (std::is_integral<T>::value)
+            {
+                // unsigned and 64 bit values don't fit int data, so they are read from the cells
+                if(column.Type == ConstantsTypeColumn::cBoolColumn)
+                {
+                    const std::vector<int>& data = assignment.GetIntData();
+                    for(Row& row: rows) { row.*field.Member = static_cast<T>(data[cell]); cell += columnsCount; }
+                }
+                else
+                {
+                    for(Row& row: rows)
+                    {
+                        if constexpr (std::is_signed<T>::value) row.*field.Member = static_cast<T>(StringUtils::ParseLong(assignment.GetToken(cell)));
+                        else row.*field.Member = static_cast<T>(StringUtils::ParseULong(assignment.GetToken(cell)));
+                        cell += columnsCount;
+                    }
+                }
+            }
+            else
+            {
+                static_assert(std::is_arithmetic<T>::value, "RowSchema members must be arithmetic or std::string");
+            }
+        }
+
+        template<typename Row, typename... T, size_t... I>
+        void FillColumns(std::vector<Row>& rows, const Assignment& assignment, const std::tuple<RowField<Row, T>...>& fields,
+                         const std::vector<RowColumnBinding>& binding, size_t columnsCount, std::index_sequence<I...>)
+        {
+            (FillColumn(rows, assignment, std::get<I>(fields), binding[I], columnsCount), ...);
+        }
+
+        template<typename Row, typename... T>
+        void FillColumns(std::vector<Row>& rows, const Assignment& assignment, const std::tuple<RowField<Row, T>...>& fields,
+                         const std::vector<RowColumnBinding>& binding, size_t columnsCount)
+        {
+            FillColumns(rows, assignment, fields, binding, columnsCount, std::index_sequence_for<T...>());
+        }
+    }
+
+
+    /** @brief Schema fields of the Row as they are given to @see BindRowColumns */
+    template<typename Row>
+    const auto& GetRowColumnSpecs()
+    {
+        static const auto specs = RowSchemaDetail::MakeSpecs(RowSchema<Row>::Fields);
+        return specs;
+    }
+
+
+    /** @brief Decodes all rows of the assignment to the vector of structs
+     *
+     * @param [out] rows - resized to the number of rows of the assignment
+     * @param binding - @see BindRowColumns result for the same Row and the assignment type table
+     * @throw std::logic_error if the assignment has no data
+     */
+    template<typename Row>
+    void FillRows(std::vector<Row>& rows, const Assignment& assignment, const std::vector<RowColumnBinding>& binding)
+    {
+        size_t columnsCount = assignment.GetColumnsCount();
+        if(columnsCount == 0 || assignment.GetTokensCount() == 0) {
+            throw std::logic_error("ccdb::FillRows. Data has no rows. Zero rows are not supposed to be.");
+        }
+
+        rows.clear();
+        rows.resize(assignment.GetTokensCount() / columnsCount);
+        RowSchemaDetail::FillColumns(rows, assignment, RowSchema<Row>::Fields, binding, columnsCount);
+    }
+}
+
+#endif // _RowSchema_
@@ -0,0 +1,87 @@
+#include <algorithm>
+
+#include "CCDB/Helpers/RunRangeIndex.h"
+
+using namespace std;
+
+namespace ccdb
+{
+
+//______________________________________________________________________________
+RunRangeIndex::RunRangeIndex(std::vector<Item> items)
+{
+    //newest first. Invalid ranges would never be selected by SQL either
+    items.erase(remove_if(items.begin(), items.end(), [](const Item& item) { return item.RunMin > item.RunMax; }), items.end());
+    sort(items.begin(), items.end(), [](const Item& lhs, const Item& rhs) { return lhs.AssignmentId > rhs.AssignmentId; });
+    mItems = std::move(items);
+    if(mItems.empty()) return;
+
+    //segment boundaries. RunMax+1 is kept in 64 bits as RunMax may be INT_MAX
+    for(const Item& item: mItems) {
+        mSegmentStarts.push_back(item.RunMin);
+        mSegmentStarts.push_back(static_cast<int64_t>(item.RunMax) + 1);
+    }
+    sort(mSegmentStarts.begin(), mSegmentStarts.end());
+    mSegmentStarts.erase(unique(mSegmentStarts.begin(), mSegmentStarts.end()), mSegmentStarts.end());
+
+    size_t segmentsCount = mSegmentStarts.size() - 1;       //the last boundary only closes the last segment
+    mSegmentItems.assign(segmentsCount, -1);
+
+    //nextUnpainted[i] leads to the first not painted segment >= i (with path compression)
+    vector<size_t> nextUnpainted(segmentsCount + 1);
+    for(size_t i = 0; i <= segmentsCount; i++) nextUnpainted[i] = i;
+    auto findUnpainted = [&nextUnpainted](size_t i) {
+        size_t root = i;
+        while(nextUnpainted[root] != root) root = nextUnpainted[root];
+        while(nextUnpainted[i] != root) {
+            size_t next = nextUnpainted[i];
+            nextUnpainted[i] = root;
+            i = next;
+        }
+        return root;
+    };
+
+    for(size_t itemIndex = 0; itemIndex < mItems.size(); itemIndex++) {
+        const Item& item = mItems[itemIndex];
+        size_t first = lower_bound(mSegmentStarts.begin(), mSegmentStarts.end(), static_cast<int64_t>(item.RunMin)) - mSegmentStarts.begin();
+        size_t end = lower_bound(mSegmentStarts.begin(), mSegmentStarts.end(), static_cast<int64_t>(item.RunMax) + 1) - mSegmentStarts.begin();
+
+        for(size_t segment = findUnpainted(first); segment < end; segment = findUnpainted(segment)) {
+            mSegmentItems[segment] = static_cast<int32_t>(itemIndex);
+            nextUnpainted[segment] = segment + 1;
+        }
+    }
+}
+
+
+//______________________________________________________________________________
+const RunRangeIndex::Item* RunRangeIndex::Find(int run) const
+{
+    //the last segment starting at or before the run
+    auto startIter = upper_bound(mSegmentStarts.begin(), mSegmentStarts.end(), static_cast<int64_t>(run));
+    if(startIter == mSegmentStarts.begin()) return nullptr;
+
+    size_t segment = (startIter - mSegmentStarts.begin()) - 1;
+    if(segment >= mSegmentItems.size()) return nullptr;     //after the last range
+
+    int32_t itemIndex = mSegmentItems[segment];
+    return itemIndex < 0 ? nullptr : &mItems[itemIndex];
+}
+
+
+//______________________________________________________________________________
+std::vector<const RunRangeIndex::Item*> RunRangeIndex::GetReachableItems() const
+{
+    vector<bool> isReachable(mItems.size(), false);
+    for(int32_t itemIndex: mSegmentItems) {
+        if(itemIndex >= 0) isReachable[itemIndex] = true;
+    }
+
+    vector<const Item*> items;
+    for(size_t i = 0; i < mItems.size(); i++) {
+        if(isReachable[i]) items.push_back(&mItems[i]);
+    }
+    return items;
+}
+
+}
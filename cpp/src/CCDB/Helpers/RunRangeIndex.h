@@ -0,0 +1,65 @@
+#ifndef _RunRangeIndex_
+#define _RunRangeIndex_
+
+#include <stdint.h>
+#include <vector>
+
+#include "CCDB/Globals.h"
+
+namespace ccdb
+{
+    /** @brief Resolves the newest assignment for a run among assignments of one (type table, variation)
+     *
+     * Assignments of a table may have overlapping run ranges. The newest one (the largest id) wins,
+     * exactly as "ORDER BY assignments.id DESC LIMIT 1" in the providers' assignment query.
+     * The index flattens the ranges into sorted non overlapping segments, each one knowing its winner.
+     * So Find is a binary search: O(log n), no SQL.
+     *
+     * Building is O(n log n): items are painted from the newest to the oldest, each segment is painted once.
+     * The index is immutable after the constructor, so it may be shared by threads without locks
+     */
+    class RunRangeIndex
+    {
+    public:
+        /** @brief Assignment as it is seen by the index */
+        struct Item
+        {
+            int RunMin;
+            int RunMax;
+            dbkey_t AssignmentId;
+            dbkey_t ConstantSetId;
+        };
+
+        /** @brief Builds the index. Items order doesn't matter. Items with RunMin > RunMax are ignored */
+        explicit RunRangeIndex(std::vector<Item> items);
+
+        /** @brief The newest item with RunMin <= run <= RunMax or nullptr if there is no such item */
+        const Item* Find(int run) const;
+
+        /** @brief Calls onSegment(runStart, runEnd, item) for each segment in runs order
+         *
+         * The segment is [runStart, runEnd). item is nullptr for a gap between ranges
+         */
+        template<typename Func>
+        void ForEachSegment(Func onSegment) const
+        {
+            for(size_t i = 0; i < mSegmentItems.size(); i++) {
+                const Item* item = mSegmentItems[i] < 0 ? nullptr : &mItems[mSegmentItems[i]];
+                onSegment(mSegmentStarts[i], mSegmentStarts[i + 1], item);
+            }
+        }
+
+        /** @brief Items which are the newest for at least one run. Only they can be returned by Find */
+        std::vector<const Item*> GetReachableItems() const;
+
+        size_t GetItemsCount() const { return mItems.size(); }                 /// Items the index is built of
+        size_t GetSegmentsCount() const { return mSegmentItems.size(); }       /// Non overlapping segments
+
+    private:
+        std::vector<Item> mItems;                   /// Items sorted by AssignmentId descending
+        std::vector<int64_t> mSegmentStarts;        /// Segment i is [mSegmentStarts[i], mSegmentStarts[i+1])
+        std::vector<int32_t> mSegmentItems;         /// Index of the winner in mItems or -1 for a gap
+    };
+}
+
+#endif // _RunRangeIndex_
@@ -11,6 +11,8 @@
 #include <sqlite3.h>
 #include <fmt/format.h>
 
+#include "CCDB/Helpers/Trace.h"
+
 namespace ccdb {
     class SQLiteStatement{
     public:
@@ -18,19 +20,29 @@ namespace ccdb {
         using RowProcessCallback = void (*)(uint64_t rowIndex);
 
 
-        SQLiteStatement(sqlite3* database): mDatabase(database) {}
+        SQLiteStatement(sqlite3* database): mStatement(nullptr), mDatabase(database), mLastQueryColumnCount(0) {}
 
         /// Same as SQLiteStatement(db); Prepare(query)
-        SQLiteStatement(sqlite3* database, const std::string& query): mDatabase(database) {Prepare(query);}
+        SQLiteStatement(sqlite3* database, const std::string& query): SQLiteStatement(database) {Prepare(query);}
 
         ~SQLiteStatement() {
             sqlite3_finalize(mStatement);
         }
 
-        void Prepare(const std::string& query) {
-            int result = sqlite3_prepare_v2(mDatabase, query.c_str(), -1, &mStatement, nullptr);
+        /** @brief Compiles the query
+         *
+         * @param query SQL text with ?N parameters
+         * @param isPersistent the statement is going to be reused many times (@see Reset).
+         *        SQLite then keeps it out of the lookaside memory that is meant for short living statements
+         */
+        void Prepare(const std::string& query, bool isPersistent=false) {
+            sqlite3_finalize(mStatement);
+            mStatement = nullptr;
+
+            unsigned int flags = isPersistent ? SQLITE_PREPARE_PERSISTENT : 0;
+            int result = sqlite3_prepare_v3(mDatabase, query.c_str(), -1, flags, &mStatement, nullptr);
             if( result ) {
-                auto error = fmt::format("Error in sqlite3_prepare_v2: {}", sqlite3_errmsg(mDatabase));
+                auto error = fmt::format("Error in sqlite3_prepare_v3: {}", sqlite3_errmsg(mDatabase));
                 throw std::runtime_error(error);
             }
 
@@ -38,6 +50,13 @@ namespace ccdb {
             mLastQueryColumnCount = 0;  // Set it to 0 so if user tries
         }
 
+        /// Makes a prepared statement ready to be bound and executed again
+        void Reset() {
+            sqlite3_reset(mStatement);
+            sqlite3_clear_bindings(mStatement);
+            mLastQueryColumnCount = 0;
+        }
+
 
         /// Checks if there is a value with this fieldNum index (reports error in such case)
         /// and if it is not null (just returns false in this case)
@@ -75,31 +94,59 @@ namespace ccdb {
             }
         }
 
+        /** @brief Binds string without copying it
+         *
+         * @warning str must stay alive and unchanged until Execute is finished
+         */
+        void BindStringStatic(int32_t varId, const std::string& str) {
+            int result = sqlite3_bind_text(mStatement, varId, str.data(), static_cast<int>(str.size()), SQLITE_STATIC);
+            if( result ) {
+                auto error = fmt::format("sqlite3_bind_text error: {}. Query: {}", sqlite3_errmsg(mDatabase), mLastQuery);
+                throw std::runtime_error(error);
+            }
+        }
+
 
+        /** @brief Steps through all result rows calling onRow(rowIndex) for each
+         *
+         * The statement is reset at the end (even if onRow throws), so it doesn't hold
+         * the database read lock and can be executed again after new Bind calls
+         */
         template<typename Func>
         uint64_t Execute(Func onRow) {
+            TraceSpan span(TracePhase::Sql, mLastQuery);
             uint64_t rowsProcessed = 0;
             int result;
             mLastQueryColumnCount = sqlite3_column_count(mStatement);
-            do
+            try
             {
-                result = sqlite3_step(mStatement);
-                switch( result )
+                do
                 {
-                    case SQLITE_DONE:
-                        break;
-                    case SQLITE_ROW:
-                        //ok lets read the data...
-                        onRow(rowsProcessed);
-                        rowsProcessed++;
-                        break;
-                    default:
-                        auto error = fmt::format("sqlite3_step error: {}. Query: {}",
-                                                 sqlite3_errmsg(mDatabase), mLastQuery);
-                        throw std::runtime_error(error);
+                    result = sqlite3_step(mStatement);
+                    switch( result )
+                    {
+                        case SQLITE_DONE:
+                            break;
+                        case SQLITE_ROW:
+                            //ok lets read the data...
+                            onRow(rowsProcessed);
+                            rowsProcessed++;
+                            break;
+                        default:
+                            auto error = fmt::format("sqlite3_step error: {}. Query: {}",
+                                                     sqlite3_errmsg(mDatabase), mLastQuery);
+                            throw std::runtime_error(error);
+                    }
                 }
+                while(result==SQLITE_ROW );
             }
-            while(result==SQLITE_ROW );
+            catch (...)
+            {
+                sqlite3_reset(mStatement);
+                throw;
+            }
+
+            sqlite3_reset(mStatement);
             return rowsProcessed;
         }
 
@@ -151,6 +198,33 @@ namespace ccdb {
         uint64_t        mLastQueryColumnCount;
         std::string     mLastQuery;
     };
+
+
+    /** @brief Read transaction for the object lifetime
+     *
+     * All queries made while the object is alive see the same database state.
+     * The transaction is ended in the destructor (it has nothing to commit)
+     */
+    class SQLiteReadTransaction{
+    public:
+        explicit SQLiteReadTransaction(sqlite3* database): mDatabase(database) {
+            int result = sqlite3_exec(mDatabase, "BEGIN", nullptr, nullptr, nullptr);
+            if( result ) {
+                auto error = fmt::format("Error beginning read transaction: {}", sqlite3_errmsg(mDatabase));
+                throw std::runtime_error(error);
+            }
+        }
+
+        ~SQLiteReadTransaction() {
+            sqlite3_exec(mDatabase, "COMMIT", nullptr, nullptr, nullptr);
+        }
+
+    private:
+        sqlite3 *		mDatabase;
+
+        SQLiteReadTransaction(const SQLiteReadTransaction& rhs);
+        SQLiteReadTransaction& operator=(const SQLiteReadTransaction& rhs);
+    };
 }
 
 #endif //CCDB_SQLITE_H
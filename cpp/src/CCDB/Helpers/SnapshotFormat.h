@@ -0,0 +1,147 @@
+#ifndef _SnapshotFormat_
+#define _SnapshotFormat_
+
+#include <stdint.h>
+
+namespace ccdb
+{
+    /** @brief Binary calibration snapshot file format (.ccdbsnap)
+     *
+     * The file is made to be mapped read-only into memory and used in place, so all the processes
+     * on a node share the same physical pages. It is position independent: every reference is
+     * an offset from the file start or an index in a section. Records are plain structs with
+     * fixed size fields aligned to 8 bytes. Numbers are in the byte order of the machine that wrote
+     * the file, which is checked by ByteOrderMark.
+     *
+     * The file holds the database state at one time (SnapshotTime, 0 means "the latest at conversion"):
+     *   Data        - bytes of all strings and blobs (String records point here)
+     *   Directories - SnapshotDirectory records
+     *   Tables      - SnapshotTable records sorted by FullPath
+     *   Columns     - SnapshotColumn records. A table has ColumnsCount columns from FirstColumn
+     *   Variations  - SnapshotVariation records sorted by Name
+     *   Indexes     - SnapshotIndex records sorted by (TableId, VariationId), one per run-range index
+     *   Segments    - SnapshotSegment records. Segments of an index are sorted by RunStart,
+     *                 a segment lasts until RunStart of the next one. The last segment of each index
+     *                 only closes the previous one (its Blob is SnapshotFormat::NoBlob)
+     *   Blobs       - SnapshotBlob records: raw vault text and optionally values decoded to double and int
+     *   Doubles     - double values of blobs
+     *   Ints        - int values of blobs
+     *
+     * Version history:
+     *   1 - initial
+     */
+    namespace SnapshotFormat
+    {
+        static const char Magic[8] = {'C','C','D','B','S','N','A','P'};
+        static const uint32_t Version = 1;
+        static const uint32_t ByteOrderMark = 0x01020304;
+        static const uint32_t NoBlob = 0xFFFFFFFF;      /// Blob index of a gap segment
+        static const char* const FileExtension = ".ccdbsnap";
+    }
+
+    /** @brief A part of the file: Offset from the file start and the number of records in it */
+    struct SnapshotSection
+    {
+        uint64_t Offset;
+        uint64_t Count;
+    };
+
+    /** @brief Text in Data section */
+    struct SnapshotString
+    {
+        uint64_t Offset;        /// Offset from Data section start
+        uint64_t Length;
+    };
+
+    struct SnapshotHeader
+    {
+        char     Magic[8];
+        uint32_t Version;
+        uint32_t ByteOrderMark;
+        uint64_t FileSize;
+        int64_t  SnapshotTime;
+        SnapshotSection Data;
+        SnapshotSection Directories;
+        SnapshotSection Tables;
+        SnapshotSection Columns;
+        SnapshotSection Variations;
+        SnapshotSection Indexes;
+        SnapshotSection Segments;
+        SnapshotSection Blobs;
+        SnapshotSection Doubles;
+        SnapshotSection Ints;
+    };
+
+    struct SnapshotDirectory
+    {
+        int32_t Id;
+        int32_t ParentId;
+        SnapshotString Name;
+        SnapshotString Comment;
+    };
+
+    struct SnapshotTable
+    {
+        int32_t  Id;
+        int32_t  DirectoryId;
+        int32_t  RowsCount;
+        int32_t  ColumnsCountFromDB;
+        uint32_t FirstColumn;
+        uint32_t ColumnsCount;
+        uint32_t HasBoolColumns;    /// Decoded values of bool columns depend on column types
+        uint32_t Reserved;
+        SnapshotString Name;
+        SnapshotString FullPath;
+        SnapshotString Comment;
+    };
+
+    struct SnapshotColumn
+    {
+        int32_t Id;
+        int32_t Reserved;
+        SnapshotString Name;
+        SnapshotString Type;
+    };
+
+    struct SnapshotVariation
+    {
+        int32_t Id;
+        int32_t ParentId;
+        SnapshotString Name;
+    };
+
+    struct SnapshotIndex
+    {
+        int32_t  TableId;
+        int32_t  VariationId;
+        uint64_t FirstSegment;
+        uint64_t SegmentsCount;
+    };
+
+    struct SnapshotSegment
+    {
+        int64_t  RunStart;
+        int32_t  AssignmentId;
+        uint32_t Blob;              /// Index in Blobs or SnapshotFormat::NoBlob for a gap
+    };
+
+    struct SnapshotBlob
+    {
+        int32_t  ConstantSetId;
+        int32_t  Reserved;
+        SnapshotString Raw;         /// Vault text as it is in DB
+        uint64_t FirstValue;        /// Index of the first value in Doubles and Ints
+        uint64_t ValuesCount;       /// Number of decoded values (0 if not decoded)
+    };
+
+    static_assert(sizeof(SnapshotHeader) == 192, "SnapshotHeader layout changed. Increase SnapshotFormat::Version");
+    static_assert(sizeof(SnapshotDirectory) == 40, "SnapshotDirectory layout changed. Increase SnapshotFormat::Version");
+    static_assert(sizeof(SnapshotTable) == 80, "SnapshotTable layout changed. Increase SnapshotFormat::Version");
+    static_assert(sizeof(SnapshotColumn) == 40, "SnapshotColumn layout changed. Increase SnapshotFormat::Version");
+    static_assert(sizeof(SnapshotVariation) == 24, "SnapshotVariation layout changed. Increase SnapshotFormat::Version");
+    static_assert(sizeof(SnapshotIndex) == 24, "SnapshotIndex layout changed. Increase SnapshotFormat::Version");
+    static_assert(sizeof(SnapshotSegment) == 16, "SnapshotSegment layout changed. Increase SnapshotFormat::Version");
+    static_assert(sizeof(SnapshotBlob) == 40, "SnapshotBlob layout changed. Increase SnapshotFormat::Version");
+}
+
+#endif // _SnapshotFormat_
@@ -0,0 +1,37 @@
+#ifndef _Span_
+#define _Span_
+
+#include <stddef.h>
+
+namespace ccdb
+{
+    /** @brief Non owning view of contiguous elements (pointer and size), like C++20 std::span
+     *
+     * Used by ConstantsView to give columns and rows of decoded data without copying.
+     * The span is valid while the data it points to is alive
+     */
+    template<typename T>
+    class Span
+    {
+    public:
+        Span(): mData(nullptr), mSize(0) {}
+        Span(T* data, size_t size): mData(data), mSize(size) {}
+
+        T* data() const { return mData; }
+        size_t size() const { return mSize; }
+        bool empty() const { return mSize == 0; }
+
+        T& operator[](size_t index) const { return mData[index]; }     ///No bounds check
+        T& front() const { return mData[0]; }
+        T& back() const { return mData[mSize - 1]; }
+
+        T* begin() const { return mData; }
+        T* end() const { return mData + mSize; }
+
+    private:
+        T* mData;
+        size_t mSize;
+    };
+}
+
+#endif // _Span_
@@ -1,4 +1,11 @@
 #include <cstdlib>
+#include <charconv>
+#include <stdexcept>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CCDB_SPLIT_X86_SIMD
+#include <immintrin.h>
+#endif
 
 #include "CCDB/Helpers/StringUtils.h"
 
@@ -167,48 +174,291 @@ vector<string> & ccdb::StringUtils::Split( const string& str, vector<string>& to
 
 
 //______________________________________________________________________________
-int ccdb::StringUtils::ParseInt( const string& source, bool *result/*=NULL*/  )
+static inline void AddStringToken(vector<StringToken>& tokens, size_t begin, size_t end)
+{
+    //empty tokens are skipped as Split does
+    if(end > begin) tokens.push_back(StringToken{static_cast<uint32_t>(begin), static_cast<uint32_t>(end - begin)});
+}
+
+
+//______________________________________________________________________________
+static void SplitOffsetsScalar(const char* str, size_t size, char delimiter, vector<StringToken>& tokens)
+{
+    size_t begin = 0;
+    while(begin < size)
+    {
+        const char* found = static_cast<const char*>(memchr(str + begin, delimiter, size - begin));
+        size_t end = found ? static_cast<size_t>(found - str) : size;
+        AddStringToken(tokens, begin, end);
+        begin = end + 1;
+    }
+}
+
+
+#ifdef CCDB_SPLIT_X86_SIMD
+
+//______________________________________________________________________________
+/** Adds tokens ended by delimiters at chunkStart + set bits of the mask */
+static inline void AddStringTokensByMask(vector<StringToken>& tokens, size_t chunkStart, uint32_t mask, size_t& begin)
+{
+    while(mask)
+    {
+        size_t end = chunkStart + __builtin_ctz(mask);
+        AddStringToken(tokens, begin, end);
+        begin = end + 1;
+        mask &= mask - 1;    //clear the lowest bit
+    }
+}
+
+
+//______________________________________________________________________________
+__attribute__((target("sse2")))
+static void SplitOffsetsSSE2(const char* str, size_t size, char delimiter, vector<StringToken>& tokens)
+{
+    const __m128i pattern = _mm_set1_epi8(delimiter);
+    size_t begin = 0;
+    size_t pos = 0;
+    for(; pos + 16 <= size; pos += 16)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + pos));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, pattern)));
+        AddStringTokensByMask(tokens, pos, mask, begin);
+    }
+
+    //the tail
+    for(; pos < size; pos++)
+    {
+        if(str[pos] == delimiter)
+        {
+            AddStringToken(tokens, begin, pos);
+            begin = pos + 1;
+        }
+    }
+    AddStringToken(tokens, begin, size);
+}
+
+
+//______________________________________________________________________________
+__attribute__((target("avx2")))
+static void SplitOffsetsAVX2(const char* str, size_t size, char delimiter, vector<StringToken>& tokens)
+{
+    const __m256i pattern = _mm256_set1_epi8(delimiter);
+    size_t begin = 0;
+    size_t pos = 0;
+    for(; pos + 32 <= size; pos += 32)
+    {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(str + pos));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, pattern)));
+        AddStringTokensByMask(tokens, pos, mask, begin);
+    }
+
+    //the tail
+    for(; pos < size; pos++)
+    {
+        if(str[pos] == delimiter)
+        {
+            AddStringToken(tokens, begin, pos);
+            begin = pos + 1;
+        }
+    }
+    AddStringToken(tokens, begin, size);
+}
+
+#endif //CCDB_SPLIT_X86_SIMD
+
+
+//______________________________________________________________________________
+bool ccdb::StringUtils::IsSplitImplementationSupported(SplitImplementations implementation)
+{
+    switch(implementation)
+    {
+    case cSplitAuto:
+    case cSplitScalar:
+        return true;
+#ifdef CCDB_SPLIT_X86_SIMD
+    case cSplitSSE2:
+        return __builtin_cpu_supports("sse2");
+    case cSplitAVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+
+//______________________________________________________________________________
+ccdb::StringUtils::SplitImplementations ccdb::StringUtils::GetSplitImplementation()
+{
+    //CPU features are checked once
+    static const SplitImplementations implementation =
+        IsSplitImplementationSupported(cSplitAVX2) ? cSplitAVX2 :
+        IsSplitImplementationSupported(cSplitSSE2) ? cSplitSSE2 :
+        cSplitScalar;
+
+    return implementation;
+}
+
+
+//______________________________________________________________________________
+void ccdb::StringUtils::SplitOffsets(const char* str, size_t size, char delimiter, vector<StringToken>& tokens, SplitImplementations implementation /*= cSplitAuto*/)
 {
-    return atoi(source.c_str()); //ugly isn't it?
+    if(size > UINT32_MAX)
+    {
+        throw std::runtime_error("StringUtils::SplitOffsets. String is too big to be split by 32 bit offsets");
+    }
+
+    tokens.clear();
+
+    if(implementation == cSplitAuto) implementation = GetSplitImplementation();
+    else if(!IsSplitImplementationSupported(implementation)) implementation = cSplitScalar;
+
+    switch(implementation)
+    {
+#ifdef CCDB_SPLIT_X86_SIMD
+    case cSplitAVX2:
+        SplitOffsetsAVX2(str, size, delimiter, tokens);
+        break;
+    case cSplitSSE2:
+        SplitOffsetsSSE2(str, size, delimiter, tokens);
+        break;
+#endif
+    default:
+        SplitOffsetsScalar(str, size, delimiter, tokens);
+    }
 }
 
 
 //______________________________________________________________________________
-unsigned int ccdb::StringUtils::ParseUInt( const string& source, bool *result/*=NULL*/  )
+/** Skips blanks and a leading '+', that atoi/atof accepted but from_chars does not */
+static inline const char* SkipNumberPrefix(const char* begin, const char* end)
 {
-    return static_cast<unsigned int>(atoi(source.c_str())); //ugly isn't it?
+    while(begin < end && CCDB_CHECK_CHAR_IS_BLANK(*begin)) begin++;
+    if(begin < end && *begin == '+' && (end - begin) > 1 && *(begin + 1) != '-') begin++;
+    return begin;
 }
 
 
 //______________________________________________________________________________
-long ccdb::StringUtils::ParseLong( const string& source, bool *result/*=NULL*/  )
+/** Checks that only blanks are left after the number */
+static inline bool IsNumberEnd(const char* begin, const char* end)
 {
-    return atol(source.c_str()); //ugly isn't it?
+    while(begin < end && CCDB_CHECK_CHAR_IS_BLANK(*begin)) begin++;
+    return begin == end;
 }
 
 
 //______________________________________________________________________________
-unsigned long ccdb::StringUtils::ParseULong( const string& source, bool *result/*=NULL*/  )
+template<typename T>
+static inline T ParseInteger(std::string_view source, bool *result)
 {
-    return static_cast<unsigned long>(atol(source.c_str())); //ugly isn't it?
+    const char* end = source.data() + source.size();
+    const char* begin = SkipNumberPrefix(source.data(), end);
+
+    T value = 0;
+    std::from_chars_result parsed = std::from_chars(begin, end, value);
+    bool isParsed = parsed.ec == std::errc() && IsNumberEnd(parsed.ptr, end);
+    if(parsed.ec != std::errc()) value = 0;
+
+    if(result) *result = isParsed;
+    return value;
 }
 
 
 //______________________________________________________________________________
-bool ccdb::StringUtils::ParseBool( const string& source, bool *result/*=NULL*/  )
+int ccdb::StringUtils::ParseInt(std::string_view source, bool *result/*=nullptr*/)
 {
-    if(source=="true") return true;
-    if(source=="false") return false;
+    return ParseInteger<int>(source, result);
+}
+
 
-    return static_cast<bool>(atoi(source.c_str())!=0); //ugly isn't it?
+//______________________________________________________________________________
+unsigned int ccdb::StringUtils::ParseUInt(std::string_view source, bool *result/*=nullptr*/)
+{
+    return ParseInteger<unsigned int>(source, result);
+}
+
+
+//______________________________________________________________________________
+long ccdb::StringUtils::ParseLong(std::string_view source, bool *result/*=nullptr*/)
+{
+    return ParseInteger<long>(source, result);
+}
+
+
+//______________________________________________________________________________
+unsigned long ccdb::StringUtils::ParseULong(std::string_view source, bool *result/*=nullptr*/)
+{
+    return ParseInteger<unsigned long>(source, result);
 }
 
+
+//______________________________________________________________________________
+bool ccdb::StringUtils::ParseBool(std::string_view source, bool *result/*=nullptr*/)
+{
+    if(source=="true" || source=="false")
+    {
+        if(result) *result = true;
+        return source=="true";
+    }
+
+    return ParseInteger<int>(source, result) != 0;
+}
+
+
+//___________________________________________________________________________________
+double ccdb::StringUtils::ParseDouble(std::string_view source, bool *result/*=nullptr*/)
+{
+    const char* end = source.data() + source.size();
+    const char* begin = SkipNumberPrefix(source.data(), end);
+
+    double value = 0;
+    std::from_chars_result parsed = std::from_chars(begin, end, value);
+    bool isParsed = parsed.ec == std::errc() && IsNumberEnd(parsed.ptr, end);
+
+    if(parsed.ec == std::errc::result_out_of_range)
+    {
+        //from_chars leaves the value untouched. Give HUGE_VAL or 0 as strtod does (rare case, so copying is OK)
+        value = strtod(string(begin, parsed.ptr).c_str(), nullptr);
+    }
+    else if(parsed.ec != std::errc())
+    {
+        value = 0;
+    }
+
+    if(result) *result = isParsed;
+    return value;
+}
+
+
+//___________________________________________________________________________________
+bool ccdb::StringUtils::ParseDoubleArray(const char* str, const StringToken* tokens, size_t count, double* values)
+{
+    bool isAllParsed = true;
+    for(size_t i = 0; i < count; i++)
+    {
+        bool isParsed;
+        values[i] = ParseDouble(std::string_view(str + tokens[i].Offset, tokens[i].Length), &isParsed);
+        isAllParsed = isAllParsed && isParsed;
+    }
+    return isAllParsed;
+}
+
+
 //___________________________________________________________________________________
-double ccdb::StringUtils::ParseDouble( const string& source, bool *result/*=NULL*/  )
+bool ccdb::StringUtils::ParseIntArray(const char* str, const StringToken* tokens, size_t count, int* values)
 {
-    return atof(source.c_str()); //ugly isn't it?
+    bool isAllParsed = true;
+    for(size_t i = 0; i < count; i++)
+    {
+        bool isParsed;
+        values[i] = ParseInt(std::string_view(str + tokens[i].Offset, tokens[i].Length), &isParsed);
+        isAllParsed = isAllParsed && isParsed;
+    }
+    return isAllParsed;
 }
 
+
 //_______________________________________________________________________________________
 std::string ccdb::StringUtils::ParseString( const string& source, bool *result/*=NULL*/  )
 {
@@ -11,7 +11,9 @@
 #include <stdio.h>
 
 #include <stdarg.h>
+#include <stdint.h>
 #include <string>
+#include <string_view>
 #include <string.h>
 #include <sstream>
 #include <vector>
@@ -43,10 +45,26 @@ struct AssignmentRequest
     time_t      Time;
 };
 
+/** @brief Position of a token in a string. @see StringUtils::SplitOffsets */
+struct StringToken
+{
+    uint32_t Offset;    /// Offset of the first character of the token
+    uint32_t Length;    /// Number of characters in the token
+};
+
 class StringUtils
 {
 public:
 
+    /** @brief Implementations of SplitOffsets delimiter scan */
+    enum SplitImplementations
+    {
+        cSplitAuto,     /// The fastest implementation supported by the CPU (chosen once at runtime)
+        cSplitScalar,   /// Portable memchr loop
+        cSplitSSE2,     /// 16 bytes per step (x86 only)
+        cSplitAVX2      /// 32 bytes per step (x86 only)
+    };
+
     /** @brief Encodes string to add to DB
      * Encode
      *
@@ -111,6 +129,29 @@ public:
     static std::vector<std::string> Split(const std::string &s, const std::string& delimiters = " ");
 
 
+    /** @brief Splits string by one delimiter character to token offsets without allocating strings
+     *
+     * Follows Split semantics: empty tokens (leading, trailing or repeated delimiters) are skipped.
+     * The delimiter scan is vectorized (AVX2 or SSE2) when the CPU supports it.
+     *
+     * @throw std::runtime_error if the string is larger than 4GB (offsets are 32 bit)
+     * @param [in]  str            - string to split
+     * @param [in]  size           - size of the string
+     * @param [in]  delimiter      - delimiter character
+     * @param [out] tokens         - tokens positions. The vector is cleared before filling
+     * @param [in]  implementation - scan implementation, unsupported one falls back to cSplitScalar
+     */
+    static void SplitOffsets(const char* str, size_t size, char delimiter, std::vector<StringToken>& tokens, SplitImplementations implementation = cSplitAuto);
+
+
+    /** @brief Checks if SplitOffsets implementation is supported by the CPU */
+    static bool IsSplitImplementationSupported(SplitImplementations implementation);
+
+
+    /** @brief Gets implementation that SplitOffsets uses with cSplitAuto */
+    static SplitImplementations GetSplitImplementation();
+
+
 
     /**
      * @brief trims string from the both sides
@@ -231,12 +272,36 @@ public:
 
     }
 
-    static int              ParseInt(const std::string& source, bool *result=nullptr );         ///Reads int    from the last query row
-    static unsigned int     ParseUInt(const std::string& source, bool *result=nullptr );        ///Reads unsigned int from the last query row
-    static long             ParseLong(const std::string& source, bool *result=nullptr );        ///Reads long from the last query row
-    static unsigned long    ParseULong(const std::string& source, bool *result=nullptr );       ///Reads unsigned long from the last query row
-    static bool             ParseBool(const std::string& source, bool *result=nullptr );        ///Reads bool from the last query row
-    static double           ParseDouble(const std::string& source, bool *result=nullptr );      ///Reads double from the last query row
+    /** @brief Numbers parsing
+     *
+     * Parsing is locale independent and works on string views (no NUL terminator is needed).
+     * Leading and trailing blank characters and a leading '+' are allowed.
+     * The whole string must be a number, otherwise *result is set to false.
+     * Integer and unsigned parsing stops at a fractional part ("12.5" gives 12 with *result=false).
+     * Out of range and invalid values give 0 (doubles give +-HUGE_VAL or 0 as strtod does).
+     *
+     * @param [in]  source - string to parse
+     * @param [out] result - if not null, is set to true if the whole string was parsed
+     */
+    static int              ParseInt(std::string_view source, bool *result=nullptr );         ///Reads int
+    static unsigned int     ParseUInt(std::string_view source, bool *result=nullptr );        ///Reads unsigned int
+    static long             ParseLong(std::string_view source, bool *result=nullptr );        ///Reads long
+    static unsigned long    ParseULong(std::string_view source, bool *result=nullptr );       ///Reads unsigned long
+    static bool             ParseBool(std::string_view source, bool *result=nullptr );        ///Reads bool: "true", "false" or an integer
+    static double           ParseDouble(std::string_view source, bool *result=nullptr );      ///Reads double
+
+
+    /** @brief Parses tokens of a blob to a contiguous array in one pass
+     *
+     * @param [in]  str    - the blob tokens point to
+     * @param [in]  tokens - tokens positions (@see SplitOffsets)
+     * @param [in]  count  - number of tokens
+     * @param [out] values - array of at least count elements
+     * @return true if all tokens were parsed. Values that failed to parse are set as by ParseDouble/ParseInt
+     */
+    static bool ParseDoubleArray(const char* str, const StringToken* tokens, size_t count, double* values);
+    static bool ParseIntArray(const char* str, const StringToken* tokens, size_t count, int* values);     ///@see ParseDoubleArray
+
     static std::string      ParseString(const std::string& source, bool *result=nullptr );      ///Reads string from the last query row
     static time_t           ParseUnixTime(const std::string& source, bool *result=nullptr );    ///Reads string from the last query row
 };
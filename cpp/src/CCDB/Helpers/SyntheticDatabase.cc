@@ -0,0 +1,528 @@
+#include <stdio.h>
+#include <limits>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "CCDB/Helpers/SyntheticDatabase.h"
+#include "CCDB/Helpers/SQLite.h"
+
+using namespace std;
+
+namespace ccdb
+{
+
+/// Schema v2 (schemaVersion 5) as in sql/ccdb.sqlite
+static const char* const cSchemaSql = R"SQL(
+CREATE TABLE IF NOT EXISTS "assignments" (
+  "id" integer  NOT NULL ,
+  "created" timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP,
+  "modified" timestamp NOT NULL DEFAULT '2007-01-01 00:00:00',
+  "variationId" integer NOT NULL,
+  "runRangeId" integer DEFAULT NULL,
+  "eventRangeId" integer DEFAULT NULL,
+  "constantSetId" integer NOT NULL,
+  "authorId" integer NOT NULL DEFAULT '1',
+  "comment" text,
+  PRIMARY KEY ("id")
+);
+CREATE TABLE IF NOT EXISTS "columns" (
+  "id" integer NOT NULL ,
+  "created" timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP,
+  "modified" timestamp NOT NULL DEFAULT '2007-01-01 00:00:00',
+  "name" varchar(45) NOT NULL,
+  "typeId" integer NOT NULL,
+  "columnType" text  DEFAULT NULL,
+  "order" integer NOT NULL,
+  "comment" text,
+  PRIMARY KEY ("id")
+);
+CREATE TABLE IF NOT EXISTS "constantSets" (
+  "id" integer NOT NULL ,
+  "created" timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP,
+  "modified" timestamp NOT NULL DEFAULT '2007-01-01 00:00:00',
+  "vault" longtext NOT NULL,
+  "constantTypeId" integer NOT NULL,
+  PRIMARY KEY ("id")
+);
+CREATE TABLE IF NOT EXISTS "directories" (
+  "id" integer NOT NULL ,
+  "created" timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP,
+  "modified" timestamp NOT NULL DEFAULT '2007-01-01 00:00:00',
+  "name" varchar(255) NOT NULL DEFAULT '',
+  "parentId" integer NOT NULL DEFAULT '0',
+  "authorId" integer NOT NULL DEFAULT '1',
+  "comment" text,
+  isDeprecated TINYINT(1) NOT NULL DEFAULT 0,
+  deprecatedById INT(11) NOT NULL DEFAULT -1,
+  PRIMARY KEY ("id")
+);
+CREATE TABLE IF NOT EXISTS "eventRanges" (
+  "id" integer NOT NULL ,
+  "created" timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP,
+  "modified" timestamp NOT NULL DEFAULT '2007-01-01 00:00:00',
+  "runNumber" integer NOT NULL,
+  "eventMin" integer NOT NULL,
+  "eventMax" integer NOT NULL,
+  "comment" text,
+  PRIMARY KEY ("id")
+);
+CREATE TABLE IF NOT EXISTS "logs" (
+  "id" integer NOT NULL ,
+  "created" timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP,
+  "affectedIds" text NOT NULL,
+  "action" varchar(7) NOT NULL,
+  "description" varchar(255) NOT NULL,
+  "comment" text,
+  "authorId" integer NOT NULL,
+  PRIMARY KEY ("id")
+);
+CREATE TABLE IF NOT EXISTS "runRanges" (
+  "id" integer NOT NULL ,
+  "created" timestamp NOT NULL DEFAULT '2007-01-01 00:00:00',
+  "modified" timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP,
+  "name" varchar(45) DEFAULT '',
+  "runMin" integer NOT NULL,
+  "runMax" integer NOT NULL,
+  "comment" text,
+  PRIMARY KEY ("id")
+);
+CREATE TABLE IF NOT EXISTS "schemaVersions" (
+  "id" integer NOT NULL,
+  "schemaVersion" integer NOT NULL DEFAULT '1',
+  PRIMARY KEY ("id")
+);
+CREATE TABLE IF NOT EXISTS "tags" (
+  "id" integer NOT NULL ,
+  "name" varchar(45) NOT NULL,
+  PRIMARY KEY ("id")
+);
+CREATE TABLE IF NOT EXISTS "typeTables" (
+  "id" integer NOT NULL ,
+  "created" timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP,
+  "modified" timestamp NOT NULL DEFAULT '2007-01-01 00:00:00',
+  "directoryId" integer NOT NULL,
+  "name" varchar(255) NOT NULL,
+  "nRows" integer NOT NULL DEFAULT '1',
+  "nColumns" integer NOT NULL,
+  "nAssignments" integer NOT NULL DEFAULT '0',
+  "authorId" integer NOT NULL DEFAULT '1',
+  "comment" text,
+  isDeprecated TINYINT(1) NOT NULL DEFAULT 0,
+  deprecatedById INT(11) NOT NULL DEFAULT -1,
+  isLocked TINYINT(1) NOT NULL DEFAULT 0,
+  lockAuthorId INT(11) NULL DEFAULT NULL,
+  lockTime TIMESTAMP NULL DEFAULT NULL,
+  PRIMARY KEY ("id")
+);
+CREATE TABLE IF NOT EXISTS "users" (
+  "id" integer NOT NULL ,
+  "created" timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP,
+  "lastActionTime" timestamp NOT NULL DEFAULT '2001-01-01 00:00:00',
+  "name" varchar(100) NOT NULL,
+  "password" varchar(100) DEFAULT NULL,
+  "roles" text NOT NULL,
+  "info" varchar(125) NOT NULL,
+  "isDeleted" integer NOT NULL DEFAULT '0',
+  PRIMARY KEY ("id")
+);
+CREATE TABLE IF NOT EXISTS "variations" (
+  "id" integer NOT NULL ,
+  "created" timestamp NOT NULL DEFAULT '2007-01-01 00:00:00',
+  "modified" timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP,
+  "name" varchar(100) NOT NULL DEFAULT 'default',
+  "description" varchar(255) DEFAULT NULL,
+  "authorId" integer NOT NULL DEFAULT '1',
+  "comment" text,
+  "parentId" integer NOT NULL DEFAULT '0',
+  isLocked TINYINT(1) NOT NULL DEFAULT 0,
+  lockTime TIMESTAMP NULL DEFAULT NULL,
+  lockAuthorId VARCHAR(45) NULL DEFAULT NULL,
+  goBackBehavior INT(11) NOT NULL DEFAULT 0,
+  goBackTime TIMESTAMP NULL DEFAULT NULL,
+  PRIMARY KEY ("id")
+);
+CREATE TABLE IF NOT EXISTS "variations_has_tags" (
+  "variations_id" integer NOT NULL,
+  "tags_id" integer NOT NULL,
+  PRIMARY KEY ("variations_id","tags_id")
+);
+CREATE INDEX "variations_has_tags_fk_variations_has_tags_tags1_idx" ON "variations_has_tags" ("tags_id");
+CREATE INDEX "typeTables_id_UNIQUE" ON "typeTables" ("id");
+CREATE INDEX "typeTables_fk_constantTypes_directories1_idx" ON "typeTables" ("directoryId");
+CREATE INDEX "users_id_UNIQUE" ON "users" ("id");
+CREATE INDEX "assignments_id_UNIQUE" ON "assignments" ("id");
+CREATE INDEX "assignments_fk_assignments_variations1_idx" ON "assignments" ("variationId");
+CREATE INDEX "assignments_fk_assignments_runRanges1_idx" ON "assignments" ("runRangeId");
+CREATE INDEX "assignments_fk_assignments_constantSets1_idx" ON "assignments" ("constantSetId");
+CREATE INDEX "assignments_fk_assignments_eventRanges1_idx" ON "assignments" ("eventRangeId");
+CREATE INDEX "assignments_date_sort_index" ON "assignments" ("created");
+CREATE INDEX "tags_id_UNIQUE" ON "tags" ("id");
+CREATE INDEX "columns_id_UNIQUE" ON "columns" ("id");
+CREATE INDEX "columns_fk_columns_constantTypes1_idx" ON "columns" ("typeId");
+CREATE INDEX "directories_id_UNIQUE" ON "directories" ("id");
+CREATE INDEX "directories_fk_directories_directories1_idx" ON "directories" ("parentId");
+CREATE INDEX "variations_id_UNIQUE" ON "variations" ("id");
+CREATE INDEX "variations_name_search" ON "variations" ("name");
+CREATE INDEX "variations_fk_variations_variations1_idx" ON "variations" ("parentId");
+CREATE INDEX "runRanges_id_UNIQUE" ON "runRanges" ("id");
+CREATE INDEX "runRanges_run search" ON "runRanges" ("runMin","runMax");
+CREATE INDEX "eventRanges_ideventRanges_UNIQUE" ON "eventRanges" ("id");
+CREATE INDEX "constantSets_id_UNIQUE" ON "constantSets" ("id");
+CREATE INDEX "constantSets_fk_constantSets_constantTypes1_idx" ON "constantSets" ("constantTypeId");
+CREATE INDEX "logs_id_UNIQUE" ON "logs" ("id");
+CREATE INDEX "logs_fk_logs_users1_idx" ON "logs" ("authorId");
+CREATE TABLE assignmentsMaterializedView (
+  id INT(11) NOT NULL,
+  assignmentsId INT(11) NOT NULL,
+  variationsId INT(11) NOT NULL,
+  constantSetsId INT(11) NOT NULL,
+  typeTablesId INT(11) NOT NULL,
+  runRangesId INT(11) NOT NULL,
+  runMin INT(11) NOT NULL,
+  runMax INT(11) NOT NULL,
+  assignmentTime TIMESTAMP NOT NULL,
+  PRIMARY KEY (id ASC)
+);
+)SQL";
+
+static const int cSchemaVersion = 5;
+static const int64_t cDefaultVariationId = 1;
+static const int64_t cAllRunsRangeId = 1;
+static const int64_t cBaseTime = 1420070400;        /// 2015-01-01 00:00:00 UTC, creation time of the content
+static const int64_t cAssignmentsInterval = 60;     /// Seconds between creation times of assignments
+
+
+//______________________________________________________________________________
+/** @brief Deterministic random numbers
+ *
+ * Only the output of mt19937_64 is used, which is the same in all standard libraries
+ * (std distributions are implementation defined). No floating point math is used for integers
+ */
+class SyntheticRandom
+{
+public:
+    explicit SyntheticRandom(uint64_t seed): mEngine(seed) {}
+
+    uint64_t Next() { return mEngine(); }
+
+    /** Integer in [min, max] */
+    int64_t Uniform(int64_t min, int64_t max)
+    {
+        uint64_t count = static_cast<uint64_t>(max - min) + 1;
+        return min + static_cast<int64_t>(count ? Next() % count : Next());
+    }
+
+    /** Number in [0, 1) */
+    double Unit() { return static_cast<double>(Next() >> 11) * (1.0 / 9007199254740992.0); }
+
+    /** Integer in [min, max] (min >= 1) with uniformly distributed number of bits */
+    int64_t LogUniform(int64_t min, int64_t max)
+    {
+        int bits = static_cast<int>(Uniform(BitsCount(min), BitsCount(max)));
+        int64_t low = bits > 1 ? int64_t(1) << (bits - 1) : 1;
+        int64_t high = bits < 63 ? (int64_t(1) << bits) - 1 : max;
+        return Uniform(low < min ? min : low, high > max ? max : high);
+    }
+
+private:
+    static int BitsCount(int64_t value)
+    {
+        int bits = 0;
+        for(; value > 0; value >>= 1) bits++;
+        return bits;
+    }
+
+    std::mt19937_64 mEngine;
+};
+
+
+//______________________________________________________________________________
+/** Formats unix time as 'YYYY-MM-DD HH:MM:SS' UTC (without gmtime, for any platform) */
+static string FormatTime(int64_t time)
+{
+    int64_t days = time / 86400;
+    int64_t seconds = time % 86400;
+
+    // civil from days, http://howardhinnant.github.io/date_algorithms.html
+    days += 719468;
+    int64_t era = days / 146097;
+    int64_t dayOfEra = days - era * 146097;
+    int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int64_t monthPart = (5 * dayOfYear + 2) / 153;
+    int64_t day = dayOfYear - (153 * monthPart + 2) / 5 + 1;
+    int64_t month = monthPart < 10 ? monthPart + 3 : monthPart - 9;
+    int64_t year = yearOfEra + era * 400 + (month <= 2 ? 1 : 0);
+
+    char text[32];
+    snprintf(text, sizeof(text), "%04d-%02d-%02d %02d:%02d:%02d", static_cast<int>(year), static_cast<int>(month),
+             static_cast<int>(day), static_cast<int>(seconds / 3600), static_cast<int>(seconds / 60 % 60), static_cast<int>(seconds % 60));
+    return text;
+}
+
+
+//______________________________________________________________________________
+static void ExecuteSql(sqlite3* database, const char* sql)
+{
+    char* errorMessage = nullptr;
+    if(sqlite3_exec(database, sql, nullptr, nullptr, &errorMessage) != SQLITE_OK) {
+        string error = string("SyntheticDatabase SQL error: ") + (errorMessage ? errorMessage : "");
+        sqlite3_free(errorMessage);
+        throw std::runtime_error(error);
+    }
+}
+
+
+//______________________________________________________________________________
+SyntheticDatabase::SyntheticDatabase(const SyntheticDatabaseOptions& options):
+    mOptions(options)
+{
+    ValidateOptions(mOptions);
+}
+
+
+//______________________________________________________________________________
+void SyntheticDatabase::ValidateOptions(const SyntheticDatabaseOptions& options)
+{
+    string thisFunc("SyntheticDatabase::ValidateOptions. ");
+
+    if(options.Directories < 0) throw std::logic_error(thisFunc + "Directories < 0");
+    if(options.Tables < 0) throw std::logic_error(thisFunc + "Tables < 0");
+    if(options.MinColumns < 1 || options.MinColumns > options.MaxColumns) throw std::logic_error(thisFunc + "Columns range should be 1 <= min <= max");
+    if(options.MinRows < 1 || options.MinRows > options.MaxRows) throw std::logic_error(thisFunc + "Rows range should be 1 <= min <= max");
+    if(options.MaxCells < options.MaxColumns) throw std::logic_error(thisFunc + "MaxCells should fit a row of MaxColumns");
+    if(options.Runs < 1) throw std::logic_error(thisFunc + "Runs < 1");
+    if(options.MinRunRangeLength < 1 || options.MinRunRangeLength > options.MaxRunRangeLength) {
+        throw std::logic_error(thisFunc + "Run range length range should be 1 <= min <= max");
+    }
+    if(options.Variations < 1) throw std::logic_error(thisFunc + "Variations < 1 (default is one of them)");
+    if(options.VariationDepth < 0 || options.VariationDepth > 63) throw std::logic_error(thisFunc + "VariationDepth should be in [0, 63]");
+    if(options.Variations > 1 && options.VariationDepth < 1) throw std::logic_error(thisFunc + "VariationDepth should be >= 1 for variations besides default");
+    if(options.MinAssignments < 1 || options.MinAssignments > options.MaxAssignments) {
+        throw std::logic_error(thisFunc + "Assignments range should be 1 <= min <= max");
+    }
+    if(options.IntColumnsShare < 0 || options.StringColumnsShare < 0 || options.IntColumnsShare + options.StringColumnsShare > 1) {
+        throw std::logic_error(thisFunc + "Column type shares should be >= 0 with the sum <= 1");
+    }
+}
+
+
+//______________________________________________________________________________
+SyntheticDatabaseStats SyntheticDatabase::Generate(const std::string& filePath)
+{
+    FILE* existingFile = fopen(filePath.c_str(), "rb");
+    if(existingFile) {
+        fclose(existingFile);
+        throw std::runtime_error("SyntheticDatabase::Generate. File already exists: " + filePath);
+    }
+
+    sqlite3* database = nullptr;
+    if(sqlite3_open_v2(filePath.c_str(), &database, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr) != SQLITE_OK) { // NOLINT(hicpp-signed-bitwise)
+        string error = "SyntheticDatabase::Generate. Can't create " + filePath + ": " + sqlite3_errmsg(database);
+        sqlite3_close(database);
+        throw std::runtime_error(error);
+    }
+
+    const SyntheticDatabaseOptions& options = mOptions;
+    SyntheticRandom random(options.Seed);
+    SyntheticDatabaseStats stats;
+    string baseTime = FormatTime(cBaseTime);
+
+    try
+    {
+        // The file is new, nothing to recover if writing fails
+        ExecuteSql(database, "PRAGMA journal_mode = OFF");
+        ExecuteSql(database, "PRAGMA synchronous = OFF");
+        ExecuteSql(database, "BEGIN");
+        ExecuteSql(database, cSchemaSql);
+
+        SQLiteStatement versionQuery(database, "INSERT INTO `schemaVersions` (`id`, `schemaVersion`) VALUES (1, ?1)");
+        versionQuery.BindInt32(1, cSchemaVersion);
+        versionQuery.Execute([](uint64_t) {});
+
+        SQLiteStatement userQuery(database,
+            "INSERT INTO `users` (`id`, `created`, `name`, `roles`, `info`) VALUES (1, ?1, 'anonymous', '', 'Default user')");
+        userQuery.BindString(1, baseTime);
+        userQuery.Execute([](uint64_t) {});
+
+        // Variations. The first VariationDepth ones make the longest chain, the others get random parents
+        SQLiteStatement variationQuery(database,
+            "INSERT INTO `variations` (`id`, `created`, `modified`, `name`, `description`, `parentId`) VALUES (?1, ?2, ?2, ?3, ?4, ?5)");
+        vector<int> variationDepths(options.Variations + 1, 0);    //by id
+        vector<int64_t> shallowVariations;                          //ids of variations which may have children
+        for(int64_t id = 1; id <= options.Variations; id++) {
+            int64_t parentId = 0;
+            char name[16];
+            if(id == cDefaultVariationId) {
+                snprintf(name, sizeof(name), "default");
+            }
+            else {
+                parentId = id - 1 <= options.VariationDepth ? id - 1 : shallowVariations[random.Uniform(0, static_cast<int64_t>(shallowVariations.size()) - 1)];
+                variationDepths[id] = variationDepths[parentId] + 1;
+                snprintf(name, sizeof(name), "var%04d", static_cast<int>(id - 1));
+            }
+            if(variationDepths[id] < options.VariationDepth) shallowVariations.push_back(id);
+
+            variationQuery.BindInt64(1, id);
+            variationQuery.BindString(2, baseTime);
+            variationQuery.BindString(3, name);
+            variationQuery.BindString(4, "Synthetic variation");
+            variationQuery.BindInt64(5, parentId);
+            variationQuery.Execute([](uint64_t) {});
+
+            stats.Variations++;
+            if(variationDepths[id] > stats.MaxVariationDepth || id == cDefaultVariationId) {
+                stats.MaxVariationDepth = variationDepths[id];
+                stats.DeepestVariation = name;
+            }
+        }
+
+        // Directories tree
+        SQLiteStatement directoryQuery(database,
+            "INSERT INTO `directories` (`id`, `created`, `modified`, `name`, `parentId`, `comment`) VALUES (?1, ?2, ?2, ?3, ?4, '')");
+        for(int64_t id = 1; id <= options.Directories; id++) {
+            char name[16];
+            snprintf(name, sizeof(name), "dir%04d", static_cast<int>(id - 1));
+            directoryQuery.BindInt64(1, id);
+            directoryQuery.BindString(2, baseTime);
+            directoryQuery.BindString(3, name);
+            directoryQuery.BindInt64(4, random.Uniform(0, id - 1));      //0 is the root
+            directoryQuery.Execute([](uint64_t) {});
+            stats.Directories++;
+        }
+
+        // Run ranges are shared by assignments with the same runs
+        SQLiteStatement runRangeQuery(database,
+            "INSERT INTO `runRanges` (`id`, `created`, `modified`, `name`, `runMin`, `runMax`, `comment`) VALUES (?1, ?2, ?2, ?3, ?4, ?5, '')");
+        map<pair<int64_t, int64_t>, int64_t> runRangeIds;
+        auto getRunRangeId = [&](int64_t runMin, int64_t runMax, const char* name) {
+            auto found = runRangeIds.find(make_pair(runMin, runMax));
+            if(found != runRangeIds.end()) return found->second;
+
+            int64_t id = static_cast<int64_t>(runRangeIds.size()) + 1;
+            runRangeQuery.BindInt64(1, id);
+            runRangeQuery.BindString(2, baseTime);
+            runRangeQuery.BindString(3, name);
+            runRangeQuery.BindInt64(4, runMin);
+            runRangeQuery.BindInt64(5, runMax);
+            runRangeQuery.Execute([](uint64_t) {});
+            runRangeIds[make_pair(runMin, runMax)] = id;
+            stats.RunRanges++;
+            return id;
+        };
+        getRunRangeId(0, numeric_limits<int32_t>::max(), "all");      //cAllRunsRangeId
+
+        // Tables with their columns and assignments
+        SQLiteStatement tableQuery(database,
+            "INSERT INTO `typeTables` (`id`, `created`, `modified`, `directoryId`, `name`, `nRows`, `nColumns`, `nAssignments`, `comment`) "
+            "VALUES (?1, ?2, ?2, ?3, ?4, ?5, ?6, ?7, 'Synthetic table')");
+        SQLiteStatement columnQuery(database,
+            "INSERT INTO `columns` (`created`, `modified`, `name`, `typeId`, `columnType`, `order`, `comment`) VALUES (?1, ?1, ?2, ?3, ?4, ?5, '')");
+        SQLiteStatement constantSetQuery(database,
+            "INSERT INTO `constantSets` (`id`, `created`, `modified`, `vault`, `constantTypeId`) VALUES (?1, ?2, ?2, ?3, ?4)");
+        SQLiteStatement assignmentQuery(database,
+            "INSERT INTO `assignments` (`id`, `created`, `modified`, `variationId`, `runRangeId`, `constantSetId`, `comment`) "
+            "VALUES (?1, ?2, ?2, ?3, ?4, ?5, '')");
+
+        enum ColumnKind { cDouble, cInt, cString };
+        static const char* const cColumnTypeNames[] = {"double", "int", "string"};
+
+        int64_t assignmentId = 0;
+        string vault;
+        char cell[32];
+        for(int64_t tableId = 1; tableId <= options.Tables; tableId++) {
+            int64_t columns = random.Uniform(options.MinColumns, options.MaxColumns);
+            int64_t rows = random.LogUniform(options.MinRows, options.MaxRows);
+            if(rows * columns > options.MaxCells) rows = options.MaxCells / columns;
+            int64_t assignments = random.Uniform(options.MinAssignments, options.MaxAssignments);
+            int64_t directoryId = options.Directories ? random.Uniform(1, options.Directories) : 0;
+
+            char name[16];
+            snprintf(name, sizeof(name), "table%05d", static_cast<int>(tableId - 1));
+            tableQuery.BindInt64(1, tableId);
+            tableQuery.BindString(2, baseTime);
+            tableQuery.BindInt64(3, directoryId);
+            tableQuery.BindString(4, name);
+            tableQuery.BindInt64(5, rows);
+            tableQuery.BindInt64(6, columns);
+            tableQuery.BindInt64(7, assignments);
+            tableQuery.Execute([](uint64_t) {});
+            stats.Tables++;
+
+            vector<ColumnKind> kinds(columns);
+            for(int64_t column = 0; column < columns; column++) {
+                double share = random.Unit();
+                kinds[column] = share < options.IntColumnsShare ? cInt :
+                                share < options.IntColumnsShare + options.StringColumnsShare ? cString : cDouble;
+
+                columnQuery.BindString(1, baseTime);
+                columnQuery.BindString(2, "c" + to_string(column));
+                columnQuery.BindInt64(3, tableId);
+                columnQuery.BindString(4, cColumnTypeNames[kinds[column]]);
+                columnQuery.BindInt64(5, column);
+                columnQuery.Execute([](uint64_t) {});
+                stats.Columns++;
+            }
+
+            for(int64_t assignmentIndex = 0; assignmentIndex < assignments; assignmentIndex++) {
+                int64_t variationId = cDefaultVariationId;
+                int64_t runRangeId = cAllRunsRangeId;
+                if(assignmentIndex > 0) {
+                    if(options.Variations > 1 && random.Unit() >= 0.5) variationId = random.Uniform(2, options.Variations);
+                    int64_t runMin = random.Uniform(0, options.Runs - 1);
+                    int64_t runMax = runMin + random.LogUniform(options.MinRunRangeLength, options.MaxRunRangeLength) - 1;
+                    if(runMax > numeric_limits<int32_t>::max()) runMax = numeric_limits<int32_t>::max();
+                    runRangeId = getRunRangeId(runMin, runMax, "");
+                }
+
+                vault.clear();
+                for(int64_t row = 0; row < rows; row++) {
+                    for(int64_t column = 0; column < columns; column++) {
+                        switch(kinds[column]) {
+                            case cDouble: snprintf(cell, sizeof(cell), "%.6g", (random.Unit() * 2 - 1) * 1000); break;
+                            case cInt:    snprintf(cell, sizeof(cell), "%d", static_cast<int>(random.Uniform(-100000, 100000))); break;
+                            case cString: snprintf(cell, sizeof(cell), "s%06x", static_cast<unsigned>(random.Next() & 0xffffff)); break;
+                        }
+                        if(row || column) vault += '|';
+                        vault += cell;
+                    }
+                }
+
+                assignmentId++;
+                string created = FormatTime(cBaseTime + assignmentId * cAssignmentsInterval);
+
+                constantSetQuery.BindInt64(1, assignmentId);
+                constantSetQuery.BindString(2, created);
+                constantSetQuery.BindString(3, vault);
+                constantSetQuery.BindInt64(4, tableId);
+                constantSetQuery.Execute([](uint64_t) {});
+
+                assignmentQuery.BindInt64(1, assignmentId);
+                assignmentQuery.BindString(2, created);
+                assignmentQuery.BindInt64(3, variationId);
+                assignmentQuery.BindInt64(4, runRangeId);
+                assignmentQuery.BindInt64(5, assignmentId);
+                assignmentQuery.Execute([](uint64_t) {});
+
+                stats.Assignments++;
+                stats.Cells += static_cast<uint64_t>(rows * columns);
+                stats.VaultBytes += vault.size();
+            }
+        }
+
+        ExecuteSql(database, "COMMIT");
+    }
+    catch (...)
+    {
+        sqlite3_close(database);
+        throw;
+    }
+
+    sqlite3_close(database);
+    return stats;
+}
+
+}
@@ -0,0 +1,85 @@
+#ifndef _SyntheticDatabase_
+#define _SyntheticDatabase_
+
+#include <stdint.h>
+#include <string>
+
+namespace ccdb
+{
+    /** @brief Sizes of a synthetic database. @see SyntheticDatabase
+     *
+     * Ranges are [Min, Max]. Rows and run range lengths are log-uniform in their ranges,
+     * so there are many small tables (ranges) and some big ones as in production databases
+     */
+    struct SyntheticDatabaseOptions
+    {
+        uint64_t Seed = 1;                  /// The same seed and options give the same database
+
+        int Directories = 20;               /// Directories tree (each directory has a random parent)
+        int Tables = 200;                   /// Type tables in random directories
+        int MinColumns = 1;
+        int MaxColumns = 10;
+        int MinRows = 1;
+        int MaxRows = 1000;
+        int64_t MaxCells = 1000000;         /// Rows of a table are cut so rows x columns <= MaxCells
+
+        int Runs = 100000;                  /// Run ranges start in [0, Runs)
+        int MinRunRangeLength = 1;
+        int MaxRunRangeLength = 10000;
+
+        int Variations = 10;                /// Including default
+        int VariationDepth = 3;             /// The longest chain of parents below default. It is made if there are enough variations
+
+        int MinAssignments = 1;             /// Assignments of each table (the first one is default variation for all runs)
+        int MaxAssignments = 20;
+
+        double IntColumnsShare = 0.2;       /// Column types: int, string, the rest are double
+        double StringColumnsShare = 0.05;
+    };
+
+
+    /** @brief What was written by @see SyntheticDatabase::Generate */
+    struct SyntheticDatabaseStats
+    {
+        uint64_t Directories = 0;
+        uint64_t Tables = 0;
+        uint64_t Columns = 0;
+        uint64_t Variations = 0;
+        uint64_t RunRanges = 0;
+        uint64_t Assignments = 0;
+        uint64_t Cells = 0;                 /// Of all constant sets
+        uint64_t VaultBytes = 0;
+        int MaxVariationDepth = 0;
+        std::string DeepestVariation;       /// Name of the variation with the longest parents chain
+    };
+
+
+    /** @brief Writes a CCDB SQLite database (schema v2) with generated content for scalability tests
+     *
+     *  - directories dir0000... make a tree under the root
+     *  - type tables table00000... with columns c0, c1... of double, int and string types
+     *  - variations var0001... with parents chains up to VariationDepth under default
+     *  - run ranges of random starts and lengths, shared by assignments with the same range
+     *  - each table has the first assignment in default for all runs (so every run resolves)
+     *    and others in random variations and run ranges, each with its own constant set
+     *
+     * Random numbers are made by std::mt19937_64 without std distributions, so the content only
+     * depends on the seed and options, not on the standard library. Creation times are fixed too.
+     */
+    class SyntheticDatabase
+    {
+    public:
+        explicit SyntheticDatabase(const SyntheticDatabaseOptions& options);
+
+        /** @brief Creates a new SQLite file. Throws std::runtime_error if the file exists or on SQLite errors */
+        SyntheticDatabaseStats Generate(const std::string& filePath);
+
+        /** @brief Checks the options. Throws std::logic_error with the reason if they are not consistent */
+        static void ValidateOptions(const SyntheticDatabaseOptions& options);
+
+    private:
+        SyntheticDatabaseOptions mOptions;
+    };
+}
+
+#endif // _SyntheticDatabase_
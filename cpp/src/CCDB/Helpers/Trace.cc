@@ -0,0 +1,310 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+#include "CCDB/Helpers/Trace.h"
+
+using namespace std;
+
+namespace ccdb
+{
+
+std::atomic<bool> Trace::sIsEnabled(false);
+
+
+//______________________________________________________________________________
+// Each thread writes its own buffer. The buffer mutex is taken by the owner thread on each record
+// (it is not contended then) and by the readers (GetEvents, Summarize, Clear).
+// Buffers are kept by the registry after their threads exit, so their events are written at exit too.
+
+namespace
+{
+    /** Events and per phase counters of one thread */
+    struct TraceBuffer
+    {
+        std::mutex Mutex;
+        std::vector<TraceEvent> Events;     /// Ring of BufferEvents
+        uint64_t WrittenCount = 0;          /// All events written. The next one goes to WrittenCount % size
+        uint32_t ThreadIndex = 0;
+        uint64_t PhaseCounts[TracePhasesCount] = {};
+        uint64_t PhaseTotalNs[TracePhasesCount] = {};
+        uint64_t PhaseMaxNs[TracePhasesCount] = {};
+    };
+
+    /** Buffers of all threads */
+    struct TraceRegistry
+    {
+        std::mutex Mutex;
+        std::vector<std::shared_ptr<TraceBuffer> > Buffers;
+    };
+
+    TraceRegistry& GetRegistry()
+    {
+        static TraceRegistry registry;
+        return registry;
+    }
+
+    thread_local std::shared_ptr<TraceBuffer> tBuffer;
+
+    TraceBuffer& GetThreadBuffer()
+    {
+        if(!tBuffer) {
+            auto buffer = std::make_shared<TraceBuffer>();
+            buffer->Events.resize(Trace::BufferEvents);
+
+            TraceRegistry& registry = GetRegistry();
+            lock_guard<mutex> lock(registry.Mutex);
+            registry.Buffers.push_back(buffer);
+            buffer->ThreadIndex = static_cast<uint32_t>(registry.Buffers.size());
+            tBuffer = buffer;
+        }
+        return *tBuffer;
+    }
+
+    /** Copies of all buffers to read them without holding the registry lock for long */
+    std::vector<std::shared_ptr<TraceBuffer> > GetBuffers()
+    {
+        TraceRegistry& registry = GetRegistry();
+        lock_guard<mutex> lock(registry.Mutex);
+        return registry.Buffers;
+    }
+
+    /** Escapes a string for JSON */
+    string JsonString(const char* text)
+    {
+        string result("\"");
+        for(const char* symbol = text; *symbol; symbol++) {
+            if(*symbol == '"' || *symbol == '\\') {
+                result += '\\';
+                result += *symbol;
+            }
+            else if(static_cast<unsigned char>(*symbol) < 0x20) {
+                char escaped[8];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", *symbol);
+                result += escaped;
+            }
+            else {
+                result += *symbol;
+            }
+        }
+        return result + "\"";
+    }
+
+
+    /** Reads CCDB_TRACE when the library is loaded and writes the trace at exit */
+    class TraceEnvironment
+    {
+    public:
+        TraceEnvironment()
+        {
+            GetRegistry();      // constructed before, so destroyed after this object
+
+            const char* mode = getenv("CCDB_TRACE");
+            if(!mode || !*mode || strcmp(mode, "0") == 0) return;
+
+            mIsEvents = strcmp(mode, "events") == 0;
+            mIsSummary = !mIsEvents;
+            const char* filePath = getenv("CCDB_TRACE_FILE");
+            if(filePath) mFilePath = filePath;
+            Trace::Enable(true);
+        }
+
+        ~TraceEnvironment()
+        {
+            if(!mIsEvents && !mIsSummary) return;
+
+            ofstream file;
+            if(!mFilePath.empty()) file.open(mFilePath);
+            ostream& stream = file.is_open() ? static_cast<ostream&>(file) : cerr;
+            if(mIsEvents) Trace::WriteEvents(stream);
+            else Trace::WriteSummary(stream);
+            stream.flush();
+        }
+
+    private:
+        bool mIsEvents = false;
+        bool mIsSummary = false;
+        string mFilePath;
+    };
+
+    TraceEnvironment gTraceEnvironment;
+}
+
+
+//______________________________________________________________________________
+void Trace::Enable(bool value)
+{
+    sIsEnabled.store(value);
+}
+
+
+//______________________________________________________________________________
+uint64_t Trace::NowNs()
+{
+    using namespace std::chrono;
+    return static_cast<uint64_t>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+
+//______________________________________________________________________________
+void Trace::Record(TracePhase phase, uint64_t startNs, uint64_t durationNs, const char* detail, size_t detailSize)
+{
+    TraceBuffer& buffer = GetThreadBuffer();
+    size_t phaseIndex = static_cast<size_t>(phase);
+
+    lock_guard<mutex> lock(buffer.Mutex);
+    TraceEvent& event = buffer.Events[buffer.WrittenCount % buffer.Events.size()];
+    event.StartNs = startNs;
+    event.DurationNs = durationNs;
+    event.ThreadIndex = buffer.ThreadIndex;
+    event.Phase = phase;
+    detailSize = detail ? min(detailSize, TraceEvent::DetailSize - 1) : 0;
+    if(detailSize) memcpy(event.Detail, detail, detailSize);
+    event.Detail[detailSize] = '\0';
+    buffer.WrittenCount++;
+
+    buffer.PhaseCounts[phaseIndex]++;
+    buffer.PhaseTotalNs[phaseIndex] += durationNs;
+    buffer.PhaseMaxNs[phaseIndex] = max(buffer.PhaseMaxNs[phaseIndex], durationNs);
+}
+
+
+//______________________________________________________________________________
+std::vector<TraceEvent> Trace::GetEvents()
+{
+    vector<TraceEvent> events;
+    for(auto& buffer: GetBuffers()) {
+        lock_guard<mutex> lock(buffer->Mutex);
+        size_t size = buffer->Events.size();
+        uint64_t first = buffer->WrittenCount > size ? buffer->WrittenCount - size : 0;
+        for(uint64_t i = first; i < buffer->WrittenCount; i++) events.push_back(buffer->Events[i % size]);
+    }
+
+    stable_sort(events.begin(), events.end(), [](const TraceEvent& lhs, const TraceEvent& rhs) { return lhs.StartNs < rhs.StartNs; });
+    return events;
+}
+
+
+//______________________________________________________________________________
+std::vector<TracePhaseSummary> Trace::Summarize()
+{
+    vector<TracePhaseSummary> summaries(TracePhasesCount);
+    for(size_t phaseIndex = 0; phaseIndex < TracePhasesCount; phaseIndex++) {
+        summaries[phaseIndex] = TracePhaseSummary{static_cast<TracePhase>(phaseIndex), 0, 0, 0, 0, 0};
+    }
+
+    for(auto& buffer: GetBuffers()) {
+        lock_guard<mutex> lock(buffer->Mutex);
+        for(size_t phaseIndex = 0; phaseIndex < TracePhasesCount; phaseIndex++) {
+            summaries[phaseIndex].Count += buffer->PhaseCounts[phaseIndex];
+            summaries[phaseIndex].TotalNs += buffer->PhaseTotalNs[phaseIndex];
+            summaries[phaseIndex].MaxNs = max(summaries[phaseIndex].MaxNs, buffer->PhaseMaxNs[phaseIndex]);
+        }
+    }
+
+    vector<vector<uint64_t> > durations(TracePhasesCount);
+    for(const TraceEvent& event: GetEvents()) durations[static_cast<size_t>(event.Phase)].push_back(event.DurationNs);
+    for(size_t phaseIndex = 0; phaseIndex < TracePhasesCount; phaseIndex++) {
+        vector<uint64_t>& phaseDurations = durations[phaseIndex];
+        if(phaseDurations.empty()) continue;
+
+        auto p50 = phaseDurations.begin() + phaseDurations.size() / 2;
+        nth_element(phaseDurations.begin(), p50, phaseDurations.end());
+        summaries[phaseIndex].P50Us = static_cast<double>(*p50) / 1000.0;
+
+        auto p99 = phaseDurations.begin() + (phaseDurations.size() * 99) / 100;
+        nth_element(phaseDurations.begin(), p99, phaseDurations.end());
+        summaries[phaseIndex].P99Us = static_cast<double>(*p99) / 1000.0;
+    }
+    return summaries;
+}
+
+
+//______________________________________________________________________________
+uint64_t Trace::GetDroppedEventsCount()
+{
+    uint64_t droppedCount = 0;
+    for(auto& buffer: GetBuffers()) {
+        lock_guard<mutex> lock(buffer->Mutex);
+        if(buffer->WrittenCount > buffer->Events.size()) droppedCount += buffer->WrittenCount - buffer->Events.size();
+    }
+    return droppedCount;
+}
+
+
+//______________________________________________________________________________
+void Trace::Clear()
+{
+    for(auto& buffer: GetBuffers()) {
+        lock_guard<mutex> lock(buffer->Mutex);
+        buffer->WrittenCount = 0;
+        for(size_t phaseIndex = 0; phaseIndex < TracePhasesCount; phaseIndex++) {
+            buffer->PhaseCounts[phaseIndex] = 0;
+            buffer->PhaseTotalNs[phaseIndex] = 0;
+            buffer->PhaseMaxNs[phaseIndex] = 0;
+        }
+    }
+}
+
+
+//______________________________________________________________________________
+void Trace::WriteEvents(std::ostream& stream)
+{
+    char times[64];
+    for(const TraceEvent& event: GetEvents()) {
+        snprintf(times, sizeof(times), "\"start_us\":%.3f,\"elapsed_us\":%.3f",
+                 static_cast<double>(event.StartNs) / 1000.0, static_cast<double>(event.DurationNs) / 1000.0);
+        stream<<"CCDB_TRACE:{\"thread\":"<<event.ThreadIndex
+              <<",\"phase\":\""<<GetPhaseName(event.Phase)<<"\""
+              <<",\"detail\":"<<JsonString(event.Detail)
+              <<","<<times<<"}\n";
+    }
+}
+
+
+//______________________________________________________________________________
+void Trace::WriteSummary(std::ostream& stream)
+{
+    char line[160];
+    snprintf(line, sizeof(line), "CCDB trace summary (%zu threads, %llu events dropped from buffers)\n",
+             GetBuffers().size(), static_cast<unsigned long long>(GetDroppedEventsCount()));
+    stream<<line;
+    snprintf(line, sizeof(line), "%-12s %10s %12s %10s %10s %10s %10s\n", "phase", "count", "total ms", "mean us", "p50 us", "p99 us", "max us");
+    stream<<line;
+
+    for(const TracePhaseSummary& summary: Summarize()) {
+        if(!summary.Count) continue;
+        snprintf(line, sizeof(line), "%-12s %10llu %12.3f %10.2f %10.2f %10.2f %10.2f\n",
+                 GetPhaseName(summary.Phase), static_cast<unsigned long long>(summary.Count),
+                 static_cast<double>(summary.TotalNs) / 1e6,
+                 static_cast<double>(summary.TotalNs) / static_cast<double>(summary.Count) / 1000.0,
+                 summary.P50Us, summary.P99Us, static_cast<double>(summary.MaxNs) / 1000.0);
+        stream<<line;
+    }
+}
+
+
+//______________________________________________________________________________
+const char* Trace::GetPhaseName(TracePhase phase)
+{
+    switch(phase)
+    {
+        case TracePhase::Request:   return "request";
+        case TracePhase::Parse:     return "parse";
+        case TracePhase::Metadata:  return "metadata";
+        case TracePhase::Sql:       return "sql";
+        case TracePhase::BlobSplit: return "blob_split";
+        case TracePhase::Decode:    return "decode";
+        case TracePhase::Cache:     return "cache";
+        case TracePhase::Prefetch:  return "prefetch";
+    }
+    return "unknown";
+}
+
+} //namespace ccdb
@@ -0,0 +1,147 @@
+#ifndef _Trace_
+#define _Trace_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ccdb
+{
+    /** @brief What a traced span measures */
+    enum class TracePhase: uint8_t
+    {
+        Request,        /// Loading of an assignment from the provider (a cache miss or no cache)
+        Parse,          /// Parsing of a namepath to the request
+        Metadata,       /// Loading of directories or of the catalog (type tables, columns, variations)
+        Sql,            /// Execution of an SQL query
+        BlobSplit,      /// Splitting of a data blob to cells
+        Decode,         /// Filling of the user containers or rows from an assignment
+        Cache,          /// Cache lookup
+        Prefetch        /// Loading of many assignments at once
+    };
+
+    static const size_t TracePhasesCount = 8;
+
+
+    /** @brief One traced span */
+    struct TraceEvent
+    {
+        static const size_t DetailSize = 96;    /// Longer details are cut
+
+        uint64_t StartNs;           /// Steady clock time (@see Trace::NowNs)
+        uint64_t DurationNs;
+        uint32_t ThreadIndex;       /// Threads are numbered from 1 in the order they record their first span
+        TracePhase Phase;
+        char Detail[DetailSize];    /// Zero terminated namepath, query, ... Empty if the span has no detail
+    };
+
+
+    /** @brief Spans of one phase of all threads. @see Trace::Summarize */
+    struct TracePhaseSummary
+    {
+        TracePhase Phase;
+        uint64_t Count;             /// All spans recorded (including ones dropped from the buffers)
+        uint64_t TotalNs;
+        uint64_t MaxNs;
+        double P50Us;               /// Percentiles of spans that are still in the buffers
+        double P99Us;
+    };
+
+
+    /** @brief Runtime switchable tracing of CCDB internals
+     *
+     * Spans (@see TraceSpan) of the phases of a request are recorded to a ring buffer of the thread that
+     * makes them, so threads don't contend. When a buffer is full the oldest events are overwritten,
+     * but per phase counters (@see Summarize) keep counting. While tracing is off a span costs
+     * one relaxed atomic load.
+     *
+     * Tracing is switched by Enable or by CCDB_TRACE environment variable that is read when the library is loaded:
+     *     CCDB_TRACE=summary (or 1)  - the phases summary is written at exit
+     *     CCDB_TRACE=events          - all buffered events are written at exit as CCDB_TRACE:{json} lines
+     * The output goes to stderr or to the file given by CCDB_TRACE_FILE. python/ccdb_cpp_perf.py reads events.
+     *
+     * @remark all functions are thread safe
+     */
+    class Trace
+    {
+    public:
+        static const size_t BufferEvents = 4096;   /// Events kept per thread
+
+        /** @brief True if spans are recorded */
+        static bool IsEnabled() { return sIsEnabled.load(std::memory_order_relaxed); }
+
+        /** @brief Switches recording on or off. Recorded events are kept */
+        static void Enable(bool value);
+
+        /** @brief Adds the event to the buffer of the calling thread. detail may be nullptr */
+        static void Record(TracePhase phase, uint64_t startNs, uint64_t durationNs, const char* detail, size_t detailSize);
+
+        /** @brief Steady clock time in nanoseconds */
+        static uint64_t NowNs();
+
+        /** @brief Buffered events of all threads ordered by start time */
+        static std::vector<TraceEvent> GetEvents();
+
+        /** @brief Counts, times and latency percentiles of each phase */
+        static std::vector<TracePhaseSummary> Summarize();
+
+        /** @brief Number of events overwritten in full buffers */
+        static uint64_t GetDroppedEventsCount();
+
+        /** @brief Removes recorded events and resets counters */
+        static void Clear();
+
+        /** @brief Writes buffered events, one CCDB_TRACE:{json} line per event */
+        static void WriteEvents(std::ostream& stream);
+
+        /** @brief Writes the phases summary as a table */
+        static void WriteSummary(std::ostream& stream);
+
+        /** @brief Phase name: request, parse, metadata, sql, blob_split, decode, cache, prefetch */
+        static const char* GetPhaseName(TracePhase phase);
+
+    private:
+        static std::atomic<bool> sIsEnabled;
+    };
+
+
+    /** @brief Records the time from its construction to its destruction as a span of the phase
+     *
+     * @code
+     *     TraceSpan span(TracePhase::Parse, namepath);
+     * @endcode
+     * @warning detail must stay alive and unchanged until the span is destroyed
+     */
+    class TraceSpan
+    {
+    public:
+        explicit TraceSpan(TracePhase phase): TraceSpan(phase, nullptr, 0) {}
+        TraceSpan(TracePhase phase, const std::string& detail): TraceSpan(phase, detail.data(), detail.size()) {}
+        TraceSpan(TracePhase phase, const char* detail, size_t detailSize):
+            mStartNs(Trace::IsEnabled() ? Trace::NowNs() : 0),
+            mDetail(detail),
+            mDetailSize(detailSize),
+            mPhase(phase)
+        {
+        }
+
+        ~TraceSpan()
+        {
+            if(mStartNs) Trace::Record(mPhase, mStartNs, Trace::NowNs() - mStartNs, mDetail, mDetailSize);
+        }
+
+    private:
+        TraceSpan(const TraceSpan& rhs);
+        TraceSpan& operator=(const TraceSpan& rhs);
+
+        uint64_t mStartNs;          /// 0 if tracing was off at the start
+        const char* mDetail;
+        size_t mDetailSize;
+        TracePhase mPhase;
+    };
+}
+
+#endif // _Trace_
@@ -0,0 +1,62 @@
+#include <stdexcept>
+
+#include "CCDB/Helpers/WorkerPool.h"
+
+using namespace std;
+
+namespace ccdb
+{
+
+//______________________________________________________________________________
+WorkerPool::WorkerPool(size_t threadsCount)
+{
+    if(threadsCount == 0) throw std::logic_error("WorkerPool::WorkerPool. Number of threads must be greater than 0");
+
+    mIsStopping = false;
+    mThreads.reserve(threadsCount);
+    for(size_t i = 0; i < threadsCount; i++) mThreads.emplace_back(&WorkerPool::Run, this);
+}
+
+
+//______________________________________________________________________________
+WorkerPool::~WorkerPool()
+{
+    {
+        lock_guard<mutex> lock(mMutex);
+        mIsStopping = true;
+    }
+    mTaskAdded.notify_all();
+    for(thread& worker: mThreads) worker.join();
+}
+
+
+//______________________________________________________________________________
+void WorkerPool::Submit(std::function<void()> task)
+{
+    {
+        lock_guard<mutex> lock(mMutex);
+        if(mIsStopping) throw std::logic_error("WorkerPool::Submit. The pool is being destroyed");
+        mTasks.push_back(std::move(task));
+    }
+    mTaskAdded.notify_one();
+}
+
+
+//______________________________________________________________________________
+void WorkerPool::Run()
+{
+    for(;;)
+    {
+        std::function<void()> task;
+        {
+            unique_lock<mutex> lock(mMutex);
+            mTaskAdded.wait(lock, [this]() { return mIsStopping || !mTasks.empty(); });
+            if(mTasks.empty()) return;      //stopping and nothing left to do
+            task = std::move(mTasks.front());
+            mTasks.pop_front();
+        }
+        task();
+    }
+}
+
+}
@@ -0,0 +1,47 @@
+#ifndef _WorkerPool_
+#define _WorkerPool_
+
+#include <stddef.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ccdb
+{
+    /** @brief Small fixed size pool of threads that run submitted tasks in the order of submission
+     *
+     * Used by Calibration to run asynchronous requests (@see Calibration::GetCalibAsync).
+     * Threads are started in the constructor. The destructor runs all the tasks that are
+     * already submitted and joins the threads.
+     * @remark Submit is thread safe
+     */
+    class WorkerPool
+    {
+    public:
+        explicit WorkerPool(size_t threadsCount);
+        ~WorkerPool();
+
+        /** @brief Adds the task to the queue. Exceptions of the task must be handled by the task itself */
+        void Submit(std::function<void()> task);
+
+        /** @brief Number of threads of the pool */
+        size_t GetThreadsCount() const { return mThreads.size(); }
+
+    private:
+        WorkerPool(const WorkerPool& rhs);
+        WorkerPool& operator=(const WorkerPool& rhs);
+
+        void Run();     /// Thread body. Runs tasks until the pool is stopped and the queue is empty
+
+        std::vector<std::thread> mThreads;
+        std::deque<std::function<void()> > mTasks;
+        std::mutex mMutex;                      /// Guards mTasks and mIsStopping
+        std::condition_variable mTaskAdded;
+        bool mIsStopping;
+    };
+}
+
+#endif // _WorkerPool_
@@ -7,9 +7,12 @@
 #include <vector>
 #include <sstream>
 #include <assert.h>
+#include <string.h>
 
 #include "CCDB/Model/Assignment.h"
+#include "CCDB/Model/RunRange.h"
 #include "CCDB/Helpers/StringUtils.h"
+#include "CCDB/Helpers/Trace.h"
 #include "CCDB/Globals.h"
 
 using namespace ccdb;
@@ -32,12 +35,34 @@ ccdb::Assignment::Assignment()
 	mEventRange = NULL;		// Event range object, is NULL if not set
 	mVariation  = NULL;		// Variation object, is NULL if not set
 	mTypeTable  = NULL;		// Reference to type table
+	mIsTypeTableOwner = false;
+	mIsRunRangeOwner = false;
+	mIsDoubleDataDecoded = false;
+	mIsIntDataDecoded = false;
+	mIsDoubleColumnDataDecoded = false;
+	mIsIntColumnDataDecoded = false;
+	mDecodedBytes = 0;
+	mDataBytes = 0;
 }
 
 
 //______________________________________________________________________________
 ccdb::Assignment::~Assignment() {
-	// TODO Auto-generated destructor stub
+	if(mIsTypeTableOwner) delete mTypeTable;
+	if(mIsRunRangeOwner) delete mRunRange;
+}
+
+
+//______________________________________________________________________________
+size_t ccdb::Assignment::GetMemoryUsage() const
+{
+	size_t bytes = sizeof(Assignment) + mComment.capacity() + mDataBytes + mDecodedBytes;
+
+	if(mIsTypeTableOwner && mTypeTable) {
+		bytes += sizeof(ConstantsTypeTable) + mTypeTable->GetColumns().size() * (sizeof(ConstantsTypeColumn) + sizeof(void*));
+	}
+	if(mIsRunRangeOwner && mRunRange) bytes += sizeof(RunRange);
+	return bytes;
 }
 
 //______________________________________________________________________________
@@ -160,9 +185,19 @@ RunRange * ccdb::Assignment::GetRunRange() const
 }
 
 //______________________________________________________________________________
-void ccdb::Assignment::SetRunRange( RunRange * val )
+void ccdb::Assignment::SetRunRange( RunRange * val, bool isOwner /*=false*/ )
 {
+	if(mIsRunRangeOwner && mRunRange != val) delete mRunRange;
 	mRunRange = val;
+	mIsRunRangeOwner = isOwner;
+}
+
+//______________________________________________________________________________
+void ccdb::Assignment::SetRunRange( int runMin, int runMax )
+{
+	RunRange *runRange = new RunRange();
+	runRange->SetRange(runMin, runMax);
+	SetRunRange(runRange, /*isOwner*/ true);
 }
 
 //______________________________________________________________________________
@@ -230,10 +265,22 @@ vector<map<string,string> > ccdb::Assignment::GetMappedData() const
 void ccdb::Assignment::GetMappedData(vector<map<string, string> >& mappedData) const
 {
     assert(mTypeTable !=NULL); // it is DataProvider work
-    	
-	//fill data
-	MapData(mappedData, GetVectorData(), mTypeTable->GetColumnNames() );
-	
+
+	vector<string> columns = mTypeTable->GetColumnNames();
+	assert(columns.size() != 0);
+
+	//fill data directly from tokens
+	size_t rows = mTokens.size() / columns.size();
+	mappedData.reserve(mappedData.size() + rows);
+	for (size_t rowIter = 0; rowIter < rows; rowIter++)
+	{
+		map<string,string> line;
+		for (size_t colIter = 0; colIter < columns.size(); colIter++)
+		{
+			line[columns[colIter]] = string(GetToken(rowIter*columns.size() + colIter));
+		}
+		mappedData.push_back(std::move(line));
+	}
 }
 
 
@@ -263,8 +310,20 @@ void ccdb::Assignment::GetData(std::vector<std::vector<std::string> >& data) con
 	//clear before filling
 	data.clear();
 
-	//fill data
-	MapData(data, GetVectorData(), mTypeTable->GetColumnsCount());
+	size_t columnsNum = mTypeTable->GetColumnsCount();
+	if(mTokens.empty() || columnsNum == 0) return;
+
+	//fill data directly from tokens
+	size_t rows = mTokens.size() / columnsNum;
+	data.resize(rows);
+	for (size_t rowIter = 0; rowIter < rows; rowIter++)
+	{
+		data[rowIter].reserve(columnsNum);
+		for (size_t colIter = 0; colIter < columnsNum; colIter++)
+		{
+			data[rowIter].emplace_back(GetToken(rowIter*columnsNum + colIter));
+		}
+	}
 }
 
 
@@ -296,60 +355,267 @@ vector<string> ccdb::Assignment::GetVectorData() const
 //______________________________________________________________________________
 void ccdb::Assignment::GetVectorData(vector<string>& vectorData) const
 {
-	//split data
 	vectorData.clear();
-	auto iter = mVectorData.begin();
-	while (iter<mVectorData.end())
-	{	
-		vectorData.push_back(DecodeBlobSeparator(*iter));
-		iter++;
+	vectorData.reserve(mTokens.size());
+	for (size_t i = 0; i < mTokens.size(); i++)
+	{
+		vectorData.emplace_back(GetToken(i));
 	}
 }
 
+
 //______________________________________________________________________________
 void ccdb::Assignment::SetRawData(std::string val)
 {
-	mVectorData.clear();
-	mRows.clear();
-	mRawData = val;
+	ccdb::TraceSpan span(ccdb::TracePhase::BlobSplit);
+	mTokens.clear();
+	mDecodedTokensData.clear();
+	mRawData = std::move(val);
+
+	//typed data should be decoded again
+	mDoubleData.clear();
+	mIntData.clear();
+	mDoubleColumnData.clear();
+	mIntColumnData.clear();
+	mIsDoubleDataDecoded = false;
+	mIsIntDataDecoded = false;
+	mIsDoubleColumnDataDecoded = false;
+	mIsIntColumnDataDecoded = false;
+	mDecodedBytes = 0;
+
+	// Tokens are kept as offsets in mRawData. Empty tokens are skipped as StringUtils::Split does.
+	StringUtils::SplitOffsets(mRawData.data(), mRawData.size(), CCDB_DATA_BLOB_DELIMETER[0], mTokens);
+
+	// Only tokens with '&' may contain encoded '&delimiter;'. Such tokens are decoded to mDecodedTokensData
+	// and their offset is counted from the end of mRawData (@see GetToken).
+	const char* data = mRawData.data();
+	const size_t size = mRawData.size();
+	if(memchr(data, '&', size))
+	{
+		for (size_t i = 0; i < mTokens.size(); i++)
+		{
+			StringToken& token = mTokens[i];
+			if(!memchr(data + token.Offset, '&', token.Length)) continue;
 
-	mVectorData = StringUtils::Split(mRawData, CCDB_DATA_BLOB_DELIMETER);
-	for (size_t i = 0; i < mVectorData.size(); i++)
+			string decoded = DecodeBlobSeparator(mRawData.substr(token.Offset, token.Length));
+			token.Offset = static_cast<uint32_t>(size + mDecodedTokensData.size());
+			token.Length = static_cast<uint32_t>(decoded.size());
+			mDecodedTokensData += decoded;
+		}
+	}
+
+	//memory estimation for caches
+	mTokens.shrink_to_fit();
+	mDataBytes = mRawData.capacity() + mDecodedTokensData.capacity() + mTokens.capacity() * sizeof(StringToken);
+}
+
+
+//______________________________________________________________________________
+vector<ConstantsTypeColumn::ColumnTypes> ccdb::Assignment::GetColumnTypes() const
+{
+	vector<ConstantsTypeColumn::ColumnTypes> types;
+	if(mTypeTable == NULL) return types;
+
+	for(auto column: mTypeTable->GetColumns()) types.push_back(column->GetType());
+	return types;
+}
+
+
+//______________________________________________________________________________
+bool ccdb::Assignment::HasBoolColumns(const vector<ConstantsTypeColumn::ColumnTypes>& types)
+{
+	for(auto type: types)
 	{
-		mVectorData[i] = DecodeBlobSeparator(mVectorData[i]); //Decode blob separators
+		if(type == ConstantsTypeColumn::cBoolColumn) return true;
 	}
+	return false;
 }
 
-std::string ccdb::Assignment::GetValue(const string& columnName)
+
+//______________________________________________________________________________
+const vector<double>& ccdb::Assignment::GetDoubleData() const
 {
-	if (mRows.empty())
+	if(mIsDoubleDataDecoded) return mDoubleData;   //fast path, no locking
+
+	std::lock_guard<std::mutex> lock(mDecodeMutex);
+	if(mIsDoubleDataDecoded) return mDoubleData;   //other thread has decoded it while we waited
+
+	auto types = GetColumnTypes();
+	mDoubleData.resize(mTokens.size());
+	if(!HasBoolColumns(types) && mDecodedTokensData.empty())
 	{
-		//fill data
-		MapData(mRows, GetVectorData(), mTypeTable->GetColumnNames());
+		//all tokens are numbers in mRawData. The usual case
+		StringUtils::ParseDoubleArray(mRawData.data(), mTokens.data(), mTokens.size(), mDoubleData.data());
+	}
+	else
+	{
+		for (size_t i = 0; i < mTokens.size(); i++)
+		{
+			if(!types.empty() && types[i % types.size()] == ConstantsTypeColumn::cBoolColumn) {
+				mDoubleData[i] = StringUtils::ParseBool(GetToken(i)) ? 1.0 : 0.0;
+			}
+			else {
+				mDoubleData[i] = StringUtils::ParseDouble(GetToken(i));
+			}
+		}
 	}
-	return mRows[0][columnName];
+
+	mDecodedBytes += mDoubleData.capacity() * sizeof(double);
+	mIsDoubleDataDecoded = true;
+	return mDoubleData;
 }
 
-std::string ccdb::Assignment::GetValue(size_t rowIndex, const std::string& columnName)
+
+//______________________________________________________________________________
+bool ccdb::Assignment::SetDecodedData(const double* doubleValues, const int* intValues, size_t count)
+{
+	if(count != mTokens.size()) return false;
+
+	std::lock_guard<std::mutex> lock(mDecodeMutex);
+	mDoubleData.assign(doubleValues, doubleValues + count);
+	mIntData.assign(intValues, intValues + count);
+	mDoubleColumnData.clear();
+	mIntColumnData.clear();
+	mDecodedBytes = mDoubleData.capacity() * sizeof(double) + mIntData.capacity() * sizeof(int);
+	mIsDoubleDataDecoded = true;
+	mIsIntDataDecoded = true;
+	mIsDoubleColumnDataDecoded = false;
+	mIsIntColumnDataDecoded = false;
+	return true;
+}
+
+
+//______________________________________________________________________________
+const vector<int>& ccdb::Assignment::GetIntData() const
 {
-	if (mRows.size() == 0)
+	if(mIsIntDataDecoded) return mIntData;   //fast path, no locking
+
+	std::lock_guard<std::mutex> lock(mDecodeMutex);
+	if(mIsIntDataDecoded) return mIntData;   //other thread has decoded it while we waited
+
+	auto types = GetColumnTypes();
+	mIntData.resize(mTokens.size());
+	if(!HasBoolColumns(types) && mDecodedTokensData.empty())
 	{
-		//fill data
-		MapData(mRows, GetVectorData(), mTypeTable->GetColumnNames());
+		//all tokens are numbers in mRawData. The usual case
+		StringUtils::ParseIntArray(mRawData.data(), mTokens.data(), mTokens.size(), mIntData.data());
+	}
+	else
+	{
+		for (size_t i = 0; i < mTokens.size(); i++)
+		{
+			if(!types.empty() && types[i % types.size()] == ConstantsTypeColumn::cBoolColumn) {
+				mIntData[i] = StringUtils::ParseBool(GetToken(i)) ? 1 : 0;
+			}
+			else {
+				mIntData[i] = StringUtils::ParseInt(GetToken(i));
+			}
+		}
 	}
-	return GetMappedData()[0][columnName];
+
+	mDecodedBytes += mIntData.capacity() * sizeof(int);
+	mIsIntDataDecoded = true;
+	return mIntData;
 }
 
+
+//______________________________________________________________________________
+template<typename T>
+static void TransposeToColumns(const vector<T>& rowData, size_t columnsCount, vector<T>& columnData)
+{
+	// Row by row cells => column by column cells
+
+	columnData.resize(rowData.size());
+	if(columnsCount == 0) return;
+
+	size_t rowsCount = rowData.size() / columnsCount;
+	for (size_t rowIter = 0; rowIter < rowsCount; rowIter++)
+	{
+		for (size_t colIter = 0; colIter < columnsCount; colIter++)
+		{
+			columnData[colIter * rowsCount + rowIter] = rowData[rowIter * columnsCount + colIter];
+		}
+	}
+}
+
+
+//______________________________________________________________________________
+const vector<double>& ccdb::Assignment::GetDoubleColumnData() const
+{
+	if(mIsDoubleColumnDataDecoded) return mDoubleColumnData;   //fast path, no locking
+
+	const vector<double>& rowData = GetDoubleData();     //locks mDecodeMutex itself
+
+	std::lock_guard<std::mutex> lock(mDecodeMutex);
+	if(mIsDoubleColumnDataDecoded) return mDoubleColumnData;
+
+	TransposeToColumns(rowData, GetColumnsCount(), mDoubleColumnData);
+	mDecodedBytes += mDoubleColumnData.capacity() * sizeof(double);
+	mIsDoubleColumnDataDecoded = true;
+	return mDoubleColumnData;
+}
+
+
+//______________________________________________________________________________
+const vector<int>& ccdb::Assignment::GetIntColumnData() const
+{
+	if(mIsIntColumnDataDecoded) return mIntColumnData;   //fast path, no locking
+
+	const vector<int>& rowData = GetIntData();     //locks mDecodeMutex itself
+
+	std::lock_guard<std::mutex> lock(mDecodeMutex);
+	if(mIsIntColumnDataDecoded) return mIntColumnData;
+
+	TransposeToColumns(rowData, GetColumnsCount(), mIntColumnData);
+	mDecodedBytes += mIntColumnData.capacity() * sizeof(int);
+	mIsIntColumnDataDecoded = true;
+	return mIntColumnData;
+}
+
+
+//______________________________________________________________________________
+size_t ccdb::Assignment::GetColumnIndex(const std::string& columnName) const
+{
+	const auto& columns = mTypeTable->GetColumns();
+	for (size_t i = 0; i < columns.size(); i++)
+	{
+		if(columns[i]->GetName() == columnName) return i;
+	}
+	return string::npos;
+}
+
+
+//______________________________________________________________________________
+std::string ccdb::Assignment::GetValue(const string& columnName)
+{
+	return GetValue(0, columnName);
+}
+
+
+//______________________________________________________________________________
+std::string ccdb::Assignment::GetValue(size_t rowIndex, const std::string& columnName)
+{
+	size_t columnIndex = GetColumnIndex(columnName);
+	if(columnIndex == string::npos) return string();   //no such column
+	return GetValue(rowIndex, columnIndex);
+}
+
+
+//______________________________________________________________________________
 std::string ccdb::Assignment::GetValue(size_t rowIndex, size_t columnIndex)
 {
-	return GetData()[rowIndex][columnIndex];
+	return string(GetToken(rowIndex * mTypeTable->GetColumnsCount() + columnIndex));
 }
 
+
+//______________________________________________________________________________
 std::string ccdb::Assignment::GetValue(size_t columnIndex)
 {
-	return GetVectorData()[columnIndex];
+	return string(GetToken(columnIndex));
 }
 
+
+//______________________________________________________________________________
 ConstantsTypeColumn::ColumnTypes ccdb::Assignment::GetValueType(const string& columnName)
 {
 	return mTypeTable->GetColumnsByName()[columnName]->GetType();
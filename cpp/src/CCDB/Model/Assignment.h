@@ -7,6 +7,11 @@
 
 #include <vector>
 #include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <atomic>
+#include <mutex>
 
 #include "CCDB/Model/ConstantsTypeTable.h"
 #include "CCDB/Model/ConstantsTypeColumn.h"
@@ -81,7 +86,8 @@ class RunRange;
         void			SetRequestedRun(int val);			/// Run than was requested for user
 
         RunRange *	    GetRunRange() const;		        /// Run range object, is NULL if not set
-        void            SetRunRange(RunRange * val);		/// Run range object, is NULL if not set
+        void            SetRunRange(RunRange * val, bool isOwner=false);	/// Run range object. If isOwner, it is deleted with the assignment
+        void            SetRunRange(int runMin, int runMax);	/// Creates an owned run range object of the runs (without id and name)
 
         EventRange *	GetEventRange() const;			    /// Event range object, is NULL if not set
         void			SetEventRange(EventRange * val);    /// Event range object, is NULL if not set
@@ -111,18 +117,78 @@ class RunRange;
         vector<string> GetVectorData() const;				    ///Vector data
         void GetVectorData(vector<string> & vectorData) const;	///Mapped data
 
+        /** @brief Number of cells (tokens) in the data blob */
+        size_t GetTokensCount() const { return mTokens.size(); }
+
+        /** @brief Gets data cell by its index in the blob (row by row) without copying
+         *
+         * @warning the view is valid while the assignment is alive and SetRawData is not called
+         * @param tokenIndex - index of the cell, should be less than GetTokensCount()
+         * @return decoded cell value
+         */
+        std::string_view GetToken(size_t tokenIndex) const
+        {
+            const StringToken& token = mTokens[tokenIndex];
+            if(token.Offset < mRawData.size()) return std::string_view(mRawData.data() + token.Offset, token.Length);
+            return std::string_view(mDecodedTokensData.data() + (token.Offset - mRawData.size()), token.Length);
+        }
+
         /** @brief return data as vector of rows that contain vectors of cells
          * @return   std::vector<std::vector<std::string> >
          */
         vector<vector<string> > GetData() const;
         void GetData(vector<vector<string> > &data) const;
 
+        /** @brief All cells of the table (row by row) converted to double
+         *
+         * The conversion is done once per assignment according to column types
+         * (bool columns give 0 or 1) and is kept next to the raw blob.
+         * The function is thread safe.
+         * @return  cells as a flat vector of size rows*columns
+         */
+        const vector<double>& GetDoubleData() const;
+
+        /** @brief All cells of the table (row by row) converted to int. @see GetDoubleData */
+        const vector<int>& GetIntData() const;
+
+        /** @brief Same as GetDoubleData but column by column: all cells of the first column, then of the second...
+         *
+         * Made from GetDoubleData once per assignment and kept with it. The function is thread safe.
+         * @see ConstantsView
+         * @return  cells as a flat vector of size columns*rows
+         */
+        const vector<double>& GetDoubleColumnData() const;
+
+        /** @brief Same as GetIntData but column by column. @see GetDoubleColumnData */
+        const vector<int>& GetIntColumnData() const;
+
+        /** @brief Sets typed data that was decoded beforehand (e.g. stored in a snapshot file)
+         *
+         * Must be called after SetRawData. The values must be what GetDoubleData and GetIntData
+         * would give with the same column types.
+         * @return false (and nothing is set) if count doesn't match the number of cells
+         */
+        bool SetDecodedData(const double* doubleValues, const int* intValues, size_t count);
+
         std::string GetComment() const { return mComment;} ///Comment of assignment
         void SetComment(const std::string& val) { mComment = val;} ///Comment of assignment
 
-        void SetTypeTable(ConstantsTypeTable* typeTable) { this->mTypeTable = typeTable;}
+        /** @brief Sets type table of the assignment
+         *
+         * @param typeTable - type table
+         * @param isOwner   - if true, the table is deleted with the assignment
+         */
+        void SetTypeTable(ConstantsTypeTable* typeTable, bool isOwner=false) { this->mTypeTable = typeTable; mIsTypeTableOwner = isOwner; mSharedTypeTable.reset();}
+
+        /** @brief Sets type table shared by many assignments (@see Catalog). The table lives while the assignment holds it */
+        void SetTypeTable(const std::shared_ptr<ConstantsTypeTable>& typeTable) { mSharedTypeTable = typeTable; mTypeTable = typeTable.get(); mIsTypeTableOwner = false;}
         ConstantsTypeTable* GetTypeTable() const { return mTypeTable; }
 
+        /** @brief Estimated memory in bytes used by the assignment data (and type table if it is owned)
+         * Used by the assignment cache to keep its memory budget. The function is cheap (doesn't iterate data)
+         */
+        size_t GetMemoryUsage() const;
+
         std::string GetValue(size_t columnIndex);
         std::string GetValue(size_t rowIndex, size_t columnIndex);
         std::string GetValue(const std::string& columnName);
@@ -168,8 +234,14 @@ class RunRange;
         size_t GetColumnsCount() const { return mTypeTable->GetColumnsCount(); }
     private:
 
-        vector<map<string,string> > mRows;	// cache for blob data by rows
+
+        /// Index of column by name or string::npos if there is no such column
+        size_t GetColumnIndex(const std::string& columnName) const;
+
         string mRawData;					// data blob
+        vector<StringToken> mTokens;        // Cells of the blob. Offsets less than mRawData.size() point to mRawData,
+                                            // others point to mDecodedTokensData (counted from the end of mRawData)
+        string mDecodedTokensData;          // Cells that had encoded '&delimiter;' (rare)
         int mId;							// id in database
         int mDataBlobId;					// blob id in database
         unsigned int mVariationId;			// database ID of variation
@@ -182,12 +254,29 @@ class RunRange;
         EventRange *mEventRange;			// Event range object, is NULL if not set
         Variation *mVariation;				// Variation object, is NULL if not set
         ConstantsTypeTable * mTypeTable;	// Constants table
+        bool mIsTypeTableOwner;				// If true mTypeTable is deleted in destructor
+        bool mIsRunRangeOwner;				// If true mRunRange is deleted in destructor
+        std::shared_ptr<ConstantsTypeTable> mSharedTypeTable;  // Holds mTypeTable if it is shared
 
         time_t mCreatedTime;				// time of creation
         time_t mModifiedTime;				// time of last modification
         string mComment;					// Comment of assignment
 
-        vector<string> mVectorData;         // Vectorized blob
+        mutable std::mutex mDecodeMutex;                    // Guards decoding of typed data
+        mutable std::atomic<bool> mIsDoubleDataDecoded;     // mDoubleData is filled
+        mutable std::atomic<bool> mIsIntDataDecoded;        // mIntData is filled
+        mutable std::atomic<size_t> mDecodedBytes;          // Memory used by typed data
+        size_t mDataBytes;                                  // Memory used by blob and tokens
+        mutable vector<double> mDoubleData;                 // Blob decoded to doubles
+        mutable vector<int> mIntData;                       // Blob decoded to ints
+        mutable std::atomic<bool> mIsDoubleColumnDataDecoded;  // mDoubleColumnData is filled
+        mutable std::atomic<bool> mIsIntColumnDataDecoded;     // mIntColumnData is filled
+        mutable vector<double> mDoubleColumnData;           // mDoubleData column by column
+        mutable vector<int> mIntColumnData;                 // mIntData column by column
+
+        /// Column types for each column or empty vector if columns are not loaded
+        vector<ConstantsTypeColumn::ColumnTypes> GetColumnTypes() const;
+        static bool HasBoolColumns(const vector<ConstantsTypeColumn::ColumnTypes>& types);
 
         Assignment(const Assignment& rhs);
         Assignment& operator=(const Assignment& rhs);
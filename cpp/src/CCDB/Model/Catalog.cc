@@ -0,0 +1,91 @@
+#include "CCDB/Model/Catalog.h"
+
+using namespace std;
+
+namespace ccdb
+{
+
+//______________________________________________________________________________
+Catalog::Catalog(std::vector<std::unique_ptr<ConstantsTypeTable> > tables, std::vector<CatalogVariation> variations):
+    mVariations(std::move(variations))
+{
+    mTables.reserve(tables.size());
+    mTablesByFullPath.reserve(tables.size());
+    mTablesById.reserve(tables.size());
+    for(auto& table: tables) AddTable(std::shared_ptr<ConstantsTypeTable>(table.release()));
+    IndexVariations();
+}
+
+
+//______________________________________________________________________________
+Catalog::Catalog(std::shared_ptr<ObjectArena> arena, const std::vector<ConstantsTypeTable*>& tables, std::vector<CatalogVariation> variations):
+    mVariations(std::move(variations))
+{
+    mTables.reserve(tables.size());
+    mTablesByFullPath.reserve(tables.size());
+    mTablesById.reserve(tables.size());
+    for(ConstantsTypeTable* table: tables) AddTable(std::shared_ptr<ConstantsTypeTable>(arena, table));    //shares the arena
+    IndexVariations();
+}
+
+
+//______________________________________________________________________________
+void Catalog::AddTable(std::shared_ptr<ConstantsTypeTable> table)
+{
+    CatalogTable record;
+    for(ConstantsTypeColumn* column: table->GetColumns())
+    {
+        record.ColumnNames.push_back(&*mColumnNames.insert(column->GetName()).first);
+    }
+    mTablesByFullPath[table->GetFullPath()] = mTables.size();
+    mTablesById[table->GetId()] = mTables.size();
+    record.TypeTable = std::move(table);
+    mTables.push_back(std::move(record));
+}
+
+
+//______________________________________________________________________________
+void Catalog::IndexVariations()
+{
+    mVariationsByName.reserve(mVariations.size());
+    mVariationsById.reserve(mVariations.size());
+    for(size_t i = 0; i < mVariations.size(); i++)
+    {
+        mVariationsByName[mVariations[i].Name] = i;
+        mVariationsById[mVariations[i].Id] = i;
+    }
+}
+
+
+//______________________________________________________________________________
+const CatalogTable* Catalog::FindTable(const std::string& fullPath) const
+{
+    auto tableIter = mTablesByFullPath.find(fullPath);
+    return tableIter == mTablesByFullPath.end() ? nullptr : &mTables[tableIter->second];
+}
+
+
+//______________________________________________________________________________
+const CatalogTable* Catalog::FindTable(dbkey_t id) const
+{
+    auto tableIter = mTablesById.find(id);
+    return tableIter == mTablesById.end() ? nullptr : &mTables[tableIter->second];
+}
+
+
+//______________________________________________________________________________
+const CatalogVariation* Catalog::FindVariation(const std::string& name) const
+{
+    auto variationIter = mVariationsByName.find(name);
+    return variationIter == mVariationsByName.end() ? nullptr : &mVariations[variationIter->second];
+}
+
+
+//______________________________________________________________________________
+const CatalogVariation* Catalog::FindVariation(dbkey_t id) const
+{
+    auto variationIter = mVariationsById.find(id);
+    return variationIter == mVariationsById.end() ? nullptr : &mVariations[variationIter->second];
+}
+
+}
@@ -0,0 +1,112 @@
+#ifndef _Catalog_
+#define _Catalog_
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "CCDB/Globals.h"
+#include "CCDB/Model/ConstantsTypeTable.h"
+#include "CCDB/Helpers/ObjectArena.h"
+
+namespace ccdb
+{
+    /** @brief Variation as it is stored in the catalog */
+    struct CatalogVariation
+    {
+        dbkey_t Id;
+        dbkey_t ParentId;       /// 0 if the variation has no parent
+        std::string Name;
+    };
+
+
+    /** @brief Type table as it is stored in the catalog */
+    struct CatalogTable
+    {
+        std::shared_ptr<ConstantsTypeTable> TypeTable;      /// With full path and columns, but no Directory object. Shared by assignments
+        std::vector<const std::string*> ColumnNames;        /// Interned in the catalog, in columns order
+    };
+
+
+    /** @brief Immutable metadata of a database: type tables with columns and variations
+     *
+     * A provider loads the catalog with a few bulk queries (@see DataProvider::GetCatalog). After it is built
+     * the catalog is never changed, so it is shared by providers, calibrations and threads through
+     * shared_ptr<const Catalog> without locks. A refresh builds a new catalog and swaps the pointer,
+     * holders of the old one keep using it until they release it.
+     *
+     * Lookups are hash probes that don't allocate. Column names are interned: tables with the same
+     * column names point to the same strings
+     */
+    class Catalog
+    {
+    public:
+
+        /** @brief Builds indexes over tables and variations
+         *
+         * @param tables - type tables with full paths and columns set. The catalog takes them
+         * @param variations - all variations
+         */
+        Catalog(std::vector<std::unique_ptr<ConstantsTypeTable> > tables, std::vector<CatalogVariation> variations);
+
+        /** @brief Same as above, but tables and their columns are in the arena
+         *
+         * The arena is released with the last holder of the catalog or of its type tables
+         * (type tables given to assignments keep the whole arena alive)
+         *
+         * @param arena - arena with the tables and columns. Tables must not own columns (@see ConstantsTypeTable::SetIsColumnsOwner)
+         * @param tables - type tables with full paths and columns set
+         * @param variations - all variations
+         */
+        Catalog(std::shared_ptr<ObjectArena> arena, const std::vector<ConstantsTypeTable*>& tables, std::vector<CatalogVariation> variations);
+
+        /** @brief Finds type table by its full path, like /test/test_vars/test_table
+         * @return table or nullptr if there is no such table
+         */
+        const CatalogTable* FindTable(const std::string& fullPath) const;
+
+        /** @brief Finds type table by its database id
+         * @return table or nullptr if there is no such table
+         */
+        const CatalogTable* FindTable(dbkey_t id) const;
+
+        /** @brief Finds variation by name
+         * @return variation or nullptr if there is no such variation
+         */
+        const CatalogVariation* FindVariation(const std::string& name) const;
+
+        /** @brief Finds variation by its database id
+         * @return variation or nullptr if there is no such variation
+         */
+        const CatalogVariation* FindVariation(dbkey_t id) const;
+
+        size_t GetTablesCount() const { return mTables.size(); }            /// Number of type tables
+        size_t GetVariationsCount() const { return mVariations.size(); }    /// Number of variations
+        size_t GetColumnNamesCount() const { return mColumnNames.size(); }  /// Number of distinct column names
+
+        const std::vector<CatalogTable>& GetTables() const { return mTables; }              /// All type tables
+        const std::vector<CatalogVariation>& GetVariations() const { return mVariations; }  /// All variations
+
+    private:
+        Catalog(const Catalog& rhs);
+        Catalog& operator=(const Catalog& rhs);
+
+        /// Adds the table to indexes
+        void AddTable(std::shared_ptr<ConstantsTypeTable> table);
+
+        /// Builds indexes of variations
+        void IndexVariations();
+
+        std::vector<CatalogTable> mTables;
+        std::vector<CatalogVariation> mVariations;
+        std::unordered_set<std::string> mColumnNames;                      /// Interned column names
+        std::unordered_map<std::string, size_t> mTablesByFullPath;         /// Full path => index in mTables
+        std::unordered_map<dbkey_t, size_t> mTablesById;                   /// Id => index in mTables
+        std::unordered_map<std::string, size_t> mVariationsByName;         /// Name => index in mVariations
+        std::unordered_map<dbkey_t, size_t> mVariationsById;               /// Id => index in mVariations
+    };
+}
+
+#endif // _Catalog_
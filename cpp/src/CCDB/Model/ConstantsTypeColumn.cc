@@ -66,7 +66,7 @@ void ConstantsTypeColumn::SetId( dbkey_t val )
 	mId = val;
 }
 
-std::string ConstantsTypeColumn::GetName() const
+const std::string& ConstantsTypeColumn::GetName() const
 {
 	return mName;
 }
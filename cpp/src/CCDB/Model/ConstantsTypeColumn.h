@@ -65,7 +65,7 @@ public:
 	dbkey_t			GetId() const;						///get database table uniq id;
 	void			SetId(dbkey_t val);					///set database table uniq id;
 
-	string			GetName() const;					///get name
+	const string&	GetName() const;					///get name
 	void			SetName(string val);				///set name
 
 	string			GetComment() const;					///get comment
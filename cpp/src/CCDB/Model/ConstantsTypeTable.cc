@@ -26,12 +26,14 @@ ConstantsTypeTable::ConstantsTypeTable()
 	mNRows = 0;
 	mNColumnsFromDB = 0;		//
 	mColumns.clear();
+	mIsColumnsOwner = true;
 }
 
 
 ConstantsTypeTable::~ConstantsTypeTable() 
 {
-	
+	//the table owns its columns unless they are in an arena
+	if(mIsColumnsOwner) for(auto column: mColumns) delete column;
 }
 
 
@@ -127,6 +127,10 @@ namespace ccdb {
 
         /** @brief gets map of pointer to columns by name of columns*/
         std::map<std::string, ConstantsTypeColumn *> &GetColumnsByName();
+
+        /** @brief If true (default) the table deletes its columns. False if columns are owned by an arena (@see ObjectArena) */
+        void SetIsColumnsOwner(bool isOwner) { mIsColumnsOwner = isOwner; }
+        bool GetIsColumnsOwner() const { return mIsColumnsOwner; }
     private:
         string		mName;			//Name of the table of constants
         string		mFullPath;		//Full path of the constant
@@ -143,6 +147,7 @@ namespace ccdb {
         std::map<std::string, ConstantsTypeColumn *> mColumnsByName;
 
         vector<ConstantsTypeColumn *> mColumns; //Columns object
+        bool mIsColumnsOwner;                   //Columns are deleted with the table
         ConstantsTypeTable(const ConstantsTypeTable& rhs);
         ConstantsTypeTable& operator=(const ConstantsTypeTable& rhs);
     };
@@ -0,0 +1,88 @@
+#include "CCDB/Model/ConstantsView.h"
+
+using namespace std;
+
+namespace ccdb
+{
+
+//______________________________________________________________________________
+ConstantsView::ConstantsView():
+    mAssignment(nullptr),
+    mRowsCount(0),
+    mColumnsCount(0)
+{
+}
+
+
+//______________________________________________________________________________
+ConstantsView::ConstantsView(std::shared_ptr<const Assignment> assignment):
+    ConstantsView()
+{
+    if(!assignment) return;     //empty view
+
+    mSharedAssignment = std::move(assignment);
+    mAssignment = mSharedAssignment.get();
+    mColumnsCount = mAssignment->GetColumnsCount();
+    mRowsCount = mColumnsCount ? mAssignment->GetTokensCount() / mColumnsCount : 0;
+}
+
+
+//______________________________________________________________________________
+ConstantsView::ConstantsView(const Assignment& assignment):
+    mAssignment(&assignment),
+    mColumnsCount(assignment.GetColumnsCount())
+{
+    mRowsCount = mColumnsCount ? assignment.GetTokensCount() / mColumnsCount : 0;
+}
+
+
+//______________________________________________________________________________
+std::vector<std::string> ConstantsView::GetColumnNames() const
+{
+    vector<string> names;
+    names.reserve(mColumnsCount);
+    for(size_t i = 0; i < mColumnsCount; i++) names.push_back(GetColumnName(i));
+    return names;
+}
+
+
+//______________________________________________________________________________
+size_t ConstantsView::GetColumnIndex(const std::string& columnName) const
+{
+    const vector<ConstantsTypeColumn*>& columns = mAssignment->GetTypeTable()->GetColumns();
+    for(size_t i = 0; i < columns.size(); i++)
+    {
+        if(columns[i]->GetName() == columnName) return i;
+    }
+    return string::npos;
+}
+
+
+//______________________________________________________________________________
+Span<const double> ConstantsView::GetDoubleColumn(size_t column) const
+{
+    return Span<const double>(mAssignment->GetDoubleColumnData().data() + column * mRowsCount, mRowsCount);
+}
+
+
+//______________________________________________________________________________
+Span<const int> ConstantsView::GetIntColumn(size_t column) const
+{
+    return Span<const int>(mAssignment->GetIntColumnData().data() + column * mRowsCount, mRowsCount);
+}
+
+
+//______________________________________________________________________________
+Span<const double> ConstantsView::GetDoubleRow(size_t row) const
+{
+    return Span<const double>(mAssignment->GetDoubleData().data() + row * mColumnsCount, mColumnsCount);
+}
+
+
+//______________________________________________________________________________
+Span<const int> ConstantsView::GetIntRow(size_t row) const
+{
+    return Span<const int>(mAssignment->GetIntData().data() + row * mColumnsCount, mColumnsCount);
+}
+
+}
@@ -0,0 +1,101 @@
+#ifndef _ConstantsView_
+#define _ConstantsView_
+
+#include <stddef.h>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "CCDB/Model/Assignment.h"
+#include "CCDB/Helpers/Span.h"
+
+namespace ccdb
+{
+    /** @brief Read only columnar view of constants of an assignment
+     *
+     * The view shares the assignment (with the cache, if the cache is on) and gives its decoded data
+     * without copying: spans over contiguous columns (column by column arrays) or rows (row by row arrays).
+     * Both arrays are decoded once per assignment on the first use and are kept with it
+     * (@see Assignment::GetDoubleData, Assignment::GetDoubleColumnData).
+     *
+     * Column names are resolved to indexes once with GetColumnIndex, then data is accessed by indexes:
+     * @code
+     *     ConstantsView view = calib->GetView("/TOF/gains");
+     *     size_t gainColumn = view.GetColumnIndex("gain");
+     *     for(double gain: view.GetDoubleColumn(gainColumn)) { ... }
+     * @endcode
+     *
+     * Copies of the view are cheap and share the assignment. The view is thread safe.
+     * The view doesn't check bounds of row and column indexes
+     */
+    class ConstantsView
+    {
+    public:
+
+        /** @brief Empty view, IsEmpty() returns true */
+        ConstantsView();
+
+        /** @brief View that shares the assignment */
+        explicit ConstantsView(std::shared_ptr<const Assignment> assignment);
+
+        /** @brief View that doesn't own the assignment. It is valid while the assignment is alive */
+        explicit ConstantsView(const Assignment& assignment);
+
+        /** @brief True if the view has no assignment (e.g. GetView found no data) */
+        bool IsEmpty() const { return mAssignment == nullptr; }
+        explicit operator bool() const { return mAssignment != nullptr; }
+
+        size_t GetRowsCount() const { return mRowsCount; }          /// Number of rows
+        size_t GetColumnsCount() const { return mColumnsCount; }    /// Number of columns
+
+        /** @brief Name of the column by its index */
+        const std::string& GetColumnName(size_t column) const { return mAssignment->GetTypeTable()->GetColumns()[column]->GetName(); }
+
+        /** @brief Names of all columns in columns order */
+        std::vector<std::string> GetColumnNames() const;
+
+        /** @brief Type of the column by its index */
+        ConstantsTypeColumn::ColumnTypes GetColumnType(size_t column) const { return mAssignment->GetTypeTable()->GetColumns()[column]->GetType(); }
+
+        /** @brief Index of column by its name
+         * @return index or std::string::npos if there is no such column
+         */
+        size_t GetColumnIndex(const std::string& columnName) const;
+
+        /** @brief All cells of the column converted to double (bool columns give 0 or 1) */
+        Span<const double> GetDoubleColumn(size_t column) const;
+
+        /** @brief All cells of the column converted to int */
+        Span<const int> GetIntColumn(size_t column) const;
+
+        /** @brief All cells of the row converted to double */
+        Span<const double> GetDoubleRow(size_t row) const;
+
+        /** @brief All cells of the row converted to int */
+        Span<const int> GetIntRow(size_t row) const;
+
+        /** @brief Cell converted to double */
+        double GetDouble(size_t row, size_t column) const { return mAssignment->GetDoubleData()[row * mColumnsCount + column]; }
+
+        /** @brief Cell converted to int */
+        int GetInt(size_t row, size_t column) const { return mAssignment->GetIntData()[row * mColumnsCount + column]; }
+
+        /** @brief Cell as it is stored. The view is valid while the assignment is alive */
+        std::string_view GetString(size_t row, size_t column) const { return mAssignment->GetToken(row * mColumnsCount + column); }
+
+        /** @brief The assignment of the view */
+        const Assignment& GetAssignment() const { return *mAssignment; }
+
+        /** @brief The assignment if the view shares it, empty pointer if the view doesn't own the assignment */
+        const std::shared_ptr<const Assignment>& GetSharedAssignment() const { return mSharedAssignment; }
+
+    private:
+        std::shared_ptr<const Assignment> mSharedAssignment;    /// Keeps the assignment alive if the view owns it
+        const Assignment* mAssignment;
+        size_t mRowsCount;
+        size_t mColumnsCount;
+    };
+}
+
+#endif // _ConstantsView_
@@ -19,7 +19,7 @@ Directory::Directory():
 	mParent = nullptr;
 	mId = 0;
 	mParentId = 0;
-
+	mFullPath = "/";
 }
 
 
@@ -48,12 +48,18 @@ void ccdb::Directory::AddSubdirectory(Directory* subdirectory)
 {
 	subdirectory->mParent = this;
 	mSubDirectories.push_back(subdirectory);
+	subdirectory->UpdateFullPath();
 }
 
-std::string ccdb::Directory::GetFullPath() const
+void ccdb::Directory::UpdateFullPath()
 {
-    string parentFullPath = mParent ? mParent->GetFullPath() : "";
-    return parentFullPath + "/" + mName;
+    //Root directory (or a directory that is not attached yet) has no parent
+    //Root directory full path is "/", thus top level directories should not get "//"
+    if(!mParent) mFullPath = "/" + mName;
+    else if(mParent->mFullPath == "/") mFullPath = mParent->mFullPath + mName;
+    else mFullPath = mParent->mFullPath + "/" + mName;
+
+    for(Directory* subdirectory: mSubDirectories) subdirectory->UpdateFullPath();
 }
 
 
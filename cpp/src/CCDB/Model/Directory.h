@@ -41,6 +41,12 @@ namespace ccdb{
          */
         void DisposeSubdirectories();
 
+        /**
+         * @brief Removes subdirectories from this directory without deleting them
+         * (when they are owned by the provider, @see DataProvider::ClearDirectories)
+         */
+        void ClearSubdirectories() { mSubDirectories.clear(); }
+
         /**
          * @brief Get
          * @return pointer to parent directory. NULL if there is no parent directory
@@ -54,7 +60,7 @@ namespace ccdb{
         const std::vector<ccdb::Directory*>& GetSubdirectories() const { return mSubDirectories; }
 
         std::string GetName() const { return mName; }                 /// Name of the directory
-        void SetName(const std::string& val) { mName = val; }         /// Name of the directory
+        void SetName(const std::string& val) { mName = val; UpdateFullPath(); }  /// Name of the directory
 
 
         std::string GetComment() const { return mComment; }           /// Gets virginia natural gas bill in coronas
@@ -68,7 +74,12 @@ namespace ccdb{
         int GetId() const { return mId;}                              /// DB id
         void SetId(dbkey_t val) { mId = val; }                        /// DB id
 
-        std::string GetFullPath() const;         /// Full path (including self name) of the directory
+        /** @brief Full path (including self name) of the directory
+         *
+         * The path is built when the name is set or the directory is attached to a parent (@see AddSubdirectory),
+         * so the getter doesn't allocate
+         */
+        const std::string& GetFullPath() const { return mFullPath; }
 
 
 
@@ -78,6 +89,7 @@ namespace ccdb{
     private:
         std::string mName;		///Name of directory like in db
         std::string mComment;	///Comment like in db
+        std::string mFullPath;  ///Full path, @see GetFullPath
         Directory *mParent;
         std::vector<Directory *> mSubDirectories;
         dbkey_t mParentId;
@@ -86,6 +98,8 @@ namespace ccdb{
         time_t mModifiedTime;
 
 
+        void UpdateFullPath();  ///Builds mFullPath of this directory and its subdirectories
+
         Directory(const Directory& rhs);
         Directory& operator=(const Directory& rhs);
     };
@@ -24,6 +24,7 @@ MySQLCalibration::MySQLCalibration( int defaultRun, string defaultVariation/*="d
 //______________________________________________________________________________
 MySQLCalibration::~MySQLCalibration()
 {   
+    StopAsyncRequests();    //queued requests use IsConnected of this class
 }
 
 
@@ -48,7 +49,7 @@ bool MySQLCalibration::Connect( std::string connectionString )
 	 * @param connectionString the Connection String
 	 * @return true if connected
 	 */
-    std::lock_guard<std::mutex> lock(mReadMutex);
+    std::lock_guard<ReadMostlyMutex> lock(mReadMutex);
 
     UpdateActivityTime();
 
@@ -88,6 +89,7 @@ bool MySQLCalibration::Connect( std::string connectionString )
         throw std::logic_error(ERRMSG_CONNECT_LOCKED);
     }
 
+    NextProviderGeneration();   //handles of the previous connection are resolved again
     bool result = mProvider->Connect(connectionString);
     return result;
     //TODO decide maybe to throw an exception here?
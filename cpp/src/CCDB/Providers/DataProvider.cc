@@ -4,6 +4,7 @@
 #include "CCDB/Providers/DataProvider.h"
 #include "CCDB/Helpers/StringUtils.h"
 #include "CCDB/Helpers/PathUtils.h"
+#include "CCDB/Helpers/Trace.h"
 
 #include "CCDB/Globals.h"
 
@@ -18,6 +19,8 @@ DataProvider::DataProvider()
 {
     //Constructor
     mConnectionString="";
+    mDirsAreLoaded = false;
+    mIsCatalogEnabled = false;
 }
 
 
@@ -89,6 +92,17 @@ Directory* DataProvider::GetDirectory( const string& path )
 }
 
 
+//______________________________________________________________________________
+void DataProvider::ClearDirectories()
+{
+	mDirectories.clear();
+	mDirectoriesById.clear();
+	mDirectoriesByFullPath.clear();
+	mRootDir->ClearSubdirectories();
+	mDirectoriesArena.Clear();
+}
+
+
 //______________________________________________________________________________
 void DataProvider::BuildDirectoryDependencies()
 {
@@ -160,6 +174,10 @@ void DataProvider::UpdateDirectoriesIfNeeded()
     //Update directories structure if this is required
 
 	//Logic to check directories...
+	if(this->mDirsAreLoaded) return;
+
+	//Other threads wait while one loads directories
+	std::lock_guard<std::mutex> lock(mDirectoriesMutex);
 	if(!this->mDirsAreLoaded) LoadDirectories();
 }
 
@@ -190,5 +208,99 @@ ConstantsTypeTable * DataProvider::GetConstantsTypeTable(const string& path, boo
 }
 
 
-} //namespace ccdb
+//______________________________________________________________________________
+std::vector<Assignment*> DataProvider::GetAssignmentsShort(const std::vector<AssignmentRequest>& requests, bool loadColumns)
+{
+	std::vector<Assignment*> assignments;
+	assignments.reserve(requests.size());
+	try
+	{
+		for(const AssignmentRequest& request: requests)
+		{
+			Assignment* assignment = nullptr;
+			try
+			{
+				assignment = GetAssignmentShort(request.RunNumber, request.Path, request.Time, request.Variation, loadColumns);
+			}
+			catch (std::runtime_error&)
+			{
+				//no such table or variation. The error is for the single request to report
+			}
+			assignments.push_back(assignment);
+		}
+	}
+	catch (...)
+	{
+		for(Assignment* assignment: assignments) delete assignment;
+		throw;
+	}
+	return assignments;
+}
+
+
+//______________________________________________________________________________
+Assignment* DataProvider::GetResolvedAssignmentShort(int run, const std::shared_ptr<ConstantsTypeTable>& table, Variation* variation, time_t time)
+{
+    return GetAssignmentShort(run, table->GetFullPath(), time, variation->GetName(), /*loadColumns*/ true);
+}
 
+
+//______________________________________________________________________________
+std::shared_ptr<const Catalog> DataProvider::GetCatalog()
+{
+    std::shared_ptr<const Catalog> catalog = std::atomic_load(&mCatalog);
+    if(catalog) return catalog;
+
+    //Other threads wait while one loads the catalog
+    std::lock_guard<std::mutex> lock(mCatalogLoadMutex);
+    catalog = std::atomic_load(&mCatalog);
+    if(catalog) return catalog;
+
+    TraceSpan span(TracePhase::Metadata, "catalog", 7);
+    catalog = LoadCatalog();
+    std::atomic_store(&mCatalog, catalog);
+    return catalog;
+}
+
+
+//______________________________________________________________________________
+std::shared_ptr<const Catalog> DataProvider::RefreshCatalog()
+{
+    std::lock_guard<std::mutex> lock(mCatalogLoadMutex);
+    TraceSpan span(TracePhase::Metadata, "catalog", 7);
+    std::shared_ptr<const Catalog> catalog = LoadCatalog();
+    std::atomic_store(&mCatalog, catalog);
+    return catalog;
+}
+
+
+//______________________________________________________________________________
+void DataProvider::SetCatalog(std::shared_ptr<const Catalog> catalog)
+{
+    std::atomic_store(&mCatalog, catalog);
+}
+
+
+//______________________________________________________________________________
+std::shared_ptr<const Catalog> DataProvider::GetLoadedCatalog() const
+{
+    return std::atomic_load(&mCatalog);
+}
+
+
+//______________________________________________________________________________
+std::shared_ptr<const Catalog> DataProvider::LoadCatalog()
+{
+    std::vector<std::unique_ptr<ConstantsTypeTable> > tables;
+    for(ConstantsTypeTable* table: GetAllConstantsTypeTables(true))
+    {
+        //the catalog may outlive directory objects of the provider, only the path is kept
+        string fullPath = table->GetFullPath();
+        table->SetDirectory(nullptr);
+        table->SetFullPath(fullPath);
+        tables.emplace_back(table);
+    }
+    return std::make_shared<const Catalog>(std::move(tables), std::vector<CatalogVariation>());
+}
+
+} //namespace ccdb
@@ -4,12 +4,17 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <atomic>
+#include <memory>
+#include <mutex>
 
 #include "CCDB/Model/Assignment.h"
 #include "CCDB/Model/ConstantsTypeTable.h"
 #include "CCDB/Model/Directory.h"
 #include "CCDB/Model/RunRange.h"
 #include "CCDB/Model/Variation.h"
+#include "CCDB/Model/Catalog.h"
+#include "CCDB/Helpers/ObjectArena.h"
 
 
 
@@ -130,6 +135,40 @@ namespace ccdb
         */
         virtual Assignment* GetAssignmentShort(int run, const string& path, time_t time, const string& variation, bool loadColumns)=0;
 
+        /** @brief Indicates that GetAssignmentShort, GetConstantsTypeTable and GetVariation
+         *         may be called from many threads at the same time
+         *
+         * If false (the default), the caller must serialize all calls to the provider
+         */
+        virtual bool IsConcurrentReadSupported() { return false; }
+
+        /** @brief Gets assignments of many requests at once. @see GetAssignmentShort
+         *
+         * Providers with a network or file round trip per query override it to resolve
+         * all requests with a few set-based queries. The default implementation calls
+         * GetAssignmentShort for each request.
+         *
+         * @param [in] requests - absolute table path, run, variation and time of each assignment
+         * @param [in] loadColumns - do we need to load table columns information or not
+         * @return new Assignment objects in the order of requests. nullptr if there is no assignment
+         *         or the request can't be resolved (no such table or variation). The caller owns the objects
+         */
+        virtual std::vector<Assignment*> GetAssignmentsShort(const std::vector<AssignmentRequest>& requests, bool loadColumns);
+
+        /** @brief GetAssignmentShort by already resolved type table and variation (@see Calibration::Resolve)
+         *
+         * Providers override it to skip path parsing and metadata lookups and to give the table to
+         * the assignment without copying it. The default implementation calls GetAssignmentShort
+         * with the table path and variation name
+         *
+         * @param [in] run - run number
+         * @param [in] table - type table with columns, as GetConstantsTypeTable returns it
+         * @param [in] variation - variation of this provider
+         * @param [in] time - timestamp, data that is equal or earlier in time than that timestamp is returned
+         * @return new Assignment object or nullptr if there is no assignment. The caller owns the object
+         */
+        virtual Assignment* GetResolvedAssignmentShort(int run, const std::shared_ptr<ConstantsTypeTable>& table, Variation* variation, time_t time);
+
 
 
 
@@ -183,6 +222,43 @@ namespace ccdb
 
 
 
+        //----------------------------------------------------------------------------------------
+        //  C A T A L O G
+        //----------------------------------------------------------------------------------------
+
+        /** @brief Metadata catalog of the database (@see Catalog). It is loaded by the first call
+         *
+         * @remark the function is thread safe. The returned catalog stays valid while it is held,
+         *         even if the provider refreshes or disconnects
+         * @return catalog, never nullptr
+         */
+        std::shared_ptr<const Catalog> GetCatalog();
+
+        /** @brief Loads the catalog again and swaps it in. Users of the old catalog are not affected
+         * @return the new catalog
+         */
+        std::shared_ptr<const Catalog> RefreshCatalog();
+
+        /** @brief Uses the catalog loaded by another provider connected to the same database */
+        void SetCatalog(std::shared_ptr<const Catalog> catalog);
+
+        /** @brief Catalog if it is loaded (or set), nullptr otherwise. Doesn't load it */
+        std::shared_ptr<const Catalog> GetLoadedCatalog() const;
+
+        /** @brief Enables resolving of type tables and variations through the catalog
+         *
+         * When enabled, GetAssignmentShort finds a type table by a hash probe in the catalog and shares
+         * the table object with other assignments instead of querying and allocating it.
+         * Tables and variations added to the database after the catalog was loaded are loaded
+         * as usual, @see RefreshCatalog to pick up changed metadata.
+         * Supported by SQLiteDataProvider. Disabled by default
+         */
+        void SetCatalogEnabled(bool isEnabled) { mIsCatalogEnabled = isEnabled; }
+
+        /** @brief @see SetCatalogEnabled */
+        bool IsCatalogEnabled() const { return mIsCatalogEnabled; }
+
+
         //----------------------------------------------------------------------------------------
         //  O T H E R   F U N C T I O N S
         //----------------------------------------------------------------------------------------
@@ -197,17 +273,38 @@ namespace ccdb
 
     protected:
 
+        /** @brief Loads a new catalog from the database
+         *
+         * The default implementation uses GetAllConstantsTypeTables and has no variations.
+         * Providers override it to load all the metadata with a few bulk queries
+         */
+        virtual std::shared_ptr<const Catalog> LoadCatalog();
+
+        /** @brief Releases all directories (except the root one) before they are loaded again
+         *
+         * Directories are created in mDirectoriesArena and are released together
+         */
+        void ClearDirectories();
+
         std::vector<Directory *>  mDirectories;
         std::map<dbkey_t,Directory *> mDirectoriesById;
         std::map<string,Directory *>  mDirectoriesByFullPath;
-        bool mDirsAreLoaded;                 //Directories are loaded from database
+        std::atomic<bool> mDirsAreLoaded;   //Directories are loaded from database
+        std::mutex mDirectoriesMutex;       //Only one thread loads directories (@see UpdateDirectoriesIfNeeded)
         Directory *mRootDir;                ///root directory. This directory contains all other directories. It is not stored in databases
+        ObjectArena mDirectoriesArena;      ///Directories of mDirectories. @see ClearDirectories
 
 
         std::string mConnectionString;      ///Connection string that was used on last successfully connect.
 
         std::map<dbkey_t, Variation *> mVariationsById;
         std::map<std::string, Variation *> mVariationsByName;
+        ObjectArena mVariationsArena;       ///Variations of the maps above. They live as long as the provider
+
+        std::atomic<bool> mIsCatalogEnabled;    ///@see SetCatalogEnabled
+    private:
+        std::shared_ptr<const Catalog> mCatalog;    ///Accessed by std::atomic_load/atomic_store only
+        std::mutex mCatalogLoadMutex;               ///Only one thread loads the catalog
     };
 }
 #endif // _DDataProvider_
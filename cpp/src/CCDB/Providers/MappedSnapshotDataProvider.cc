@@ -0,0 +1,412 @@
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <stdexcept>
+#include <algorithm>
+
+#include "CCDB/Providers/MappedSnapshotDataProvider.h"
+#include "CCDB/Helpers/PathUtils.h"
+#include "CCDB/Model/ConstantsTypeTable.h"
+
+using namespace std;
+
+namespace ccdb
+{
+
+const char* const MappedSnapshotDataProvider::ConnectionPrefix = "ccdbsnap://";
+
+//______________________________________________________________________________
+bool MappedSnapshotDataProvider::IsMappedSnapshotConnectionString(const std::string& connectionString)
+{
+    return connectionString.compare(0, strlen(ConnectionPrefix), ConnectionPrefix) == 0;
+}
+
+
+//______________________________________________________________________________
+MappedSnapshotDataProvider::MappedSnapshotDataProvider():
+    mData(nullptr),
+    mMappedSize(0),
+    mHeader(nullptr),
+    mIsConnected(false)
+{
+    mRootDir = new Directory();
+}
+
+
+//______________________________________________________________________________
+MappedSnapshotDataProvider::~MappedSnapshotDataProvider()
+{
+    Disconnect();
+
+    //The provider owns directories and variations (in its arenas). Objects made of them must not outlive it
+    delete mRootDir;
+}
+
+
+//______________________________________________________________________________
+void MappedSnapshotDataProvider::Connect(const std::string& connectionString)
+{
+    std::string thisFuncName = "ccdb::MappedSnapshotDataProvider::Connect";
+    if(!IsMappedSnapshotConnectionString(connectionString))
+    {
+        throw std::runtime_error(thisFuncName + "=>Error parse connection string. The string is not started with " + ConnectionPrefix);
+    }
+
+    if(IsConnected())
+    {
+        if(connectionString != mConnectionString) {
+            throw std::runtime_error(thisFuncName + "=>Connection already opened with different connection string");
+        }
+        return;
+    }
+
+    std::string filePath = connectionString.substr(strlen(ConnectionPrefix));
+    int fd = open(filePath.c_str(), O_RDONLY);
+    if(fd < 0) {
+        throw std::runtime_error(thisFuncName + "=>Can't open snapshot file '" + filePath + "': " + strerror(errno));
+    }
+
+    struct stat fileStat;
+    if(fstat(fd, &fileStat) != 0 || fileStat.st_size < static_cast<off_t>(sizeof(SnapshotHeader))) {
+        close(fd);
+        throw std::runtime_error(thisFuncName + "=>Snapshot file '" + filePath + "' is too small");
+    }
+
+    //the mapping stays valid after the descriptor is closed
+    void* mapped = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(mapped == MAP_FAILED) {
+        throw std::runtime_error(thisFuncName + "=>Can't map snapshot file '" + filePath + "': " + strerror(errno));
+    }
+
+    mData = static_cast<const char*>(mapped);
+    mMappedSize = fileStat.st_size;
+    mHeader = reinterpret_cast<const SnapshotHeader*>(mData);
+
+    try
+    {
+        ValidateHeader(filePath);
+        LoadDirectories();
+
+        //variations of the previous connection are reused, objects made by the provider may point to them
+        const SnapshotVariation* variations = GetSection<SnapshotVariation>(mHeader->Variations);
+        for(size_t i = 0; i < mHeader->Variations.Count; i++) {
+            Variation* variation = mVariationsById[variations[i].Id];
+            if(!variation) {
+                variation = mVariationsArena.Create<Variation>();
+                mVariationsById[variations[i].Id] = variation;
+            }
+            variation->SetId(variations[i].Id);
+            variation->SetParentDbId(variations[i].ParentId);
+            variation->SetName(GetString(variations[i].Name));
+            mVariationsByName[variation->GetName()] = variation;
+        }
+        for(auto& idVariation: mVariationsById) {
+            Variation* variation = idVariation.second;
+            auto parentIter = mVariationsById.find(variation->GetParentDbId());
+            variation->SetParent(parentIter != mVariationsById.end() && variation->GetParentDbId() > 0 ? parentIter->second : nullptr);
+        }
+    }
+    catch (std::exception& ex)
+    {
+        Disconnect();
+        throw std::runtime_error(thisFuncName + "=>" + ex.what());
+    }
+
+    mConnectionString = connectionString;
+    mIsConnected = true;
+}
+
+
+//______________________________________________________________________________
+void MappedSnapshotDataProvider::ValidateHeader(const std::string& filePath) const
+{
+    auto fail = [&filePath](const std::string& what) {
+        throw std::runtime_error("Snapshot file '" + filePath + "' " + what);
+    };
+
+    if(memcmp(mHeader->Magic, SnapshotFormat::Magic, sizeof(mHeader->Magic)) != 0) fail("is not a CCDB snapshot");
+    if(mHeader->ByteOrderMark != SnapshotFormat::ByteOrderMark) fail("was written on a machine with different byte order");
+    if(mHeader->Version != SnapshotFormat::Version) {
+        fail("has format version " + to_string(mHeader->Version) + ", supported version is " + to_string(SnapshotFormat::Version));
+    }
+    if(mHeader->FileSize != mMappedSize) fail("is truncated or damaged (size doesn't match the header)");
+
+    auto checkSection = [this, &fail](const SnapshotSection& section, uint64_t recordSize, const char* name) {
+        if(section.Offset % 8 != 0 || section.Offset > mMappedSize ||
+           section.Count > (mMappedSize - section.Offset) / recordSize) {
+            fail(std::string("is damaged (section ") + name + " is out of the file)");
+        }
+    };
+    checkSection(mHeader->Data, 1, "Data");
+    checkSection(mHeader->Directories, sizeof(SnapshotDirectory), "Directories");
+    checkSection(mHeader->Tables, sizeof(SnapshotTable), "Tables");
+    checkSection(mHeader->Columns, sizeof(SnapshotColumn), "Columns");
+    checkSection(mHeader->Variations, sizeof(SnapshotVariation), "Variations");
+    checkSection(mHeader->Indexes, sizeof(SnapshotIndex), "Indexes");
+    checkSection(mHeader->Segments, sizeof(SnapshotSegment), "Segments");
+    checkSection(mHeader->Blobs, sizeof(SnapshotBlob), "Blobs");
+    checkSection(mHeader->Doubles, sizeof(double), "Doubles");
+    checkSection(mHeader->Ints, sizeof(int32_t), "Ints");
+
+    //references between sections. One pass, so lookups don't check bounds
+    uint64_t dataSize = mHeader->Data.Count;
+    auto checkString = [dataSize, &fail](const SnapshotString& str) {
+        if(str.Offset > dataSize || str.Length > dataSize - str.Offset) fail("is damaged (string is out of Data section)");
+    };
+
+    const SnapshotDirectory* directories = GetSection<SnapshotDirectory>(mHeader->Directories);
+    for(size_t i = 0; i < mHeader->Directories.Count; i++) {
+        checkString(directories[i].Name);
+        checkString(directories[i].Comment);
+    }
+
+    const SnapshotTable* tables = GetSection<SnapshotTable>(mHeader->Tables);
+    for(size_t i = 0; i < mHeader->Tables.Count; i++) {
+        checkString(tables[i].Name);
+        checkString(tables[i].FullPath);
+        checkString(tables[i].Comment);
+        if(tables[i].FirstColumn > mHeader->Columns.Count || tables[i].ColumnsCount > mHeader->Columns.Count - tables[i].FirstColumn) {
+            fail("is damaged (table columns are out of Columns section)");
+        }
+    }
+
+    const SnapshotColumn* columns = GetSection<SnapshotColumn>(mHeader->Columns);
+    for(size_t i = 0; i < mHeader->Columns.Count; i++) {
+        checkString(columns[i].Name);
+        checkString(columns[i].Type);
+    }
+
+    const SnapshotVariation* variations = GetSection<SnapshotVariation>(mHeader->Variations);
+    for(size_t i = 0; i < mHeader->Variations.Count; i++) checkString(variations[i].Name);
+
+    const SnapshotIndex* indexes = GetSection<SnapshotIndex>(mHeader->Indexes);
+    for(size_t i = 0; i < mHeader->Indexes.Count; i++) {
+        if(indexes[i].SegmentsCount < 2 || indexes[i].FirstSegment > mHeader->Segments.Count ||
+           indexes[i].SegmentsCount > mHeader->Segments.Count - indexes[i].FirstSegment) {
+            fail("is damaged (index segments are out of Segments section)");
+        }
+    }
+
+    const SnapshotSegment* segments = GetSection<SnapshotSegment>(mHeader->Segments);
+    for(size_t i = 0; i < mHeader->Segments.Count; i++) {
+        if(segments[i].Blob != SnapshotFormat::NoBlob && segments[i].Blob >= mHeader->Blobs.Count) {
+            fail("is damaged (segment blob is out of Blobs section)");
+        }
+    }
+
+    const SnapshotBlob* blobs = GetSection<SnapshotBlob>(mHeader->Blobs);
+    uint64_t valuesCount = std::min(mHeader->Doubles.Count, mHeader->Ints.Count);
+    for(size_t i = 0; i < mHeader->Blobs.Count; i++) {
+        checkString(blobs[i].Raw);
+        if(blobs[i].FirstValue > valuesCount || blobs[i].ValuesCount > valuesCount - blobs[i].FirstValue) {
+            fail("is damaged (blob values are out of Doubles or Ints section)");
+        }
+    }
+}
+
+
+//______________________________________________________________________________
+void MappedSnapshotDataProvider::Disconnect()
+{
+    //Also cleans a partially made connection if Connect fails
+    mIsConnected = false;
+    if(mData) munmap(const_cast<char*>(mData), mMappedSize);
+    mData = nullptr;
+    mHeader = nullptr;
+    mMappedSize = 0;
+
+    //directories and variations are kept, objects made by the provider may point to them
+}
+
+
+//______________________________________________________________________________
+bool MappedSnapshotDataProvider::IsConnected()
+{
+    return mIsConnected;
+}
+
+
+//______________________________________________________________________________
+void MappedSnapshotDataProvider::LoadDirectories()
+{
+    if(!mHeader) throw std::runtime_error("MappedSnapshotDataProvider::LoadDirectories => Snapshot file is not mapped");
+
+    ClearDirectories();
+
+    const SnapshotDirectory* records = GetSection<SnapshotDirectory>(mHeader->Directories);
+    for(size_t i = 0; i < mHeader->Directories.Count; i++) {
+        auto dir = mDirectoriesArena.Create<Directory>();
+        dir->SetId(records[i].Id);
+        dir->SetName(GetString(records[i].Name));
+        dir->SetParentId(records[i].ParentId);
+        dir->SetComment(GetString(records[i].Comment));
+
+        mDirectories.push_back(dir);
+        mDirectoriesById[dir->GetId()] = dir;
+    }
+
+    BuildDirectoryDependencies();
+    mDirsAreLoaded = true;
+}
+
+
+//______________________________________________________________________________
+const SnapshotTable* MappedSnapshotDataProvider::FindTable(const std::string& fullPath) const
+{
+    const SnapshotTable* begin = GetSection<SnapshotTable>(mHeader->Tables);
+    const SnapshotTable* end = begin + mHeader->Tables.Count;
+    const char* data = mData + mHeader->Data.Offset;
+
+    //tables are sorted by full path as std::string compares
+    auto tableIter = lower_bound(begin, end, fullPath, [data](const SnapshotTable& table, const std::string& path) {
+        return path.compare(0, string::npos, data + table.FullPath.Offset, table.FullPath.Length) > 0;
+    });
+    if(tableIter == end || fullPath.compare(0, string::npos, data + tableIter->FullPath.Offset, tableIter->FullPath.Length) != 0) {
+        return nullptr;
+    }
+    return tableIter;
+}
+
+
+//______________________________________________________________________________
+ConstantsTypeTable* MappedSnapshotDataProvider::MakeTypeTable(const SnapshotTable& record, bool loadColumns) const
+{
+    auto dirIter = mDirectoriesById.find(record.DirectoryId);
+    Directory* directory = dirIter != mDirectoriesById.end() ? dirIter->second : mRootDir;
+
+    auto table = new ConstantsTypeTable();
+    table->SetId(record.Id);
+    table->SetName(GetString(record.Name));
+    table->SetDirectoryId(record.DirectoryId);
+    table->SetNRows(record.RowsCount);
+    table->SetNColumnsFromDB(record.ColumnsCountFromDB);
+    table->SetComment(GetString(record.Comment));
+    table->SetDirectory(directory);
+    table->SetFullPath(GetString(record.FullPath));
+
+    if(loadColumns) {
+        const SnapshotColumn* columns = GetSection<SnapshotColumn>(mHeader->Columns) + record.FirstColumn;
+        for(size_t i = 0; i < record.ColumnsCount; i++) {
+            auto column = new ConstantsTypeColumn();
+            column->SetId(columns[i].Id);
+            column->SetName(GetString(columns[i].Name));
+            column->SetType(GetString(columns[i].Type));
+            column->SetDBTypeTableId(record.Id);
+            table->AddColumn(column);
+        }
+    }
+    return table;
+}
+
+
+//______________________________________________________________________________
+ConstantsTypeTable* MappedSnapshotDataProvider::GetConstantsTypeTable(const string& name, Directory* parentDir, bool loadColumns)
+{
+    std::string thisFunc("ccdb::MappedSnapshotDataProvider::GetConstantsTypeTable");
+    if(!IsConnected()) throw std::runtime_error(thisFunc + " => MappedSnapshotDataProvider is not connected");
+
+    if(parentDir == nullptr || (parentDir->GetFullPath()!=string("/") && parentDir->GetId()<=0)) {
+        throw std::runtime_error(thisFunc + " => Parent directory is null or have invalid ID");
+    }
+
+    const SnapshotTable* record = FindTable(PathUtils::CombinePath(parentDir->GetFullPath(), name));
+    return record ? MakeTypeTable(*record, loadColumns) : nullptr;
+}
+
+
+//______________________________________________________________________________
+std::vector<ConstantsTypeTable*> MappedSnapshotDataProvider::GetAllConstantsTypeTables(bool loadColumns)
+{
+    if(!IsConnected()) throw std::runtime_error("MappedSnapshotDataProvider::GetAllConstantsTypeTables => MappedSnapshotDataProvider is not connected");
+
+    std::vector<ConstantsTypeTable*> tables;
+    const SnapshotTable* records = GetSection<SnapshotTable>(mHeader->Tables);
+    for(size_t i = 0; i < mHeader->Tables.Count; i++) tables.push_back(MakeTypeTable(records[i], loadColumns));
+    return tables;
+}
+
+
+//______________________________________________________________________________
+Variation* MappedSnapshotDataProvider::GetVariation(const string& name)
+{
+    auto variationIter = mVariationsByName.find(name);
+    return variationIter == mVariationsByName.end() ? nullptr : variationIter->second;
+}
+
+
+//______________________________________________________________________________
+const SnapshotSegment* MappedSnapshotDataProvider::FindSegment(dbkey_t tableId, dbkey_t variationId, int run) const
+{
+    const SnapshotIndex* indexesBegin = GetSection<SnapshotIndex>(mHeader->Indexes);
+    const SnapshotIndex* indexesEnd = indexesBegin + mHeader->Indexes.Count;
+    auto indexIter = lower_bound(indexesBegin, indexesEnd, make_pair(tableId, variationId),
+        [](const SnapshotIndex& index, const pair<dbkey_t, dbkey_t>& key) {
+            return make_pair(static_cast<dbkey_t>(index.TableId), static_cast<dbkey_t>(index.VariationId)) < key;
+        });
+    if(indexIter == indexesEnd || indexIter->TableId != tableId || indexIter->VariationId != variationId) return nullptr;
+
+    //the last segment starting at or before the run. The terminator segment has no blob
+    const SnapshotSegment* segmentsBegin = GetSection<SnapshotSegment>(mHeader->Segments) + indexIter->FirstSegment;
+    const SnapshotSegment* segmentsEnd = segmentsBegin + indexIter->SegmentsCount;
+    auto segmentIter = upper_bound(segmentsBegin, segmentsEnd, static_cast<int64_t>(run),
+        [](int64_t runValue, const SnapshotSegment& segment) { return runValue < segment.RunStart; });
+    if(segmentIter == segmentsBegin) return nullptr;
+
+    const SnapshotSegment* segment = segmentIter - 1;
+    return segment->Blob == SnapshotFormat::NoBlob ? nullptr : segment;
+}
+
+
+//______________________________________________________________________________
+Assignment* MappedSnapshotDataProvider::GetAssignmentShort(int run, const string& path, time_t time, const string& variationName, bool loadColumns)
+{
+    std::string thisFunc("MappedSnapshotDataProvider::GetAssignmentShort");
+    if(!IsConnected()) throw std::runtime_error(thisFunc + " => MappedSnapshotDataProvider is not connected");
+
+    if(time != 0 && time != mHeader->SnapshotTime) {
+        throw std::runtime_error(thisFunc + " => Snapshot file is made for time " + to_string(mHeader->SnapshotTime) +
+                                 " and can't answer requests for time " + to_string(time));
+    }
+
+    string absolutePath(path);
+    const SnapshotTable* record = FindTable(PathUtils::MakeAbsolute(absolutePath));
+    if(!record) {
+        throw std::runtime_error(thisFunc + " => Type table was not found: '" + path + "'");
+    }
+
+    Variation* variation = GetVariation(variationName);
+    if(!variation) {
+        throw std::runtime_error(thisFunc + " => No variation '" + variationName + "' was found");
+    }
+
+    //If there is no data for this variation, the parent variation is looked up
+    for(; variation != nullptr; variation = variation->GetParent())
+    {
+        const SnapshotSegment* segment = FindSegment(record->Id, variation->GetId(), run);
+        if(!segment) continue;
+
+        const SnapshotBlob& blob = GetSection<SnapshotBlob>(mHeader->Blobs)[segment->Blob];
+        auto assignment = new Assignment();
+        assignment->SetId(segment->AssignmentId);
+        assignment->SetRawData(GetString(blob.Raw));
+        assignment->SetRequestedRun(run);
+        assignment->SetTypeTable(MakeTypeTable(*record, loadColumns), /*isOwner*/ true);
+        assignment->SetVariation(variation);
+
+        //values were decoded with column types. Without columns bool cells are decoded differently
+        if(blob.ValuesCount > 0 && (loadColumns || !record->HasBoolColumns)) {
+            assignment->SetDecodedData(GetSection<double>(mHeader->Doubles) + blob.FirstValue,
+                                       GetSection<int32_t>(mHeader->Ints) + blob.FirstValue,
+                                       blob.ValuesCount);
+        }
+        return assignment;
+    }
+
+    return nullptr;
+}
+
+}
@@ -0,0 +1,121 @@
+#ifndef _MappedSnapshotDataProvider_
+#define _MappedSnapshotDataProvider_
+
+#include <time.h>
+#include <string>
+#include <vector>
+#include <atomic>
+
+#include "CCDB/Providers/DataProvider.h"
+#include "CCDB/Helpers/SnapshotFormat.h"
+
+namespace ccdb
+{
+
+/** @brief Read-only provider working on a memory-mapped binary snapshot file (.ccdbsnap)
+ *
+ * The file is made by ccdb_snapshot tool (@see SnapshotDataProvider::WriteBinarySnapshot)
+ * and is used in place: type tables, variations and run ranges are found by binary search
+ * in the mapped sections, blobs and their decoded values are copied from the mapping.
+ * All processes on a node which map the same file share its pages in the page cache,
+ * so a farm node with many jobs keeps one copy of the calibrations. No SQL is issued.
+ *
+ * Connection string:
+ *    ccdbsnap://<path to .ccdbsnap file>
+ *
+ * The file holds the database state at one time. Requests with time 0 or with the snapshot
+ * time are answered; other times throw std::runtime_error as they can't be answered correctly
+ */
+class MappedSnapshotDataProvider: public DataProvider
+{
+public:
+    /** @brief Connection string prefix of this provider */
+    static const char* const ConnectionPrefix;
+
+    /** @brief Checks that the connection string is for MappedSnapshotDataProvider */
+    static bool IsMappedSnapshotConnectionString(const std::string& connectionString);
+
+    MappedSnapshotDataProvider();
+    ~MappedSnapshotDataProvider() override;
+
+    //----------------------------------------------------------------------------------------
+    //  I M P L E M E N T   I N T E R F A C E
+    //----------------------------------------------------------------------------------------
+
+    /** @brief Maps the snapshot file and checks its header
+     *
+     * @param connectionString ccdbsnap://<path to .ccdbsnap file>
+     */
+    void Connect(const std::string &connectionString) override;
+
+    /** @brief Unmaps the file */
+    void Disconnect() override;
+
+    /** @brief true if the file is mapped */
+    bool IsConnected() override;
+
+    /** @brief Makes directories of the file. It is done on Connect */
+    void LoadDirectories() override;
+
+    /** @brief Gets new ConstantsTypeTable object made of the snapshot */
+    ConstantsTypeTable * GetConstantsTypeTable(const string& name, Directory *parentDir, bool loadColumns) override;
+
+    /** @brief Gets new ConstantsTypeTable objects of all tables */
+    std::vector<ConstantsTypeTable *> GetAllConstantsTypeTables(bool loadColumns) override;
+
+    /** @brief Get variation by name (all variations are made on Connect) */
+    Variation* GetVariation(const string& name) override;
+
+    /** @brief Assignment with data blob for the run. @see DataProvider::GetAssignmentShort
+     *
+     * @param time 0 or the snapshot time (@see GetSnapshotTime). Other times throw std::runtime_error
+     */
+    Assignment* GetAssignmentShort(int run, const string& path, time_t time, const string& variation, bool loadColumns) override;
+
+    /** @brief The mapping is immutable, so reads don't need locks */
+    bool IsConcurrentReadSupported() override { return true; }
+
+    //----------------------------------------------------------------------------------------
+    //  E N D   I M P L E M E N T   I N T E R F A C E
+    //----------------------------------------------------------------------------------------
+
+    time_t GetSnapshotTime() const { return mHeader ? mHeader->SnapshotTime : 0; }  /// Time the file was made for. 0 - the latest at conversion
+    size_t GetMappedSize() const { return mMappedSize; }                           /// Size of the mapped file in bytes
+
+private:
+
+    /** @brief Checks that the file is a valid snapshot. Throws std::runtime_error */
+    void ValidateHeader(const std::string& filePath) const;
+
+    /** @brief Records of a section */
+    template<typename T> const T* GetSection(const SnapshotSection& section) const
+    {
+        return reinterpret_cast<const T*>(mData + section.Offset);
+    }
+
+    /** @brief Text of Data section */
+    std::string GetString(const SnapshotString& str) const
+    {
+        return std::string(mData + mHeader->Data.Offset + str.Offset, str.Length);
+    }
+
+    /** @brief Binary search of the table by full path. nullptr if not found */
+    const SnapshotTable* FindTable(const std::string& fullPath) const;
+
+    /** @brief Makes new ConstantsTypeTable object of the record */
+    ConstantsTypeTable* MakeTypeTable(const SnapshotTable& record, bool loadColumns) const;
+
+    /** @brief Binary search of the segment of the run. nullptr if the run is not covered */
+    const SnapshotSegment* FindSegment(dbkey_t tableId, dbkey_t variationId, int run) const;
+
+    const char* mData;                      // Start of the mapping
+    size_t mMappedSize;
+    const SnapshotHeader* mHeader;          // == mData while connected
+    std::atomic<bool> mIsConnected;
+
+    MappedSnapshotDataProvider(const MappedSnapshotDataProvider& rhs);
+    MappedSnapshotDataProvider& operator=(const MappedSnapshotDataProvider& rhs);
+};
+}
+
+#endif //_MappedSnapshotDataProvider_
@@ -10,6 +10,7 @@
 #include "CCDB/Log.h"
 #include "CCDB/Helpers/StringUtils.h"
 #include "CCDB/Helpers/PathUtils.h"
+#include "CCDB/Helpers/Trace.h"
 #include "CCDB/Providers/MySQLDataProvider.h"
 #include "CCDB/Model/ConstantsTypeTable.h"
 #include "CCDB/Model/RunRange.h"
@@ -219,6 +220,7 @@ void ccdb::MySQLDataProvider::Disconnect()
 
 bool ccdb::MySQLDataProvider::LoadDirectories()
 {
+	TraceSpan span(TracePhase::Metadata, "directories", 11);
 	//
 	if(IsConnected())
 	{
@@ -792,17 +794,27 @@ Assignment* ccdb::MySQLDataProvider::GetAssignmentShort(int run, const string& p
     //run number to string
     string runStr = StringUtils::IntToString(run);
 
+    //the variation and its parents, the nearest first. The whole chain is resolved by one query:
+    //the assignment of the nearest variation that has data wins, FIELD() gives the chain position
+    string variationIds;
+    for(Variation* chainVariation = variation; chainVariation; chainVariation = chainVariation->GetParent())
+    {
+        if(!variationIds.empty()) variationIds += ",";
+        variationIds += StringUtils::IntToString(chainVariation->GetId());
+    }
+
 	//ok now we must build our mighty query...
 	string query=
         "SELECT `assignments`.`id` AS `asId`, "
-        "`constantSets`.`vault` AS `blob` "
+        "`constantSets`.`vault` AS `blob`, "
+        "`assignments`.`variationId` AS `varId` "
         "FROM  `assignments` "
         "INNER JOIN `runRanges` ON `assignments`.`runRangeId`= `runRanges`.`id` "
         "INNER JOIN `constantSets` ON `assignments`.`constantSetId` = `constantSets`.`id` "
         "INNER JOIN `typeTables` ON `constantSets`.`constantTypeId` = `typeTables`.`id` "
         "WHERE  `runRanges`.`runMin` <= '"+runStr+"' "
         "AND `runRanges`.`runMax` >= '"+runStr+"' "
-        "AND `assignments`.`variationId`= '"+StringUtils::IntToString(variation->GetId())+"' "
+        "AND `assignments`.`variationId` IN ("+variationIds+") "
         "AND `constantSets`.`constantTypeId` ='"+StringUtils::IntToString(table->GetId())+"' ";
     
     //time in querY?
@@ -814,7 +826,7 @@ Assignment* ccdb::MySQLDataProvider::GetAssignmentShort(int run, const string& p
     }
 
     //finish query 
-    query = query + "ORDER BY `assignments`.`id` DESC LIMIT 1 ";
+    query = query + "ORDER BY FIELD(`assignments`.`variationId`, "+variationIds+"), `assignments`.`id` DESC LIMIT 1 ";
 	
 	//query this
 	if(!QuerySelect(query))
@@ -822,13 +834,6 @@ Assignment* ccdb::MySQLDataProvider::GetAssignmentShort(int run, const string& p
 		return nullptr;
 	}
 
-    //If We have not found data for this variation, getting data for parent variation
-    if(mReturnedRowsNum==0 && variation->GetParentDbId()!=0)
-    {
-        delete table;
-		return GetAssignmentShort(run, path, time, variation->GetParent()->GetName(), loadColumns);
-    }
-
 	//Ok! We queried our run range! lets catch it! 
 	if(!FetchRow())
 	{
@@ -843,7 +848,7 @@ Assignment* ccdb::MySQLDataProvider::GetAssignmentShort(int run, const string& p
 	
 	//additional fill
 	result->SetRequestedRun(run);
-	result->SetVariationId(variation->GetId());
+	result->SetVariationId(ReadIndex(2));      //the variation of the chain that has data
 	
     //type table
     result->SetTypeTable(table);
@@ -1295,6 +1300,7 @@ bool ccdb::MySQLDataProvider::QuerySelect(const char* query)
 	}
 
 	//query
+	TraceSpan span(TracePhase::Sql, query, strlen(query));
 	if(mysql_query(mMySQLHnd, query))
 	{
 		string errStr = ComposeMySQLError("mysql_query()"); errStr.append("\n Query: "); errStr.append(query);
@@ -1341,6 +1347,7 @@ bool ccdb::MySQLDataProvider::QueryCustom( const string& query )
 		FreeMySQLResult();
 	}
 	//query
+	TraceSpan span(TracePhase::Sql, query);
 	if(mysql_query(mMySQLHnd, query.c_str()))
 	{
 		string errStr = ComposeMySQLError("mysql_query()"); errStr.append("\n Query: "); errStr.append(query);
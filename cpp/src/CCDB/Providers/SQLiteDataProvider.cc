@@ -5,6 +5,7 @@
 #include <time.h>
 #include <string.h>
 #include <limits.h>
+#include <set>
 
 #include <fmt/format.h>
 
@@ -12,6 +13,7 @@
 #include "CCDB/Helpers/StringUtils.h"
 #include "CCDB/Helpers/PathUtils.h"
 #include "CCDB/Helpers/SQLite.h"
+#include "CCDB/Helpers/Trace.h"
 #include "CCDB/Providers/SQLiteDataProvider.h"
 #include "CCDB/Model/ConstantsTypeTable.h"
 #include "CCDB/Model/RunRange.h"
@@ -19,10 +21,93 @@
 
 using namespace ccdb;
 
-ccdb::SQLiteDataProvider::SQLiteDataProvider()
+/// The newest assignment of the table for the run in the variation ?2 or, if it has none, in the nearest parent.
+/// The variation chain is walked by the recursive CTE, so the whole fallback is one query
+#define CCDB_SQLITE_ASSIGNMENT_QUERY(timeCondition) \
+    "WITH RECURSIVE `chain`(`variationId`, `depth`) AS ( " \
+    "SELECT ?2, 0 " \
+    "UNION ALL " \
+    "SELECT `variations`.`parentId`, `chain`.`depth` + 1 FROM `variations` " \
+    "INNER JOIN `chain` ON `variations`.`id` = `chain`.`variationId` " \
+    "WHERE `variations`.`parentId` > 0 AND `chain`.`depth` < 64) " \
+    "SELECT `assignments`.`id` AS `asId`, " \
+    "`constantSets`.`vault` AS `blob`, " \
+    "`assignments`.`variationId`, " \
+    "`runRanges`.`runMin`, " \
+    "`runRanges`.`runMax`, " \
+    "`chain`.`depth` " \
+    "FROM `chain` " \
+    "INNER JOIN `assignments` ON `assignments`.`variationId` = `chain`.`variationId` " \
+    "INNER JOIN `runRanges` ON `assignments`.`runRangeId`= `runRanges`.`id` " \
+    "INNER JOIN `constantSets` ON `assignments`.`constantSetId` = `constantSets`.`id` " \
+    "WHERE  `runRanges`.`runMin` <= ?1 " \
+    "AND `runRanges`.`runMax` >= ?1 " \
+    "AND  `constantSets`.`constantTypeId` =?3 " \
+    timeCondition \
+    "ORDER BY `chain`.`depth` ASC, `assignments`.`id` DESC " \
+    "LIMIT 1 "
+
+/// All assignments of a type table and variation with their run ranges (for RunRangeIndex)
+#define CCDB_SQLITE_RUN_RANGES_QUERY(timeCondition) \
+    "SELECT `assignments`.`id`, `runRanges`.`runMin`, `runRanges`.`runMax`, `assignments`.`constantSetId` " \
+    "FROM  `assignments` " \
+    "INNER JOIN `runRanges` ON `assignments`.`runRangeId`= `runRanges`.`id` " \
+    "INNER JOIN `constantSets` ON `assignments`.`constantSetId` = `constantSets`.`id` " \
+    "WHERE `assignments`.`variationId`= ?1 " \
+    "AND  `constantSets`.`constantTypeId` =?2 " \
+    timeCondition
+
+/// Ids of a GetAssignmentsShort list (@see SQLiteDataProvider::SetBatchIds)
+#define CCDB_SQLITE_BATCH_IDS(listParameter) \
+    "(SELECT `id` FROM temp.`ccdb_batch_ids` WHERE `listId` = " listParameter ")"
+
+/// Candidate assignments of the listed tables and variations that cover the run ?1
+#define CCDB_SQLITE_BATCH_ASSIGNMENTS_QUERY(timeCondition) \
+    "SELECT `assignments`.`id`, `constantSets`.`constantTypeId`, `assignments`.`variationId`, `assignments`.`constantSetId`, " \
+    "`runRanges`.`runMin`, `runRanges`.`runMax` " \
+    "FROM  `assignments` " \
+    "INNER JOIN `runRanges` ON `assignments`.`runRangeId`= `runRanges`.`id` " \
+    "INNER JOIN `constantSets` ON `assignments`.`constantSetId` = `constantSets`.`id` " \
+    "WHERE  `runRanges`.`runMin` <= ?1 " \
+    "AND `runRanges`.`runMax` >= ?1 " \
+    "AND `assignments`.`variationId` IN " CCDB_SQLITE_BATCH_IDS("?2") " " \
+    "AND  `constantSets`.`constantTypeId` IN " CCDB_SQLITE_BATCH_IDS("?3") " " \
+    timeCondition
+
+/// SQL of SQLiteDataProvider::CachedStatements (in the same order)
+static const char* const cCachedStatementQueries[] = {
+    /* cStatementDirectories      */ "SELECT `id`, `name`, `parentId`, `comment` FROM `directories`",
+    /* cStatementTypeTable        */ "SELECT `id`, `name`, `directoryId`, `nRows`, `nColumns`, `comment` "
+                                     "FROM `typeTables` WHERE `name` = ?1 AND `directoryId` = ?2",
+    /* cStatementAllTypeTables    */ "SELECT `id`, `name`, `directoryId`, `nRows`, `nColumns`, `comment` FROM typeTables",
+    /* cStatementColumns          */ "SELECT `id`, `name`, `columnType` FROM `columns` WHERE `typeId` = ?1 ORDER BY `order`",
+    /* cStatementVariationByName  */ "SELECT `id`, `parentId`, `name` FROM `variations` WHERE `name`= ?1",
+    /* cStatementVariationById    */ "SELECT `id`, `parentId`, `name` FROM `variations` WHERE `id`= ?1",
+    /* cStatementAssignment       */ CCDB_SQLITE_ASSIGNMENT_QUERY(""),
+    /* cStatementAssignmentByTime */ CCDB_SQLITE_ASSIGNMENT_QUERY("AND  `assignments`.`created` <= datetime(?4, 'unixepoch', 'localtime') "),
+    /* cStatementRunRanges        */ CCDB_SQLITE_RUN_RANGES_QUERY(""),
+    /* cStatementRunRangesByTime  */ CCDB_SQLITE_RUN_RANGES_QUERY("AND  `assignments`.`created` <= datetime(?3, 'unixepoch', 'localtime') "),
+    /* cStatementVault            */ "SELECT `vault` FROM `constantSets` WHERE `id` = ?1",
+    /* cStatementBatchIdsClear    */ "DELETE FROM temp.`ccdb_batch_ids` WHERE `listId` = ?1",
+    /* cStatementBatchIdsInsert   */ "INSERT OR IGNORE INTO temp.`ccdb_batch_ids` (`listId`, `id`) VALUES (?1, ?2)",
+    /* cStatementBatchTypeTables  */ "SELECT `id`, `name`, `directoryId`, `nRows`, `nColumns`, `comment` FROM `typeTables` "
+                                     "WHERE `directoryId` IN " CCDB_SQLITE_BATCH_IDS("?1"),
+    /* cStatementBatchColumns     */ "SELECT `id`, `name`, `columnType`, `typeId` FROM `columns` "
+                                     "WHERE `typeId` IN " CCDB_SQLITE_BATCH_IDS("?1") " ORDER BY `typeId`, `order`",
+    /* cStatementBatchAssignments */ CCDB_SQLITE_BATCH_ASSIGNMENTS_QUERY(""),
+    /* cStatementBatchAssignmentsByTime */ CCDB_SQLITE_BATCH_ASSIGNMENTS_QUERY("AND  `assignments`.`created` <= datetime(?4, 'unixepoch', 'localtime') "),
+    /* cStatementBatchVaults      */ "SELECT `id`, `vault` FROM `constantSets` WHERE `id` IN " CCDB_SQLITE_BATCH_IDS("?1")
+};
+
+ccdb::SQLiteDataProvider::SQLiteDataProvider():
+	mConnectionGeneration(0),
+	mStatementHits(0),
+	mStatementMisses(0),
+	mIsRunRangeIndexEnabled(false)
 {
+	static_assert(sizeof(cCachedStatementQueries)/sizeof(cCachedStatementQueries[0]) == cStatementsCount,
+	              "cCachedStatementQueries doesn't match CachedStatements");
 	mIsConnected = false;
-	mDatabase=nullptr;
 	mRootDir = new Directory();
 	mDirsAreLoaded = false;
 }
@@ -33,6 +118,9 @@ ccdb::SQLiteDataProvider::~SQLiteDataProvider()
 	if(IsConnected()) {
 		Disconnect();
 	}
+
+	//directories and variations are released with their arenas
+	delete mRootDir;
 }
 
 
@@ -61,24 +149,150 @@ void ccdb::SQLiteDataProvider::Connect(const std::string& connectionString )
 
     std::string filePath (connectionString);
     filePath.erase(0,9);            // ok we dont need sqlite:// in the beginning.
+    mFilePath = filePath;
 
-	//Try to open sqlite database
-	int result = sqlite3_open_v2(filePath.c_str(), &mDatabase, SQLITE_OPEN_READONLY|SQLITE_OPEN_FULLMUTEX|SQLITE_OPEN_SHAREDCACHE, nullptr); // NOLINT(hicpp-signed-bitwise)
-
-	if (result != SQLITE_OK) 
+	//Try to open sqlite database. The first connection goes to the pool
+	PooledConnection* connection;
+	try
+	{
+		connection = OpenConnection();
+	}
+	catch (std::exception& ex)
 	{
-		string errStr(sqlite3_errmsg(mDatabase));
-		mDatabase=nullptr;		//some compilers dont set NULL after delete
 		mConnectionString = "";
-        throw std::runtime_error(thisFuncName + "=> SQLite open error:" + errStr);
+		throw std::runtime_error(thisFuncName + "=> " + ex.what());
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mConnectionsMutex);
+		connection->Generation = mConnectionGeneration;
+		mIdleConnections.push_back(connection);
 	}
 
-    sqlite3_exec(mDatabase, "PRAGMA journal_mode = OFF;", nullptr, nullptr, nullptr);
-	
 	mIsConnected = true;
 }
 
 
+ccdb::SQLiteDataProvider::PooledConnection* ccdb::SQLiteDataProvider::OpenConnection()
+{
+	// Each connection is used by one thread at a time, so SQLite mutexes are not needed.
+	// No shared cache: it would make connections wait for each other's table locks
+	sqlite3* connection = nullptr;
+	int result = sqlite3_open_v2(mFilePath.c_str(), &connection, SQLITE_OPEN_READONLY|SQLITE_OPEN_NOMUTEX, nullptr); // NOLINT(hicpp-signed-bitwise)
+
+	if (result != SQLITE_OK)
+	{
+		string errStr(connection ? sqlite3_errmsg(connection) : "out of memory");
+		sqlite3_close(connection);
+		throw std::runtime_error("SQLite open error:" + errStr);
+	}
+
+	sqlite3_exec(connection, "PRAGMA journal_mode = OFF;", nullptr, nullptr, nullptr);
+
+	//id lists of GetAssignmentsShort. The temporary database is writable on a read-only connection
+	result = sqlite3_exec(connection,
+		"CREATE TEMP TABLE `ccdb_batch_ids` (`listId` INTEGER NOT NULL, `id` INTEGER NOT NULL, PRIMARY KEY (`listId`, `id`)) WITHOUT ROWID",
+		nullptr, nullptr, nullptr);
+	if (result != SQLITE_OK)
+	{
+		string errStr(sqlite3_errmsg(connection));
+		sqlite3_close(connection);
+		throw std::runtime_error("SQLite temporary table error:" + errStr);
+	}
+
+	auto pooledConnection = new PooledConnection();
+	pooledConnection->Database = connection;
+	return pooledConnection;
+}
+
+
+void ccdb::SQLiteDataProvider::CloseConnection(PooledConnection* connection)
+{
+	//statements must be finalized before the connection is closed
+	for(auto& statement: connection->Statements) statement.reset();
+	sqlite3_close(connection->Database);
+	delete connection;
+}
+
+
+ccdb::SQLiteDataProvider::PooledConnection* ccdb::SQLiteDataProvider::AcquireConnection()
+{
+	if(!IsConnected()) {
+		throw std::runtime_error("ccdb::SQLiteDataProvider => Not connected to SQLite database");
+	}
+
+	uint64_t generation;
+	{
+		std::lock_guard<std::mutex> lock(mConnectionsMutex);
+		if(!mIdleConnections.empty()) {
+			PooledConnection* connection = mIdleConnections.back();
+			mIdleConnections.pop_back();
+			return connection;
+		}
+		generation = mConnectionGeneration;
+	}
+
+	// All connections are busy. Opening is done out of the lock
+	PooledConnection* connection = OpenConnection();
+	connection->Generation = generation;
+	return connection;
+}
+
+
+void ccdb::SQLiteDataProvider::ReleaseConnection(PooledConnection* connection)
+{
+	{
+		std::lock_guard<std::mutex> lock(mConnectionsMutex);
+		if(IsConnected() && connection->Generation == mConnectionGeneration) {
+			mIdleConnections.push_back(connection);
+			return;
+		}
+	}
+
+	// Disconnect was called while the connection was leased (it may be connected to another file since)
+	CloseConnection(connection);
+}
+
+
+ccdb::SQLiteDataProvider::ConnectionLease::ConnectionLease(SQLiteDataProvider* provider):
+	mProvider(provider),
+	mConnection(provider->AcquireConnection())
+{
+}
+
+
+ccdb::SQLiteDataProvider::ConnectionLease::~ConnectionLease()
+{
+	mProvider->ReleaseConnection(mConnection);
+}
+
+
+SQLiteStatement& ccdb::SQLiteDataProvider::ConnectionLease::GetStatement(CachedStatements statementId)
+{
+	std::unique_ptr<SQLiteStatement>& statement = mConnection->Statements[statementId];
+	if(statement) {
+		statement->Reset();
+		mProvider->mStatementHits.fetch_add(1, std::memory_order_relaxed);
+		return *statement;
+	}
+
+	std::unique_ptr<SQLiteStatement> newStatement(new SQLiteStatement(mConnection->Database));
+	newStatement->Prepare(cCachedStatementQueries[statementId], /*isPersistent*/ true);
+	statement = std::move(newStatement);
+	mProvider->mStatementMisses.fetch_add(1, std::memory_order_relaxed);
+	return *statement;
+}
+
+
+SQLiteStatementCacheStats ccdb::SQLiteDataProvider::GetStatementCacheStats() const
+{
+	SQLiteStatementCacheStats stats;
+	stats.Hits = mStatementHits.load(std::memory_order_relaxed);
+	stats.Misses = mStatementMisses.load(std::memory_order_relaxed);
+	return stats;
+}
+
+
 bool ccdb::SQLiteDataProvider::IsConnected()
 {
 	return mIsConnected;
@@ -89,15 +303,24 @@ void ccdb::SQLiteDataProvider::Disconnect()
 {
 	if(IsConnected())
 	{
-		sqlite3_close(mDatabase);
-		mDatabase = nullptr;
+		std::lock_guard<std::mutex> lock(mConnectionsMutex);
 		mIsConnected = false;
+		mConnectionGeneration++;
+
+		//leased connections are closed when they are released
+		for(PooledConnection* connection: mIdleConnections) CloseConnection(connection);
+		mIdleConnections.clear();
 	}
+
+	//the database may be changed before the next connection
+	std::lock_guard<std::mutex> lock(mRunRangeIndexesMutex);
+	mRunRangeIndexes.clear();
 }
 
 
 void ccdb::SQLiteDataProvider::LoadDirectories()
 {
+    TraceSpan span(TracePhase::Metadata, "directories", 11);
 
     string thisFunc("SQliteDataProvider::LoadDirectories");
     //
@@ -106,17 +329,17 @@ void ccdb::SQLiteDataProvider::LoadDirectories()
     }
     // prepare the SQL statement from the command line
 
-    SQLiteStatement query(mDatabase, "SELECT `id`, `name`, `parentId`, `comment` FROM `directories`");
+    ConnectionLease connection(this);
+    SQLiteStatement& query = connection.GetStatement(cStatementDirectories);
 
 
-    //clear diretory arrays
-    mDirectories.clear();
-    mDirectoriesById.clear();
+    //release the previous directories
+    ClearDirectories();
 
     Directory *dir = nullptr;
 
     query.Execute([&dir, &query, this](uint64_t rowIndex) {
-        dir = new Directory();
+        dir = mDirectoriesArena.Create<Directory>();
         dir->SetId(query.ReadUInt64(0));              // `id`,
         dir->SetName(query.ReadString(1));            // `name`,
         dir->SetParentId(query.ReadInt32(2));         // `parentId`,
@@ -126,9 +349,6 @@ void ccdb::SQLiteDataProvider::LoadDirectories()
         mDirectoriesById[dir->GetId()] = dir;
     });
 
-    //clear root directory (delete all directory structure objects)
-    mRootDir->DisposeSubdirectories();
-
     BuildDirectoryDependencies();
 
     mDirsAreLoaded = true;
@@ -149,10 +369,9 @@ ConstantsTypeTable * ccdb::SQLiteDataProvider::GetConstantsTypeTable( const stri
         throw std::runtime_error(thisFunc + " => Parent directory is null or have invalid ID");
 	}
 
-	SQLiteStatement query(mDatabase);
-	query.Prepare("SELECT `id`, `name`, `directoryId`, `nRows`, `nColumns`, `comment` "
-                  "FROM `typeTables` WHERE `name` = ?1 AND `directoryId` = ?2");
-	query.BindString(1, name);
+	ConnectionLease connection(this);
+	SQLiteStatement& query = connection.GetStatement(cStatementTypeTable);
+	query.BindStringStatic(1, name);      //name outlives Execute
 	query.BindInt64(2, parentDir->GetId());
 
 	// execute the statement
@@ -187,8 +406,8 @@ std::vector<ConstantsTypeTable *> ccdb::SQLiteDataProvider::GetAllConstantsTypeT
     UpdateDirectoriesIfNeeded();
 
 	//combine query
-    SQLiteStatement query(mDatabase);
-    query.Prepare("SELECT `id`, `name`, `directoryId`, `nRows`, `nColumns`, `comment` FROM typeTables");
+    ConnectionLease connection(this);
+    SQLiteStatement& query = connection.GetStatement(cStatementAllTypeTables);
 
     // execute the statement
     std::vector<ConstantsTypeTable *> tables;
@@ -202,7 +421,8 @@ std::vector<ConstantsTypeTable *> ccdb::SQLiteDataProvider::GetAllConstantsTypeT
         table->SetNRows(query.ReadUInt32(3));
         table->SetNColumnsFromDB(query.ReadUInt32(4));
         table->SetComment(query.ReadString(5));
-        table->SetDirectory(mDirectoriesById[table->GetDirectoryId()]);
+        auto dirIter = mDirectoriesById.find(table->GetDirectoryId());   //find doesn't change the map shared by threads
+        table->SetDirectory(dirIter != mDirectoriesById.end() ? dirIter->second : nullptr);
         tables.push_back(table);
     });
 
@@ -221,8 +441,8 @@ std::vector<ConstantsTypeTable *> ccdb::SQLiteDataProvider::GetAllConstantsTypeT
 
 void ccdb::SQLiteDataProvider::LoadColumns( ConstantsTypeTable* table )
 {
-    SQLiteStatement query(mDatabase);
-    query.Prepare("SELECT `id`, `name`, `columnType` FROM `columns` WHERE `typeId` = ?1 ORDER BY `order`");
+    ConnectionLease connection(this);
+    SQLiteStatement& query = connection.GetStatement(cStatementColumns);
 	query.BindInt32(1, table->GetId());
 
     // execute the statement
@@ -240,33 +460,75 @@ void ccdb::SQLiteDataProvider::LoadColumns( ConstantsTypeTable* table )
 
 
 Variation* ccdb::SQLiteDataProvider::GetVariation( const string& name )
+{
+    //Variations are shared by all threads. Once loaded, variation objects are not changed
+    std::lock_guard<std::mutex> lock(mVariationsMutex);
+    return GetVariationUnlocked(name);
+}
+
+
+Variation* ccdb::SQLiteDataProvider::GetVariationUnlocked( const string& name )
 {
     //check that maybe we have this variation id by the last request?
     if(mVariationsByName.find(name) != mVariationsByName.end()) return mVariationsByName[name];
-    SQLiteStatement query(mDatabase);
-    query.Prepare("SELECT `id`, `parentId`, `name` FROM `variations` WHERE `name`= ?1");
-    query.BindString(1, name);
+
+    //the catalog knows all the variations that existed when it was loaded
+    if(mIsCatalogEnabled) {
+        std::shared_ptr<const Catalog> catalog = GetLoadedCatalog();
+        if(catalog) {
+            Variation* variation = GetCatalogVariationUnlocked(catalog->FindVariation(name));
+            if(variation) return variation;
+        }
+    }
+
+    ConnectionLease connection(this);
+    SQLiteStatement& query = connection.GetStatement(cStatementVariationByName);
+    query.BindStringStatic(1, name);      //name outlives Execute
     return SelectVariation(query);
 }
 
 
 Variation* ccdb::SQLiteDataProvider::GetVariationById( dbkey_t id )
+{
+    std::lock_guard<std::mutex> lock(mVariationsMutex);
+    return GetVariationByIdUnlocked(id);
+}
+
+
+Variation* ccdb::SQLiteDataProvider::GetVariationByIdUnlocked( dbkey_t id )
 {
     //check that maybe we have this variation id by the last request?
     if(mVariationsById.find(id) != mVariationsById.end()) return mVariationsById[id];
-    SQLiteStatement query(mDatabase);
-    query.Prepare("SELECT `id`, `parentId`, `name` FROM `variations` WHERE `id`= ?1");
+    ConnectionLease connection(this);
+    SQLiteStatement& query = connection.GetStatement(cStatementVariationById);
     query.BindInt64(1, id);
     return SelectVariation(query);
 }
 
 
+Variation* ccdb::SQLiteDataProvider::GetCatalogVariationUnlocked(const CatalogVariation* record)
+{
+    if(!record) return nullptr;
+    auto variationIter = mVariationsById.find(record->Id);
+    if(variationIter != mVariationsById.end()) return variationIter->second;
+
+    auto var = mVariationsArena.Create<Variation>();
+    var->SetId(record->Id);
+    var->SetParentDbId(record->ParentId);
+    var->SetName(record->Name);
+    mVariationsById[var->GetId()] = var;
+    mVariationsByName[var->GetName()] = var;
+    if(var->GetParentDbId() > 0) var->SetParent(GetVariationByIdUnlocked(var->GetParentDbId()));
+    return var;
+}
+
+
 Variation* ccdb::SQLiteDataProvider::SelectVariation(SQLiteStatement& query)
 {
     // execute the statement
     Variation *var = nullptr;
     query.Execute([&var, &query, this](uint64_t rowIndex) {
-        var = new Variation();
+        var = mVariationsArena.Create<Variation>();
         var->SetId(query.ReadUInt64(0));
         var->SetParentDbId(query.ReadUInt64(1));
         var->SetName(query.ReadString(2));
@@ -279,7 +541,7 @@ Variation* ccdb::SQLiteDataProvider::SelectVariation(SQLiteStatement& query)
 
         //recursive call to get variation parent
         if(var->GetParentDbId() > 0) {
-            var->SetParent(GetVariationById(var->GetParentDbId()));
+            var->SetParent(GetVariationByIdUnlocked(var->GetParentDbId()));
         }
     }
     
@@ -289,8 +551,14 @@ Variation* ccdb::SQLiteDataProvider::SelectVariation(SQLiteStatement& query)
 
 Assignment* ccdb::SQLiteDataProvider::GetAssignmentShort(int run, const string& path, time_t time, const string& variationName, bool loadColumns /*=false*/)
 {
-    //Get type table
-    ConstantsTypeTable *table = DataProvider::GetConstantsTypeTable(path, loadColumns);
+    //Get type table. The catalog table is shared, otherwise it is loaded for this assignment
+    std::shared_ptr<ConstantsTypeTable> sharedTable;
+    if(mIsCatalogEnabled) {
+        std::shared_ptr<const Catalog> catalog = GetCatalog();     //the record lives while the catalog is held
+        const CatalogTable* record = catalog->FindTable(path);
+        if(record) sharedTable = record->TypeTable;
+    }
+    ConstantsTypeTable *table = sharedTable ? sharedTable.get() : DataProvider::GetConstantsTypeTable(path, loadColumns);
     if(!table) {
         string error("SQLiteDataProvider::GetAssignmentShort => Type table was not found: '"+path+"'" );
         throw std::runtime_error(error);
@@ -299,56 +567,387 @@ Assignment* ccdb::SQLiteDataProvider::GetAssignmentShort(int run, const string&
     //get variation
     Variation* variation = GetVariation(variationName);
     if(!variation) {
+        if(!sharedTable) delete table;
         string error("SQLiteDataProvider::GetAssignmentShort => No variation '"+variationName+"' was found");
         throw std::runtime_error(error);
     }
 
-	////ok now we must build our mighty query...
-    SQLiteStatement query(mDatabase);
-    query.Prepare(
-        "SELECT `assignments`.`id` AS `asId`, "
-        "`constantSets`.`vault` AS `blob` "
-        "FROM  `assignments` "
-        "INNER JOIN `runRanges` ON `assignments`.`runRangeId`= `runRanges`.`id` "
-        "INNER JOIN `constantSets` ON `assignments`.`constantSetId` = `constantSets`.`id` "
-        "INNER JOIN `typeTables` ON `constantSets`.`constantTypeId` = `typeTables`.`id` "
-        "WHERE  `runRanges`.`runMin` <= ?1 "
-        "AND `runRanges`.`runMax` >= ?1 "
-        "AND `assignments`.`variationId`= ?2 "
-        "AND  `constantSets`.`constantTypeId` =?3 " + 
-        ((time>0)? string("AND  `assignments`.`created` <= datetime(?4, 'unixepoch', 'localtime') ") : string()) +
-        "ORDER BY `assignments`.`id` DESC "
-        "LIMIT 1 ");
-	
+    Assignment *assignment = SelectAssignmentInChain(run, table->GetId(), variation, time);
+
+	if(assignment != nullptr)
+	{
+        if(sharedTable) assignment->SetTypeTable(sharedTable);
+        else assignment->SetTypeTable(table, /*isOwner*/ true);    // the table is created for this assignment only
+        assignment->SetVariation(variation);
+	}
+	else if(!sharedTable)
+	{
+		delete table;
+	}
+
+	return assignment;
+}
+
+
+Assignment* ccdb::SQLiteDataProvider::GetResolvedAssignmentShort(int run, const std::shared_ptr<ConstantsTypeTable>& table, Variation* variation, time_t time)
+{
+    if(!IsConnected()) { throw std::runtime_error("ccdb::SQLiteDataProvider::GetResolvedAssignmentShort => SQLiteDataProvider is not connected to DB");}
+
+    Assignment *assignment = SelectAssignmentInChain(run, table->GetId(), variation, time);
+    if(assignment != nullptr)
+    {
+        assignment->SetTypeTable(table);
+        assignment->SetVariation(variation);
+    }
+    return assignment;
+}
+
+
+Assignment* ccdb::SQLiteDataProvider::SelectAssignmentInChain(int run, dbkey_t tableId, Variation*& variation, time_t time)
+{
+    //If there is no data for the variation, the data of the parent variation is taken. And so on
+    if(mIsRunRangeIndexEnabled)
+    {
+        for(Variation* chainVariation = variation; chainVariation; chainVariation = chainVariation->GetParent())
+        {
+            Assignment *assignment = SelectAssignmentByIndex(run, tableId, chainVariation->GetId(), time);
+            if(assignment) {
+                variation = chainVariation;
+                return assignment;
+            }
+        }
+        return nullptr;
+    }
+
+    return SelectAssignment(run, tableId, variation, time);
+}
+
+
+std::shared_ptr<const Catalog> ccdb::SQLiteDataProvider::LoadCatalog()
+{
+    std::string thisFunc("ccdb::SQLiteDataProvider::LoadCatalog");
+    if(!IsConnected()) { throw std::runtime_error(thisFunc + " => SQLiteDataProvider is not connected to DB");}
+
+    UpdateDirectoriesIfNeeded();
+
+    ConnectionLease connection(this);
+    SQLiteReadTransaction transaction(connection.Get());     //all queries see the same database state
+
+    //tables and columns of the catalog are released together when the catalog and all its tables are not used
+    auto arena = std::make_shared<ObjectArena>();
+    std::vector<ConstantsTypeTable*> tables;
+    std::map<dbkey_t, ConstantsTypeTable*> tablesById;
+    SQLiteStatement& tablesQuery = connection.GetStatement(cStatementAllTypeTables);
+    tablesQuery.Execute([&tablesQuery, &tables, &tablesById, &arena, this](uint64_t rowIndex) {
+        auto dirIter = mDirectoriesById.find(tablesQuery.ReadInt32(2));
+        if(dirIter == mDirectoriesById.end()) return;         //not reachable by path
+
+        auto table = arena->Create<ConstantsTypeTable>();
+        table->SetIsColumnsOwner(false);
+        table->SetId(tablesQuery.ReadUInt64(0));
+        table->SetName(tablesQuery.ReadString(1));
+        table->SetDirectoryId(tablesQuery.ReadUInt64(2));
+        table->SetNRows(tablesQuery.ReadUInt32(3));
+        table->SetNColumnsFromDB(tablesQuery.ReadUInt32(4));
+        table->SetComment(tablesQuery.ReadString(5));
+        table->SetFullPath(PathUtils::CombinePath(dirIter->second->GetFullPath(), table->GetName()));   //no Directory object, it may die before the catalog
+        tablesById[table->GetId()] = table;
+        tables.push_back(table);
+    });
+
+    SQLiteStatement columnsQuery(connection.Get(), "SELECT `id`, `name`, `columnType`, `typeId` FROM `columns` ORDER BY `typeId`, `order`");
+    columnsQuery.Execute([&columnsQuery, &tablesById, &arena](uint64_t rowIndex) {
+        auto tableIter = tablesById.find(columnsQuery.ReadInt32(3));
+        if(tableIter == tablesById.end()) return;
+        auto column = arena->Create<ConstantsTypeColumn>();
+        column->SetId(columnsQuery.ReadUInt64(0));
+        column->SetName(columnsQuery.ReadString(1));
+        column->SetType(columnsQuery.ReadString(2));
+        column->SetDBTypeTableId(tableIter->first);
+        tableIter->second->AddColumn(column);
+    });
+
+    std::vector<CatalogVariation> variations;
+    SQLiteStatement variationsQuery(connection.Get(), "SELECT `id`, `parentId`, `name` FROM `variations`");
+    variationsQuery.Execute([&variationsQuery, &variations](uint64_t rowIndex) {
+        variations.push_back({variationsQuery.ReadInt32(0), variationsQuery.ReadInt32(1), variationsQuery.ReadString(2)});
+    });
+
+    return std::make_shared<const Catalog>(std::move(arena), tables, std::move(variations));
+}
+
+
+void ccdb::SQLiteDataProvider::SetBatchIds(ConnectionLease& connection, BatchIdLists listId, const std::set<dbkey_t>& ids)
+{
+    SQLiteStatement& clearQuery = connection.GetStatement(cStatementBatchIdsClear);
+    clearQuery.BindInt32(1, listId);
+    clearQuery.Execute([](uint64_t) {});
+
+    SQLiteStatement& insertQuery = connection.GetStatement(cStatementBatchIdsInsert);
+    for(dbkey_t id: ids) {
+        insertQuery.Reset();
+        insertQuery.BindInt32(1, listId);
+        insertQuery.BindInt32(2, id);
+        insertQuery.Execute([](uint64_t) {});
+    }
+}
+
+
+std::vector<Assignment*> ccdb::SQLiteDataProvider::GetAssignmentsShort(const std::vector<AssignmentRequest>& requests, bool loadColumns)
+{
+    std::string thisFunc("ccdb::SQLiteDataProvider::GetAssignmentsShort");
+    if(!IsConnected()) { throw std::runtime_error(thisFunc + " => SQLiteDataProvider is not connected to DB");}
+
+    std::vector<Assignment*> assignments(requests.size(), nullptr);
+
+    //directories and variations are resolved in memory (a new variation is selected once)
+    std::shared_ptr<const Catalog> catalog = mIsCatalogEnabled ? GetCatalog() : nullptr;
+    std::vector<Directory*> directories(requests.size(), nullptr);
+    std::vector<Variation*> variations(requests.size(), nullptr);
+    std::set<dbkey_t> directoryIds;
+    for(size_t i = 0; i < requests.size(); i++) {
+        variations[i] = GetVariation(requests[i].Variation);
+        if(!variations[i] || catalog) continue;
+        directories[i] = GetDirectory(PathUtils::ExtractDirectory(requests[i].Path));
+        if(directories[i]) directoryIds.insert(directories[i]->GetId());
+    }
+
+    //type tables are shared by the assignments: tables of the catalog or tables loaded here once per call
+    std::vector<std::shared_ptr<ConstantsTypeTable>> requestTables(requests.size());
+    if(catalog) {
+        for(size_t i = 0; i < requests.size(); i++) {
+            const CatalogTable* record = variations[i] ? catalog->FindTable(requests[i].Path) : nullptr;
+            if(record) requestTables[i] = record->TypeTable;
+        }
+    }
+    else if(directoryIds.empty()) {
+        return assignments;
+    }
+
+    ConnectionLease connection(this);
+    SQLiteReadTransaction transaction(connection.Get());     //all queries see the same database state
+
+    if(!catalog) {
+        //type tables of the directories, names are matched in memory
+        std::map<std::pair<dbkey_t, std::string>, std::shared_ptr<ConstantsTypeTable>> tables;
+        SetBatchIds(connection, cBatchDirectoryIds, directoryIds);
+        SQLiteStatement& tablesQuery = connection.GetStatement(cStatementBatchTypeTables);
+        tablesQuery.BindInt32(1, cBatchDirectoryIds);
+        tablesQuery.Execute([&tablesQuery, &tables](uint64_t rowIndex) {
+            auto table = std::make_shared<ConstantsTypeTable>();
+            table->SetId(tablesQuery.ReadInt32(0));
+            table->SetName(tablesQuery.ReadString(1));
+            table->SetDirectoryId(tablesQuery.ReadInt32(2));
+            table->SetNRows(tablesQuery.ReadInt32(3));
+            table->SetNColumnsFromDB(tablesQuery.ReadInt32(4));
+            table->SetComment(tablesQuery.ReadString(5));
+            tables[std::make_pair(static_cast<dbkey_t>(table->GetDirectoryId()), table->GetName())] = table;
+        });
+
+        std::map<dbkey_t, ConstantsTypeTable*> tablesById;
+        for(size_t i = 0; i < requests.size(); i++) {
+            if(!directories[i]) continue;
+            auto tableIter = tables.find(std::make_pair(static_cast<dbkey_t>(directories[i]->GetId()), PathUtils::ExtractObjectname(requests[i].Path)));
+            if(tableIter == tables.end()) continue;
+            ConstantsTypeTable* table = tableIter->second.get();
+            table->SetDirectory(directories[i]);
+            table->SetFullPath(PathUtils::CombinePath(directories[i]->GetFullPath(), table->GetName()));
+            requestTables[i] = tableIter->second;
+            tablesById[table->GetId()] = table;
+        }
+
+        if(loadColumns && !tablesById.empty()) {
+            std::set<dbkey_t> tableIds;
+            for(auto& idTable: tablesById) tableIds.insert(idTable.first);
+            SetBatchIds(connection, cBatchTableIds, tableIds);
+
+            SQLiteStatement& columnsQuery = connection.GetStatement(cStatementBatchColumns);
+            columnsQuery.BindInt32(1, cBatchTableIds);
+            columnsQuery.Execute([&columnsQuery, &tablesById](uint64_t rowIndex) {
+                auto column = new ConstantsTypeColumn();
+                column->SetId(columnsQuery.ReadInt32(0));
+                column->SetName(columnsQuery.ReadString(1));
+                column->SetType(columnsQuery.ReadString(2));
+                column->SetDBTypeTableId(columnsQuery.ReadInt32(3));
+                tablesById[columnsQuery.ReadInt32(3)]->AddColumn(column);
+            });
+        }
+    }
+
+    //requests with the same run and time are resolved by one query over all their tables and variation chains
+    std::map<std::pair<int, time_t>, std::vector<size_t>> groups;
+    for(size_t i = 0; i < requests.size(); i++) {
+        if(requestTables[i]) groups[std::make_pair(requests[i].RunNumber, requests[i].Time > 0 ? requests[i].Time : 0)].push_back(i);
+    }
+
+    std::vector<RunRangeIndex::Item> selected(requests.size(), RunRangeIndex::Item{0, 0, 0, 0});
+    std::vector<Variation*> selectedVariations(requests.size(), nullptr);
+    std::set<dbkey_t> constantSetIds;
+    for(auto& group: groups) {
+        int run = group.first.first;
+        time_t time = group.first.second;
+
+        std::set<dbkey_t> groupTableIds;
+        std::set<dbkey_t> groupVariationIds;
+        for(size_t i: group.second) {
+            groupTableIds.insert(requestTables[i]->GetId());
+            for(Variation* variation = variations[i]; variation; variation = variation->GetParent()) groupVariationIds.insert(variation->GetId());
+        }
+        SetBatchIds(connection, cBatchTableIds, groupTableIds);
+        SetBatchIds(connection, cBatchVariationIds, groupVariationIds);
+
+        //the newest assignment of each (table, variation) that covers the run. Blobs are not selected yet
+        std::map<std::pair<dbkey_t, dbkey_t>, RunRangeIndex::Item> newest;
+        SQLiteStatement& query = connection.GetStatement((time > 0) ? cStatementBatchAssignmentsByTime : cStatementBatchAssignments);
+        query.BindInt32(1, run);
+        query.BindInt32(2, cBatchVariationIds);
+        query.BindInt32(3, cBatchTableIds);
+        if(time > 0) query.BindInt64(4, time);
+        query.Execute([&query, &newest](uint64_t rowIndex) {
+            auto& found = newest[std::make_pair(query.ReadInt32(1), query.ReadInt32(2))];
+            dbkey_t assignmentId = query.ReadInt32(0);
+            if(assignmentId > found.AssignmentId) found = RunRangeIndex::Item{query.ReadInt32(4), query.ReadInt32(5), assignmentId, query.ReadInt32(3)};
+        });
+
+        //If there is no data for the variation, the parent variation is looked up
+        for(size_t i: group.second) {
+            for(Variation* variation = variations[i]; variation; variation = variation->GetParent()) {
+                auto newestIter = newest.find(std::make_pair(static_cast<dbkey_t>(requestTables[i]->GetId()), static_cast<dbkey_t>(variation->GetId())));
+                if(newestIter == newest.end()) continue;
+                selected[i] = newestIter->second;
+                selectedVariations[i] = variation;
+                constantSetIds.insert(newestIter->second.ConstantSetId);
+                break;
+            }
+        }
+    }
+    if(constantSetIds.empty()) return assignments;
+
+    std::map<dbkey_t, std::string> blobs;
+    SetBatchIds(connection, cBatchConstantSetIds, constantSetIds);
+    SQLiteStatement& blobsQuery = connection.GetStatement(cStatementBatchVaults);
+    blobsQuery.BindInt32(1, cBatchConstantSetIds);
+    blobsQuery.Execute([&blobsQuery, &blobs](uint64_t rowIndex) {
+        blobs[blobsQuery.ReadInt32(0)] = blobsQuery.ReadString(1);
+    });
+
+    for(size_t i = 0; i < requests.size(); i++) {
+        if(!selectedVariations[i]) continue;
+
+        auto assignment = new Assignment();
+        assignment->SetId(selected[i].AssignmentId);
+        assignment->SetRawData(blobs[selected[i].ConstantSetId]);
+        assignment->SetRequestedRun(requests[i].RunNumber);
+        assignment->SetRunRange(selected[i].RunMin, selected[i].RunMax);
+        assignment->SetTypeTable(requestTables[i]);
+        assignment->SetVariation(selectedVariations[i]);
+        assignments[i] = assignment;
+    }
+
+    return assignments;
+}
+
+
+Assignment* ccdb::SQLiteDataProvider::SelectAssignment(int run, dbkey_t tableId, Variation*& variation, time_t time)
+{
+	////ok now we take our mighty query. The time condition is a separate statement,
+	////so the query plan without it stays the same
+    ConnectionLease connection(this);
+    SQLiteStatement& query = connection.GetStatement((time>0) ? cStatementAssignmentByTime : cStatementAssignment);
+
     query.BindInt32(1, run);
 	query.BindInt32(2, variation->GetId());	/*`variationId`*/
-	query.BindInt32(3, table->GetId());	    /*``typeTables`.`directoryId``*/
-    
+	query.BindInt32(3, tableId);	    /*``typeTables`.`directoryId``*/
+
     if(time>0) {
         query.BindInt64(4, time);	/*` `assignments`.`created``*/
     }
 
 	// execute the statement
 	Assignment *assignment = nullptr;
-    auto selectedRows = query.Execute([&assignment, &query, run](uint64_t rowIndex) {
+	int foundDepth = 0;
+    query.Execute([&assignment, &foundDepth, &query, run](uint64_t rowIndex) {
         assignment = new Assignment();
         assignment->SetId( query.ReadUInt64(0) );
         assignment->SetRawData(query.ReadString(1));
         assignment->SetRequestedRun(run);
+        assignment->SetRunRange(query.ReadInt32(3), query.ReadInt32(4));
+        foundDepth = query.ReadInt32(5);
     });
 
+    //the query walked the same chain, the assignment belongs to the variation at its depth
+    for(int depth = 0; depth < foundDepth && variation->GetParent(); depth++) variation = variation->GetParent();
+    return assignment;
+}
+
+
+Assignment* ccdb::SQLiteDataProvider::SelectAssignmentByIndex(int run, dbkey_t tableId, dbkey_t variationId, time_t time)
+{
+    std::shared_ptr<const RunRangeIndex> index = GetRunRangeIndex(tableId, variationId, time);
+    const RunRangeIndex::Item* item = index->Find(run);
+    if(!item) return nullptr;
+
+    //only the blob is left to select, by the primary key
+    ConnectionLease connection(this);
+    SQLiteStatement& query = connection.GetStatement(cStatementVault);
+    query.BindInt32(1, item->ConstantSetId);
+
+    Assignment *assignment = nullptr;
+    query.Execute([&assignment, &query, item, run](uint64_t rowIndex) {
+        assignment = new Assignment();
+        assignment->SetId(item->AssignmentId);
+        assignment->SetRawData(query.ReadString(0));
+        assignment->SetRequestedRun(run);
+        assignment->SetRunRange(item->RunMin, item->RunMax);
+    });
 
-    //If We have not found data for this variation, getting data for parent variation
-    if((assignment == nullptr && selectedRows==0) && variation->GetParentDbId()!=0)
+    return assignment;
+}
+
+
+std::shared_ptr<const RunRangeIndex> ccdb::SQLiteDataProvider::GetRunRangeIndex(dbkey_t tableId, dbkey_t variationId, time_t time)
+{
+    if(time < 0) time = 0;      //as in SelectAssignment, no time condition for time <= 0
+    RunRangeIndexKey key(tableId, variationId, time);
     {
-        return GetAssignmentShort(run, path, time, variation->GetParent()->GetName(), loadColumns);
+        std::lock_guard<std::mutex> lock(mRunRangeIndexesMutex);
+        auto indexIter = mRunRangeIndexes.find(key);
+        if(indexIter != mRunRangeIndexes.end()) return indexIter->second;
     }
-    
-	if(assignment != nullptr)
-	{
-        assignment->SetTypeTable(table);
-        assignment->SetVariation(variation);
-	}
 
-	return assignment;
-}
\ No newline at end of file
+    //Load out of the lock. If two threads load the same index, the first one is kept
+    std::vector<RunRangeIndex::Item> items;
+    {
+        ConnectionLease connection(this);
+        SQLiteStatement& query = connection.GetStatement((time>0) ? cStatementRunRangesByTime : cStatementRunRanges);
+        query.BindInt32(1, variationId);
+        query.BindInt32(2, tableId);
+        if(time>0) query.BindInt64(3, time);
+
+        query.Execute([&items, &query](uint64_t rowIndex) {
+            RunRangeIndex::Item item;
+            item.AssignmentId = query.ReadInt32(0);
+            item.RunMin = query.ReadInt32(1);
+            item.RunMax = query.ReadInt32(2);
+            item.ConstantSetId = query.ReadInt32(3);
+            items.push_back(item);
+        });
+    }
+
+    auto index = std::make_shared<const RunRangeIndex>(std::move(items));
+    std::lock_guard<std::mutex> lock(mRunRangeIndexesMutex);
+    return mRunRangeIndexes.emplace(key, index).first->second;
+}
+
+
+void ccdb::SQLiteDataProvider::SetRunRangeIndexEnabled(bool isEnabled)
+{
+    mIsRunRangeIndexEnabled = isEnabled;
+}
+
+
+size_t ccdb::SQLiteDataProvider::GetRunRangeIndexesCount()
+{
+    std::lock_guard<std::mutex> lock(mRunRangeIndexesMutex);
+    return mRunRangeIndexes.size();
+}
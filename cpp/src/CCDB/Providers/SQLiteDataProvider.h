@@ -5,10 +5,16 @@
 #include <sqlite3.h>
 #include <vector>
 #include <map>
+#include <set>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <tuple>
 
 #include "CCDB/Providers/DataProvider.h"
 #include "CCDB/Model/ConstantsTypeTable.h"
 #include "CCDB/Helpers/SQLite.h"
+#include "CCDB/Helpers/RunRangeIndex.h"
 
 ///We making this define to be sure if we switch to other library nothing will change
 //#define SQLITE_ULONG my_ulonglong
@@ -16,6 +22,13 @@
 namespace ccdb
 {
 
+/** @brief Usage statistics of SQLiteDataProvider prepared statements cache */
+struct SQLiteStatementCacheStats
+{
+    uint64_t Hits = 0;         ///How many times an already prepared statement was reused
+    uint64_t Misses = 0;       ///How many times a statement was compiled
+};
+
 class SQLiteDataProvider: public DataProvider
 {
 	
@@ -79,6 +92,9 @@ public:
     /** @brief Get variation by name*/
     Variation* GetVariation(const string& name) override;
 
+    /** @brief Get variation by DB id. Variations are shared with GetVariation */
+    Variation* GetVariationById(dbkey_t id);
+
     /** @brief Get specified by creation time version of Assignment with data blob only.
     *
     * This function is optimized for fast data retrieving and is assumed to be performance critical;
@@ -95,11 +111,50 @@ public:
     */
     Assignment* GetAssignmentShort(int run, const string& path, time_t time, const string& variation, bool loadColumns) override;
 
+    /** @brief Queries run on pooled connections, so many threads may read at the same time */
+    bool IsConcurrentReadSupported() override { return true; }
+
+    /** @brief Gets assignments of many requests with a few set-based queries. @see DataProvider::GetAssignmentsShort
+     *
+     * All queries run in one read transaction and are cached statements. Their id lists are put
+     * to the temporary table of the connection: type tables and columns are selected by directory ids
+     * (or are taken from the catalog if it is enabled), then candidate assignments of all tables and
+     * variation chains (one query per distinct run and time), then the blobs of the selected assignments
+     */
+    std::vector<Assignment*> GetAssignmentsShort(const std::vector<AssignmentRequest>& requests, bool loadColumns) override;
+
+    /** @brief Queries the assignment by table and variation ids and shares the table with it. @see DataProvider::GetResolvedAssignmentShort */
+    Assignment* GetResolvedAssignmentShort(int run, const std::shared_ptr<ConstantsTypeTable>& table, Variation* variation, time_t time) override;
+
 
     //----------------------------------------------------------------------------------------
     //  E N D   I M P L E M E N T   I N T E R F A C E
     //----------------------------------------------------------------------------------------
 
+    /** @brief Hits and misses of prepared statements cache (summed over all pooled connections) */
+    SQLiteStatementCacheStats GetStatementCacheStats() const;
+
+    /** @brief Enables run-range index mode of GetAssignmentShort
+     *
+     * On the first request for a (type table, variation, time) all its assignments and run ranges
+     * are loaded into RunRangeIndex. Then the assignment for any run is resolved in memory
+     * and only its blob is selected by the primary key. It pays off when many runs are visited.
+     * Indexes are kept until Disconnect, so the mode is for a database that doesn't change
+     * (or a fixed time in the past). Disabled by default
+     */
+    void SetRunRangeIndexEnabled(bool isEnabled);
+
+    /** @brief @see SetRunRangeIndexEnabled */
+    bool IsRunRangeIndexEnabled() const { return mIsRunRangeIndexEnabled; }
+
+    /** @brief Number of (type table, variation, time) indexes loaded */
+    size_t GetRunRangeIndexesCount();
+
+protected:
+
+    /** @brief Loads type tables, all columns and variations with three queries in one read transaction */
+    std::shared_ptr<const Catalog> LoadCatalog() override;
+
 	private:
 
     /** @brief Loads columns for "table" type table
@@ -109,12 +164,12 @@ public:
 	 */
     void LoadColumns(ConstantsTypeTable* table);
 
-    /** @brief Load variation by DB id
+    /** @brief Load variation by DB id. mVariationsMutex must be locked
 	 * 
 	 * @param     const char * name
 	 * @return   DVariation*
 	 */
-    Variation* GetVariationById(dbkey_t id);
+    Variation* GetVariationByIdUnlocked(dbkey_t id);
 
      /** @brief Executes statement and create Variation object. 
 	 * 
@@ -125,15 +180,129 @@ public:
 	 */
     Variation *SelectVariation(SQLiteStatement& statement);
 
+    /** @brief Selects the newest assignment of the table for the run with one query
+     *
+     * If the variation has no data, its parents are looked up by the same query (nearest first).
+     *
+     * @param [in out] variation - the requested variation, is set to the variation of the found assignment
+     */
+    Assignment* SelectAssignment(int run, dbkey_t tableId, Variation*& variation, time_t time);
+
+    /** @brief Selects the assignment of the variation or the nearest parent that has data (by the index or one query)
+     *
+     * @param [in out] variation - the requested variation, is set to the variation of the found assignment
+     */
+    Assignment* SelectAssignmentInChain(int run, dbkey_t tableId, Variation*& variation, time_t time);
+
+    /** @brief Finds the assignment for the run in RunRangeIndex and selects its blob */
+    Assignment* SelectAssignmentByIndex(int run, dbkey_t tableId, dbkey_t variationId, time_t time);
+
+    /** @brief Gets existing or loads new index for the table, variation and time */
+    std::shared_ptr<const RunRangeIndex> GetRunRangeIndex(dbkey_t tableId, dbkey_t variationId, time_t time);
+
+    /** @brief Queries which are prepared once per connection and then reused */
+    enum CachedStatements
+    {
+        cStatementDirectories,
+        cStatementTypeTable,
+        cStatementAllTypeTables,
+        cStatementColumns,
+        cStatementVariationByName,
+        cStatementVariationById,
+        cStatementAssignment,
+        cStatementAssignmentByTime,
+        cStatementRunRanges,
+        cStatementRunRangesByTime,
+        cStatementVault,
+        cStatementBatchIdsClear,
+        cStatementBatchIdsInsert,
+        cStatementBatchTypeTables,
+        cStatementBatchColumns,
+        cStatementBatchAssignments,
+        cStatementBatchAssignmentsByTime,
+        cStatementBatchVaults,
+        cStatementsCount
+    };
+
+    /** @brief Id lists of GetAssignmentsShort in the temporary table `ccdb_batch_ids` of a connection */
+    enum BatchIdLists
+    {
+        cBatchDirectoryIds,
+        cBatchTableIds,
+        cBatchVariationIds,
+        cBatchConstantSetIds
+    };
+
+    /** @brief Pooled connection with statements prepared on it */
+    struct PooledConnection
+    {
+        sqlite3* Database = nullptr;
+        uint64_t Generation = 0;            /// mConnectionGeneration when the connection was opened
+        std::unique_ptr<SQLiteStatement> Statements[cStatementsCount];
+    };
+
+    /** @brief Read-only connection leased from the pool for one query (or a few queries in a row)
+     *
+     * Each connection is opened with SQLITE_OPEN_NOMUTEX and is used by one thread at a time,
+     * so queries of different threads don't wait for each other.
+     * The connection is returned to the pool when the lease is destroyed
+     */
+    class ConnectionLease
+    {
+    public:
+        explicit ConnectionLease(SQLiteDataProvider* provider);
+        ~ConnectionLease();
+        sqlite3* Get() const { return mConnection->Database; }
+
+        /** @brief Prepared statement of this connection, ready for Bind calls
+         *
+         * The statement is compiled on the first use and is reset on the next ones.
+         * It belongs to the connection, so it must not be used after the lease is destroyed
+         */
+        SQLiteStatement& GetStatement(CachedStatements statementId);
+
+    private:
+        SQLiteDataProvider* mProvider;
+        PooledConnection* mConnection;
+
+        ConnectionLease(const ConnectionLease& rhs);
+        ConnectionLease& operator=(const ConnectionLease& rhs);
+    };
+
+    PooledConnection* OpenConnection();                     /// Opens new read-only connection to mFilePath. Throws on error
+    PooledConnection* AcquireConnection();                  /// Gets idle connection or opens a new one
+    void ReleaseConnection(PooledConnection* connection);   /// Returns connection to the pool (closes it if disconnected or reconnected since)
+    static void CloseConnection(PooledConnection* connection);  /// Finalizes the statements and closes the connection
+
+    /// Replaces the ids of the list in the temporary table `ccdb_batch_ids` of the connection
+    static void SetBatchIds(ConnectionLease& connection, BatchIdLists listId, const std::set<dbkey_t>& ids);
+
+    /// Loads variation by name. mVariationsMutex must be locked
+    Variation* GetVariationUnlocked(const string& name);
+
+    /// Makes variation (with parents) from the catalog if the catalog is enabled and loaded. mVariationsMutex must be locked
+    Variation* GetCatalogVariationUnlocked(const CatalogVariation* record);
+
 private:
 
 	//Assignment* FetchAssignment(ConstantsTypeTable *table);
 	//virtual void FetchAssignment(Assignment* assignment, ConstantsTypeTable *table);
 
 
-	sqlite3 *		mDatabase;			//Handler to sqlite object
+	std::string mFilePath;                      //Path of the database file
+	std::vector<PooledConnection*> mIdleConnections;     //Connections that are not leased now
+	uint64_t mConnectionGeneration;             //Is incremented by Disconnect, so connections of the previous database are not pooled
+	std::mutex mConnectionsMutex;               //Guards mIdleConnections and mConnectionGeneration
+	std::mutex mVariationsMutex;                //Guards variations cache (@see GetVariation)
+
+	std::atomic<bool> mIsConnected;				//indicates connection to db
+	std::atomic<uint64_t> mStatementHits;       //Prepared statements reused
+	std::atomic<uint64_t> mStatementMisses;     //Statements compiled
 
-	bool mIsConnected;					//indicates connection to db
+	typedef std::tuple<dbkey_t, dbkey_t, time_t> RunRangeIndexKey;        //type table id, variation id, time
+	std::map<RunRangeIndexKey, std::shared_ptr<const RunRangeIndex>> mRunRangeIndexes;
+	std::mutex mRunRangeIndexesMutex;           //Guards mRunRangeIndexes
+	std::atomic<bool> mIsRunRangeIndexEnabled;  //@see SetRunRangeIndexEnabled
 
 };
 }
@@ -0,0 +1,654 @@
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <stdio.h>
+#include <stdexcept>
+#include <fstream>
+#include <algorithm>
+#include <unordered_set>
+
+#include "CCDB/Providers/SnapshotDataProvider.h"
+#include "CCDB/Helpers/PathUtils.h"
+#include "CCDB/Helpers/SnapshotFormat.h"
+#include "CCDB/Model/ConstantsTypeTable.h"
+
+using namespace std;
+
+namespace ccdb
+{
+
+const char* const SnapshotDataProvider::ConnectionPrefix = "sqlite+snapshot://";
+
+//______________________________________________________________________________
+bool SnapshotDataProvider::IsSnapshotConnectionString(const std::string& connectionString)
+{
+    return connectionString.compare(0, strlen(ConnectionPrefix), ConnectionPrefix) == 0;
+}
+
+
+//______________________________________________________________________________
+SnapshotDataProvider::SnapshotDataProvider(time_t snapshotTime):
+    mSnapshotTime(snapshotTime),
+    mSnapshotTimeKey(MakeTimeKey(snapshotTime)),
+    mIsEagerBlobs(false),
+    mIsConnected(false),
+    mAssignmentsCount(0),
+    mDatabase(nullptr),
+    mQueriesAfterConnect(0)
+{
+    mRootDir = new Directory();
+}
+
+
+//______________________________________________________________________________
+SnapshotDataProvider::~SnapshotDataProvider()
+{
+    Disconnect();
+
+    //The provider owns directories and variations (in its arenas). Objects made of them must not outlive it
+    delete mRootDir;
+}
+
+
+//______________________________________________________________________________
+void SnapshotDataProvider::Connect(const std::string& connectionString)
+{
+    std::string thisFuncName = "ccdb::SnapshotDataProvider::Connect";
+    if(!IsSnapshotConnectionString(connectionString))
+    {
+        throw std::runtime_error(thisFuncName + "=>Error parse connection string. The string is not started with " + ConnectionPrefix);
+    }
+
+    if(IsConnected())
+    {
+        if(connectionString != mConnectionString) {
+            throw std::runtime_error(thisFuncName + "=>Connection already opened with different connection string");
+        }
+        return;
+    }
+
+    //sqlite+snapshot://<path>[?blobs=lazy|eager]
+    std::string filePath = connectionString.substr(strlen(ConnectionPrefix));
+    mIsEagerBlobs = false;
+    size_t optionsPos = filePath.rfind('?');
+    if(optionsPos != string::npos)
+    {
+        std::string options = filePath.substr(optionsPos + 1);
+        filePath.erase(optionsPos);
+        if(options == "blobs=eager") mIsEagerBlobs = true;
+        else if(options != "blobs=lazy") {
+            throw std::runtime_error(thisFuncName + "=>Unknown option '" + options + "'. Known options: blobs=lazy, blobs=eager");
+        }
+    }
+
+    int result = sqlite3_open_v2(filePath.c_str(), &mDatabase, SQLITE_OPEN_READONLY|SQLITE_OPEN_NOMUTEX, nullptr); // NOLINT(hicpp-signed-bitwise)
+    if (result != SQLITE_OK)
+    {
+        string errStr(mDatabase ? sqlite3_errmsg(mDatabase) : "out of memory");
+        sqlite3_close(mDatabase);
+        mDatabase = nullptr;
+        throw std::runtime_error(thisFuncName + "=>SQLite open error:" + errStr);
+    }
+    sqlite3_exec(mDatabase, "PRAGMA journal_mode = OFF;", nullptr, nullptr, nullptr);
+
+    try
+    {
+        //a few bulk queries
+        LoadDirectories();
+        LoadTypeTables();
+        LoadVariations();
+        LoadAssignments();
+
+        //indexes at the snapshot time are ready before the first request
+        for(auto& keyAssignments: mAssignments) {
+            GetRunRangeIndex(keyAssignments.first.first, keyAssignments.first.second, mSnapshotTimeKey);
+        }
+
+        if(mIsEagerBlobs) LoadBlobs();
+    }
+    catch (std::exception& ex)
+    {
+        Disconnect();
+        throw std::runtime_error(thisFuncName + "=>" + ex.what());
+    }
+
+    mConnectionString = connectionString;
+    mQueriesAfterConnect = 0;
+    mIsConnected = true;
+}
+
+
+//______________________________________________________________________________
+void SnapshotDataProvider::Disconnect()
+{
+    //Also cleans a partially loaded snapshot if Connect fails
+    mIsConnected = false;
+
+    {
+        std::lock_guard<std::mutex> lock(mDatabaseMutex);
+        mBlobStatement.reset();     //finalized before the connection is closed
+        sqlite3_close(mDatabase);
+        mDatabase = nullptr;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mIndexesMutex);
+        mIndexes.clear();
+    }
+
+    //directories and variations are kept, objects made by the provider may point to them
+    mTables.clear();
+    mAssignments.clear();
+    mBlobs.clear();
+    mAssignmentsCount = 0;
+}
+
+
+//______________________________________________________________________________
+bool SnapshotDataProvider::IsConnected()
+{
+    return mIsConnected;
+}
+
+
+//______________________________________________________________________________
+void SnapshotDataProvider::LoadDirectories()
+{
+    if(!mDatabase) throw std::runtime_error("SnapshotDataProvider::LoadDirectories => Not connected to SQLite database");
+
+    SQLiteStatement query(mDatabase, "SELECT `id`, `name`, `parentId`, `comment` FROM `directories`");
+
+    ClearDirectories();
+
+    query.Execute([&query, this](uint64_t rowIndex) {
+        auto dir = mDirectoriesArena.Create<Directory>();
+        dir->SetId(query.ReadUInt64(0));
+        dir->SetName(query.ReadString(1));
+        dir->SetParentId(query.ReadInt32(2));
+        dir->SetComment(query.ReadString(3));
+
+        mDirectories.push_back(dir);
+        mDirectoriesById[dir->GetId()] = dir;
+    });
+
+    BuildDirectoryDependencies();
+    mDirsAreLoaded = true;
+}
+
+
+//______________________________________________________________________________
+void SnapshotDataProvider::LoadTypeTables()
+{
+    map<dbkey_t, TableRecord> tablesById;
+    SQLiteStatement tablesQuery(mDatabase, "SELECT `id`, `name`, `directoryId`, `nRows`, `nColumns`, `comment` FROM `typeTables`");
+    tablesQuery.Execute([&tablesQuery, &tablesById](uint64_t rowIndex) {
+        TableRecord& record = tablesById[tablesQuery.ReadInt32(0)];
+        record.Id = tablesQuery.ReadInt32(0);
+        record.Name = tablesQuery.ReadString(1);
+        record.DirectoryId = tablesQuery.ReadInt32(2);
+        record.RowsCount = tablesQuery.ReadInt32(3);
+        record.ColumnsCount = tablesQuery.ReadInt32(4);
+        record.Comment = tablesQuery.ReadString(5);
+    });
+
+    SQLiteStatement columnsQuery(mDatabase, "SELECT `id`, `name`, `columnType`, `typeId` FROM `columns` ORDER BY `typeId`, `order`");
+    columnsQuery.Execute([&columnsQuery, &tablesById](uint64_t rowIndex) {
+        auto tableIter = tablesById.find(columnsQuery.ReadInt32(3));
+        if(tableIter == tablesById.end()) return;      //a column of not existing table
+
+        ColumnRecord column;
+        column.Id = columnsQuery.ReadInt32(0);
+        column.Name = columnsQuery.ReadString(1);
+        column.Type = columnsQuery.ReadString(2);
+        tableIter->second.Columns.push_back(std::move(column));
+    });
+
+    mTables.clear();
+    for(auto& idTable: tablesById) {
+        TableRecord& record = idTable.second;
+        auto key = std::make_pair(record.DirectoryId, record.Name);
+        mTables.emplace(std::move(key), std::move(record));
+    }
+}
+
+
+//______________________________________________________________________________
+void SnapshotDataProvider::LoadVariations()
+{
+    SQLiteStatement query(mDatabase, "SELECT `id`, `parentId`, `name` FROM `variations`");
+    query.Execute([&query, this](uint64_t rowIndex) {
+        dbkey_t id = query.ReadInt32(0);
+        Variation* variation = mVariationsById[id];
+        if(!variation) {
+            variation = mVariationsArena.Create<Variation>();        //variations of the previous connection are reused
+            mVariationsById[id] = variation;
+        }
+        variation->SetId(id);
+        variation->SetParentDbId(query.ReadUInt64(1));
+        variation->SetName(query.ReadString(2));
+        mVariationsByName[variation->GetName()] = variation;
+    });
+
+    for(auto& idVariation: mVariationsById) {
+        Variation* variation = idVariation.second;
+        auto parentIter = mVariationsById.find(variation->GetParentDbId());
+        variation->SetParent(parentIter != mVariationsById.end() && variation->GetParentDbId() > 0 ? parentIter->second : nullptr);
+    }
+}
+
+
+//______________________________________________________________________________
+void SnapshotDataProvider::LoadAssignments()
+{
+    SQLiteStatement query(mDatabase,
+        "SELECT `assignments`.`id`, `runRanges`.`runMin`, `runRanges`.`runMax`, `assignments`.`constantSetId`, "
+        "`constantSets`.`constantTypeId`, `assignments`.`variationId`, `assignments`.`created` "
+        "FROM  `assignments` "
+        "INNER JOIN `runRanges` ON `assignments`.`runRangeId`= `runRanges`.`id` "
+        "INNER JOIN `constantSets` ON `assignments`.`constantSetId` = `constantSets`.`id` ");
+
+    mAssignments.clear();
+    mAssignmentsCount = query.Execute([&query, this](uint64_t rowIndex) {
+        AssignmentRecord record;
+        record.Item.AssignmentId = query.ReadInt32(0);
+        record.Item.RunMin = query.ReadInt32(1);
+        record.Item.RunMax = query.ReadInt32(2);
+        record.Item.ConstantSetId = query.ReadInt32(3);
+        record.CreatedKey = ParseTimeKey(query.ReadString(6));
+        mAssignments[std::make_pair(query.ReadInt32(4), query.ReadInt32(5))].push_back(record);
+    });
+}
+
+
+//______________________________________________________________________________
+void SnapshotDataProvider::LoadBlobs()
+{
+    //only blobs which may be selected at the snapshot time
+    unordered_set<dbkey_t> constantSetIds;
+    {
+        std::lock_guard<std::mutex> lock(mIndexesMutex);
+        for(auto& keyIndex: mIndexes) {
+            if(std::get<2>(keyIndex.first) != mSnapshotTimeKey) continue;
+            for(const RunRangeIndex::Item* item: keyIndex.second->GetReachableItems()) constantSetIds.insert(item->ConstantSetId);
+        }
+    }
+
+    mBlobs.clear();
+    mBlobs.reserve(constantSetIds.size());
+    SQLiteStatement query(mDatabase, "SELECT `id`, `vault` FROM `constantSets`");
+    query.Execute([&query, &constantSetIds, this](uint64_t rowIndex) {
+        dbkey_t id = query.ReadInt32(0);
+        if(constantSetIds.count(id)) mBlobs.emplace(id, query.ReadString(1));
+    });
+}
+
+
+//______________________________________________________________________________
+ConstantsTypeTable* SnapshotDataProvider::MakeTypeTable(const TableRecord& record, Directory* directory, bool loadColumns) const
+{
+    auto table = new ConstantsTypeTable();
+    table->SetId(record.Id);
+    table->SetName(record.Name);
+    table->SetDirectoryId(record.DirectoryId);
+    table->SetNRows(record.RowsCount);
+    table->SetNColumnsFromDB(record.ColumnsCount);
+    table->SetComment(record.Comment);
+    table->SetDirectory(directory);
+    if(directory) table->SetFullPath(PathUtils::CombinePath(directory->GetFullPath(), record.Name));
+
+    if(loadColumns) {
+        for(const ColumnRecord& columnRecord: record.Columns) {
+            auto column = new ConstantsTypeColumn();
+            column->SetId(columnRecord.Id);
+            column->SetName(columnRecord.Name);
+            column->SetType(columnRecord.Type);
+            column->SetDBTypeTableId(record.Id);
+            table->AddColumn(column);
+        }
+    }
+    return table;
+}
+
+
+//______________________________________________________________________________
+ConstantsTypeTable* SnapshotDataProvider::GetConstantsTypeTable(const string& name, Directory* parentDir, bool loadColumns)
+{
+    std::string thisFunc("ccdb::SnapshotDataProvider::GetConstantsTypeTable");
+    if(!IsConnected()) throw std::runtime_error(thisFunc + " => SnapshotDataProvider is not connected to DB");
+
+    if(parentDir == nullptr || (parentDir->GetFullPath()!=string("/") && parentDir->GetId()<=0)) {
+        throw std::runtime_error(thisFunc + " => Parent directory is null or have invalid ID");
+    }
+
+    auto tableIter = mTables.find(std::make_pair(static_cast<dbkey_t>(parentDir->GetId()), name));
+    if(tableIter == mTables.end()) return nullptr;
+    return MakeTypeTable(tableIter->second, parentDir, loadColumns);
+}
+
+
+//______________________________________________________________________________
+std::vector<ConstantsTypeTable *> SnapshotDataProvider::GetAllConstantsTypeTables(bool loadColumns)
+{
+    std::vector<ConstantsTypeTable *> tables;
+    tables.reserve(mTables.size());
+    for(auto& keyTable: mTables) {
+        auto dirIter = mDirectoriesById.find(keyTable.second.DirectoryId);
+        tables.push_back(MakeTypeTable(keyTable.second, dirIter != mDirectoriesById.end() ? dirIter->second : nullptr, loadColumns));
+    }
+    return tables;
+}
+
+
+//______________________________________________________________________________
+Variation* SnapshotDataProvider::GetVariation(const string& name)
+{
+    if(!IsConnected()) throw std::runtime_error("ccdb::SnapshotDataProvider::GetVariation => SnapshotDataProvider is not connected to DB");
+
+    auto variationIter = mVariationsByName.find(name);
+    return variationIter == mVariationsByName.end() ? nullptr : variationIter->second;
+}
+
+
+//______________________________________________________________________________
+Assignment* SnapshotDataProvider::GetAssignmentShort(int run, const string& path, time_t time, const string& variationName, bool loadColumns)
+{
+    ConstantsTypeTable *table = DataProvider::GetConstantsTypeTable(path, loadColumns);
+    if(!table) {
+        throw std::runtime_error("SnapshotDataProvider::GetAssignmentShort => Type table was not found: '" + path + "'");
+    }
+
+    Variation* variation = GetVariation(variationName);
+    if(!variation) {
+        delete table;
+        throw std::runtime_error("SnapshotDataProvider::GetAssignmentShort => No variation '" + variationName + "' was found");
+    }
+
+    //If there is no data for this variation, the parent variation is looked up
+    int64_t timeKey = (time == mSnapshotTime) ? mSnapshotTimeKey : MakeTimeKey(time);
+    for(; variation != nullptr; variation = variation->GetParent())
+    {
+        std::shared_ptr<const RunRangeIndex> index = GetRunRangeIndex(table->GetId(), variation->GetId(), timeKey);
+        const RunRangeIndex::Item* item = index->Find(run);
+        if(!item) continue;
+
+        auto assignment = new Assignment();
+        assignment->SetId(item->AssignmentId);
+        assignment->SetRawData(GetBlob(item->ConstantSetId));
+        assignment->SetRequestedRun(run);
+        assignment->SetRunRange(item->RunMin, item->RunMax);
+        assignment->SetTypeTable(table, /*isOwner*/ true);
+        assignment->SetVariation(variation);
+        return assignment;
+    }
+
+    delete table;
+    return nullptr;
+}
+
+
+//______________________________________________________________________________
+std::shared_ptr<const RunRangeIndex> SnapshotDataProvider::GetRunRangeIndex(dbkey_t tableId, dbkey_t variationId, int64_t timeKey)
+{
+    RunRangeIndexKey key(tableId, variationId, timeKey);
+    {
+        std::lock_guard<std::mutex> lock(mIndexesMutex);
+        auto indexIter = mIndexes.find(key);
+        if(indexIter != mIndexes.end()) return indexIter->second;
+    }
+
+    //Built out of the lock (mAssignments is not changed while connected). The first built index is kept
+    std::vector<RunRangeIndex::Item> items;
+    auto assignmentsIter = mAssignments.find(std::make_pair(tableId, variationId));
+    if(assignmentsIter != mAssignments.end()) {
+        for(const AssignmentRecord& record: assignmentsIter->second) {
+            if(record.CreatedKey <= timeKey) items.push_back(record.Item);
+        }
+    }
+
+    auto index = std::make_shared<const RunRangeIndex>(std::move(items));
+    std::lock_guard<std::mutex> lock(mIndexesMutex);
+    return mIndexes.emplace(key, index).first->second;
+}
+
+
+//______________________________________________________________________________
+std::string SnapshotDataProvider::GetBlob(dbkey_t constantSetId)
+{
+    auto blobIter = mBlobs.find(constantSetId);
+    if(blobIter != mBlobs.end()) return blobIter->second;
+
+    std::lock_guard<std::mutex> lock(mDatabaseMutex);
+    if(!mDatabase) throw std::runtime_error("SnapshotDataProvider::GetBlob => Not connected to SQLite database");
+
+    if(mBlobStatement) {
+        mBlobStatement->Reset();
+    }
+    else {
+        mBlobStatement.reset(new SQLiteStatement(mDatabase));
+        mBlobStatement->Prepare("SELECT `vault` FROM `constantSets` WHERE `id` = ?1", /*isPersistent*/ true);
+    }
+
+    std::string blob;
+    SQLiteStatement& query = *mBlobStatement;
+    query.BindInt32(1, constantSetId);
+    query.Execute([&query, &blob](uint64_t rowIndex) { blob = query.ReadString(0); });
+    mQueriesAfterConnect++;
+    return blob;
+}
+
+
+//______________________________________________________________________________
+int64_t SnapshotDataProvider::MakeTimeKey(time_t time)
+{
+    if(time <= 0) return INT64_MAX;
+
+    //the same conversion as datetime(time, 'unixepoch', 'localtime') of SQLite provider
+    struct tm localTime;
+    localtime_r(&time, &localTime);
+    return (localTime.tm_year + 1900) * 10000000000LL + (localTime.tm_mon + 1) * 100000000LL +
+           localTime.tm_mday * 1000000LL + localTime.tm_hour * 10000LL + localTime.tm_min * 100LL + localTime.tm_sec;
+}
+
+
+//______________________________________________________________________________
+int64_t SnapshotDataProvider::ParseTimeKey(const std::string& dateTime)
+{
+    //'YYYY-MM-DD hh:mm:ss' has 14 digits. Fractions of seconds are dropped
+    int64_t key = 0;
+    int digitsCount = 0;
+    for(char c: dateTime) {
+        if(c < '0' || c > '9') continue;
+        key = key * 10 + (c - '0');
+        if(++digitsCount == 14) break;
+    }
+
+    //NULL created time never passes a time condition in SQL
+    return digitsCount == 14 ? key : INT64_MAX;
+}
+
+
+//______________________________________________________________________________
+void SnapshotDataProvider::WriteBinarySnapshot(const std::string& filePath)
+{
+    std::string thisFunc("ccdb::SnapshotDataProvider::WriteBinarySnapshot");
+    if(!IsConnected()) throw std::runtime_error(thisFunc + " => SnapshotDataProvider is not connected to DB");
+
+    vector<char> data;
+    auto addString = [&data](const std::string& str) {
+        SnapshotString result = {data.size(), str.size()};
+        data.insert(data.end(), str.begin(), str.end());
+        return result;
+    };
+
+    //directories
+    vector<SnapshotDirectory> directories;
+    for(Directory* dir: mDirectories) {
+        directories.push_back({static_cast<int32_t>(dir->GetId()), dir->GetParentId(), addString(dir->GetName()), addString(dir->GetComment())});
+    }
+
+    //tables sorted by full path. Table objects with columns are kept to decode blobs
+    map<dbkey_t, unique_ptr<ConstantsTypeTable>> typeTablesById;
+    vector<pair<string, const TableRecord*>> tablesByPath;
+    for(auto& keyTable: mTables) {
+        auto dirIter = mDirectoriesById.find(keyTable.second.DirectoryId);
+        Directory* dir = dirIter != mDirectoriesById.end() ? dirIter->second : mRootDir;
+        ConstantsTypeTable* typeTable = MakeTypeTable(keyTable.second, dir, true);
+        typeTablesById[keyTable.second.Id].reset(typeTable);
+        tablesByPath.emplace_back(typeTable->GetFullPath(), &keyTable.second);
+    }
+    sort(tablesByPath.begin(), tablesByPath.end());
+
+    vector<SnapshotTable> tables;
+    vector<SnapshotColumn> columns;
+    for(auto& pathTable: tablesByPath) {
+        const TableRecord& record = *pathTable.second;
+        SnapshotTable table = {};
+        table.Id = record.Id;
+        table.DirectoryId = record.DirectoryId;
+        table.RowsCount = record.RowsCount;
+        table.ColumnsCountFromDB = record.ColumnsCount;
+        table.FirstColumn = static_cast<uint32_t>(columns.size());
+        table.ColumnsCount = static_cast<uint32_t>(record.Columns.size());
+        table.Name = addString(record.Name);
+        table.FullPath = addString(pathTable.first);
+        table.Comment = addString(record.Comment);
+        for(auto column: typeTablesById[record.Id]->GetColumns()) {
+            if(column->GetType() == ConstantsTypeColumn::cBoolColumn) table.HasBoolColumns = 1;
+        }
+        for(const ColumnRecord& column: record.Columns) {
+            columns.push_back({column.Id, 0, addString(column.Name), addString(column.Type)});
+        }
+        tables.push_back(table);
+    }
+
+    //variations sorted by name (mVariationsByName is sorted)
+    vector<SnapshotVariation> variations;
+    for(auto& nameVariation: mVariationsByName) {
+        Variation* variation = nameVariation.second;
+        variations.push_back({static_cast<int32_t>(variation->GetId()), static_cast<int32_t>(variation->GetParentDbId()), addString(variation->GetName())});
+    }
+
+    //blobs are written once even if many segments point to them
+    vector<SnapshotBlob> blobs;
+    vector<double> doubles;
+    vector<int> ints;
+    unordered_map<dbkey_t, uint32_t> blobIndexes;
+    auto addBlob = [&](dbkey_t constantSetId, dbkey_t tableId) {
+        auto blobIter = blobIndexes.find(constantSetId);
+        if(blobIter != blobIndexes.end()) return blobIter->second;
+
+        Assignment assignment;
+        assignment.SetTypeTable(typeTablesById[tableId].get());
+        assignment.SetRawData(GetBlob(constantSetId));
+
+        SnapshotBlob blob = {};
+        blob.ConstantSetId = constantSetId;
+        blob.Raw = addString(assignment.GetRawData());
+        blob.FirstValue = doubles.size();
+        const vector<double>& doubleValues = assignment.GetDoubleData();
+        const vector<int>& intValues = assignment.GetIntData();
+        if(doubleValues.size() == assignment.GetTokensCount() && intValues.size() == doubleValues.size()) {
+            blob.ValuesCount = doubleValues.size();
+            doubles.insert(doubles.end(), doubleValues.begin(), doubleValues.end());
+            ints.insert(ints.end(), intValues.begin(), intValues.end());
+        }
+
+        uint32_t blobIndex = static_cast<uint32_t>(blobs.size());
+        blobs.push_back(blob);
+        blobIndexes[constantSetId] = blobIndex;
+        return blobIndex;
+    };
+
+    //run-range indexes at the snapshot time, sorted by (table id, variation id) as mAssignments is
+    vector<SnapshotIndex> indexes;
+    vector<SnapshotSegment> segments;
+    for(auto& keyAssignments: mAssignments) {
+        dbkey_t tableId = keyAssignments.first.first;
+        if(!typeTablesById.count(tableId)) continue;     //assignments of a not existing table
+
+        auto runRangeIndex = GetRunRangeIndex(tableId, keyAssignments.first.second, mSnapshotTimeKey);
+        if(runRangeIndex->GetSegmentsCount() == 0) continue;
+
+        SnapshotIndex index = {tableId, keyAssignments.first.second, segments.size(), 0};
+        int64_t lastRunEnd = 0;
+        runRangeIndex->ForEachSegment([&](int64_t runStart, int64_t runEnd, const RunRangeIndex::Item* item) {
+            SnapshotSegment segment = {runStart, 0, SnapshotFormat::NoBlob};
+            if(item) {
+                segment.AssignmentId = item->AssignmentId;
+                segment.Blob = addBlob(item->ConstantSetId, tableId);
+            }
+            segments.push_back(segment);
+            lastRunEnd = runEnd;
+        });
+        segments.push_back({lastRunEnd, 0, SnapshotFormat::NoBlob});
+        index.SegmentsCount = segments.size() - index.FirstSegment;
+        indexes.push_back(index);
+    }
+
+    //layout: header and sections aligned to 8 bytes
+    SnapshotHeader header = {};
+    std::copy(SnapshotFormat::Magic, SnapshotFormat::Magic + sizeof(header.Magic), header.Magic);
+    header.Version = SnapshotFormat::Version;
+    header.ByteOrderMark = SnapshotFormat::ByteOrderMark;
+    header.SnapshotTime = mSnapshotTime;
+
+    uint64_t fileSize = sizeof(SnapshotHeader);
+    auto placeSection = [&fileSize](SnapshotSection& section, uint64_t count, uint64_t recordSize) {
+        section.Offset = fileSize;
+        section.Count = count;
+        fileSize += (count * recordSize + 7) & ~static_cast<uint64_t>(7);
+    };
+    placeSection(header.Data, data.size(), 1);
+    placeSection(header.Directories, directories.size(), sizeof(SnapshotDirectory));
+    placeSection(header.Tables, tables.size(), sizeof(SnapshotTable));
+    placeSection(header.Columns, columns.size(), sizeof(SnapshotColumn));
+    placeSection(header.Variations, variations.size(), sizeof(SnapshotVariation));
+    placeSection(header.Indexes, indexes.size(), sizeof(SnapshotIndex));
+    placeSection(header.Segments, segments.size(), sizeof(SnapshotSegment));
+    placeSection(header.Blobs, blobs.size(), sizeof(SnapshotBlob));
+    placeSection(header.Doubles, doubles.size(), sizeof(double));
+    placeSection(header.Ints, ints.size(), sizeof(int32_t));
+    header.FileSize = fileSize;
+
+    //write to a temporary file and rename it
+    std::string tempPath = filePath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if(!file) throw std::runtime_error(thisFunc + " => Can't open file for writing: " + tempPath);
+
+        uint64_t written = 0;
+        auto writeSection = [&file, &written](const void* records, uint64_t bytes) {
+            static const char padding[8] = {0};
+            file.write(static_cast<const char*>(records), bytes);
+            written += bytes;
+            uint64_t paddingBytes = (8 - written % 8) % 8;
+            file.write(padding, paddingBytes);
+            written += paddingBytes;
+        };
+        writeSection(&header, sizeof(header));
+        writeSection(data.data(), data.size());
+        writeSection(directories.data(), directories.size() * sizeof(SnapshotDirectory));
+        writeSection(tables.data(), tables.size() * sizeof(SnapshotTable));
+        writeSection(columns.data(), columns.size() * sizeof(SnapshotColumn));
+        writeSection(variations.data(), variations.size() * sizeof(SnapshotVariation));
+        writeSection(indexes.data(), indexes.size() * sizeof(SnapshotIndex));
+        writeSection(segments.data(), segments.size() * sizeof(SnapshotSegment));
+        writeSection(blobs.data(), blobs.size() * sizeof(SnapshotBlob));
+        writeSection(doubles.data(), doubles.size() * sizeof(double));
+        writeSection(ints.data(), ints.size() * sizeof(int32_t));
+
+        file.close();
+        if(!file || written != fileSize) {
+            remove(tempPath.c_str());
+            throw std::runtime_error(thisFunc + " => Error writing file: " + tempPath);
+        }
+    }
+
+    if(rename(tempPath.c_str(), filePath.c_str()) != 0) {
+        remove(tempPath.c_str());
+        throw std::runtime_error(thisFunc + " => Can't rename " + tempPath + " to " + filePath);
+    }
+}
+
+}
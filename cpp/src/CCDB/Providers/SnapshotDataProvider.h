@@ -0,0 +1,185 @@
+#ifndef _SnapshotDataProvider_
+#define _SnapshotDataProvider_
+
+#include <time.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+#include <sqlite3.h>
+
+#include "CCDB/Providers/DataProvider.h"
+#include "CCDB/Helpers/SQLite.h"
+#include "CCDB/Helpers/RunRangeIndex.h"
+
+namespace ccdb
+{
+
+/** @brief Read-only provider that keeps the whole SQLite database structure in memory
+ *
+ * Jobs usually run with a fixed calibration time, at which the database is effectively immutable.
+ * On Connect the provider loads directories, type tables, columns, variations and all
+ * (type table, variation, run range) -> assignment mappings with a few bulk queries.
+ * Then type tables, variations and assignments are resolved in memory (@see RunRangeIndex).
+ *
+ * Connection string:
+ *    sqlite+snapshot://<path to sqlite file>[?blobs=lazy|eager]
+ *
+ * blobs=lazy (default) - an assignment blob is selected by the primary key when it is requested.
+ *                        With Calibration cache it happens once per table
+ * blobs=eager          - blobs of all assignments valid at the snapshot time are loaded on Connect,
+ *                        then requests at the snapshot time never issue SQL.
+ *
+ * Requests with other times are also answered correctly: the mappings of all times are in memory,
+ * the index for a new time is built on the first request.
+ * The provider is made by SQLiteCalibration (so by CalibrationGenerator) with the calibration default time
+ */
+class SnapshotDataProvider: public DataProvider
+{
+public:
+    /** @brief Connection string prefix of this provider */
+    static const char* const ConnectionPrefix;
+
+    /** @brief Checks that the connection string is for SnapshotDataProvider */
+    static bool IsSnapshotConnectionString(const std::string& connectionString);
+
+    /** @brief Ctor
+     *
+     * @param snapshotTime assignments created after this time are not seen by default. 0 means no time limit
+     */
+    explicit SnapshotDataProvider(time_t snapshotTime = 0);
+    ~SnapshotDataProvider() override;
+
+    //----------------------------------------------------------------------------------------
+    //  I M P L E M E N T   I N T E R F A C E
+    //----------------------------------------------------------------------------------------
+
+    /** @brief Opens sqlite file and loads the snapshot
+     *
+     * @param connectionString sqlite+snapshot://<path to sqlite file>[?blobs=lazy|eager]
+     */
+    void Connect(const std::string &connectionString) override;
+
+    /** @brief Closes the database and frees the snapshot */
+    void Disconnect() override;
+
+    /** @brief true if the snapshot is loaded */
+    bool IsConnected() override;
+
+    /** @brief Loads directories from DB. It is done on Connect */
+    void LoadDirectories() override;
+
+    /** @brief Gets new ConstantsTypeTable object made of the snapshot */
+    ConstantsTypeTable * GetConstantsTypeTable(const string& name, Directory *parentDir, bool loadColumns) override;
+
+    /** @brief Gets new ConstantsTypeTable objects of all tables */
+    std::vector<ConstantsTypeTable *> GetAllConstantsTypeTables(bool loadColumns) override;
+
+    /** @brief Get variation by name (all variations are loaded on Connect) */
+    Variation* GetVariation(const string& name) override;
+
+    /** @brief Assignment with data blob for the run. @see DataProvider::GetAssignmentShort */
+    Assignment* GetAssignmentShort(int run, const string& path, time_t time, const string& variation, bool loadColumns) override;
+
+    /** @brief The snapshot is immutable, so reads don't need locks */
+    bool IsConcurrentReadSupported() override { return true; }
+
+    //----------------------------------------------------------------------------------------
+    //  E N D   I M P L E M E N T   I N T E R F A C E
+    //----------------------------------------------------------------------------------------
+
+    time_t GetSnapshotTime() const { return mSnapshotTime; }      /// @see SnapshotDataProvider()
+    bool IsEagerBlobs() const { return mIsEagerBlobs; }            /// blobs=eager was given in the connection string
+    size_t GetLoadedBlobsCount() const { return mBlobs.size(); }   /// Number of blobs loaded on Connect
+    size_t GetAssignmentsCount() const { return mAssignmentsCount; }    /// Number of assignments in the snapshot
+
+    /** @brief Number of SQL queries made after Connect (they select lazy blobs) */
+    uint64_t GetQueriesAfterConnectCount() const { return mQueriesAfterConnect; }
+
+    /** @brief Writes the snapshot at the snapshot time to a binary .ccdbsnap file
+     *
+     * The file is read by MappedSnapshotDataProvider (@see SnapshotFormat.h).
+     * Blobs are stored with values decoded to double and int. The file is written
+     * next to filePath and then renamed, so readers never see a partially written file
+     */
+    void WriteBinarySnapshot(const std::string& filePath);
+
+private:
+
+    /** @brief Column of a type table as it is in DB */
+    struct ColumnRecord
+    {
+        dbkey_t Id;
+        std::string Name;
+        std::string Type;
+    };
+
+    /** @brief Type table as it is in DB. ConstantsTypeTable objects are made of it */
+    struct TableRecord
+    {
+        dbkey_t Id;
+        std::string Name;
+        dbkey_t DirectoryId;
+        int RowsCount;
+        int ColumnsCount;
+        std::string Comment;
+        std::vector<ColumnRecord> Columns;
+    };
+
+    /** @brief Assignment mapping with its creation time (as YYYYMMDDhhmmss number in local time, @see MakeTimeKey) */
+    struct AssignmentRecord
+    {
+        RunRangeIndex::Item Item;
+        int64_t CreatedKey;
+    };
+
+    void LoadTypeTables();
+    void LoadVariations();
+    void LoadAssignments();
+    void LoadBlobs();
+
+    /** @brief Makes new ConstantsTypeTable object of the record */
+    ConstantsTypeTable* MakeTypeTable(const TableRecord& record, Directory* directory, bool loadColumns) const;
+
+    /** @brief Gets existing or builds new index for the table, variation and time key */
+    std::shared_ptr<const RunRangeIndex> GetRunRangeIndex(dbkey_t tableId, dbkey_t variationId, int64_t timeKey);
+
+    /** @brief Gets the blob of the constant set from memory or from DB */
+    std::string GetBlob(dbkey_t constantSetId);
+
+    /** @brief Converts unix time to comparable YYYYMMDDhhmmss number in local time. No limit for time <= 0 */
+    static int64_t MakeTimeKey(time_t time);
+
+    /** @brief Converts 'YYYY-MM-DD hh:mm:ss' to YYYYMMDDhhmmss number */
+    static int64_t ParseTimeKey(const std::string& dateTime);
+
+    time_t mSnapshotTime;
+    int64_t mSnapshotTimeKey;
+    bool mIsEagerBlobs;
+    std::atomic<bool> mIsConnected;
+    size_t mAssignmentsCount;
+
+    sqlite3* mDatabase;                         // Read-only connection, for lazy blobs
+    std::unique_ptr<SQLiteStatement> mBlobStatement;
+    std::mutex mDatabaseMutex;                  // Guards mDatabase and mBlobStatement after Connect
+    std::atomic<uint64_t> mQueriesAfterConnect;
+
+    std::map<std::pair<dbkey_t, std::string>, TableRecord> mTables;        // by directory id and name
+    std::map<std::pair<dbkey_t, dbkey_t>, std::vector<AssignmentRecord>> mAssignments;  // by table id and variation id
+    std::unordered_map<dbkey_t, std::string> mBlobs;                        // by constant set id (blobs=eager)
+
+    typedef std::tuple<dbkey_t, dbkey_t, int64_t> RunRangeIndexKey;        // table id, variation id, time key
+    std::map<RunRangeIndexKey, std::shared_ptr<const RunRangeIndex>> mIndexes;
+    std::mutex mIndexesMutex;                   // Guards mIndexes
+
+    SnapshotDataProvider(const SnapshotDataProvider& rhs);
+    SnapshotDataProvider& operator=(const SnapshotDataProvider& rhs);
+};
+}
+
+#endif //_SnapshotDataProvider_
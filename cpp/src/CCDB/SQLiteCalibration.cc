@@ -3,6 +3,8 @@
 
 #include "CCDB/SQLiteCalibration.h"
 #include "CCDB/Providers/SQLiteDataProvider.h"
+#include "CCDB/Providers/SnapshotDataProvider.h"
+#include "CCDB/Providers/MappedSnapshotDataProvider.h"
 #include "CCDB/Helpers/PathUtils.h"
 
 namespace ccdb
@@ -24,6 +26,7 @@ SQLiteCalibration::SQLiteCalibration( int defaultRun, string defaultVariation/*=
 //______________________________________________________________________________
 SQLiteCalibration::~SQLiteCalibration()
 {   
+    StopAsyncRequests();    //queued requests use IsConnected of this class
 }
 
 
@@ -48,7 +51,7 @@ bool SQLiteCalibration::Connect( std::string connectionString )
 	 * @param connectionString the Connection String
 	 * @return true if connected
 	 */
-    std::lock_guard<std::mutex> lock(mReadMutex);
+    std::lock_guard<ReadMostlyMutex> lock(mReadMutex);
 
     UpdateActivityTime();
 
@@ -57,7 +60,20 @@ bool SQLiteCalibration::Connect( std::string connectionString )
     {
         if(!mProviderIsLocked)
         {
-            mProvider = new SQLiteDataProvider();
+            //sqlite+snapshot:// loads the whole database at the default time
+            if(SnapshotDataProvider::IsSnapshotConnectionString(connectionString))
+            {
+                mProvider = new SnapshotDataProvider(mDefaultTime);
+            }
+            //ccdbsnap:// maps a binary snapshot file made by ccdb_snapshot tool
+            else if(MappedSnapshotDataProvider::IsMappedSnapshotConnectionString(connectionString))
+            {
+                mProvider = new MappedSnapshotDataProvider();
+            }
+            else
+            {
+                mProvider = new SQLiteDataProvider();
+            }
         }
         else
         {
@@ -88,6 +104,7 @@ bool SQLiteCalibration::Connect( std::string connectionString )
         throw std::logic_error(ERRMSG_CONNECT_LOCKED);
     }
 
+    NextProviderGeneration();   //handles of the previous connection are resolved again
     mProvider->Connect(connectionString);
 
     return true; // If we get here, it is 'true'. It is an old API issue to have 'bool' here at all
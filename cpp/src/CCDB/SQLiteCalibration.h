@@ -46,6 +46,12 @@ namespace ccdb
          * @see SQLiteCalibration
          * sqlite://<path to sqlite file>
          *
+         * @see SnapshotDataProvider (the database is loaded in memory at the default time)
+         * sqlite+snapshot://<path to sqlite file>[?blobs=lazy|eager]
+         *
+         * @see MappedSnapshotDataProvider (binary snapshot file made by ccdb_snapshot tool)
+         * ccdbsnap://<path to .ccdbsnap file>
+         *
          * @param connectionString the Connection String
          * @return true if connected
          */
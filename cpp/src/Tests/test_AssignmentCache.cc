@@ -0,0 +1,254 @@
+#pragma warning(disable:4800)
+#include "Tests/catch.hpp"
+#include "Tests/tests.h"
+
+#include <memory>
+#include <thread>
+#include <atomic>
+
+#include "CCDB/Helpers/AssignmentCache.h"
+#include "CCDB/CalibrationGenerator.h"
+
+using namespace std;
+using namespace ccdb;
+
+static shared_ptr<Assignment> MakeTestAssignment(size_t blobSize)
+{
+    shared_ptr<Assignment> assignment(new Assignment());
+    assignment->SetRawData(string(blobSize, '1'));
+    return assignment;
+}
+
+/** ********************************************************************* 
+ * @brief Test of assignment cache LRU and byte budget logic
+ */
+TEST_CASE("CCDB/AssignmentCache/LRU","Assignment cache eviction tests")
+{
+    auto a = MakeTestAssignment(1000);
+    auto b = MakeTestAssignment(1000);
+    auto c = MakeTestAssignment(1000);
+
+    // budget fits two assignments but not three
+    size_t budget = a->GetMemoryUsage() * 2 + 1000;
+    AssignmentCache cache(budget);
+
+    REQUIRE(AssignmentCache::MakeKey("/a") != AssignmentCache::MakeKey("/b"));
+    REQUIRE(!cache.Find(AssignmentCache::MakeKey("/a"), "/a"));
+
+    cache.Insert(AssignmentCache::MakeKey("/a"), "/a", a);
+    cache.Insert(AssignmentCache::MakeKey("/b"), "/b", b);
+    REQUIRE(cache.GetEntriesCount() == 2);
+    REQUIRE(cache.GetUsedBytes() <= budget);
+
+    // touch /a so /b becomes the least recently used
+    REQUIRE(cache.Find(AssignmentCache::MakeKey("/a"), "/a") == a);
+
+    cache.Insert(AssignmentCache::MakeKey("/c"), "/c", c);
+    REQUIRE(cache.GetEntriesCount() == 2);
+    REQUIRE(cache.Find(AssignmentCache::MakeKey("/a"), "/a") == a);
+    REQUIRE(!cache.Find(AssignmentCache::MakeKey("/b"), "/b"));
+    REQUIRE(cache.Find(AssignmentCache::MakeKey("/c"), "/c") == c);
+
+    // the key is validated by the request string
+    REQUIRE(!cache.Find(AssignmentCache::MakeKey("/a"), "/not_a"));
+
+    AssignmentCacheStats stats = cache.GetStats();
+    REQUIRE(stats.Hits == 3);
+    REQUIRE(stats.Misses == 3);
+    REQUIRE(stats.Evictions == 1);
+
+    // shrinking the budget evicts immediately, too big assignments are not cached
+    cache.SetMaxBytes(10);
+    REQUIRE(cache.GetEntriesCount() == 0);
+    REQUIRE(cache.GetUsedBytes() == 0);
+    cache.Insert(AssignmentCache::MakeKey("/a"), "/a", a);
+    REQUIRE(cache.GetEntriesCount() == 0);
+}
+
+
+/** *********************************************************************
+ * @brief Test of the clock hand order and of assignments held by Acquire
+ */
+TEST_CASE("CCDB/AssignmentCache/Clock","Assignment cache clock tests")
+{
+    auto a = MakeTestAssignment(1000);
+    auto b = MakeTestAssignment(1000);
+    auto c = MakeTestAssignment(1000);
+    auto d = MakeTestAssignment(1000);
+
+    // budget fits three assignments but not four
+    AssignmentCache cache(a->GetMemoryUsage() * 3 + 1000);
+    cache.Insert(AssignmentCache::MakeKey("/a"), "/a", a);
+    cache.Insert(AssignmentCache::MakeKey("/b"), "/b", b);
+    cache.Insert(AssignmentCache::MakeKey("/c"), "/c", c);
+
+    // /a and /b are referenced, the hand passes them and evicts /c
+    REQUIRE(cache.Find(AssignmentCache::MakeKey("/a"), "/a") == a);
+    REQUIRE(cache.Find(AssignmentCache::MakeKey("/b"), "/b") == b);
+    cache.Insert(AssignmentCache::MakeKey("/d"), "/d", d);
+    REQUIRE(cache.GetEntriesCount() == 3);
+    REQUIRE(!cache.Find(AssignmentCache::MakeKey("/c"), "/c"));
+
+    // the hand cleared /a and /b, so /a goes next though /d is newer
+    cache.Insert(AssignmentCache::MakeKey("/c"), "/c", c);
+    REQUIRE(!cache.Find(AssignmentCache::MakeKey("/a"), "/a"));
+    REQUIRE(cache.GetEntriesCount() == 3);
+
+    // an acquired assignment stays valid after it is evicted
+    AssignmentCache::ReadPtr held = cache.Acquire(AssignmentCache::MakeKey("/b"), "/b");
+    REQUIRE(held.get() == b.get());
+    cache.SetMaxBytes(10);
+    REQUIRE(cache.GetEntriesCount() == 0);
+    REQUIRE(held->GetRawData().size() == 1000);
+    held.Release();
+    REQUIRE(!held);
+}
+
+
+/** ********************************************************************* 
+ * @brief Test that each Calibration has its own cache with counters
+ */
+TEST_CASE("CCDB/AssignmentCache/Calibration","Calibration cache tests")
+{
+    unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(TESTS_SQLITE_STRING, 100, "default"));
+    calib->EnableCache(true);
+
+    vector<vector<string> > tabledValues;
+    REQUIRE(calib->GetCalib(tabledValues, "/test/test_vars/test_table"));
+    tabledValues.clear();
+    REQUIRE(calib->GetCalib(tabledValues, "/test/test_vars/test_table"));
+    REQUIRE(tabledValues.size() == 2);
+
+    // the entry loaded through vector<vector<>> can serve requests that need column names
+    vector<map<string, string> > mappedValues;
+    REQUIRE(calib->GetCalib(mappedValues, "/test/test_vars/test_table"));
+    REQUIRE(mappedValues.size() == 2);
+
+    AssignmentCacheStats stats = calib->GetCacheStats();
+    REQUIRE(stats.Misses == 1);
+    REQUIRE(stats.Hits == 2);
+    REQUIRE(stats.Entries == 1);
+    REQUIRE(stats.UsedBytes > 0);
+
+    // Another Calibration doesn't share the cache
+    unique_ptr<Calibration> calib2(CalibrationGenerator::CreateCalibration(TESTS_SQLITE_STRING, 100, "default"));
+    REQUIRE(calib2->GetCacheStats().Entries == 0);
+
+    // shared assignment stays alive after eviction
+    shared_ptr<Assignment> assignment = calib->GetAssignmentShared("/test/test_vars/test_table");
+    calib->SetCacheMaxBytes(0);
+    REQUIRE(calib->GetCacheStats().Entries == 0);
+    REQUIRE(calib->GetCacheStats().Evictions == 1);
+    REQUIRE(assignment->GetValue(0) == "2.2");
+
+    // GetAssignment gives an owned object even if the cache can't keep the assignment
+    unique_ptr<Assignment> owned(calib->GetAssignment("/test/test_vars/test_table"));
+    REQUIRE(owned);
+    REQUIRE(owned->GetValue(0) == "2.2");
+    REQUIRE(calib->GetCacheStats().Entries == 0);
+}
+
+
+/** ********************************************************************* 
+ * @brief Test that typed data is decoded once and kept with the cached assignment
+ */
+TEST_CASE("CCDB/AssignmentCache/TypedData","Decoded numeric data cache tests")
+{
+    unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(TESTS_SQLITE_STRING, 100, "default"));
+    calib->EnableCache(true);
+
+    vector<vector<double> > doubleValues;
+    REQUIRE(calib->GetCalib(doubleValues, "/test/test_vars/test_table"));
+    REQUIRE(doubleValues.size() == 2);
+    REQUIRE(doubleValues[0].size() == 3);
+    REQUIRE(doubleValues[1][2] == Approx(2.7));
+
+    shared_ptr<Assignment> assignment = calib->GetAssignmentShared("/test/test_vars/test_table");
+    const vector<double>* decoded = &assignment->GetDoubleData();
+    REQUIRE(decoded->size() == 6);
+
+    doubleValues.clear();
+    REQUIRE(calib->GetCalib(doubleValues, "/test/test_vars/test_table"));
+    REQUIRE(&assignment->GetDoubleData() == decoded);
+    REQUIRE(doubleValues[0][0] == Approx(2.2));
+
+    vector<vector<int> > intValues;
+    REQUIRE(calib->GetCalib(intValues, "/test/test_vars/test_table2::test"));
+    REQUIRE(intValues.size() == 1);
+    REQUIRE(intValues[0][2] == 30);
+
+    int intValue = 0;
+    REQUIRE(calib->GetCalib(intValue, "/test/test_vars/test_table2::test"));
+    REQUIRE(intValue == 10);
+
+    map<string, int> intMap;
+    REQUIRE(calib->GetCalib(intMap, "/test/test_vars/test_table2::test"));
+    REQUIRE(intMap["c3"] == 30);
+
+    vector<map<string, double> > doubleMaps;
+    REQUIRE(calib->GetCalib(doubleMaps, "/test/test_vars/test_table"));
+    REQUIRE(doubleMaps.size() == 2);
+    REQUIRE(doubleMaps[1].size() == 3);
+
+    // decoded data is accounted by the cache
+    REQUIRE(calib->GetCacheStats().UsedBytes >= assignment->GetMemoryUsage());
+}
+
+
+/** ********************************************************************* 
+ * @brief Test of data blob tokenization without per cell strings
+ */
+TEST_CASE("CCDB/AssignmentCache/Tokens","Assignment blob tokens tests")
+{
+    Assignment assignment;
+    assignment.SetRawData("|1.5||a&delimiter;b|&amp|3|");
+
+    REQUIRE(assignment.GetTokensCount() == 4);
+    REQUIRE(assignment.GetToken(0) == "1.5");
+    REQUIRE(assignment.GetToken(1) == "a|b");
+    REQUIRE(assignment.GetToken(2) == "&amp");
+    REQUIRE(assignment.GetToken(3) == "3");
+
+    vector<string> tokens = assignment.GetVectorData();
+    REQUIRE(tokens.size() == 4);
+    REQUIRE(tokens[1] == "a|b");
+
+    // new data replaces old tokens
+    assignment.SetRawData("7|8");
+    REQUIRE(assignment.GetTokensCount() == 2);
+    REQUIRE(assignment.GetToken(1) == "8");
+}
+
+
+/** ********************************************************************* 
+ * @brief Concurrent cache hits, misses and evictions from many threads
+ */
+TEST_CASE("CCDB/AssignmentCache/Threads","Concurrent cache access tests")
+{
+    unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(TESTS_SQLITE_STRING, 100, "default"));
+    calib->EnableCache(true);
+
+    atomic<int> errorsCount(0);
+    vector<thread> threads;
+    for (int threadIndex = 0; threadIndex < 4; threadIndex++)
+    {
+        threads.emplace_back([&, threadIndex]() {
+            for (int i = 0; i < 200; i++)
+            {
+                vector<vector<double> > doubleValues;
+                vector<int> intValues;
+                if(!calib->GetCalib(doubleValues, "/test/test_vars/test_table") || doubleValues[1][2] != 2.7) errorsCount++;
+                if(!calib->GetCalib(intValues, "/test/test_vars/test_table2::test") || intValues[2] != 30) errorsCount++;
+
+                // the budget is shrunk in the middle, so entries are evicted while other threads read
+                if(threadIndex == 0 && i == 100) calib->SetCacheMaxBytes(1);
+            }
+        });
+    }
+    for (auto& thread: threads) thread.join();
+
+    REQUIRE(errorsCount == 0);
+    AssignmentCacheStats stats = calib->GetCacheStats();
+    REQUIRE(stats.Hits + stats.Misses == 4 * 200 * 2);
+    REQUIRE(stats.Entries == 0);
+}
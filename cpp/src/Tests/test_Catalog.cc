@@ -0,0 +1,158 @@
+#pragma warning(disable:4800)
+#include "Tests/catch.hpp"
+#include "Tests/tests.h"
+
+#include <memory>
+
+#include "CCDB/CalibrationGenerator.h"
+#include "CCDB/Providers/SQLiteDataProvider.h"
+#include "CCDB/Providers/SnapshotDataProvider.h"
+#include "CCDB/Model/Catalog.h"
+
+using namespace std;
+using namespace ccdb;
+
+/** @brief Compares catalog tables with tables loaded one by one */
+static void CheckCatalogTables(const Catalog& catalog, DataProvider& reference)
+{
+    vector<ConstantsTypeTable*> referenceTables = reference.GetAllConstantsTypeTables(false);
+    REQUIRE(catalog.GetTablesCount() == referenceTables.size());
+
+    for(ConstantsTypeTable* referenceTable: referenceTables) {
+        unique_ptr<ConstantsTypeTable> expected(reference.GetConstantsTypeTable(referenceTable->GetFullPath(), true));
+        const CatalogTable* found = catalog.FindTable(expected->GetFullPath());
+        REQUIRE(found != nullptr);
+        REQUIRE(catalog.FindTable(expected->GetId()) == found);
+        REQUIRE(found->TypeTable->GetId() == expected->GetId());
+        REQUIRE(found->TypeTable->GetRowsCount() == expected->GetRowsCount());
+        REQUIRE(found->TypeTable->GetColumnNames() == expected->GetColumnNames());
+        REQUIRE(found->TypeTable->GetColumnTypeStrings() == expected->GetColumnTypeStrings());
+        REQUIRE(found->TypeTable->GetDirectory() == nullptr);
+        REQUIRE(found->ColumnNames.size() == expected->GetColumns().size());
+        for(size_t i = 0; i < found->ColumnNames.size(); i++) REQUIRE(*found->ColumnNames[i] == expected->GetColumnNames()[i]);
+        delete referenceTable;
+    }
+    REQUIRE(catalog.FindTable("/test/test_vars/no_such_table") == nullptr);
+    REQUIRE(catalog.FindTable("test/test_vars/test_table") == nullptr);      //full paths only
+}
+
+
+/********************************************************************* **
+ * @brief Catalog has the same metadata as the provider queries
+ */
+TEST_CASE("CCDB/Catalog/Load","Catalog tests")
+{
+    SQLiteDataProvider reference;
+    reference.Connect(TESTS_SQLITE_STRING);
+
+    SECTION("SQLite bulk queries") {
+        SQLiteDataProvider provider;
+        provider.Connect(TESTS_SQLITE_STRING);
+        REQUIRE(provider.GetLoadedCatalog() == nullptr);
+        shared_ptr<const Catalog> catalog = provider.GetCatalog();
+        REQUIRE(catalog);
+        REQUIRE(provider.GetCatalog() == catalog);       //loaded once
+        CheckCatalogTables(*catalog, reference);
+
+        REQUIRE(catalog->GetVariationsCount() == 4);
+        const CatalogVariation* subtest = catalog->FindVariation("subtest");
+        REQUIRE(subtest != nullptr);
+        REQUIRE(subtest->Id == reference.GetVariation("subtest")->GetId());
+        REQUIRE(catalog->FindVariation(subtest->ParentId)->Name == "test");
+        REQUIRE(catalog->FindVariation("default")->ParentId == 0);
+        REQUIRE(catalog->FindVariation("no_such_variation") == nullptr);
+
+        //refresh gives a new catalog, the old one is still valid
+        shared_ptr<const Catalog> refreshed = provider.RefreshCatalog();
+        REQUIRE(refreshed != catalog);
+        REQUIRE(provider.GetCatalog() == refreshed);
+        REQUIRE(catalog->FindTable("/test/test_vars/test_table") != nullptr);
+    }
+
+    SECTION("Default implementation") {
+        SnapshotDataProvider provider;
+        provider.Connect(TESTS_SQLITE_SNAPSHOT_STRING);
+        CheckCatalogTables(*provider.GetCatalog(), reference);
+    }
+}
+
+
+/********************************************************************* **
+ * @brief Assignments share catalog type tables
+ */
+TEST_CASE("CCDB/Catalog/Assignments","Catalog tests")
+{
+    SQLiteDataProvider reference;
+    reference.Connect(TESTS_SQLITE_STRING);
+    SQLiteDataProvider provider;
+    provider.Connect(TESTS_SQLITE_STRING);
+    REQUIRE_FALSE(provider.IsCatalogEnabled());
+    provider.SetCatalogEnabled(true);
+
+    const char* variations[] = {"default", "test", "subtest"};
+    for(auto variation: variations) {
+        unique_ptr<Assignment> expected(reference.GetAssignmentShort(100, "/test/test_vars/test_table", 0, variation, true));
+        unique_ptr<Assignment> found(provider.GetAssignmentShort(100, "/test/test_vars/test_table", 0, variation, true));
+        REQUIRE(found->GetId() == expected->GetId());
+        REQUIRE(found->GetVariation()->GetName() == expected->GetVariation()->GetName());
+        REQUIRE(found->GetTypeTable() == provider.GetCatalog()->FindTable("/test/test_vars/test_table")->TypeTable.get());
+        REQUIRE(found->GetValueDouble(1, 2) == expected->GetValueDouble(1, 2));
+    }
+    REQUIRE_THROWS(provider.GetAssignmentShort(100, "/test/test_vars/no_such_table", 0, "default", true));
+    REQUIRE_THROWS(provider.GetAssignmentShort(100, "/test/test_vars/test_table", 0, "no_such_variation", true));
+
+    //the assignment keeps its table after the refresh
+    unique_ptr<Assignment> assignment(provider.GetAssignmentShort(100, "/test/test_vars/test_table2", 0, "test", true));
+    ConstantsTypeTable* table = assignment->GetTypeTable();
+    provider.RefreshCatalog();
+    REQUIRE(assignment->GetTypeTable() == table);
+    REQUIRE(table->GetColumnNames()[2] == "c3");
+    REQUIRE(assignment->GetValueInt(2) == 30);
+}
+
+
+/********************************************************************* **
+ * @brief Calibrations of the same database share one catalog
+ */
+TEST_CASE("CCDB/Catalog/CalibrationGenerator","Catalog tests")
+{
+    CalibrationGenerator generator;
+    REQUIRE_FALSE(generator.IsCatalogEnabled());
+    generator.SetCatalogEnabled(true);
+
+    Calibration* run1 = generator.MakeCalibration(TESTS_SQLITE_STRING, 100, "default");
+    REQUIRE(run1->GetProvider()->IsCatalogEnabled());
+    vector<vector<double> > values;
+    REQUIRE(run1->GetCalib(values, "/test/test_vars/test_table"));
+    REQUIRE(values[1][2] == Approx(2.7));
+    shared_ptr<const Catalog> catalog = run1->GetProvider()->GetLoadedCatalog();
+    REQUIRE(catalog);
+
+    Calibration* run2 = generator.MakeCalibration(TESTS_SQLITE_STRING, 600, "default");
+    REQUIRE(run2->GetProvider()->GetLoadedCatalog() == catalog);
+}
+
+
+/********************************************************************* **
+ * @brief Directory full path is built when the directory is attached
+ */
+TEST_CASE("CCDB/Catalog/DirectoryFullPath","Catalog tests")
+{
+    Directory root;
+    REQUIRE(root.GetFullPath() == "/");
+
+    Directory* parent = new Directory();
+    parent->SetName("test");
+    Directory* child = new Directory();
+    child->SetName("test_vars");
+    parent->AddSubdirectory(child);
+    REQUIRE(child->GetFullPath() == "/test/test_vars");
+
+    root.AddSubdirectory(parent);       //attaching updates subdirectories
+    REQUIRE(parent->GetFullPath() == "/test");
+    REQUIRE(child->GetFullPath() == "/test/test_vars");
+
+    child->SetName("vars");
+    REQUIRE(child->GetFullPath() == "/test/vars");
+    root.DisposeSubdirectories();
+}
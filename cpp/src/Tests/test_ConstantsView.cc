@@ -0,0 +1,104 @@
+#pragma warning(disable:4800)
+#include "Tests/catch.hpp"
+#include "Tests/tests.h"
+
+#include <memory>
+
+#include "CCDB/CalibrationGenerator.h"
+#include "CCDB/Model/ConstantsView.h"
+
+using namespace std;
+using namespace ccdb;
+
+
+/********************************************************************* **
+ * @brief Columns and rows of the view are the same as GetCalib tables
+ */
+TEST_CASE("CCDB/ConstantsView/GetView", "Columnar view")
+{
+    string connections[] = {TESTS_SQLITE_STRING, TESTS_SQLITE_SNAPSHOT_STRING};
+    for(const string& connectionString: connections) {
+        for(int mode = 0; mode < 2; mode++) {      //no cache, cache
+            unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(connectionString, 100, "default"));
+            calib->EnableCache(mode == 1);
+
+            vector<vector<double> > expected;
+            vector<vector<string> > expectedText;
+            REQUIRE(calib->GetCalib(expected, "/test/test_vars/test_table"));
+            REQUIRE(calib->GetCalib(expectedText, "/test/test_vars/test_table"));
+
+            ConstantsView view = calib->GetView("/test/test_vars/test_table");
+            REQUIRE(view);
+            REQUIRE_FALSE(view.IsEmpty());
+            REQUIRE(view.GetSharedAssignment());
+            REQUIRE(view.GetRowsCount() == expected.size());
+            REQUIRE(view.GetColumnsCount() == 3);
+            REQUIRE(view.GetColumnNames() == vector<string>({"x", "y", "z"}));
+            REQUIRE(view.GetColumnIndex("z") == 2);
+            REQUIRE(view.GetColumnIndex("no_such_column") == string::npos);
+            REQUIRE(view.GetColumnType(0) == ConstantsTypeColumn::cDoubleColumn);
+
+            for(size_t column = 0; column < view.GetColumnsCount(); column++) {
+                Span<const double> cells = view.GetDoubleColumn(column);
+                REQUIRE(cells.size() == view.GetRowsCount());
+                for(size_t row = 0; row < view.GetRowsCount(); row++) {
+                    REQUIRE(cells[row] == expected[row][column]);
+                    REQUIRE(view.GetDouble(row, column) == expected[row][column]);
+                    REQUIRE(view.GetString(row, column) == expectedText[row][column]);
+                }
+            }
+
+            for(size_t row = 0; row < view.GetRowsCount(); row++) {
+                Span<const double> cells = view.GetDoubleRow(row);
+                REQUIRE(vector<double>(cells.begin(), cells.end()) == expected[row]);
+            }
+            REQUIRE(view.GetDoubleColumn(view.GetColumnIndex("z"))[1] == Approx(2.7));
+
+            //the view keeps the assignment alive
+            calib->ClearCache();
+            calib.reset();
+            REQUIRE(view.GetDouble(1, 2) == Approx(2.7));
+        }
+    }
+}
+
+
+/********************************************************************* **
+ * @brief Int columns and views over not owned assignments
+ */
+TEST_CASE("CCDB/ConstantsView/Assignment", "Columnar view")
+{
+    ConstantsTypeTable table;
+    table.AddColumn("a", ConstantsTypeColumn::cIntColumn);
+    table.AddColumn("b", ConstantsTypeColumn::cBoolColumn);
+
+    Assignment assignment;
+    assignment.SetTypeTable(&table);
+    assignment.SetRawData("1|true|2|false|3|true");
+
+    ConstantsView view(assignment);
+    REQUIRE_FALSE(view.GetSharedAssignment());
+    REQUIRE(view.GetRowsCount() == 3);
+    REQUIRE(view.GetColumnsCount() == 2);
+
+    Span<const int> a = view.GetIntColumn(0);
+    REQUIRE(vector<int>(a.begin(), a.end()) == vector<int>({1, 2, 3}));
+    Span<const int> b = view.GetIntColumn(1);
+    REQUIRE(vector<int>(b.begin(), b.end()) == vector<int>({1, 0, 1}));
+    Span<const double> bDouble = view.GetDoubleColumn(1);
+    REQUIRE(vector<double>(bDouble.begin(), bDouble.end()) == vector<double>({1, 0, 1}));
+    Span<const int> secondRow = view.GetIntRow(1);
+    REQUIRE(vector<int>(secondRow.begin(), secondRow.end()) == vector<int>({2, 0}));
+    REQUIRE(view.GetString(2, 1) == "true");
+
+    //the data is decoded again for new raw data
+    assignment.SetRawData("4|false");
+    ConstantsView newView(assignment);
+    REQUIRE(newView.GetRowsCount() == 1);
+    REQUIRE(newView.GetIntColumn(0)[0] == 4);
+
+    ConstantsView empty;
+    REQUIRE(empty.IsEmpty());
+    REQUIRE_FALSE(empty);
+    REQUIRE(empty.GetRowsCount() == 0);
+}
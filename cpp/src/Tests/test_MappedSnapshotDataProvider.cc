@@ -0,0 +1,139 @@
+#pragma warning(disable:4800)
+#include "Tests/catch.hpp"
+#include "Tests/tests.h"
+
+#include <stdio.h>
+#include <unistd.h>
+#include <limits.h>
+#include <fstream>
+#include <memory>
+
+#include "CCDB/CalibrationGenerator.h"
+#include "CCDB/Providers/SQLiteDataProvider.h"
+#include "CCDB/Providers/SnapshotDataProvider.h"
+#include "CCDB/Providers/MappedSnapshotDataProvider.h"
+
+using namespace std;
+using namespace ccdb;
+
+/** @brief Writes the snapshot of the test database at the time to a temporary file */
+static string WriteTestSnapshot(time_t snapshotTime)
+{
+    string filePath = string(P_tmpdir) + "/ccdb_test_" + to_string(getpid()) + "_" + to_string(snapshotTime) + ".ccdbsnap";
+    SnapshotDataProvider snapshot(snapshotTime);
+    snapshot.Connect(TESTS_SQLITE_SNAPSHOT_STRING + string("?blobs=eager"));
+    snapshot.WriteBinarySnapshot(filePath);
+    return filePath;
+}
+
+
+/********************************************************************* **
+ * @brief Mapped snapshot gives the same assignments as SQLite provider at the snapshot time
+ */
+TEST_CASE("CCDB/MappedSnapshotDataProvider/Assignments","Mapped snapshot provider tests")
+{
+    SQLiteDataProvider sqlProvider;
+    sqlProvider.Connect(TESTS_SQLITE_STRING);
+
+    const char* tables[] = {"/test/test_vars/test_table", "/test/test_vars/test_table2"};
+    const char* variations[] = {"default", "test", "subtest"};
+    int runs[] = {0, 100, 499, 500, 3000, 3001, INT_MAX};
+    time_t times[] = {0, 1, 1349049600};     //no time, before everything, 2012-10-01
+
+    for(time_t time: times) {
+        string filePath = WriteTestSnapshot(time);
+        MappedSnapshotDataProvider mapped;
+        REQUIRE_THROWS(mapped.Connect(TESTS_SQLITE_SNAPSHOT_STRING));     //not a mapped snapshot connection string
+        REQUIRE_NOTHROW(mapped.Connect(MappedSnapshotDataProvider::ConnectionPrefix + filePath));
+        remove(filePath.c_str());      //the mapping stays valid
+        REQUIRE(mapped.IsConnected());
+        REQUIRE(mapped.IsConcurrentReadSupported());
+        REQUIRE(mapped.GetSnapshotTime() == time);
+
+        //metadata
+        REQUIRE(mapped.GetVariation("subtest") != nullptr);
+        REQUIRE(mapped.GetVariation("subtest")->GetParent()->GetName() == "test");
+        unique_ptr<ConstantsTypeTable> table(mapped.DataProvider::GetConstantsTypeTable("/test/test_vars/test_table", true));
+        REQUIRE(table);
+        REQUIRE(table->GetFullPath() == "/test/test_vars/test_table");
+        REQUIRE(table->GetColumnNames() == unique_ptr<ConstantsTypeTable>(sqlProvider.DataProvider::GetConstantsTypeTable("/test/test_vars/test_table", true))->GetColumnNames());
+        REQUIRE(mapped.DataProvider::GetConstantsTypeTable("/test/test_vars/no_such_table", false) == nullptr);
+        REQUIRE(mapped.GetAllConstantsTypeTables(false).size() == sqlProvider.GetAllConstantsTypeTables(false).size());
+
+        for(auto tablePath: tables) {
+            for(auto variation: variations) {
+                for(int run: runs) {
+                    unique_ptr<Assignment> expected(sqlProvider.GetAssignmentShort(run, tablePath, time, variation, true));
+                    unique_ptr<Assignment> found(mapped.GetAssignmentShort(run, tablePath, time, variation, true));
+                    REQUIRE((expected == nullptr) == (found == nullptr));
+                    if(!expected) continue;
+                    REQUIRE(found->GetId() == expected->GetId());
+                    REQUIRE(found->GetRawData() == expected->GetRawData());
+                    REQUIRE(found->GetVariation()->GetName() == expected->GetVariation()->GetName());
+                    REQUIRE(found->GetDoubleData() == expected->GetDoubleData());
+                    REQUIRE(found->GetIntData() == expected->GetIntData());
+                }
+            }
+        }
+
+        //other times can't be answered by the file
+        REQUIRE_THROWS(mapped.GetAssignmentShort(100, "/test/test_vars/test_table", time + 100, "default", false));
+
+        mapped.Disconnect();
+        REQUIRE_FALSE(mapped.IsConnected());
+        REQUIRE_THROWS(mapped.GetAssignmentShort(100, "/test/test_vars/test_table", 0, "default", false));
+    }
+}
+
+
+/********************************************************************* **
+ * @brief Damaged files are rejected on Connect
+ */
+TEST_CASE("CCDB/MappedSnapshotDataProvider/Validation","Mapped snapshot provider tests")
+{
+    string filePath = WriteTestSnapshot(0);
+    MappedSnapshotDataProvider mapped;
+    REQUIRE_THROWS(mapped.Connect(MappedSnapshotDataProvider::ConnectionPrefix + filePath + ".no_such_file"));
+
+    //truncated file
+    string truncatedPath = filePath + ".truncated";
+    {
+        ifstream source(filePath, ios::binary);
+        string content((istreambuf_iterator<char>(source)), istreambuf_iterator<char>());
+        ofstream(truncatedPath, ios::binary).write(content.data(), content.size() - 8);
+    }
+    REQUIRE_THROWS(mapped.Connect(MappedSnapshotDataProvider::ConnectionPrefix + truncatedPath));
+    REQUIRE_FALSE(mapped.IsConnected());
+
+    //not a snapshot
+    REQUIRE_THROWS(mapped.Connect(MappedSnapshotDataProvider::ConnectionPrefix + string(getenv("CCDB_HOME")) + "/sql/ccdb.sqlite"));
+    REQUIRE_FALSE(mapped.IsConnected());
+
+    REQUIRE_NOTHROW(mapped.Connect(MappedSnapshotDataProvider::ConnectionPrefix + filePath));
+    remove(truncatedPath.c_str());
+    remove(filePath.c_str());
+}
+
+
+/********************************************************************* **
+ * @brief CalibrationGenerator selects the mapped snapshot provider by the connection string
+ */
+TEST_CASE("CCDB/MappedSnapshotDataProvider/Calibration","Mapped snapshot provider tests")
+{
+    string filePath = WriteTestSnapshot(0);
+    string connectionString = MappedSnapshotDataProvider::ConnectionPrefix + filePath;
+    REQUIRE(CalibrationGenerator::CheckOpenable(connectionString));
+
+    unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(connectionString, 100, "default"));
+    REQUIRE(dynamic_cast<MappedSnapshotDataProvider*>(calib->GetProvider()) != nullptr);
+
+    vector<vector<double> > values;
+    REQUIRE(calib->GetCalib(values, "/test/test_vars/test_table"));
+    REQUIRE(values.size() == 2);
+    REQUIRE(values[1][2] == Approx(2.7));
+
+    vector<int> intValues;
+    REQUIRE(calib->GetCalib(intValues, "/test/test_vars/test_table2::test"));
+    REQUIRE(intValues[2] == 30);
+    remove(filePath.c_str());
+}
@@ -163,9 +163,8 @@ TEST_CASE("CCDB/UserAPI/SQLite_CalibrationGenerator","Use universal generator to
 
 	SECTION("Get Assignment test", "Test all elements of getting data through get assignment")
 	{
-		//std::shared_ptr<Assignment> a;
-        Assignment* a;
-		REQUIRE_NOTHROW(a = sqliteCalib->GetAssignment("/test/test_vars/test_table2:0:test"));
+		std::shared_ptr<Assignment> a;
+		REQUIRE_NOTHROW(a = sqliteCalib->GetAssignmentShared("/test/test_vars/test_table2:0:test"));
 		REQUIRE(result);
 		REQUIRE(a->GetValueType(0) == ConstantsTypeColumn::cIntColumn);
 		REQUIRE(a->GetValueType("c3") == ConstantsTypeColumn::cIntColumn);
@@ -190,8 +189,155 @@ TEST_CASE("CCDB/UserAPI/SQLite_CalibrationGenerator","Use universal generator to
             unique_ptr<Calibration> sqliteCalib1(gen2->MakeCalibration(TESTS_SQLITE_STRING, 100, res.Variation, res.ConstantsTime));
             //unique_ptr<Calibration> sqliteCalib2(gen2->MakeCalibration(TESTS_SQLITE_STRING, 100, res.Variation, res.ConstantsTime));
             unique_ptr<Calibration> sqliteCalib3(gen2->MakeCalibration(TESTS_SQLITE_STRING, 101, res.Variation, res.ConstantsTime));
-            sqliteCalib1->GetAssignment("/test/test_vars/test_table2:0:test");
+            unique_ptr<Assignment> assignment(sqliteCalib1->GetAssignment("/test/test_vars/test_table2:0:test"));
             //Now lets check the teardown...
         }
 	}
 }
+
+
+/** *********************************************************************
+ * @brief Asynchronous requests give the same results as synchronous ones
+ */
+TEST_CASE("CCDB/UserAPI/SQLite_Async","Asynchronous GetCalib")
+{
+    unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(TESTS_SQLITE_STRING, 100, "default"));
+    calib->SetAsyncThreadsCount(2);
+    REQUIRE(calib->GetAsyncThreadsCount() == 2);
+
+    //start everything, then wait
+    vector<vector<double> > tableValues;
+    vector<int> intValues;
+    map<string, double> mapValues;
+    std::future<bool> tableResult = calib->GetCalibAsync(tableValues, "/test/test_vars/test_table");
+    std::future<bool> intResult = calib->GetCalibAsync(intValues, "/test/test_vars/test_table2::test");
+    std::future<bool> mapResult = calib->GetCalibAsync(mapValues, "/test/test_vars/test_table2::test");
+    std::future<bool> noDataResult = calib->GetCalibAsync(intValues, "/test/test_vars/test_table2:100:no_such_variation");
+    std::future<std::shared_ptr<Assignment> > assignment = calib->GetAssignmentAsync("/test/test_vars/test_table");
+
+    REQUIRE(tableResult.get());
+    REQUIRE(tableValues[1][2] == Approx(2.7));
+    REQUIRE(intResult.get());
+    REQUIRE(intValues[2] == 30);
+    REQUIRE(mapResult.get());
+    REQUIRE(mapValues["c3"] == Approx(30));
+    REQUIRE_THROWS(noDataResult.get());        //errors are rethrown by the future
+    REQUIRE(assignment.get()->GetId() == calib->GetAssignmentShared("/test/test_vars/test_table")->GetId());
+
+    //callback version
+    std::promise<std::shared_ptr<Assignment> > callbackResult;
+    calib->GetAssignmentAsync("/test/test_vars/test_table", [&callbackResult](std::shared_ptr<Assignment> a, std::exception_ptr error) {
+        if(error) callbackResult.set_exception(error);
+        else callbackResult.set_value(a);
+    });
+    REQUIRE(callbackResult.get_future().get()->GetValueDouble(1, 2) == Approx(2.7));
+}
+
+
+/** *********************************************************************
+ * @brief Calibration may be destroyed with asynchronous requests still queued
+ */
+TEST_CASE("CCDB/UserAPI/SQLite_AsyncDestroy","Destruction with pending asynchronous requests")
+{
+    const int requestsCount = 50;
+    std::atomic<int> callbacksCount(0);
+    std::atomic<int> errorsCount(0);
+
+    unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(TESTS_SQLITE_STRING, 100, "default"));
+    calib->SetAsyncThreadsCount(1);
+    calib->EnableCache(false);
+    for(int i = 0; i < requestsCount; i++) {
+        calib->GetAssignmentAsync("/test/test_vars/test_table", [&](std::shared_ptr<Assignment> a, std::exception_ptr error) {
+            if(error) errorsCount++;
+            else if(!a) errorsCount += 1000;      //no assignment is unexpected
+            callbacksCount++;
+        });
+    }
+    std::future<std::shared_ptr<Assignment> > pending = calib->GetAssignmentAsync("/test/test_vars/test_table");
+    calib.reset();
+
+    //each callback is called once: with the assignment or with the cancellation error
+    REQUIRE(callbacksCount == requestsCount);
+    REQUIRE(errorsCount <= requestsCount);
+    REQUIRE(pending.valid());
+    try
+    {
+        pending.get();
+    }
+    catch (std::logic_error&)
+    {
+        //canceled
+    }
+}
+
+
+/** *********************************************************************
+ * @brief GetCalib with pre-resolved handles gives the same results as with namepaths
+ */
+TEST_CASE("CCDB/UserAPI/SQLite_RequestHandle","Pre-resolved requests")
+{
+    string connections[] = {TESTS_SQLITE_STRING, TESTS_SQLITE_SNAPSHOT_STRING};
+    for(const string& connectionString: connections) {
+        for(int mode = 0; mode < 3; mode++) {      //no cache, cache, catalog
+            unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(connectionString, 100, "subtest"));
+            calib->EnableCache(mode == 1);
+            calib->GetProvider()->SetCatalogEnabled(mode == 2);
+
+            RequestHandle handle = calib->Resolve("test/test_vars/test_table");
+            REQUIRE(handle.IsValid());
+            REQUIRE(handle.GetRequest().Path == "/test/test_vars/test_table");
+            REQUIRE(handle.GetRequest().RunNumber == 100);
+            REQUIRE(handle.GetVariation()->GetName() == "subtest");
+            REQUIRE(handle.GetTypeTable()->GetColumnNames().size() == 3);
+
+            for(int i = 0; i < 2; i++) {      //the second round is a cache hit in cache mode
+                vector<vector<double> > values, expected;
+                REQUIRE(calib->GetCalib(values, handle));
+                REQUIRE(calib->GetCalib(expected, "test/test_vars/test_table"));
+                REQUIRE(values == expected);
+
+                vector<map<string, string> > mapped, expectedMapped;
+                REQUIRE(calib->GetCalib(mapped, handle));
+                REQUIRE(calib->GetCalib(expectedMapped, "test/test_vars/test_table"));
+                REQUIRE(mapped == expectedMapped);
+
+                REQUIRE(calib->GetAssignmentShared(handle)->GetId() == calib->GetAssignmentShared("test/test_vars/test_table")->GetId());
+            }
+
+            //parent variation data and single values
+            RequestHandle rowHandle = calib->Resolve("/test/test_vars/test_table2:100:test");
+            vector<int> row;
+            REQUIRE(calib->GetCalib(row, rowHandle));
+            REQUIRE(row[2] == 30);
+            int value = 0;
+            REQUIRE(calib->GetCalib(value, rowHandle));
+            REQUIRE(value == 10);
+            map<string, double> namedRow;
+            REQUIRE(calib->GetCalib(namedRow, rowHandle));
+            REQUIRE(namedRow["c3"] == Approx(30));
+
+            //no data is false, as with namepath
+            RequestHandle noData = calib->Resolve("/test/test_vars/test_table2:100:default");
+            REQUIRE_FALSE(calib->GetCalib(row, noData));
+
+            //not existing tables and variations are reported by Resolve
+            REQUIRE_THROWS(calib->Resolve("/test/test_vars/no_such_table"));
+            REQUIRE_THROWS(calib->Resolve("/test/test_vars/test_table::no_such_variation"));
+
+            //a handle of another calibration is resolved by its namepath
+            unique_ptr<Calibration> other(CalibrationGenerator::CreateCalibration(connectionString, 100, "default"));
+            vector<vector<double> > otherValues;
+            REQUIRE(other->GetCalib(otherValues, handle));
+            REQUIRE(otherValues[1][2] == Approx(2.7));
+
+            //after reconnection the handle is resolved by its namepath too
+            vector<vector<double> > expectedValues, reconnectedValues;
+            REQUIRE(calib->GetCalib(expectedValues, "test/test_vars/test_table"));
+            calib->Disconnect();
+            calib->Connect(connectionString);
+            REQUIRE(calib->GetCalib(reconnectedValues, handle));
+            REQUIRE(reconnectedValues == expectedValues);
+            REQUIRE(calib->Resolve("test/test_vars/test_table").IsValid());
+        }
+    }
+}
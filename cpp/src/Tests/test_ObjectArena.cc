@@ -0,0 +1,101 @@
+#pragma warning(disable:4800)
+#include "Tests/catch.hpp"
+#include "Tests/tests.h"
+
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+#include "CCDB/Helpers/ObjectArena.h"
+#include "CCDB/Providers/SQLiteDataProvider.h"
+
+using namespace std;
+using namespace ccdb;
+
+/** Object that records its destruction */
+struct ArenaTracked
+{
+    ArenaTracked(vector<int>& destroyed, int id): Destroyed(destroyed), Id(id) {}
+    ~ArenaTracked() { Destroyed.push_back(Id); }
+
+    vector<int>& Destroyed;
+    int Id;
+};
+
+/** Object bigger than a chunk */
+struct ArenaBig
+{
+    char Data[4096];
+};
+
+/** Over aligned object */
+struct alignas(32) ArenaAligned
+{
+    double Values[3];
+};
+
+
+/********************************************************************* **
+ * @brief Objects are placed in chunks and destroyed together in reverse order
+ */
+TEST_CASE("CCDB/ObjectArena/CreateAndClear", "Arena")
+{
+    vector<int> destroyed;
+    ObjectArena arena(1024);
+
+    for(int i = 0; i < 100; i++) {
+        ArenaTracked* object = arena.Create<ArenaTracked>(destroyed, i);
+        REQUIRE(object->Id == i);
+
+        ArenaAligned* aligned = arena.Create<ArenaAligned>();
+        REQUIRE(reinterpret_cast<uintptr_t>(aligned) % alignof(ArenaAligned) == 0);
+
+        int* number = arena.Create<int>(i);
+        REQUIRE(*number == i);
+    }
+    REQUIRE(arena.GetObjectsCount() == 300);
+    REQUIRE(arena.GetChunksCount() > 1);
+    REQUIRE(arena.GetChunksCount() < 20);       //much less than objects
+    REQUIRE(destroyed.empty());
+
+    //a big object gets a chunk of its own
+    size_t chunksCount = arena.GetChunksCount();
+    ArenaBig* big = arena.Create<ArenaBig>();
+    REQUIRE(big != nullptr);
+    REQUIRE(arena.GetChunksCount() == chunksCount + 1);
+
+    arena.Clear();
+    REQUIRE(arena.GetObjectsCount() == 0);
+    REQUIRE(arena.GetChunksCount() == 0);
+    REQUIRE(arena.GetUsedBytes() == 0);
+    REQUIRE(destroyed.size() == 100);
+    REQUIRE(destroyed.front() == 99);
+    REQUIRE(destroyed.back() == 0);
+
+    //the arena is used again after clear and destroys the rest in its destructor
+    {
+        ObjectArena scoped;
+        scoped.Create<ArenaTracked>(destroyed, 1000);
+    }
+    REQUIRE(destroyed.back() == 1000);
+}
+
+
+/********************************************************************* **
+ * @brief Catalog tables are in the catalog arena that lives while its tables are used
+ */
+TEST_CASE("CCDB/ObjectArena/CatalogTables", "Arena")
+{
+    shared_ptr<ConstantsTypeTable> table;
+    {
+        SQLiteDataProvider provider;
+        provider.Connect(TESTS_SQLITE_STRING);
+        table = provider.GetCatalog()->FindTable("/test/test_vars/test_table")->TypeTable;
+        REQUIRE_FALSE(table->GetIsColumnsOwner());
+        provider.RefreshCatalog();
+    }
+
+    //the provider and both catalogs are gone, the table is alive
+    REQUIRE(table->GetFullPath() == "/test/test_vars/test_table");
+    REQUIRE(table->GetColumnNames() == vector<string>({"x", "y", "z"}));
+}
@@ -0,0 +1,197 @@
+#pragma warning(disable:4800)
+#include "Tests/catch.hpp"
+#include "Tests/tests.h"
+
+#include <limits.h>
+#include <memory>
+
+#include "CCDB/CalibrationGenerator.h"
+#include "CCDB/Providers/SQLiteDataProvider.h"
+#include "CCDB/Providers/SnapshotDataProvider.h"
+
+using namespace std;
+using namespace ccdb;
+
+/** @brief All combinations of tables, variations, runs and times of the test database, with some bad requests */
+static vector<AssignmentRequest> MakeTestRequests()
+{
+    const char* tables[] = {"/test/test_vars/test_table", "/test/test_vars/test_table2", "/test/test_vars/no_such_table", "/no_such_dir/table"};
+    const char* variations[] = {"default", "test", "subtest", "no_such_variation"};
+    int runs[] = {0, 100, 500, 3001, INT_MAX};
+    time_t times[] = {0, 1, 1349049600};     //no time, before everything, 2012-10-01
+
+    vector<AssignmentRequest> requests;
+    for(auto table: tables) {
+        for(auto variation: variations) {
+            for(int run: runs) {
+                for(time_t time: times) requests.push_back({table, run, variation, time});
+            }
+        }
+    }
+    return requests;
+}
+
+
+/** @brief Compares batch result with GetAssignmentShort of each request */
+static void CheckBatch(DataProvider& provider, DataProvider& reference)
+{
+    vector<AssignmentRequest> requests = MakeTestRequests();
+    vector<Assignment*> assignments = provider.GetAssignmentsShort(requests, true);
+    REQUIRE(assignments.size() == requests.size());
+
+    int foundCount = 0;
+    for(size_t i = 0; i < requests.size(); i++) {
+        unique_ptr<Assignment> found(assignments[i]);
+        unique_ptr<Assignment> expected;
+        try {
+            expected.reset(reference.GetAssignmentShort(requests[i].RunNumber, requests[i].Path, requests[i].Time, requests[i].Variation, true));
+        }
+        catch (std::runtime_error&) {
+            //no such table or variation gives nullptr in batch
+        }
+
+        REQUIRE((expected == nullptr) == (found == nullptr));
+        if(!expected) continue;
+        REQUIRE(found->GetId() == expected->GetId());
+        REQUIRE(found->GetRawData() == expected->GetRawData());
+        REQUIRE(found->GetRequestedRun() == requests[i].RunNumber);
+        REQUIRE(found->GetVariation()->GetName() == expected->GetVariation()->GetName());
+        REQUIRE(found->GetTypeTable()->GetFullPath() == expected->GetTypeTable()->GetFullPath());
+        REQUIRE(found->GetTypeTable()->GetColumnNames() == expected->GetTypeTable()->GetColumnNames());
+        foundCount++;
+    }
+    REQUIRE(foundCount > 0);
+}
+
+
+/********************************************************************* **
+ * @brief Batch request gives the same assignments as requests one by one
+ */
+TEST_CASE("CCDB/Prefetch/GetAssignmentsShort","Batch assignments tests")
+{
+    SQLiteDataProvider reference;
+    reference.Connect(TESTS_SQLITE_STRING);
+
+    SECTION("SQLite set-based queries") {
+        SQLiteDataProvider provider;
+        provider.Connect(TESTS_SQLITE_STRING);
+        CheckBatch(provider, reference);
+        REQUIRE(provider.GetAssignmentsShort(vector<AssignmentRequest>(), false).empty());
+
+        //the second batch reuses the prepared statements
+        uint64_t misses = provider.GetStatementCacheStats().Misses;
+        CheckBatch(provider, reference);
+        REQUIRE(provider.GetStatementCacheStats().Misses == misses);
+    }
+
+    SECTION("SQLite with the catalog") {
+        SQLiteDataProvider provider;
+        provider.Connect(TESTS_SQLITE_STRING);
+        provider.SetCatalogEnabled(true);
+        CheckBatch(provider, reference);
+
+        //assignments share the type table of the catalog
+        vector<AssignmentRequest> requests = {{"/test/test_vars/test_table", 100, "default", 0}};
+        unique_ptr<Assignment> assignment(provider.GetAssignmentsShort(requests, false)[0]);
+        REQUIRE(assignment);
+        REQUIRE(assignment->GetTypeTable() == provider.GetCatalog()->FindTable("/test/test_vars/test_table")->TypeTable.get());
+    }
+
+    SECTION("Default implementation") {
+        SnapshotDataProvider provider;
+        provider.Connect(TESTS_SQLITE_SNAPSHOT_STRING);
+        CheckBatch(provider, reference);
+    }
+}
+
+
+/********************************************************************* **
+ * @brief GetCalib calls after Prefetch are cache hits
+ */
+TEST_CASE("CCDB/Prefetch/Calibration","Calibration prefetch tests")
+{
+    unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(TESTS_SQLITE_STRING, 100, "subtest"));
+    calib->EnableCache(true);
+
+    vector<string> namepaths = {
+        "/test/test_vars/test_table",
+        "/test/test_vars/test_table2",
+        "/test/test_vars/test_table:100:default",
+        "test/test_vars/test_table2::test",
+        "/test/test_vars/test_table",              //the same namepath once
+        "/test/test_vars/no_such_table"            //not cached
+    };
+    REQUIRE(calib->Prefetch(namepaths) == 4);
+    REQUIRE(calib->GetCacheStats().Entries == 4);
+    REQUIRE(calib->Prefetch(namepaths) == 0);     //all are cached already
+
+    vector<vector<double> > values;
+    REQUIRE(calib->GetCalib(values, "/test/test_vars/test_table"));      //subtest variation data
+    REQUIRE(values[1][2] == Approx(15));
+    vector<int> intValues;
+    REQUIRE(calib->GetCalib(intValues, "test/test_vars/test_table2::test"));
+    REQUIRE(intValues[2] == 30);
+    vector<map<string, string> > mappedValues;
+    REQUIRE(calib->GetCalib(mappedValues, "/test/test_vars/test_table:100:default"));
+    REQUIRE(mappedValues[0]["x"] == "2.2");
+
+    AssignmentCacheStats stats = calib->GetCacheStats();
+    REQUIRE(stats.Hits == 3);
+    REQUIRE(stats.Misses == 0);
+
+    //the same assignments as without prefetch
+    unique_ptr<Calibration> reference(CalibrationGenerator::CreateCalibration(TESTS_SQLITE_STRING, 100, "subtest"));
+    for(size_t i = 0; i < 4; i++) {
+        REQUIRE(calib->GetAssignmentShared(namepaths[i])->GetId() == reference->GetAssignmentShared(namepaths[i])->GetId());
+    }
+
+    //nothing to fill if the cache is disabled
+    calib->EnableCache(false);
+    REQUIRE(calib->Prefetch(namepaths) == 0);
+}
+
+
+/********************************************************************* **
+ * @brief A Calibration for the next run prefetches what the previous run requested
+ */
+TEST_CASE("CCDB/Prefetch/RunTransition","Run transition prefetch tests")
+{
+    CalibrationGenerator generator;
+    REQUIRE(generator.IsRunPrefetchEnabled());
+
+    Calibration* run1 = generator.MakeCalibration(TESTS_SQLITE_STRING, 100, "default");
+    run1->EnableCache(true);
+    vector<vector<double> > values;
+    REQUIRE(run1->GetCalib(values, "/test/test_vars/test_table"));
+    REQUIRE(run1->GetCalib(values, "/test/test_vars/test_table2::test"));
+    REQUIRE(run1->GetRequestedNamepaths().size() == 2);
+    REQUIRE(generator.GetRunPrefetchesCount() == 0);
+
+    //the next run gets the working set of the previous one
+    Calibration* run2 = generator.MakeCalibration(TESTS_SQLITE_STRING, 600, "default");
+    REQUIRE(run2 != run1);
+    REQUIRE(generator.GetRunPrefetchesCount() == 1);
+    REQUIRE(run2->IsCacheEnabled());
+    run2->WaitPrefetch();
+    REQUIRE(run2->GetCacheStats().Prefetched == 2);
+    REQUIRE(run2->GetCacheStats().PrefetchedUsed == 0);
+    REQUIRE(run2->GetRequestedNamepaths().empty());       //nothing is requested yet
+
+    REQUIRE(run2->GetCalib(values, "/test/test_vars/test_table"));
+    AssignmentCacheStats stats = run2->GetCacheStats();
+    REQUIRE(stats.Misses == 0);
+    REQUIRE(stats.PrefetchedUsed == 1);
+    REQUIRE(run2->GetRequestedNamepaths() == vector<string>{"/test/test_vars/test_table"});
+
+    //unused prefetched namepaths are not carried to the run after
+    Calibration* run3 = generator.MakeCalibration(TESTS_SQLITE_STRING, 700, "default");
+    run3->WaitPrefetch();
+    REQUIRE(run3->GetCacheStats().Prefetched == 1);
+
+    //other variation is a different context. Disabled prefetch starts nothing
+    generator.MakeCalibration(TESTS_SQLITE_STRING, 800, "test");
+    generator.SetRunPrefetchEnabled(false);
+    Calibration* run4 = generator.MakeCalibration(TESTS_SQLITE_STRING, 900, "default");
+    REQUIRE(generator.GetRunPrefetchesCount() == 2);
+    REQUIRE(run4->GetCacheStats().Prefetched == 0);
+}
@@ -0,0 +1,175 @@
+#pragma warning(disable:4800)
+#include "Tests/catch.hpp"
+#include "Tests/tests.h"
+
+#include <memory>
+
+#include "CCDB/CalibrationGenerator.h"
+#include "CCDB/Helpers/RowSchema.h"
+
+using namespace std;
+using namespace ccdb;
+
+/** Rows of /test/test_vars/test_table (x, y, z are double columns) */
+struct TestTableRow
+{
+    double x;
+    double y;
+    double z;
+};
+
+/** Some of the columns in other order and to other member types */
+struct TestTablePartialRow
+{
+    string zText;
+    float x;
+};
+
+/** Rows of /test/test_vars/test_table2 (c1, c2, c3 are int columns) */
+struct TestTable2Row
+{
+    int c1;
+    unsigned long c2;
+    bool c3;
+};
+
+/** Row with a column that test_table doesn't have */
+struct WrongRow
+{
+    double x;
+    double w;
+};
+
+namespace ccdb
+{
+    template<> struct RowSchema<TestTableRow>
+    {
+        static constexpr auto Fields = std::make_tuple(
+            Field("x", &TestTableRow::x),
+            Field("y", &TestTableRow::y),
+            Field("z", &TestTableRow::z));
+    };
+
+    template<> struct RowSchema<TestTablePartialRow>
+    {
+        static constexpr auto Fields = std::make_tuple(
+            Field("z", &TestTablePartialRow::zText),
+            Field("x", &TestTablePartialRow::x));
+    };
+
+    template<> struct RowSchema<TestTable2Row>
+    {
+        static constexpr auto Fields = std::make_tuple(
+            Field("c1", &TestTable2Row::c1),
+            Field("c2", &TestTable2Row::c2),
+            Field("c3", &TestTable2Row::c3));
+    };
+
+    template<> struct RowSchema<WrongRow>
+    {
+        static constexpr auto Fields = std::make_tuple(
+            Field("x", &WrongRow::x),
+            Field("w", &WrongRow::w));
+    };
+}
+
+
+/********************************************************************* **
+ * @brief Rows decoded to structs are the same as GetCalib tables
+ */
+TEST_CASE("CCDB/RowSchema/GetCalibRows", "Typed rows")
+{
+    string connections[] = {TESTS_SQLITE_STRING, TESTS_SQLITE_SNAPSHOT_STRING};
+    for(const string& connectionString: connections) {
+        for(int mode = 0; mode < 2; mode++) {      //no cache, cache
+            unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(connectionString, 100, "default"));
+            calib->EnableCache(mode == 1);
+
+            for(int i = 0; i < 2; i++) {      //the second round uses the kept binding
+                vector<vector<double> > expected;
+                vector<vector<string> > expectedText;
+                REQUIRE(calib->GetCalib(expected, "/test/test_vars/test_table"));
+                REQUIRE(calib->GetCalib(expectedText, "/test/test_vars/test_table"));
+
+                vector<TestTableRow> rows;
+                REQUIRE(calib->GetCalibRows(rows, "/test/test_vars/test_table"));
+                REQUIRE(rows.size() == expected.size());
+                for(size_t row = 0; row < rows.size(); row++) {
+                    REQUIRE(rows[row].x == expected[row][0]);
+                    REQUIRE(rows[row].y == expected[row][1]);
+                    REQUIRE(rows[row].z == expected[row][2]);
+                }
+                REQUIRE(rows[1].z == Approx(2.7));
+
+                vector<TestTablePartialRow> partialRows;
+                REQUIRE(calib->GetCalibRows(partialRows, calib->Resolve("/test/test_vars/test_table")));
+                REQUIRE(partialRows.size() == expected.size());
+                for(size_t row = 0; row < partialRows.size(); row++) {
+                    REQUIRE(partialRows[row].zText == expectedText[row][2]);
+                    REQUIRE(partialRows[row].x == static_cast<float>(expected[row][0]));
+                }
+            }
+
+            vector<TestTable2Row> intRows;
+            REQUIRE(calib->GetCalibRows(intRows, "/test/test_vars/test_table2::test"));
+            REQUIRE(intRows.size() == 1);
+            REQUIRE(intRows[0].c1 == 10);
+            REQUIRE(intRows[0].c2 == 20ul);
+            REQUIRE(intRows[0].c3);
+
+            vector<WrongRow> wrongRows;
+            REQUIRE_THROWS_AS(calib->GetCalibRows(wrongRows, "/test/test_vars/test_table"), std::logic_error);
+        }
+    }
+}
+
+
+/********************************************************************* **
+ * @brief A namepath without data is false, as with GetCalib
+ */
+TEST_CASE("CCDB/RowSchema/GetCalibRowsNoData", "Typed rows")
+{
+    unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(TESTS_SQLITE_STRING, 100, "default"));
+    const string noData = "/test/test_vars/test_table2:100:default";     //the table has data only in 'test' variation
+
+    vector<TestTable2Row> rows;
+    REQUIRE_FALSE(calib->GetCalibRows(rows, noData));
+    REQUIRE_FALSE(calib->GetCalibRows(rows, calib->Resolve(noData)));
+    REQUIRE(rows.empty());
+
+    //not existing tables throw
+    REQUIRE_THROWS(calib->GetCalibRows(rows, "/test/test_vars/no_such_table"));
+}
+
+
+/********************************************************************* **
+ * @brief Schema columns are checked against table columns
+ */
+TEST_CASE("CCDB/RowSchema/BindRowColumns", "Typed rows")
+{
+    ConstantsTypeTable table;
+    table.SetFullPath("/test/binding");
+    table.AddColumn("a", ConstantsTypeColumn::cIntColumn);
+    table.AddColumn("b", ConstantsTypeColumn::cStringColumn);
+    table.AddColumn("c", ConstantsTypeColumn::cDoubleColumn);
+
+    RowColumnSpec columns[] = {{"c", false}, {"a", false}, {"b", true}};
+    vector<RowColumnBinding> binding = BindRowColumns(table, columns, 3);
+    REQUIRE(binding.size() == 3);
+    REQUIRE(binding[0].Index == 2);
+    REQUIRE(binding[1].Index == 0);
+    REQUIRE(binding[1].Type == ConstantsTypeColumn::cIntColumn);
+    REQUIRE(binding[2].Index == 1);
+
+    RowColumnSpec numericOfString[] = {{"b", false}};
+    REQUIRE_THROWS_AS(BindRowColumns(table, numericOfString, 1), std::logic_error);
+
+    RowColumnSpec missing[] = {{"d", true}};
+    REQUIRE_THROWS_AS(BindRowColumns(table, missing, 1), std::logic_error);
+
+    const auto& specs = GetRowColumnSpecs<TestTablePartialRow>();
+    REQUIRE(specs.size() == 2);
+    REQUIRE(string(specs[0].Name) == "z");
+    REQUIRE(specs[0].IsString);
+    REQUIRE_FALSE(specs[1].IsString);
+}
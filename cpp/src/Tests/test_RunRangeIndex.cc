@@ -0,0 +1,121 @@
+#pragma warning(disable:4800)
+#include "Tests/catch.hpp"
+#include "Tests/tests.h"
+
+#include <limits.h>
+#include <random>
+#include <memory>
+
+#include "CCDB/Helpers/RunRangeIndex.h"
+#include "CCDB/Providers/SQLiteDataProvider.h"
+
+using namespace std;
+using namespace ccdb;
+
+
+/** Brute force "ORDER BY id DESC LIMIT 1" to compare the index with */
+static const RunRangeIndex::Item* FindNewest(const vector<RunRangeIndex::Item>& items, int run)
+{
+    const RunRangeIndex::Item* newest = nullptr;
+    for(const auto& item: items) {
+        if(item.RunMin <= run && run <= item.RunMax && (!newest || item.AssignmentId > newest->AssignmentId)) newest = &item;
+    }
+    return newest;
+}
+
+
+/********************************************************************* **
+ * @brief Test of RunRangeIndex
+ */
+TEST_CASE("CCDB/RunRangeIndex/Find","Run range index tests")
+{
+    //empty
+    RunRangeIndex empty({});
+    REQUIRE(empty.Find(100) == nullptr);
+
+    //            id  constant set
+    RunRangeIndex index({
+        {0, INT_MAX, 1, 10},        //the whole run range, oldest
+        {500, 3000, 3, 30},         //newer in the middle
+        {1000, 2000, 2, 20},        //older than 3, never wins
+        {5000, 4000, 9, 90},        //invalid range is ignored
+    });
+    REQUIRE(index.GetItemsCount() == 3);
+    REQUIRE(index.Find(-1) == nullptr);
+    REQUIRE(index.Find(0)->AssignmentId == 1);
+    REQUIRE(index.Find(499)->AssignmentId == 1);
+    REQUIRE(index.Find(500)->AssignmentId == 3);
+    REQUIRE(index.Find(1500)->AssignmentId == 3);
+    REQUIRE(index.Find(3000)->ConstantSetId == 30);
+    REQUIRE(index.Find(3001)->AssignmentId == 1);
+    REQUIRE(index.Find(INT_MAX)->AssignmentId == 1);
+
+    //gaps
+    RunRangeIndex gaps({{10, 20, 1, 1}, {30, 30, 2, 2}});
+    REQUIRE(gaps.Find(9) == nullptr);
+    REQUIRE(gaps.Find(20)->AssignmentId == 1);
+    REQUIRE(gaps.Find(21) == nullptr);
+    REQUIRE(gaps.Find(30)->AssignmentId == 2);
+    REQUIRE(gaps.Find(31) == nullptr);
+
+    //random overlapping ranges against brute force
+    mt19937 random(42);
+    uniform_int_distribution<int> runs(0, 1000);
+    vector<RunRangeIndex::Item> items;
+    for(int id = 1; id <= 300; id++) {
+        int runMin = runs(random);
+        int runMax = runMin + runs(random) / 10;
+        items.push_back({runMin, runMax, id * 7 % 301, id});   //ids are not in order
+    }
+    RunRangeIndex randomIndex(items);
+    int mismatchesCount = 0;
+    for(int run = -1; run <= 1200; run++) {
+        const RunRangeIndex::Item* expected = FindNewest(items, run);
+        const RunRangeIndex::Item* found = randomIndex.Find(run);
+        if((expected == nullptr) != (found == nullptr) || (expected && expected->AssignmentId != found->AssignmentId)) mismatchesCount++;
+    }
+    REQUIRE(mismatchesCount == 0);
+}
+
+
+/********************************************************************* **
+ * @brief The index mode of SQLiteDataProvider selects the same assignments as the SQL query
+ */
+TEST_CASE("CCDB/RunRangeIndex/SQLiteDataProvider","Run range index mode tests")
+{
+    SQLiteDataProvider sqlProvider;
+    sqlProvider.Connect(TESTS_SQLITE_STRING);
+
+    SQLiteDataProvider indexProvider;
+    indexProvider.Connect(TESTS_SQLITE_STRING);
+    indexProvider.SetRunRangeIndexEnabled(true);
+    REQUIRE(indexProvider.IsRunRangeIndexEnabled());
+
+    const char* tables[] = {"/test/test_vars/test_table", "/test/test_vars/test_table2"};
+    const char* variations[] = {"default", "test", "subtest"};
+    int runs[] = {0, 100, 499, 500, 3000, 3001, INT_MAX};
+    time_t times[] = {0, 1, 1349049600};     //no time, before everything, 2012-10-01
+
+    int comparedCount = 0;
+    for(auto table: tables) {
+        for(auto variation: variations) {
+            for(int run: runs) {
+                for(time_t time: times) {
+                    unique_ptr<Assignment> expected(sqlProvider.GetAssignmentShort(run, table, time, variation, false));
+                    unique_ptr<Assignment> found(indexProvider.GetAssignmentShort(run, table, time, variation, false));
+                    REQUIRE((expected == nullptr) == (found == nullptr));
+                    if(!expected) continue;
+                    REQUIRE(found->GetId() == expected->GetId());
+                    REQUIRE(found->GetRawData() == expected->GetRawData());
+                    comparedCount++;
+                }
+            }
+        }
+    }
+    REQUIRE(comparedCount > 0);
+    REQUIRE(indexProvider.GetRunRangeIndexesCount() > 0);
+
+    //indexes are dropped on disconnect
+    indexProvider.Disconnect();
+    REQUIRE(indexProvider.GetRunRangeIndexesCount() == 0);
+}
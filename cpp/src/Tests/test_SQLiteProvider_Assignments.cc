@@ -7,6 +7,10 @@
 #include "CCDB/Model/Variation.h"
 #include "CCDB/Model/Directory.h"
 
+#include <limits.h>
+#include <memory>
+#include <sqlite3.h>
+
 using namespace std;
 using namespace ccdb;
 
@@ -27,13 +31,15 @@ TEST_CASE("CCDB/SQLiteDataProvider/Assignments","Assignments tests")
 	//lets start with simple cases. 
 	//Get FULL assignment by table and name
 	
-	Assignment * assignment = prov->GetAssignmentShort(100,"/test/test_vars/test_table", 0, "default", false);
+	Assignment * assignment = prov->GetAssignmentShort(100,"/test/test_vars/test_table", 0, "default", true);
 	
 	REQUIRE(assignment!=NULL);
 
 	//Check that everything is loaded
 	REQUIRE(assignment->GetVariation() != NULL);
 	REQUIRE(assignment->GetRunRange()  != NULL);
+	REQUIRE(assignment->GetRunRange()->GetMin() <= 100);
+	REQUIRE(assignment->GetRunRange()->GetMax() >= 100);
 	REQUIRE(assignment->GetTypeTable() != NULL);	
 	REQUIRE(!assignment->GetTypeTable()->GetColumns().empty());
 	vector<vector<string> > tabeled_values = assignment->GetData();
@@ -46,3 +52,79 @@ TEST_CASE("CCDB/SQLiteDataProvider/Assignments","Assignments tests")
 	REQUIRE(tabeled_values[1][1] == "2.6");
 	REQUIRE(tabeled_values[1][2] == "2.7");
 }
+
+
+/** @brief The newest assignment id of the table and exactly this variation, the query of the former recursive lookup */
+static int SelectVariationAssignmentId(sqlite3* db, int run, int tableId, int variationId, time_t time)
+{
+    string query =
+        "SELECT `assignments`.`id` FROM `assignments` "
+        "INNER JOIN `runRanges` ON `assignments`.`runRangeId`= `runRanges`.`id` "
+        "INNER JOIN `constantSets` ON `assignments`.`constantSetId` = `constantSets`.`id` "
+        "WHERE `runRanges`.`runMin` <= ?1 AND `runRanges`.`runMax` >= ?1 "
+        "AND `assignments`.`variationId`= ?2 AND `constantSets`.`constantTypeId` = ?3 " +
+        string(time > 0 ? "AND `assignments`.`created` <= datetime(?4, 'unixepoch', 'localtime') " : "") +
+        "ORDER BY `assignments`.`id` DESC LIMIT 1";
+    sqlite3_stmt* stmt = nullptr;
+    REQUIRE(sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, nullptr) == SQLITE_OK);
+    sqlite3_bind_int(stmt, 1, run);
+    sqlite3_bind_int(stmt, 2, variationId);
+    sqlite3_bind_int(stmt, 3, tableId);
+    if(time > 0) sqlite3_bind_int64(stmt, 4, time);
+    int id = (sqlite3_step(stmt) == SQLITE_ROW) ? sqlite3_column_int(stmt, 0) : 0;
+    sqlite3_finalize(stmt);
+    return id;
+}
+
+
+/** ********************************************************************* **
+ * @brief Variation chain resolved by one query gives the same assignments as asking variation by variation
+ */
+TEST_CASE("CCDB/SQLiteDataProvider/Assignments/VariationChain","Assignments tests")
+{
+    sqlite3* db = nullptr;
+    REQUIRE(sqlite3_open_v2((string(getenv("CCDB_HOME")) + "/sql/ccdb.sqlite").c_str(), &db, SQLITE_OPEN_READONLY, nullptr) == SQLITE_OK);
+
+    SQLiteDataProvider chainProvider;       //recursive CTE
+    chainProvider.Connect(TESTS_SQLITE_STRING);
+    SQLiteDataProvider indexProvider;       //run range indexes, variation by variation in memory
+    indexProvider.Connect(TESTS_SQLITE_STRING);
+    indexProvider.SetRunRangeIndexEnabled(true);
+
+    const char* tables[] = {"/test/test_vars/test_table", "/test/test_vars/test_table2"};
+    const char* variations[] = {"default", "mc", "test", "subtest"};
+    int runs[] = {0, 100, 499, 500, 3000, 3001, INT_MAX};
+    time_t times[] = {0, 1, 1349049600};     //no time, before everything, 2012-10-01
+
+    int fallbacksCount = 0;
+    for(auto tablePath: tables) {
+        for(auto variationName: variations) {
+            for(int run: runs) {
+                for(time_t time: times) {
+                    //the reference: the variation, then its parent and so on
+                    unique_ptr<ConstantsTypeTable> table(chainProvider.DataProvider::GetConstantsTypeTable(tablePath, false));
+                    Variation* expectedVariation = chainProvider.GetVariation(variationName);
+                    int expectedId = 0;
+                    for(; expectedVariation; expectedVariation = expectedVariation->GetParent()) {
+                        expectedId = SelectVariationAssignmentId(db, run, table->GetId(), expectedVariation->GetId(), time);
+                        if(expectedId) break;
+                    }
+
+                    unique_ptr<Assignment> found(chainProvider.GetAssignmentShort(run, tablePath, time, variationName, false));
+                    unique_ptr<Assignment> indexed(indexProvider.GetAssignmentShort(run, tablePath, time, variationName, false));
+                    REQUIRE((found != nullptr) == (expectedId != 0));
+                    REQUIRE((indexed != nullptr) == (expectedId != 0));
+                    if(!expectedId) continue;
+
+                    REQUIRE(found->GetId() == expectedId);
+                    REQUIRE(found->GetVariation()->GetName() == expectedVariation->GetName());
+                    REQUIRE(indexed->GetId() == expectedId);
+                    REQUIRE(indexed->GetVariation()->GetName() == expectedVariation->GetName());
+                    if(expectedVariation->GetName() != variationName) fallbacksCount++;
+                }
+            }
+        }
+    }
+    REQUIRE(fallbacksCount > 0);        //the chain is really walked
+    sqlite3_close(db);
+}
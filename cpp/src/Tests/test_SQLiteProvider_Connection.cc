@@ -2,7 +2,12 @@
 #include "Tests/catch.hpp"
 #include "Tests/tests.h"
 
+#include <thread>
+#include <atomic>
+#include <memory>
+
 #include "CCDB/Providers/SQLiteDataProvider.h"
+#include "CCDB/SQLiteCalibration.h"
 
 
 using namespace std;
@@ -40,3 +45,123 @@ TEST_CASE("CCDB/SQLiteDataProvider/Connection","Connection tests")
 	prov->Disconnect();
 	delete prov;
 }
+
+
+
+/********************************************************************* ** 
+ * @brief Test that many threads read through one provider at the same time
+ */
+TEST_CASE("CCDB/SQLiteDataProvider/ConcurrentReads","Connection pool tests")
+{
+	SQLiteDataProvider prov;
+	prov.Connect(TESTS_SQLITE_STRING);
+	REQUIRE(prov.IsConcurrentReadSupported());
+
+	atomic<int> errorsCount(0);
+	vector<thread> threads;
+	for (int threadIndex = 0; threadIndex < 4; threadIndex++)
+	{
+		threads.emplace_back([&]() {
+			for (int i = 0; i < 50; i++)
+			{
+				unique_ptr<Assignment> assignment(prov.GetAssignmentShort(100, "/test/test_vars/test_table", 0, "default", true));
+				if(!assignment || assignment->GetValue(0) != "2.2") errorsCount++;
+
+				unique_ptr<Assignment> child(prov.GetAssignmentShort(100, "/test/test_vars/test_table2", 0, "test", false));
+				if(!child || child->GetValue(2) != "30") errorsCount++;
+
+				Variation* variation = prov.GetVariationById(child->GetVariation()->GetId());
+				if(!variation || variation->GetName() != "test") errorsCount++;
+			}
+		});
+	}
+	for (auto& thread: threads) thread.join();
+	REQUIRE(errorsCount == 0);
+
+	//connections leased during disconnect are closed on release, the provider may be connected again
+	prov.Disconnect();
+	REQUIRE_FALSE(prov.IsConnected());
+	REQUIRE_THROWS(prov.GetVariation("not_loaded_variation"));
+	REQUIRE_NOTHROW(prov.Connect(TESTS_SQLITE_STRING));
+	REQUIRE(prov.GetVariation("default") != nullptr);
+}
+
+
+
+/********************************************************************* ** 
+ * @brief Test that the provider may be swapped and deleted while other threads read through the calibration
+ */
+TEST_CASE("CCDB/SQLiteDataProvider/ConcurrentUseProvider","Connection pool tests")
+{
+	SQLiteCalibration calib(100);
+	calib.EnableCache(false);		//each request goes to the provider
+	auto provider = new SQLiteDataProvider();
+	provider->Connect(TESTS_SQLITE_STRING);
+	calib.UseProvider(provider, true);
+
+	atomic<bool> isDone(false);
+	atomic<int> errorsCount(0);
+	vector<thread> threads;
+	for (int threadIndex = 0; threadIndex < 4; threadIndex++)
+	{
+		threads.emplace_back([&]() {
+			while(!isDone)
+			{
+				vector<vector<double> > values;
+				if(!calib.GetCalib(values, "/test/test_vars/test_table") || values[0][0] != 2.2) errorsCount++;
+			}
+		});
+	}
+
+	for (int i = 0; i < 20; i++)
+	{
+		auto nextProvider = new SQLiteDataProvider();
+		nextProvider->Connect(TESTS_SQLITE_STRING);
+		calib.UseProvider(nextProvider, true);
+		delete provider;		//no request reads it after UseProvider
+		provider = nextProvider;
+	}
+	isDone = true;
+	for (auto& thread: threads) thread.join();
+	REQUIRE(errorsCount == 0);
+
+	calib.UseProvider(nullptr, true);
+	delete provider;
+}
+
+
+
+/********************************************************************* ** 
+ * @brief Test that prepared statements are reused and rebound correctly
+ */
+TEST_CASE("CCDB/SQLiteDataProvider/PreparedStatements","Prepared statements cache tests")
+{
+	SQLiteDataProvider prov;
+	prov.Connect(TESTS_SQLITE_STRING);
+
+	unique_ptr<Assignment> first(prov.GetAssignmentShort(100, "/test/test_vars/test_table", 0, "default", true));
+	REQUIRE(first);
+	SQLiteStatementCacheStats warmStats = prov.GetStatementCacheStats();
+	REQUIRE(warmStats.Misses > 0);
+
+	//the same statements are reused, with and without the time condition
+	for (int i = 0; i < 3; i++)
+	{
+		unique_ptr<Assignment> assignment(prov.GetAssignmentShort(100, "/test/test_vars/test_table", 0, "default", true));
+		REQUIRE(assignment);
+		REQUIRE(assignment->GetId() == first->GetId());
+		REQUIRE(assignment->GetValue(0) == "2.2");
+
+		//nothing was created before 1970-01-01 00:00:01
+		unique_ptr<Assignment> tooEarly(prov.GetAssignmentShort(100, "/test/test_vars/test_table", 1, "default", false));
+		REQUIRE_FALSE(tooEarly);
+
+		unique_ptr<Assignment> child(prov.GetAssignmentShort(100, "/test/test_vars/test_table2", 0, "test", false));
+		REQUIRE(child);
+		REQUIRE(child->GetValue(2) == "30");
+	}
+
+	SQLiteStatementCacheStats stats = prov.GetStatementCacheStats();
+	//new statements are compiled only for queries (or pooled connections) not used before
+	REQUIRE(stats.Hits - warmStats.Hits > 3 * (stats.Misses - warmStats.Misses));
+}
@@ -0,0 +1,116 @@
+#pragma warning(disable:4800)
+#include "Tests/catch.hpp"
+#include "Tests/tests.h"
+
+#include <limits.h>
+#include <memory>
+
+#include "CCDB/CalibrationGenerator.h"
+#include "CCDB/Providers/SQLiteDataProvider.h"
+#include "CCDB/Providers/SnapshotDataProvider.h"
+
+using namespace std;
+using namespace ccdb;
+
+
+/********************************************************************* **
+ * @brief Snapshot provider selects the same assignments as SQLite provider
+ */
+TEST_CASE("CCDB/SnapshotDataProvider/Assignments","Snapshot provider tests")
+{
+    SQLiteDataProvider sqlProvider;
+    sqlProvider.Connect(TESTS_SQLITE_STRING);
+
+    SnapshotDataProvider snapshot;
+    REQUIRE_FALSE(snapshot.IsConnected());
+    REQUIRE_THROWS(snapshot.Connect(TESTS_SQLITE_STRING));     //not a snapshot connection string
+    REQUIRE_NOTHROW(snapshot.Connect(TESTS_SQLITE_SNAPSHOT_STRING));
+    REQUIRE(snapshot.IsConnected());
+    REQUIRE(snapshot.IsConcurrentReadSupported());
+    REQUIRE_FALSE(snapshot.IsEagerBlobs());
+    REQUIRE(snapshot.GetAssignmentsCount() > 0);
+
+    //metadata
+    REQUIRE(snapshot.GetVariation("subtest") != nullptr);
+    REQUIRE(snapshot.GetVariation("subtest")->GetParent()->GetName() == "test");
+    REQUIRE(snapshot.GetVariation("no_such_variation") == nullptr);
+    unique_ptr<ConstantsTypeTable> table(snapshot.DataProvider::GetConstantsTypeTable("/test/test_vars/test_table", true));
+    REQUIRE(table);
+    REQUIRE(table->GetFullPath() == "/test/test_vars/test_table");
+    REQUIRE(table->GetColumnNames().size() == 3);
+    REQUIRE(table->GetColumnNames()[0] == "x");
+    REQUIRE(snapshot.GetAllConstantsTypeTables(false).size() == sqlProvider.GetAllConstantsTypeTables(false).size());
+
+    const char* tables[] = {"/test/test_vars/test_table", "/test/test_vars/test_table2"};
+    const char* variations[] = {"default", "test", "subtest"};
+    int runs[] = {0, 100, 499, 500, 3000, 3001, INT_MAX};
+    time_t times[] = {0, 1, 1349049600};     //no time, before everything, 2012-10-01
+
+    int comparedCount = 0;
+    for(auto tablePath: tables) {
+        for(auto variation: variations) {
+            for(int run: runs) {
+                for(time_t time: times) {
+                    unique_ptr<Assignment> expected(sqlProvider.GetAssignmentShort(run, tablePath, time, variation, true));
+                    unique_ptr<Assignment> found(snapshot.GetAssignmentShort(run, tablePath, time, variation, true));
+                    REQUIRE((expected == nullptr) == (found == nullptr));
+                    if(!expected) continue;
+                    REQUIRE(found->GetId() == expected->GetId());
+                    REQUIRE(found->GetRawData() == expected->GetRawData());
+                    REQUIRE(found->GetVariation()->GetName() == expected->GetVariation()->GetName());
+                    REQUIRE(found->GetTypeTable()->GetColumnNames() == expected->GetTypeTable()->GetColumnNames());
+                    comparedCount++;
+                }
+            }
+        }
+    }
+    REQUIRE(comparedCount > 0);
+    REQUIRE(snapshot.GetQueriesAfterConnectCount() == comparedCount);     //lazy blobs only
+
+    snapshot.Disconnect();
+    REQUIRE_FALSE(snapshot.IsConnected());
+    REQUIRE_THROWS(snapshot.GetAssignmentShort(100, "/test/test_vars/test_table", 0, "default", false));
+}
+
+
+/********************************************************************* **
+ * @brief With eager blobs requests at the snapshot time don't query the database
+ */
+TEST_CASE("CCDB/SnapshotDataProvider/EagerBlobs","Snapshot provider tests")
+{
+    SnapshotDataProvider snapshot;
+    REQUIRE_THROWS(snapshot.Connect(TESTS_SQLITE_SNAPSHOT_STRING + string("?blobs=sometimes")));
+    REQUIRE_FALSE(snapshot.IsConnected());
+    snapshot.Connect(TESTS_SQLITE_SNAPSHOT_STRING + string("?blobs=eager"));
+    REQUIRE(snapshot.IsEagerBlobs());
+    REQUIRE(snapshot.GetLoadedBlobsCount() > 0);
+
+    unique_ptr<Assignment> assignment(snapshot.GetAssignmentShort(100, "/test/test_vars/test_table", 0, "default", false));
+    REQUIRE(assignment);
+    REQUIRE(assignment->GetValue(0) == "2.2");
+    unique_ptr<Assignment> child(snapshot.GetAssignmentShort(100, "/test/test_vars/test_table2", 0, "subtest", false));
+    REQUIRE(child);
+    REQUIRE(child->GetValue(2) == "30");
+    REQUIRE(snapshot.GetQueriesAfterConnectCount() == 0);
+}
+
+
+/********************************************************************* **
+ * @brief CalibrationGenerator selects the snapshot provider by the connection string
+ */
+TEST_CASE("CCDB/SnapshotDataProvider/Calibration","Snapshot provider tests")
+{
+    REQUIRE(CalibrationGenerator::CheckOpenable(TESTS_SQLITE_SNAPSHOT_STRING));
+
+    unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(TESTS_SQLITE_SNAPSHOT_STRING, 100, "default"));
+    REQUIRE(dynamic_cast<SnapshotDataProvider*>(calib->GetProvider()) != nullptr);
+
+    vector<vector<double> > values;
+    REQUIRE(calib->GetCalib(values, "/test/test_vars/test_table"));
+    REQUIRE(values.size() == 2);
+    REQUIRE(values[1][2] == Approx(2.7));
+
+    vector<int> intValues;
+    REQUIRE(calib->GetCalib(intValues, "/test/test_vars/test_table2::test"));
+    REQUIRE(intValues[2] == 30);
+}
@@ -4,6 +4,7 @@
 #include "catch.hpp"
 
 #include "CCDB/Helpers/StringUtils.h"
+#include <math.h>
 
 
 using namespace std;
@@ -51,4 +52,109 @@ TEST_CASE("CCDB/StringUtils/Split", "Test of lexical splittiong string to tokens
 	REQUIRE(outArray[5] == "30e-2");
 }
 
+
+TEST_CASE("CCDB/StringUtils/SplitOffsets", "Test of splitting blob to token offsets")
+{
+	const StringUtils::SplitImplementations implementations[] = {
+		StringUtils::cSplitScalar, StringUtils::cSplitSSE2, StringUtils::cSplitAVX2, StringUtils::cSplitAuto };
+
+	//blobs of different lengths cover the vectorized body and the tail
+	string blob;
+	for (int i = 0; i < 100; i++)
+	{
+		blob += (i % 7 == 0) ? "|" : "";
+		blob += StringUtils::IntToString(i * 37) + "|";
+
+		vector<string> expected;
+		StringUtils::Split(blob, expected, "|");
+
+		for (auto implementation: implementations)
+		{
+			vector<StringToken> tokens;
+			StringUtils::SplitOffsets(blob.data(), blob.size(), '|', tokens, implementation);
+
+			REQUIRE(tokens.size() == expected.size());
+			for (size_t j = 0; j < tokens.size(); j++)
+			{
+				REQUIRE(blob.substr(tokens[j].Offset, tokens[j].Length) == expected[j]);
+			}
+		}
+	}
+
+	vector<StringToken> tokens;
+	StringUtils::SplitOffsets("", 0, '|', tokens);
+	REQUIRE(tokens.empty());
+	StringUtils::SplitOffsets("|||", 3, '|', tokens);
+	REQUIRE(tokens.empty());
+	StringUtils::SplitOffsets("abc", 3, '|', tokens);
+	REQUIRE(tokens.size() == 1);
+	REQUIRE(tokens[0].Length == 3);
+}
+
+
+TEST_CASE("CCDB/StringUtils/Parse", "Test of numbers parsing")
+{
+	bool result = false;
+
+	REQUIRE(StringUtils::ParseInt("42", &result) == 42);
+	REQUIRE(result);
+	REQUIRE(StringUtils::ParseInt(" +42 ", &result) == 42);
+	REQUIRE(result);
+	REQUIRE(StringUtils::ParseInt("-7", &result) == -7);
+	REQUIRE(result);
+	REQUIRE(StringUtils::ParseInt("12.5", &result) == 12);
+	REQUIRE_FALSE(result);
+	REQUIRE(StringUtils::ParseInt("abc", &result) == 0);
+	REQUIRE_FALSE(result);
+	REQUIRE(StringUtils::ParseInt("", &result) == 0);
+	REQUIRE_FALSE(result);
+	REQUIRE(StringUtils::ParseInt("99999999999", &result) == 0);
+	REQUIRE_FALSE(result);
+	REQUIRE(StringUtils::ParseUInt("4000000000", &result) == 4000000000u);
+	REQUIRE(result);
+	REQUIRE(StringUtils::ParseLong("-12345678901", &result) == -12345678901L);
+	REQUIRE(result);
+
+	REQUIRE(StringUtils::ParseDouble("2.5", &result) == 2.5);
+	REQUIRE(result);
+	REQUIRE(StringUtils::ParseDouble("30e-2", &result) == Approx(0.3));
+	REQUIRE(result);
+	REQUIRE(StringUtils::ParseDouble("-1.5E3", &result) == -1500.0);
+	REQUIRE(result);
+	REQUIRE(StringUtils::ParseDouble("1.5x", &result) == 1.5);
+	REQUIRE_FALSE(result);
+	REQUIRE(StringUtils::ParseDouble("1e999", &result) == HUGE_VAL);
+	REQUIRE_FALSE(result);
+
+	//views don't need NUL terminated strings
+	string blob = "3.25|17";
+	REQUIRE(StringUtils::ParseDouble(std::string_view(blob.data(), 4), &result) == 3.25);
+	REQUIRE(result);
+
+	REQUIRE(StringUtils::ParseBool("true", &result));
+	REQUIRE(result);
+	REQUIRE_FALSE(StringUtils::ParseBool("false", &result));
+	REQUIRE(result);
+	REQUIRE(StringUtils::ParseBool("1", &result));
+	REQUIRE_FALSE(StringUtils::ParseBool("0", &result));
+	REQUIRE_FALSE(StringUtils::ParseBool("yes", &result));
+	REQUIRE_FALSE(result);
+
+	//batch parsing of tokenized blob
+	blob = "1|2.5|x|-4";
+	vector<StringToken> tokens;
+	StringUtils::SplitOffsets(blob.data(), blob.size(), '|', tokens);
+	vector<double> doubles(tokens.size());
+	REQUIRE_FALSE(StringUtils::ParseDoubleArray(blob.data(), tokens.data(), tokens.size(), doubles.data()));
+	REQUIRE(doubles[1] == 2.5);
+	REQUIRE(doubles[2] == 0);
+	REQUIRE(doubles[3] == -4);
+
+	blob = "1|2|3";
+	StringUtils::SplitOffsets(blob.data(), blob.size(), '|', tokens);
+	vector<int> ints(tokens.size());
+	REQUIRE(StringUtils::ParseIntArray(blob.data(), tokens.data(), tokens.size(), ints.data()));
+	REQUIRE(ints[2] == 3);
+}
+
 #endif //test_StringUtils_h
@@ -0,0 +1,120 @@
+#pragma warning(disable:4800)
+#include "Tests/catch.hpp"
+#include "Tests/tests.h"
+
+#include <stdio.h>
+#include <unistd.h>
+#include <memory>
+
+#include "CCDB/CalibrationGenerator.h"
+#include "CCDB/Helpers/SyntheticDatabase.h"
+#include "CCDB/Model/Catalog.h"
+
+using namespace std;
+using namespace ccdb;
+
+/** Small database with all kinds of content */
+static SyntheticDatabaseOptions GetTestOptions(uint64_t seed)
+{
+    SyntheticDatabaseOptions options;
+    options.Seed = seed;
+    options.Directories = 5;
+    options.Tables = 20;
+    options.MaxColumns = 5;
+    options.MaxRows = 50;
+    options.MaxCells = 100;
+    options.Runs = 1000;
+    options.MaxRunRangeLength = 100;
+    options.Variations = 6;
+    options.VariationDepth = 4;
+    options.MaxAssignments = 5;
+    options.StringColumnsShare = 0.2;
+    return options;
+}
+
+
+/** All constants of all tables for the run in the variation as strings */
+static vector<vector<vector<string> > > ReadAll(const string& filePath, int run, const string& variation)
+{
+    unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration("sqlite://" + filePath, run, variation));
+    vector<vector<vector<string> > > result;
+    for(const CatalogTable& table: calib->GetProvider()->GetCatalog()->GetTables()) {
+        vector<vector<string> > values;
+        REQUIRE(calib->GetCalib(values, table.TypeTable->GetFullPath()));     //default for all runs is always there
+        REQUIRE(values.size() == static_cast<size_t>(table.TypeTable->GetRowsCount()));
+        REQUIRE(values[0].size() == table.TypeTable->GetColumnsCount());
+        result.push_back(values);
+    }
+    return result;
+}
+
+
+/********************************************************************* **
+ * @brief Generated database is readable and has what the options ask for
+ */
+TEST_CASE("CCDB/SyntheticDatabase/Generate", "Synthetic database")
+{
+    string prefix = string(P_tmpdir) + "/ccdb_test_synthetic_" + to_string(getpid());
+    string firstPath = prefix + "_1.sqlite";
+    string samePath = prefix + "_2.sqlite";
+    string otherPath = prefix + "_3.sqlite";
+
+    SyntheticDatabaseOptions options = GetTestOptions(42);
+    SyntheticDatabaseStats stats = SyntheticDatabase(options).Generate(firstPath);
+    REQUIRE(stats.Directories == 5);
+    REQUIRE(stats.Tables == 20);
+    REQUIRE(stats.Variations == 6);
+    REQUIRE(stats.MaxVariationDepth == 4);
+    REQUIRE(stats.DeepestVariation == "var0004");
+    REQUIRE(stats.Assignments >= 20);
+    REQUIRE(stats.Assignments <= 100);
+    REQUIRE_THROWS(SyntheticDatabase(options).Generate(firstPath));      //doesn't overwrite
+
+    {
+        unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration("sqlite://" + firstPath, 0, stats.DeepestVariation));
+        shared_ptr<const Catalog> catalog = calib->GetProvider()->GetCatalog();
+        REQUIRE(catalog->GetTablesCount() == 20);
+        REQUIRE(catalog->GetVariationsCount() == 6);
+        for(const CatalogTable& table: catalog->GetTables()) {
+            REQUIRE(table.TypeTable->GetColumnsCount() <= 5);
+            REQUIRE(table.TypeTable->GetRowsCount() * table.TypeTable->GetColumnsCount() <= 100);
+        }
+    }
+
+    //the same seed gives the same content, in the deepest variation too
+    SyntheticDatabase(options).Generate(samePath);
+    REQUIRE(ReadAll(firstPath, 500, "default") == ReadAll(samePath, 500, "default"));
+    REQUIRE(ReadAll(firstPath, 500, stats.DeepestVariation) == ReadAll(samePath, 500, stats.DeepestVariation));
+
+    SyntheticDatabase(GetTestOptions(43)).Generate(otherPath);
+    REQUIRE(ReadAll(firstPath, 500, "default") != ReadAll(otherPath, 500, "default"));
+
+    remove(firstPath.c_str());
+    remove(samePath.c_str());
+    remove(otherPath.c_str());
+}
+
+
+/********************************************************************* **
+ * @brief Inconsistent options are rejected
+ */
+TEST_CASE("CCDB/SyntheticDatabase/Options", "Synthetic database")
+{
+    SyntheticDatabaseOptions options;
+    REQUIRE_NOTHROW(SyntheticDatabase::ValidateOptions(options));
+
+    options.MinRows = 10;
+    options.MaxRows = 5;
+    REQUIRE_THROWS_AS(SyntheticDatabase::ValidateOptions(options), std::logic_error);
+
+    options = SyntheticDatabaseOptions();
+    options.VariationDepth = 0;
+    REQUIRE_THROWS_AS(SyntheticDatabase{options}, std::logic_error);
+    options.Variations = 1;
+    REQUIRE_NOTHROW(SyntheticDatabase{options});
+
+    options = SyntheticDatabaseOptions();
+    options.IntColumnsShare = 0.7;
+    options.StringColumnsShare = 0.5;
+    REQUIRE_THROWS_AS(SyntheticDatabase::ValidateOptions(options), std::logic_error);
+}
@@ -0,0 +1,107 @@
+#pragma warning(disable:4800)
+#include "Tests/catch.hpp"
+#include "Tests/tests.h"
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CCDB/Calibration.h"
+#include "CCDB/CalibrationGenerator.h"
+#include "CCDB/Helpers/Trace.h"
+
+using namespace std;
+using namespace ccdb;
+
+/** Summary of the phase */
+static TracePhaseSummary GetPhaseSummary(TracePhase phase)
+{
+    return Trace::Summarize()[static_cast<size_t>(phase)];
+}
+
+
+/********************************************************************* **
+ * @brief Spans are recorded only while tracing is on, counters outlive full ring buffers
+ */
+TEST_CASE("CCDB/Trace/Spans", "Trace")
+{
+    bool wasEnabled = Trace::IsEnabled();
+    Trace::Enable(false);
+    Trace::Clear();
+
+    { TraceSpan span(TracePhase::Parse, string("/off")); }
+    REQUIRE(Trace::GetEvents().empty());
+
+    Trace::Enable(true);
+    string longDetail(200, 'x');
+    { TraceSpan span(TracePhase::Parse, string("/test/path")); }
+    { TraceSpan span(TracePhase::Sql, longDetail); }
+    { TraceSpan span(TracePhase::Decode); }
+
+    vector<TraceEvent> events = Trace::GetEvents();
+    REQUIRE(events.size() == 3);
+    REQUIRE(events[0].Phase == TracePhase::Parse);
+    REQUIRE(string(events[0].Detail) == "/test/path");
+    REQUIRE(string(events[1].Detail) == longDetail.substr(0, TraceEvent::DetailSize - 1));
+    REQUIRE(string(events[2].Detail).empty());
+    REQUIRE(events[0].StartNs <= events[1].StartNs);
+    REQUIRE(GetPhaseSummary(TracePhase::Parse).Count == 1);
+
+    // Other threads record to their own buffers
+    thread worker([]() {
+        for(size_t i = 0; i < Trace::BufferEvents + 10; i++) { TraceSpan span(TracePhase::Cache); }
+    });
+    worker.join();
+    REQUIRE(GetPhaseSummary(TracePhase::Cache).Count == Trace::BufferEvents + 10);
+    REQUIRE(Trace::GetDroppedEventsCount() == 10);
+    REQUIRE(Trace::GetEvents().size() == 3 + Trace::BufferEvents);
+
+    stringstream stream;
+    Trace::WriteEvents(stream);
+    REQUIRE(stream.str().find("CCDB_TRACE:{\"thread\":") == 0);
+    REQUIRE(stream.str().find("\"phase\":\"parse\",\"detail\":\"/test/path\"") != string::npos);
+
+    Trace::Clear();
+    REQUIRE(Trace::GetEvents().empty());
+    REQUIRE(GetPhaseSummary(TracePhase::Cache).Count == 0);
+    Trace::Enable(wasEnabled);
+}
+
+
+/********************************************************************* **
+ * @brief GetCalib records the phases of the request
+ */
+TEST_CASE("CCDB/Trace/Calibration", "Trace")
+{
+    bool wasEnabled = Trace::IsEnabled();
+    Trace::Enable(true);
+    Trace::Clear();
+
+    unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(TESTS_SQLITE_STRING, 100, "default"));
+    calib->EnableCache(true);
+    vector<vector<double> > values;
+    REQUIRE(calib->GetCalib(values, "/test/test_vars/test_table"));
+    REQUIRE(calib->GetCalib(values, "/test/test_vars/test_table"));
+
+    REQUIRE(GetPhaseSummary(TracePhase::Request).Count == 1);
+    REQUIRE(GetPhaseSummary(TracePhase::Parse).Count == 1);
+    REQUIRE(GetPhaseSummary(TracePhase::Sql).Count > 0);
+    REQUIRE(GetPhaseSummary(TracePhase::BlobSplit).Count == 1);
+    REQUIRE(GetPhaseSummary(TracePhase::Decode).Count == 2);
+    REQUIRE(GetPhaseSummary(TracePhase::Cache).Count == 2);
+
+    bool isRequestFound = false;
+    for(const TraceEvent& event: Trace::GetEvents()) {
+        if(event.Phase == TracePhase::Request) isRequestFound = string(event.Detail) == "/test/test_vars/test_table";
+    }
+    REQUIRE(isRequestFound);
+
+    stringstream stream;
+    Trace::WriteSummary(stream);
+    REQUIRE(stream.str().find("request") != string::npos);
+
+    Trace::Enable(wasEnabled);
+    Trace::Clear();
+}
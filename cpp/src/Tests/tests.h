@@ -9,10 +9,12 @@
 #ifndef WIN32
 #define TESTS_CONENCTION_STRING "mysql://ccdb_user@127.0.0.1:3306/ccdb_test"
 #define TESTS_SQLITE_STRING ( "sqlite://" + string(getenv("CCDB_HOME")) + "/sql/ccdb.sqlite").c_str()
+#define TESTS_SQLITE_SNAPSHOT_STRING ( "sqlite+snapshot://" + string(getenv("CCDB_HOME")) + "/sql/ccdb.sqlite").c_str()
 
 #else
 #define TESTS_CONENCTION_STRING "mysql://ccdb_user@127.0.0.1:3306/ccdb_test"
 #define TESTS_SQLITE_STRING "sqlite://..\\..\\..\\sql\\ccdb.sqlite"
+#define TESTS_SQLITE_SNAPSHOT_STRING "sqlite+snapshot://..\\..\\..\\sql\\ccdb.sqlite"
 #endif
 
 
@@ -0,0 +1,145 @@
+/**
+ *  Writes a synthetic CCDB SQLite database for scalability tests (@see ccdb::SyntheticDatabase)
+ *
+ *  usage: ccdb_generate <output.sqlite> [options]
+ *
+ *  The same seed and options give the same database, so benchmarks and tests may recreate it:
+ *
+ *      ccdb_generate big.sqlite --seed 7 --tables 2000 --rows 1:100000 --assignments 1:50 --variations 30 --variation-depth 6
+ *      ccdb_benchmarks --sqlite big.sqlite
+ *
+ *  Ranges are given as min:max (or one number for min = max).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <exception>
+
+#include "CCDB/Helpers/SyntheticDatabase.h"
+#include "CCDB/Helpers/StopWatch.h"
+
+using namespace std;
+using namespace ccdb;
+
+
+//______________________________________________________________________________
+static void PrintHelp(const char* programName)
+{
+    SyntheticDatabaseOptions defaults;
+    fprintf(stderr,
+        "usage: %s <output.sqlite> [options]\n"
+        "   --seed <n>                  random seed (%llu)\n"
+        "   --directories <n>           directories (%d)\n"
+        "   --tables <n>                type tables (%d)\n"
+        "   --columns <min:max>         columns of a table (%d:%d)\n"
+        "   --rows <min:max>            rows of a table, log-uniform (%d:%d)\n"
+        "   --max-cells <n>             rows are cut so rows x columns <= n (%lld)\n"
+        "   --runs <n>                  run ranges start in [0, n) (%d)\n"
+        "   --run-range <min:max>       run range length, log-uniform (%d:%d)\n"
+        "   --variations <n>            variations including default (%d)\n"
+        "   --variation-depth <n>       the longest parents chain below default (%d)\n"
+        "   --assignments <min:max>     assignments of a table (%d:%d)\n"
+        "   --int-share <x>             share of int columns (%g)\n"
+        "   --string-share <x>          share of string columns (%g)\n"
+        "   --force                     overwrites the output file\n",
+        programName, static_cast<unsigned long long>(defaults.Seed), defaults.Directories, defaults.Tables,
+        defaults.MinColumns, defaults.MaxColumns, defaults.MinRows, defaults.MaxRows, static_cast<long long>(defaults.MaxCells),
+        defaults.Runs, defaults.MinRunRangeLength, defaults.MaxRunRangeLength, defaults.Variations, defaults.VariationDepth,
+        defaults.MinAssignments, defaults.MaxAssignments, defaults.IntColumnsShare, defaults.StringColumnsShare);
+}
+
+
+//______________________________________________________________________________
+/** Parses "min:max" or "n". Returns false if the text is not a range */
+static bool ParseRange(const string& text, int& min, int& max)
+{
+    char* end = nullptr;
+    min = static_cast<int>(strtol(text.c_str(), &end, 10));
+    if(end == text.c_str()) return false;
+    if(*end == '\0') {
+        max = min;
+        return true;
+    }
+    if(*end != ':') return false;
+
+    const char* maxText = end + 1;
+    max = static_cast<int>(strtol(maxText, &end, 10));
+    return end != maxText && *end == '\0';
+}
+
+
+//______________________________________________________________________________
+int main(int argc, char* argv[])
+{
+    if(argc < 2 || argv[1][0] == '-')
+    {
+        PrintHelp(argv[0]);
+        return 1;
+    }
+
+    string outputPath(argv[1]);
+    SyntheticDatabaseOptions options;
+    bool isForced = false;
+
+    vector<string> args(argv + 2, argv + argc);
+    for(size_t i = 0; i < args.size(); i++)
+    {
+        const string& arg = args[i];
+        if(arg == "--force") {
+            isForced = true;
+            continue;
+        }
+        if(i + 1 >= args.size()) {
+            PrintHelp(argv[0]);
+            return 1;
+        }
+
+        const string& value = args[++i];
+        bool isValid = true;
+        if(arg == "--seed") options.Seed = strtoull(value.c_str(), nullptr, 10);
+        else if(arg == "--directories") options.Directories = atoi(value.c_str());
+        else if(arg == "--tables") options.Tables = atoi(value.c_str());
+        else if(arg == "--columns") isValid = ParseRange(value, options.MinColumns, options.MaxColumns);
+        else if(arg == "--rows") isValid = ParseRange(value, options.MinRows, options.MaxRows);
+        else if(arg == "--max-cells") options.MaxCells = strtoll(value.c_str(), nullptr, 10);
+        else if(arg == "--runs") options.Runs = atoi(value.c_str());
+        else if(arg == "--run-range") isValid = ParseRange(value, options.MinRunRangeLength, options.MaxRunRangeLength);
+        else if(arg == "--variations") options.Variations = atoi(value.c_str());
+        else if(arg == "--variation-depth") options.VariationDepth = atoi(value.c_str());
+        else if(arg == "--assignments") isValid = ParseRange(value, options.MinAssignments, options.MaxAssignments);
+        else if(arg == "--int-share") options.IntColumnsShare = atof(value.c_str());
+        else if(arg == "--string-share") options.StringColumnsShare = atof(value.c_str());
+        else isValid = false;
+
+        if(!isValid) {
+            fprintf(stderr, "Wrong option or value: %s %s\n", arg.c_str(), value.c_str());
+            PrintHelp(argv[0]);
+            return 1;
+        }
+    }
+
+    try
+    {
+        SyntheticDatabase generator(options);
+        if(isForced) remove(outputPath.c_str());
+
+        StopWatch stopWatch;
+        SyntheticDatabaseStats stats = generator.Generate(outputPath);
+
+        printf("%s: %llu directories, %llu tables, %llu columns, %llu variations (deepest %s, depth %d), %llu run ranges\n",
+               outputPath.c_str(), static_cast<unsigned long long>(stats.Directories), static_cast<unsigned long long>(stats.Tables),
+               static_cast<unsigned long long>(stats.Columns), static_cast<unsigned long long>(stats.Variations),
+               stats.DeepestVariation.c_str(), stats.MaxVariationDepth, static_cast<unsigned long long>(stats.RunRanges));
+        printf("%llu assignments, %llu cells, %llu vault bytes, %.3f s\n",
+               static_cast<unsigned long long>(stats.Assignments), static_cast<unsigned long long>(stats.Cells),
+               static_cast<unsigned long long>(stats.VaultBytes), stopWatch.ElapsedMs() / 1000.0);
+    }
+    catch (std::exception& ex)
+    {
+        fprintf(stderr, "%s\n", ex.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,141 @@
+/**
+ *  Writes RowSchema descriptors of CCDB type tables (@see ccdb::RowSchema, Calibration::GetCalibRows)
+ *
+ *  usage: ccdb_rowschema <sqlite file> [table path ...]
+ *
+ *  For each table (all tables if no path is given) a row struct with one member per column
+ *  and its RowSchema specialization are printed to stdout, ready to be saved as a header:
+ *
+ *      ccdb_rowschema ccdb.sqlite /TOF/gains > TofRows.h
+ *
+ *  Struct names are made from table names (gains => Gains), members are named as columns.
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <set>
+#include <exception>
+
+#include "CCDB/Providers/SQLiteDataProvider.h"
+#include "CCDB/Model/Catalog.h"
+
+using namespace std;
+using namespace ccdb;
+
+
+//______________________________________________________________________________
+static string MakeIdentifier(const string& name, bool isTypeName)
+{
+    // Column and table names may have symbols that C++ names can't. They are replaced by '_'
+
+    static const set<string> keywords = {"auto", "bool", "break", "case", "char", "class", "const", "default", "delete",
+        "do", "double", "else", "enum", "float", "for", "if", "int", "long", "namespace", "new", "operator", "private",
+        "public", "return", "short", "signed", "static", "struct", "switch", "template", "this", "unsigned", "void", "while"};
+
+    string result;
+    bool isWordStart = true;
+    for(char symbol: name)
+    {
+        if(isalnum(static_cast<unsigned char>(symbol)))
+        {
+            result += (isTypeName && isWordStart) ? static_cast<char>(toupper(static_cast<unsigned char>(symbol))) : symbol;
+            isWordStart = false;
+        }
+        else
+        {
+            if(!isTypeName) result += '_';
+            isWordStart = true;
+        }
+    }
+
+    if(result.empty() || isdigit(static_cast<unsigned char>(result[0]))) result = "_" + result;
+    if(keywords.count(result)) result += "_";
+    return result;
+}
+
+
+//______________________________________________________________________________
+static const char* GetMemberType(ConstantsTypeColumn::ColumnTypes type)
+{
+    switch(type)
+    {
+        case ConstantsTypeColumn::cIntColumn:    return "int";
+        case ConstantsTypeColumn::cUIntColumn:   return "unsigned int";
+        case ConstantsTypeColumn::cLongColumn:   return "long";
+        case ConstantsTypeColumn::cULongColumn:  return "unsigned long";
+        case ConstantsTypeColumn::cDoubleColumn: return "double";
+        case ConstantsTypeColumn::cBoolColumn:   return "bool";
+        default:                                 return "std::string";
+    }
+}
+
+
+//______________________________________________________________________________
+static void PrintSchema(const ConstantsTypeTable& table)
+{
+    string structName = MakeIdentifier(table.GetName(), true);
+    vector<string> members;
+    for(ConstantsTypeColumn* column: table.GetColumns()) members.push_back(MakeIdentifier(column->GetName(), false));
+
+    printf("/// %s\n", table.GetFullPath().c_str());
+    printf("struct %s\n{\n", structName.c_str());
+    for(size_t i = 0; i < members.size(); i++)
+    {
+        printf("    %s %s;\n", GetMemberType(table.GetColumns()[i]->GetType()), members[i].c_str());
+    }
+    printf("};\n\n");
+
+    printf("namespace ccdb\n{\n");
+    printf("    template<> struct RowSchema<%s>\n    {\n", structName.c_str());
+    printf("        static constexpr auto Fields = std::make_tuple(");
+    for(size_t i = 0; i < members.size(); i++)
+    {
+        printf("%s\n            Field(\"%s\", &%s::%s)", i ? "," : "", table.GetColumns()[i]->GetName().c_str(), structName.c_str(), members[i].c_str());
+    }
+    printf(");\n    };\n}\n\n");
+}
+
+
+int main(int argc, char* argv[])
+{
+    if(argc < 2)
+    {
+        fprintf(stderr, "usage: %s <sqlite file> [table path ...]\n", argv[0]);
+        return 1;
+    }
+
+    try
+    {
+        SQLiteDataProvider provider;
+        provider.Connect(string("sqlite://") + argv[1]);
+        shared_ptr<const Catalog> catalog = provider.GetCatalog();
+
+        vector<const CatalogTable*> tables;
+        if(argc == 2)
+        {
+            for(const CatalogTable& table: catalog->GetTables()) tables.push_back(&table);
+        }
+        for(int i = 2; i < argc; i++)
+        {
+            const CatalogTable* table = catalog->FindTable(string(argv[i]));
+            if(!table)
+            {
+                fprintf(stderr, "Error: no type table '%s'\n", argv[i]);
+                return 1;
+            }
+            tables.push_back(table);
+        }
+
+        printf("// Generated by ccdb_rowschema from %s\n\n", argv[1]);
+        printf("#include <string>\n#include <tuple>\n\n#include \"CCDB/Helpers/RowSchema.h\"\n\n");
+        for(const CatalogTable* table: tables) PrintSchema(*table->TypeTable);
+    }
+    catch (std::exception& ex)
+    {
+        fprintf(stderr, "Error: %s\n", ex.what());
+        return 1;
+    }
+    return 0;
+}
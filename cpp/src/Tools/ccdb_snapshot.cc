@@ -0,0 +1,67 @@
+/**
+ *  Converts CCDB SQLite database to binary snapshot file (.ccdbsnap)
+ *
+ *  usage: ccdb_snapshot <sqlite file> <output.ccdbsnap> [unix time]
+ *
+ *  The snapshot holds the database state at the given time (the latest state if no time is given).
+ *  Jobs read it with ccdbsnap://<output.ccdbsnap> connection string
+ *  and calibration time 0 or the same time (@see MappedSnapshotDataProvider).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <exception>
+
+#include "CCDB/Providers/SnapshotDataProvider.h"
+#include "CCDB/Providers/MappedSnapshotDataProvider.h"
+#include "CCDB/Helpers/StopWatch.h"
+
+using namespace std;
+using namespace ccdb;
+
+int main(int argc, char* argv[])
+{
+    if(argc < 3 || argc > 4)
+    {
+        fprintf(stderr, "usage: %s <sqlite file> <output.ccdbsnap> [unix time]\n", argv[0]);
+        return 1;
+    }
+
+    string sqlitePath(argv[1]);
+    string outputPath(argv[2]);
+    time_t snapshotTime = 0;
+    if(argc == 4)
+    {
+        char* end = nullptr;
+        snapshotTime = static_cast<time_t>(strtoll(argv[3], &end, 10));
+        if(*end != '\0' || snapshotTime < 0)
+        {
+            fprintf(stderr, "Time should be unix time in seconds, got '%s'\n", argv[3]);
+            return 1;
+        }
+    }
+
+    try
+    {
+        StopWatch stopWatch;
+
+        //all blobs are loaded at once
+        SnapshotDataProvider snapshot(snapshotTime);
+        snapshot.Connect(string(SnapshotDataProvider::ConnectionPrefix) + sqlitePath + "?blobs=eager");
+        snapshot.WriteBinarySnapshot(outputPath);
+
+        //the written file is checked by opening it
+        MappedSnapshotDataProvider mapped;
+        mapped.Connect(string(MappedSnapshotDataProvider::ConnectionPrefix) + outputPath);
+
+        printf("%s: %zu assignments, %zu blobs, %zu bytes, %.3f s\n", outputPath.c_str(), snapshot.GetAssignmentsCount(),
+               snapshot.GetLoadedBlobsCount(), mapped.GetMappedSize(), stopWatch.ElapsedMs() / 1000.0);
+    }
+    catch (std::exception& ex)
+    {
+        fprintf(stderr, "Error: %s\n", ex.what());
+        return 1;
+    }
+    return 0;
+}
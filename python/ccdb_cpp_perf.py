@@ -1,30 +1,27 @@
 """
 ccdb_cpp_perf allows to evaluate performance of C++ CCDB API on live applications
 
-To use this file one has to compile CCDB C++ API with `with-perflog=true` (it defines `CCDB_PERFLOG_ON` in C++):
+C++ CCDB API traces its requests when CCDB_TRACE environment variable is set, no special build is needed
+(see CCDB/Helpers/Trace.h). With `CCDB_TRACE=events` spans of all request phases (request, parse, metadata,
+sql, blob_split, decode, cache, prefetch) are written at exit like:
 
 ```
-> scons with-perflog=true
+CCDB_TRACE:{"thread":1,"phase":"request","detail":"/PHOTON_BEAM/endpoint_energy","start_us":7309293909.528,"elapsed_us":1115.250}
 ```
 
-After this, when any constant is requested, CCDB spams performance info to std::cout like:
+The output goes to stderr or to the file given by CCDB_TRACE_FILE. Give this file to ccdb_cpp_perf.py:
 
 ```
-CCDB_PERF_LOG:{"thread_id":139771280078592,"descr":"Calibration::GetAssignment=>/PHOTON_BEAM/endpoint_energy","start_stamp":1498647171590502,"elapsed":1558,"t_units":"us"}
+> CCDB_TRACE=events CCDB_TRACE_FILE=ccdb_trace.log <analysing_soft> ...
+> python $CCDB_HOME/python/ccdb_cpp_perf.py ccdb_trace.log
 ```
 
-one needs to save all these outputs to a file and provide path to this file to ccdb_cpp_perf.py
-
-So after CCDB is compiled using `with-perflog=true`,  the commands are:
-
-```
-> <analysing_soft> ... > ccdb_perf.log
-> python $CCDB_HOME/python/ccdb_cpp_perf.py ccdb_cpp_perf
-```
+`CCDB_TRACE=summary` writes only a table of phases totals, which doesn't need this script.
 
 ### Troubleshouting 
 
-If you don't see `CCDB_PERF_LOG:...` messages and you are sure that ccdb is called at all, check with 'ldd' that the right copy of ccdb.so is loaded. 
+Each thread keeps the last 4096 events. If the summary reports dropped events, the oldest requests are not in the log.
+If you don't see `CCDB_TRACE:...` lines and you are sure that ccdb is called at all, check with 'ldd' that the right copy of ccdb.so is loaded. 
 """
 
 import argparse
@@ -33,19 +30,19 @@ import pandas as pd
 import matplotlib.pyplot as plt
 
 
-def read_ccdb_perf_log(filename):
+def read_ccdb_perf_log(filename, phase="request"):
     result = []
     with open(filename) as f:
         for line in f:
-            if not line.startswith("CCDB_PERF_LOG:"):
+            if not line.startswith("CCDB_TRACE:"):
                 continue
 
-            if " total" in line:
+            row = json.loads(line[len("CCDB_TRACE:"):])
+            if phase and row["phase"] != phase:
                 continue
 
-            line = line[len("CCDB_PERF_LOG:"):]
-            row = json.loads(line)
-            row["path"] = row['descr'].split('=>')[1]
+            row["path"] = row["detail"]
+            row["elapsed"] = row["elapsed_us"]
             result.append(row)
 
     return result
@@ -61,18 +58,17 @@ if __name__ == "__main__":
 
     parser = argparse.ArgumentParser()
     parser.add_argument('filename')
+    parser.add_argument('--phase', default='request', help="phase to analyse: request, parse, metadata, sql, "
+                                                           "blob_split, decode, cache, prefetch")
     args = parser.parse_args()
 
-    data = read_ccdb_perf_log(args.filename)
+    data = read_ccdb_perf_log(args.filename, args.phase)
 
     print(("Total CCDB requests: ", len(data)))
     df = pd.DataFrame(data)
 
     # we don't need these columns for now
-    df.drop('t_units', axis=1, inplace=True)
-    df.drop('descr', axis=1, inplace=True)
-    df.drop('thread_id', axis=1, inplace=True)
-    df.drop('start_stamp', axis=1, inplace=True)
+    df.drop(['phase', 'detail', 'thread', 'start_us', 'elapsed_us'], axis=1, inplace=True)
     df.sort_values('elapsed', ascending=False, inplace=True)
 
     print(("Total time reading from CCDB [s]: ", df.elapsed.sum() / 1000000.0))